@@ -21,6 +21,11 @@
     and for generating Pedersen parameters and validation visit
     https://link.springer.com/content/pdf/10.1007/BFb0052225.pdf, page 19, section 3.1
 
+    usage: example_cg21_auxinfo [prime pool]
+
+    With a prime pool file, the safe primes of each party are taken from the
+    pool, which is filled first if it holds too few of them. Otherwise the
+    hardcoded primes below are used.
 
  */
 
@@ -32,9 +37,13 @@
 #include "amcl/schnorr.h"
 #include "amcl/cg21/cg21_utilities.h"
 #include "amcl/cg21/cg21.h"
+#include "amcl/cg21/cg21_prime_pool.h"
 
 bool Debug = false;
 
+// AES-256 key of the prime pool
+char *POOL_K_hex = "5c0e7a1b93d24f68a0b7c3e9d1f25a84c67e0b39f1d28a5c4e703b9d6a1f8c2e";
+
 // Safe primes for Paillier and Pederesen param generation
 char *PT_hex[] = {"ffa0ec8cec4d2ffbef2a251111a361ad0199133f0aaa715df5ef052ad1efee2efda77a9349a74743e394ecef4da268c63171b8a896df79ec940f0c11d5de4a90d66628646f21f1ac0ac5f13adf45d2fd1d795c766dff1f656c91c3650ac2b59734efd3431332d691815da465b0d6f65b1620f4b1c7b9c18b38f63f478c06ca67",
                    "db47424304e2c5d57f50f6f73881eef53f55ea680d9f48b57df3e404303442c7fa5bd9418c5928cbe3b293281bdf8dce0350d7c65f22acfcf6b0fe5442fdb0c61bf396d13bc81992392d67c260a596b88eebe25661859fbcc8e871760794a3b810da2e881bb0cec6ca9310375d37bcc867436152ee71c59508220c8fbc6d9783",
@@ -421,7 +430,7 @@ int cg21_output(CG21_AUX_SESSION *auxSession){
             ssid.g = auxSession->ssid[i].g;
             ssid.q = auxSession->ssid[i].q;
 
-            int rc = CG21_PI_MOD_VERIFY_HELPER(&auxSession->round1StorePub[j],&ssid,&auxSession->round3[j]);
+            int rc = CG21_PI_MOD_VERIFY_BATCH_HELPER(auxSession->RNG, &auxSession->round1StorePub[j],&ssid,&auxSession->round3[j]);
             if (rc != CG21_OK)
             {
                 printf("Pi_MOD proof verification failed, %d\n", rc);
@@ -555,7 +564,12 @@ void Store_CSV(const CG21_AUX_SESSION *auxSession, int n){
 
 }
 
-int main() {
+int main(int argc, char *argv[]) {
+
+    if (argc > 2){
+        printf("usage: example_cg21_auxinfo [prime pool]\n");
+        exit(1);
+    }
 
     // Deterministic RNG for debugging
     const char* seedHex = "78d0fb6705ce77dee47d03eb5b9c5d30";
@@ -640,17 +654,50 @@ int main() {
     auxSession.pedersenKeys = pedersenKeys;
 
 
+    char pool_k[CG21_PRIME_POOL_KEY_SIZE];
+    octet POOL_K = {0, sizeof(pool_k), pool_k};
+    int available = 0;
+
+    if (argc == 2){
+        OCT_fromHex(&POOL_K, POOL_K_hex);
+
+        // each party takes two primes
+        int rc = CG21_PRIME_POOL_AVAILABLE(argv[1], &available);
+        if (rc != CG21_PRIME_POOL_OK && rc != CG21_PRIME_POOL_IO_ERROR){
+            printf("\nCG21_PRIME_POOL_AVAILABLE failed, %d", rc);
+            exit(rc);
+        }
+
+        if (available < 2*n){
+            printf("\nGenerating %d safe primes into %s", 2*n - available, argv[1]);
+            rc = CG21_PRIME_POOL_FILL(&RNG, argv[1], &POOL_K, 2*n - available);
+            if (rc != CG21_PRIME_POOL_OK){
+                printf("\nCG21_PRIME_POOL_FILL failed, %d", rc);
+                exit(rc);
+            }
+        }
+    }
+
     // note: based on the CG21(CSS20):Figure 5, same safe primes p,q are used for both Paillier and Pedersen
     for (int i=0; i<n; i++){
-        // Generate Paillier Keys
-        PAILLIER_KEY_PAIR(NULL, &P[i],&Q[i], &paillierKeys[i].paillier_pk,
-                          &paillierKeys[i].paillier_sk);
+        if (argc == 2){
+            // Generate Paillier and Pedersen Keys from two pooled primes
+            int rc = CG21_PRIME_POOL_AUX_KEYS(&RNG, argv[1], &POOL_K, &paillierKeys[i], &pedersenKeys[i]);
+            if (rc != CG21_PRIME_POOL_OK){
+                printf("\nCG21_PRIME_POOL_AUX_KEYS failed, %d", rc);
+                exit(rc);
+            }
+        } else {
+            // Generate Paillier Keys
+            PAILLIER_KEY_PAIR(NULL, &P[i],&Q[i], &paillierKeys[i].paillier_pk,
+                              &paillierKeys[i].paillier_sk);
 
-        // Generate Pedersen Keys
-        ring_Pedersen_setup(&RNG, &pedersenKeys[i].pedersenPriv, &P[i],&Q[i]);
+            // Generate Pedersen Keys
+            ring_Pedersen_setup(&RNG, &pedersenKeys[i].pedersenPriv, &P[i],&Q[i]);
 
-        // copy Pedersen public params into another structure to be shared
-        Pedersen_get_public_param(&pedersenKeys[i].pedersenPub, &pedersenKeys[i].pedersenPriv);
+            // copy Pedersen public params into another structure to be shared
+            Pedersen_get_public_param(&pedersenKeys[i].pedersenPub, &pedersenKeys[i].pedersenPriv);
+        }
         printf("\n{N}=");
         FF_2048_output(pedersenKeys[i].pedersenPub.N, FFLEN_2048);
         printf("\n{s}=");
@@ -810,7 +857,7 @@ int main() {
     char round3_rho[n][EGS_SECP256K1];
     char round3_x[n][CG21_PAILLIER_PROOF_SIZE];
     char round3_z[n][CG21_PAILLIER_PROOF_SIZE];
-    char round3_ab[n][CG21_PAILLIER_PROOF_ITERS*4];
+    char round3_ab[n][CG21_PAILLIER_PROOF_AB_SIZE];
     char round3_w[n][HFS_4096];
 
     // for PiFactor
@@ -849,7 +896,7 @@ int main() {
     init_octets((char *)round3_rho, ROUND3_rho, EGS_SECP256K1, n);
     init_octets((char *)round3_x, ROUND3_X, CG21_PAILLIER_PROOF_SIZE, n);
     init_octets((char *)round3_z, ROUND3_Z, CG21_PAILLIER_PROOF_SIZE, n);
-    init_octets((char *)round3_ab, ROUND3_AB, CG21_PAILLIER_PROOF_ITERS*4, n);
+    init_octets((char *)round3_ab, ROUND3_AB, CG21_PAILLIER_PROOF_AB_SIZE, n);
     init_octets((char *)round3_w, ROUND3_W, HFS_4096, n);
     init_octets((char *)round3_sigma, ROUND3_sigma, 2*FS_2048+HFS_2048, n);
     init_octets((char *)round3_P_, ROUND3_P, FS_2048, n);
@@ -404,9 +404,16 @@ void cg21_key_reshare_round3(CG21_reshare_session *session){
     // Each player XORs the given partial rho_i at this stage, but for simplicity of the example file
     // we load the final XORed rho from a hard-coded variable 'RHO'
 
-    // each player in T1 encrypts the results of his VSS using receivers' PK and broadcast them
+    // each player in T1 encrypts the results of his VSS using receivers' PK and broadcast them.
+    // The nonces r^N are precomputed for each receiver, e.g. while waiting for round 2
+    int nr = session->setting.n2 - 1;
+
     for (int i=0;i< session->setting.t1; i++) {
 
+        CG21_PAILLIER_NONCE_POOL pools[nr];
+        BIG_512_60 mem[nr][FFLEN_4096];
+        int hisID[nr];
+
         int t =0;
         for (int j=0;j< session->setting.n2; j++) {
 
@@ -414,12 +421,22 @@ void cg21_key_reshare_round3(CG21_reshare_session *session){
                 continue;
             }
 
-            CG21_KEY_RESHARE_ENCRYPT_SHARES(session->RNG, &session->paillierKeys[j].paillier_pk, j+1,
-                            &session->storeSecretT1[i],session->storePubT1[i],
-                            &session->round3_Output[i*(session->setting.n2-1)+t]);
+            CG21_PAILLIER_NONCE_POOL_FILL(session->RNG, &pools[t], &session->paillierKeys[j].paillier_pk, mem[t], 1);
+            hisID[t] = j+1;
 
             t = t +1;
         }
+
+        int rc = CG21_KEY_RESHARE_ENCRYPT_ALL_SHARES(pools, hisID, nr, &session->storeSecretT1[i],
+                                                     session->storePubT1[i],
+                                                     &session->round3_Output[i*nr]);
+        if (rc!=CG21_OK){
+            exit(rc);
+        }
+
+        for (int j=0; j<nr; j++){
+            CG21_PAILLIER_NONCE_POOL_KILL(&pools[j]);
+        }
     }
 
 }
@@ -430,18 +447,52 @@ void cg21_key_reshare_round4(CG21_reshare_session *session){
     char x_[EFS_SECP256K1 + 1];
     octet X = {0, sizeof(x_), x_};
 
+    int nr = session->setting.n2 - 1;
+
     for (int i=0; i< session->setting.n2; i++){
         printf("\nParty %d run CG21_KEY_RESHARE_CHECK_VSS_T1/N2", i+1);
 
+        // decrypt the shares received from the players in T1
+        int ns = 0;
+        CG21_RESHARE_ROUND3_OUTPUT received[session->setting.t1];
+        SSS_shares shares[session->setting.t1];
+
+        char sx[session->setting.t1][EGS_SECP256K1];
+        char sy[session->setting.t1][EGS_SECP256K1];
+        octet SX[session->setting.t1];
+        octet SY[session->setting.t1];
+        init_octets((char *)sx, SX, EGS_SECP256K1, session->setting.t1);
+        init_octets((char *)sy, SY, EGS_SECP256K1, session->setting.t1);
+
         for (int j=0; j<session->setting.t1; j++){
             if (i==j)
                 continue;
 
-            // the code in bellow should be replaced with decryption of C_i^j 'CG21_KEY_RESHARE_DECRYPT_SHARES',
-            // which is skipped for simplicity of this example
-            SSS_shares share;
-            share.X = &session->storeSecretT1[j].shares.X[i];
-            share.Y = &session->storeSecretT1[j].shares.Y[i];
+            // position of player i among the receivers of player j
+            int t = (i < j) ? i : i - 1;
+
+            received[ns] = session->round3_Output[j*nr + t];
+            shares[ns].X = SX + ns;
+            shares[ns].Y = SY + ns;
+            ns = ns + 1;
+        }
+
+        CG21_KEY_RESHARE_DECRYPT_ALL_SHARES(&session->paillierKeys[i].paillier_sk, received, shares, ns);
+
+        ns = 0;
+        for (int j=0; j<session->setting.t1; j++){
+            if (i==j)
+                continue;
+
+            SSS_shares share = shares[ns];
+            ns = ns + 1;
+
+            // the decrypted share must be the one player j computed
+            if (!OCT_comp(share.X, &session->storeSecretT1[j].shares.X[i]) ||
+                !OCT_comp(share.Y, &session->storeSecretT1[j].shares.Y[i])){
+                printf("\nParty %d decrypted a wrong share from party %d", i+1, j+1);
+                exit(EXIT_FAILURE);
+            }
 
             int Xstatus = 1;
             if (j==0 || (j==1 && i==0) )
@@ -0,0 +1,238 @@
+/*
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"); you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+*/
+
+/*
+ * Store key shares in an encrypted keystore and compare the time to load
+ * them with the time to import them again from their octet encoding.
+ *
+ * usage: example_cg21_keystore [keys]
+ *
+ * All the keys reuse the same Paillier and Pedersen primes, and every peer
+ * the public keys of the party, to keep the example fast.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <amcl/amcl.h>
+#include <amcl/randapi.h>
+#include "amcl/cg21/cg21_keystore.h"
+
+#define PEERS 3
+
+char* P_hex = "ffa0ec8cec4d2ffbef2a251111a361ad0199133f0aaa715df5ef052ad1efee2efda77a9349a74743e394ecef4da268c63171b8a896df79ec940f0c11d5de4a90d66628646f21f1ac0ac5f13adf45d2fd1d795c766dff1f656c91c3650ac2b59734efd3431332d691815da465b0d6f65b1620f4b1c7b9c18b38f63f478c06ca67";
+char* Q_hex = "e4d2fcd44d6bda22588e7f64e47fb32b1783cdc6ea43df8618cd27ae50e38a7d2ff1a252aec54625ab497f3cfe5860547ee0c66cb4ca0e29ccb1098fa3c04cee2565a20510596f5e0c8e4e2adde5aedcbb1803250f3465941880055798f1e36f5ba60e8878328132c070c6fad3c8ad2c155fd4cc88927f4410d498a5a5e40d8b";
+
+/* Monotonic clock, microseconds */
+static long long now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (long long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/* Key share with its own public keys as peers */
+static void make_key(csprng *RNG, octet *P, octet *Q, CG21_KEYSTORE_KEY *key, CG21_KEYSTORE_PEER *peers)
+{
+    ECP_SECP256K1 G;
+    BIG_256_56 q;
+    BIG_256_56 s;
+
+    char x[EFS_SECP256K1 + 1];
+    octet X = {0, sizeof(x), x};
+
+    memset(key, 0, sizeof(CG21_KEYSTORE_KEY));
+
+    for (int i = 0; i < CG21_KEYSTORE_ID_SIZE; i++)
+    {
+        key->id[i] = (char)RAND_byte(RNG);
+    }
+
+    key->j = 1;
+    key->t = 2;
+
+    // random share and its public key
+    BIG_256_56_rcopy(q, CURVE_Order_SECP256K1);
+    BIG_256_56_randomnum(s, q, RNG);
+    BIG_256_56_toBytes(key->share, s);
+
+    ECP_SECP256K1_generator(&G);
+    ECP_SECP256K1_mul(&G, s);
+    ECP_SECP256K1_toOctet(&X, &G, true);
+    memcpy(key->X, X.val, sizeof(key->X));
+
+    PAILLIER_KEY_PAIR(NULL, P, Q, &key->paillier.paillier_pk, &key->paillier.paillier_sk);
+
+    ring_Pedersen_setup(RNG, &key->pedersen.pedersenPriv, P, Q);
+    Pedersen_get_public_param(&key->pedersen.pedersenPub, &key->pedersen.pedersenPriv);
+
+    for (int i = 0; i < PEERS; i++)
+    {
+        memset(peers + i, 0, sizeof(CG21_KEYSTORE_PEER));
+
+        peers[i].j = i + 1;
+        memcpy(peers[i].X, key->X, sizeof(key->X));
+        peers[i].paillier = key->paillier.paillier_pk;
+        peers[i].pedersen = key->pedersen.pedersenPub;
+    }
+
+    BIG_256_56_zero(s);
+}
+
+int main(int argc, char *argv[])
+{
+    int keys = argc > 1 ? atoi(argv[1]) : 64;
+    int rc;
+    long long t0;
+
+    CG21_KEYSTORE ks;
+    CG21_KEYSTORE_KEY key;
+    CG21_KEYSTORE_KEY loaded;
+    CG21_KEYSTORE_PEER peers[PEERS];
+    CG21_KEYSTORE_PEER lpeers[PEERS];
+
+    char p[HFS_2048];
+    octet P = {0, sizeof(p), p};
+
+    char q[HFS_2048];
+    octet Q = {0, sizeof(q), q};
+
+    char k[CG21_KEYSTORE_KEY_SIZE];
+    octet K = {0, sizeof(k), k};
+
+    char pq[2 * HFS_2048];
+    octet PQ = {0, sizeof(pq), pq};
+
+    char ped[6 * FS_2048 + 3 * HFS_2048];
+    octet PED = {0, sizeof(ped), ped};
+
+    char pedpub[3 * FS_2048];
+    octet PEDPUB = {0, sizeof(pedpub), pedpub};
+
+    char paipub[FS_4096 + HFS_4096];
+    octet PAIPUB = {0, sizeof(paipub), paipub};
+
+    if (keys <= 0)
+    {
+        printf("usage: example_cg21_keystore [keys]\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // Deterministic RNG for debugging
+    const char* seedHex = "78d0fb6705ce77dee47d03eb5b9c5d30";
+    char seed[16] = {0};
+    octet SEED = {sizeof(seed),sizeof(seed),seed};
+
+    csprng RNG;
+
+    OCT_fromHex(&SEED,seedHex);
+    CREATE_CSPRNG(&RNG, &SEED);
+
+    OCT_fromHex(&P, P_hex);
+    OCT_fromHex(&Q, Q_hex);
+    OCT_rand(&K, &RNG, CG21_KEYSTORE_KEY_SIZE);
+
+    make_key(&RNG, &P, &Q, &key, peers);
+
+    // Encodings the keys are imported from without a keystore
+    CG21_PaillierPriv_to_octet(&key.paillier.paillier_sk, &PQ);
+    CG21_PedersenPriv_to_octet(&key.pedersen.pedersenPriv, &PED);
+    CG21_PedersenPub_to_octet(&peers[0].pedersen, &PEDPUB);
+    CG21_PaillierPub_to_octet(&peers[0].paillier, &PAIPUB);
+
+    remove("cg21_keystore.bin");
+
+    rc = CG21_KEYSTORE_OPEN(&ks, "cg21_keystore.bin", PEERS);
+    if (rc != CG21_KEYSTORE_OK)
+    {
+        printf("FAILURE CG21_KEYSTORE_OPEN rc: %d\n", rc);
+        exit(EXIT_FAILURE);
+    }
+
+    for (int i = 0; i < keys; i++)
+    {
+        rc = CG21_KEYSTORE_APPEND(&RNG, &ks, &K, &key, peers, NULL);
+        if (rc != CG21_KEYSTORE_OK)
+        {
+            printf("FAILURE CG21_KEYSTORE_APPEND rc: %d\n", rc);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    CG21_KEYSTORE_CLOSE(&ks);
+
+    // Restart: open the keystore and load all the keys
+    t0 = now();
+
+    rc = CG21_KEYSTORE_OPEN(&ks, "cg21_keystore.bin", PEERS);
+    for (int i = 0; i < keys && rc == CG21_KEYSTORE_OK; i++)
+    {
+        rc = CG21_KEYSTORE_LOAD(&ks, &K, i, &loaded, lpeers);
+    }
+
+    printf("keystore: %d keys loaded in %.3f ms\n", keys, (now() - t0) / 1000.0);
+
+    CG21_KEYSTORE_CLOSE(&ks);
+
+    if (rc != CG21_KEYSTORE_OK)
+    {
+        printf("FAILURE CG21_KEYSTORE_LOAD rc: %d\n", rc);
+        exit(EXIT_FAILURE);
+    }
+
+    if (memcmp(&loaded, &key, sizeof(key)) != 0 || memcmp(lpeers, peers, sizeof(peers)) != 0)
+    {
+        printf("FAILURE the loaded key is different\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // Same keys imported from their octet encoding
+    t0 = now();
+
+    for (int i = 0; i < keys; i++)
+    {
+        CG21_PaillierKeys_from_octet(&loaded.paillier, &PQ);
+        CG21_PedersenPriv_from_octet(&loaded.pedersen.pedersenPriv, &PED);
+
+        for (int j = 0; j < PEERS; j++)
+        {
+            CG21_PedersenPub_from_octet(&lpeers[j].pedersen, &PEDPUB);
+            CG21_PaillierPub_from_octet(&lpeers[j].paillier, &PAIPUB);
+        }
+    }
+
+    printf("octets:   %d keys imported in %.3f ms\n", keys, (now() - t0) / 1000.0);
+
+    // clean up
+    CG21_KEYSTORE_KEY_KILL(&key);
+    CG21_KEYSTORE_KEY_KILL(&loaded);
+    OCT_clear(&K);
+    OCT_clear(&P);
+    OCT_clear(&Q);
+    OCT_clear(&PQ);
+    OCT_clear(&PED);
+    KILL_CSPRNG(&RNG);
+
+    printf("SUCCESS\n");
+    exit(EXIT_SUCCESS);
+}
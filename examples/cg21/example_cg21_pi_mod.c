@@ -22,7 +22,9 @@
 
  */
 
+#define _POSIX_C_SOURCE 200809L
 #include <stdlib.h>
+#include <time.h>
 #include <amcl/amcl.h>
 #include "amcl/cg21/cg21_pi_mod.h"
 #include <amcl/paillier.h>
@@ -33,6 +35,16 @@
 bool Debug = false;
 
 
+/* Monotonic clock, microseconds */
+static long long now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (long long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
 void dec_to_octet(int decimal_Number, octet *O)
 {
     BIG_256_56 temp;
@@ -121,7 +133,7 @@ int main() {
     char zoct[CG21_PAILLIER_PROOF_SIZE];
     octet Zoct = {0, sizeof(zoct), zoct};
 
-    char ab[CG21_PAILLIER_PROOF_ITERS*4];
+    char ab[CG21_PAILLIER_PROOF_AB_SIZE];
     octet AB = {0,sizeof(ab),ab};
 
     char w[HFS_4096];
@@ -146,6 +158,25 @@ int main() {
     }
 
     // verify the proofs
+    long long t0 = now();
+    rc = CG21_PI_MOD_VERIFY(&paillierProof, &ssid, paillierKeys.paillier_pk, n);
+    printf("CG21_PI_MOD_VERIFY:       %.3f ms\n", (now() - t0) / 1000.0);
+    if (rc != CG21_OK){
+        printf("FAILURE\n");
+        exit(1);
+    }
+
+    // the zi checks batched with random exponents
+    t0 = now();
+    rc = CG21_PI_MOD_VERIFY_BATCH(&RNG, &paillierProof, &ssid, paillierKeys.paillier_pk, n);
+    printf("CG21_PI_MOD_VERIFY_BATCH: %.3f ms\n", (now() - t0) / 1000.0);
+    if (rc != CG21_OK){
+        printf("FAILURE\n");
+        exit(1);
+    }
+
+    // (ai,bi) can be left out, the verifier recovers them from xi
+    OCT_clear(&AB);
     rc = CG21_PI_MOD_VERIFY(&paillierProof, &ssid, paillierKeys.paillier_pk, n);
     if (rc == CG21_OK){
         printf("SUCCESS\n");
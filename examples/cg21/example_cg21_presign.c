@@ -296,32 +296,40 @@ void CG21_presign_round1(CG21_PRESIGN_SESSION *session){
 
     for (int i=0; i<session->setting->t2; i++) {
 
-            CG21_PRESIGN_ROUND1(session->RNG,
-                                &session->reshareOutput[i],
-                                session->setting,
-                                &session->r1out[i],
-                                &session->r1Store[i],
-                                &session->paillierKeys[i].paillier_pk);
-
-        if (i>0) {
-            // assume only player 1 generates PiEnc proof for the other players
-
-            PiEnc_SECRETS PiEncSecrets;
-            PiEnc_Sample_randoms_and_commit(session->RNG, &session->paillierKeys[0].paillier_sk,
-                                            &session->pedersenKeys[i].pedersenPub,
-                                            session->r1Store[0].k, &PiEncSecrets, &session->PiEncCommit[i],
-                                            &session->PiEncCommitOct[i]);
-
-            char e_[MODBYTES_256_56];
-            octet e = {0, sizeof(e_), e_};
-
-            PiEnc_Challenge_gen(&session->paillierKeys[0].paillier_pk, &session->pedersenKeys[i].pedersenPub,
-                                session->r1out[0].K, &session->PiEncCommit[i], &session->ssid[0], &e);
-
-            PiEnc_Prove(&session->paillierKeys[0].paillier_sk, session->r1Store[0].k,
-                        session->r1Store[0].rho, &PiEncSecrets, &e, &session->PiEnc_proof[i],
-                        &session->PiEncProofOct[i]);
-        }
+        CG21_PRESIGN_ROUND1(session->RNG,
+                            &session->reshareOutput[i],
+                            session->setting,
+                            &session->r1out[i],
+                            &session->r1Store[i],
+                            &session->paillierKeys[i].paillier_pk);
+    }
+
+    // assume only player 1 generates PiEnc proof for the other players.
+    // A is shared by all the verifiers, only S and C are computed per verifier
+    int nv = session->setting->t2 - 1;
+    PEDERSEN_PUB *pub_com[nv];
+    PiEnc_SECRETS PiEncSecrets[nv];
+
+    for (int i=0; i<nv; i++) {
+        pub_com[i] = &session->pedersenKeys[i+1].pedersenPub;
+    }
+
+    PiEnc_Sample_randoms_and_commit_multi(session->RNG, &session->paillierKeys[0].paillier_sk, pub_com, nv,
+                                          session->r1Store[0].k, PiEncSecrets, session->PiEncCommit + 1,
+                                          session->PiEncCommitOct + 1);
+
+    char e_[MODBYTES_256_56];
+    octet e = {0, sizeof(e_), e_};
+
+    PiEnc_Challenge_gen_multi(&session->paillierKeys[0].paillier_pk, pub_com, nv,
+                              session->r1out[0].K, session->PiEncCommit + 1, &session->ssid[0], &e);
+
+    for (int i=0; i<nv; i++) {
+        PiEnc_Prove(&session->paillierKeys[0].paillier_sk, session->r1Store[0].k,
+                    session->r1Store[0].rho, &PiEncSecrets[i], &e, &session->PiEnc_proof[i+1],
+                    &session->PiEncProofOct[i+1]);
+
+        PiEnc_Kill_secrets(&PiEncSecrets[i]);
     }
 
 }
@@ -332,13 +340,20 @@ void CG21_presign_round2(CG21_PRESIGN_SESSION *session){
 
     // ----- PI-ENC PROOF VALIDATION -----
     // other players verify player 1 Pi_enc proof
+    int nv = t2 - 1;
+    PEDERSEN_PUB *pub_com[nv];
+
+    for (int i=0; i<nv; i++) {
+        pub_com[i] = &session->pedersenKeys[i+1].pedersenPub;
+    }
+
     for (int i=1; i<session->setting->t2; i++) {
 
         char e_[MODBYTES_256_56];
         octet e = {0, sizeof(e_), e_};
 
-        PiEnc_Challenge_gen(&session->paillierKeys[0].paillier_pk, &session->pedersenKeys[i].pedersenPub,
-                            session->r1out[0].K, &session->PiEncCommit[i], &session->ssid[0], &e);
+        PiEnc_Challenge_gen_multi(&session->paillierKeys[0].paillier_pk, pub_com, nv,
+                                  session->r1out[0].K, session->PiEncCommit + 1, &session->ssid[0], &e);
 
         int rc = PiEnc_Verify(&session->paillierKeys[0].paillier_pk, &session->pedersenKeys[i].pedersenPriv,
                               session->r1out[0].K, &session->PiEncCommit[i], &e, &session->PiEnc_proof[i]);
@@ -351,122 +366,81 @@ void CG21_presign_round2(CG21_PRESIGN_SESSION *session){
             printf("\nPlayer %d verified pi-enc range proof from player 1 successfully!", i+1);
         }
     }
-    // -------------------------------
-
-    // ----- PRE-SIGN ROUND 2 -----
-    for (int i=0; i<t2; i++) {
-        for (int j=0; j<t2; j++){
-            if (i==j){
-                continue;
-            }
-            CG21_PRESIGN_ROUND2(session->RNG,session->r2out+i*t2+j,session->r2Store+i*t2+j,
-                                session->r1out+j,session->r1Store+i,&(session->paillierKeys+j)->paillier_pk,
-                                &(session->paillierKeys+i)->paillier_pk);
-        }
-    }
-    // ---------------------------
-
-    // ----- PI-LOGSTAR PROOF GENERATION -----
-    // assume only player 1 generates PiLogStar proof for the other players
-    for (int i=1; i<session->setting->t2; i++) {
-
-        PiLogstar_SECRETS PiLogSecrets;
-        ECP_SECP256K1 G;
-        ECP_SECP256K1_generator(&G);
-        char t[SFS_SECP256K1 + 1];
-        octet g_ = {0, sizeof(t), t};
-        ECP_SECP256K1_toOctet(&g_, &G, true);
-
-        ECP_SECP256K1_toOctet(&g_, &G, true);
-
-        int rc = PiLogstar_Sample_and_commit(session->RNG, &session->paillierKeys[0].paillier_sk,
-                                    &session->pedersenKeys[i].pedersenPub,session->r1Store[0].gamma, &g_,
-                                    &PiLogSecrets, &session->PiLogCommit1[i], &session->PiLogCommitOct1[i]);
-        if (rc != PiLogstar_OK){
-            printf("PiLogstar_Sample_and_commit failed!, %d", rc);
-            exit(rc);
-        }
 
+    // a commitment A_j different from the one bound to the challenge is rejected
+    if (nv > 1){
         char e_[MODBYTES_256_56];
         octet e = {0, sizeof(e_), e_};
 
-        PiLogstar_Challenge_gen(&session->paillierKeys[0].paillier_pk, &session->pedersenKeys[i].pedersenPub,
-                                session->r1out[0].G, &session->PiLogCommit1[i], (session->ssid + 0), session->r2Store[i].Gamma, &e);
+        PiEnc_COMMITS tampered = session->PiEncCommit[nv];
+        FF_4096_inc(session->PiEncCommit[nv].A, 1, FFLEN_4096);
 
-        PiLogstar_Prove(&session->paillierKeys[0].paillier_sk, session->r1Store[0].gamma,
-                        session->r1Store[0].nu,&PiLogSecrets, &e, &session->PiLogProof1[i],
-                        &session->PiLogProofOct1[i]);
+        PiEnc_Challenge_gen_multi(&session->paillierKeys[0].paillier_pk, pub_com, nv,
+                                  session->r1out[0].K, session->PiEncCommit + 1, &session->ssid[0], &e);
 
-    }
-    // -------------------------------
-
-    // ----- PI-AFFG (D, K, F, GAMMA) PROOF GENERATION -----
-//     assume only player 0 generates PiAffG-1 proof for player 1
-    for (int i=1; i<session->setting->t2; i++) {
-        Piaffg_SECRETS PiAffgSecrets;
+        int rc = PiEnc_Verify(&session->paillierKeys[0].paillier_pk, &session->pedersenKeys[nv].pedersenPriv,
+                              session->r1out[0].K, &session->PiEncCommit[nv], &e, &session->PiEnc_proof[nv]);
 
-        int rc = Piaffg_Sample_and_Commit(session->RNG, &session->paillierKeys[0].paillier_sk,
-                                          &session->paillierKeys[i].paillier_pk, &session->pedersenKeys[i].pedersenPub,
-                                          session->r1Store[0].gamma, session->r2Store[i].beta, &PiAffgSecrets,
-                                          &session->PiAffgCommit1[i], &session->PiAffgCommitOct1[i], session->r1out[i].K);
+        session->PiEncCommit[nv] = tampered;
 
-        if (rc != Piaffg_OK){
-            printf("PiAffg_Sample_and_Commit failed!, %d", rc);
-            exit(rc);
+        if (rc == PiEnc_OK){
+            printf("\npi-enc range proof with a tampered A verified!");
+            exit(EXIT_FAILURE);
         }
-
-        char e_[MODBYTES_256_56];
-        octet e = {0, sizeof(e_), e_};
-
-        Piaffg_Challenge_gen(&session->paillierKeys[i].paillier_pk, &session->paillierKeys[0].paillier_pk,
-                             &session->pedersenKeys[i].pedersenPub, session->r2Store[i].Gamma, (session->r2out+i)->F, (session->r1out+i)->K,
-                             (session->r2out+i)->D, &session->PiAffgCommit1[i], (session->ssid + 0), &e);
-
-        Piaffg_Prove(&session->paillierKeys[0].paillier_pk, &session->paillierKeys[i].paillier_pk,
-                     &PiAffgSecrets, session->r1Store[0].gamma, session->r2Store[i].beta,
-                     session->r2Store[i].s, session->r2Store[i].r, &e, &session->PiAffgProof1[i], &session->PiAffgProofOct1[i]);
-
+        printf("\nPlayer %d rejected pi-enc range proof with a tampered A", nv+1);
     }
+    // -------------------------------
 
-    // ----- PI-AFFG (D-hat, K, F-hat, X) PROOF GENERATION -----
-//     assume only player 0 generates PiAffG-2 proof for player 1
-    for (int i=1; i<session->setting->t2; i++) {
-        Piaffg_SECRETS PiAffgSecrets;
+    // ----- PRE-SIGN ROUND 2 -----
+    // player 1 generates its PiAffg and PiLogstar proofs for the other players in parallel
+    CG21_PRESIGN_ROUND2_PEER peers[nv];
+
+    for (int j=1; j<t2; j++) {
+        CG21_PRESIGN_ROUND2_PEER *p = peers + j - 1;
+
+        p->r1output = session->r1out + j;
+        p->hisPK = &session->paillierKeys[j].paillier_pk;
+        p->hisPedersen = &session->pedersenKeys[j].pedersenPub;
+        p->r2output = session->r2out + j;
+        p->r2store = session->r2Store + j;
+
+        p->affgPre = NULL;
+        p->affgCommit = session->PiAffgCommit1 + j;
+        p->affgCommitOct = session->PiAffgCommitOct1 + j;
+        p->affgProof = session->PiAffgProof1 + j;
+        p->affgProofOct = session->PiAffgProofOct1 + j;
+
+        p->affgHatPre = NULL;
+        p->affgHatCommit = session->PiAffgCommit2 + j;
+        p->affgHatCommitOct = session->PiAffgCommitOct2 + j;
+        p->affgHatProof = session->PiAffgProof2 + j;
+        p->affgHatProofOct = session->PiAffgProofOct2 + j;
+
+        p->logCommit = session->PiLogCommit1 + j;
+        p->logCommitOct = session->PiLogCommitOct1 + j;
+        p->logProof = session->PiLogProof1 + j;
+        p->logProofOct = session->PiLogProofOct1 + j;
+    }
 
-        int rc = Piaffg_Sample_and_Commit(session->RNG, &session->paillierKeys[0].paillier_sk,
-                                          &session->paillierKeys[i].paillier_pk, &session->pedersenKeys[i].pedersenPub,
-                                          session->r1Store[0].a, session->r2Store[i].beta_hat, &PiAffgSecrets,
-                                          &session->PiAffgCommit2[i], &session->PiAffgCommitOct2[i], session->r1out[i].K);
+    int rc = CG21_PRESIGN_ROUND2_ALL(session->RNG, session->r1Store, session->r1out, session->paillierKeys,
+                                     session->ssid, peers, nv);
+    if (rc != CG21_OK){
+        printf("\nCG21_PRESIGN_ROUND2_ALL failed!, %d", rc);
+        exit(rc);
+    }
 
-        if (rc != Piaffg_OK){
-            printf("PiAffg_Sample_and_Commit failed!, %d", rc);
-            exit(rc);
+    // the other players only run round 2, their proofs are not generated in this example
+    for (int i=1; i<t2; i++) {
+        for (int j=0; j<t2; j++){
+            if (i==j){
+                continue;
+            }
+            CG21_PRESIGN_ROUND2(session->RNG,session->r2out+i*t2+j,session->r2Store+i*t2+j,
+                                session->r1out+j,session->r1Store+i,&(session->paillierKeys+j)->paillier_pk,
+                                &(session->paillierKeys+i)->paillier_pk);
         }
-
-        char e_[MODBYTES_256_56];
-        octet e = {0, sizeof(e_), e_};
-
-        BIG_256_56 s;
-        ECP_SECP256K1 G;
-
-        char oct[EFS_SECP256K1 + 1];
-        octet X = {0, sizeof(oct), oct};
-
-        // X should be computed here, it's here for simplicity
-        ECP_SECP256K1_generator(&G);    // get curve generator
-        BIG_256_56_fromBytesLen(s, session->r1Store->a->val, session->r1Store->a->len);   // load gamma into big
-        ECP_SECP256K1_mul(&G, s);   // compute gamma*G
-        ECP_SECP256K1_toOctet(&X, &G, true); // store gamma*G
-
-        Piaffg_Challenge_gen(&session->paillierKeys[i].paillier_pk, &session->paillierKeys[0].paillier_pk,
-                             &session->pedersenKeys[i].pedersenPub, &X, (session->r2out+i)->F_hat, (session->r1out+i)->K,
-                             (session->r2out+i)->D_hat, &session->PiAffgCommit2[i], (session->ssid + 0), &e);
-
-        Piaffg_Prove(&session->paillierKeys[0].paillier_pk, &session->paillierKeys[i].paillier_pk,
-                     &PiAffgSecrets, session->r1Store[0].a, session->r2Store[i].beta_hat,
-                     session->r2Store[i].s_hat, session->r2Store[i].r_hat, &e, &session->PiAffgProof2[i], &session->PiAffgProofOct2[i]);
-
     }
+    // ---------------------------
 }
 
 
@@ -474,64 +448,20 @@ void CG21_presign_round3(CG21_PRESIGN_SESSION *session){
 
     int t2 = session->setting->t2;
 
-    // other players verify player 1 Pi_LogStar proof
-    for (int i=1; i<session->setting->t2; i++) {
-
-        char e_[MODBYTES_256_56];
-        octet e = {0, sizeof(e_), e_};
-
-        ECP_SECP256K1 G;
-        ECP_SECP256K1_generator(&G);
-        char t[SFS_SECP256K1 + 1];
-        octet g_ = {0, sizeof(t), t};
-        ECP_SECP256K1_toOctet(&g_, &G, true);
+    int nv = t2 - 1;
+    PEDERSEN_PUB *pub_com[nv];
 
-        PiLogstar_Challenge_gen(&session->paillierKeys[0].paillier_pk, &session->pedersenKeys[i].pedersenPub,
-                                session->r1out[0].G, &session->PiLogCommit1[i], (session->ssid + 0), session->r2Store[i].Gamma, &e);
-
-        int rc = PiLogstar_Verify(&session->paillierKeys[0].paillier_pk, &session->pedersenKeys[i].pedersenPriv,
-                                  session->r1out[0].G, &g_, &session->PiLogCommit1[i], session->r2Store[i].Gamma,
-                                  &e, &session->PiLogProof1[i]);
-        if (rc == PiLogstar_OK)
-        {
-            printf("\nPlayer %d verified pi-logStar range proof from player 1 successfully!", i+1);
-        }
-        else
-        {
-            printf("\npi-logStar-1 range proof Failed!");
-            exit(rc);
-        }
+    for (int i=0; i<nv; i++) {
+        pub_com[i] = &session->pedersenKeys[i+1].pedersenPub;
     }
 
-    // other players verify player 1 Pi_Affg-1 proof
-    for (int i=1; i<session->setting->t2; i++) {
-
-        char e2_[MODBYTES_256_56];
-        octet e2 = {0, sizeof(e2_), e2_};
+    // ----- PROOF VALIDATION -----
+    // other players verify the PiAffg and PiLogstar proofs of player 1
+    for (int i=1; i<t2; i++) {
 
-        Piaffg_Challenge_gen(&session->paillierKeys[i].paillier_pk, &session->paillierKeys[0].paillier_pk,
-                             &session->pedersenKeys[i].pedersenPub, session->r2Store[i].Gamma, (session->r2out+i)->F, (session->r1out+i)->K,
-                             (session->r2out+i)->D, &session->PiAffgCommit1[i], (session->ssid + 0), &e2);
-
-        int rc = Piaffg_Verify(&session->paillierKeys[i].paillier_sk, &session->paillierKeys[0].paillier_pk,
-                               &session->pedersenKeys[i].pedersenPriv,session->r1out[i].K, session->r2out[i].D, session->r2Store[i].Gamma,
-                               session->r2out[i].F, &session->PiAffgCommit1[i], &e2, &session->PiAffgProof1[i]);
-        if (rc == Piaffg_OK)
-        {
-            printf("\nPlayer %d verified pi-Affg-1 range proof from player 1 successfully!", i+1);
-        }
-        else
-        {
-            printf("\npi-Affg-2 range proof Failed!");
-            exit(rc);
-        }
-    }
-
-    // other players verify player 1 Pi_Affg-2 proof
-    for (int i=1; i<session->setting->t2; i++) {
-
-        char e2_[MODBYTES_256_56];
-        octet e2 = {0, sizeof(e2_), e2_};
+        CG21_PRESIGN_ROUND3_PEER peer;
+        int verdict;
+        int failed;
 
         BIG_256_56 s;
         ECP_SECP256K1 G;
@@ -539,30 +469,34 @@ void CG21_presign_round3(CG21_PRESIGN_SESSION *session){
         char oct[EFS_SECP256K1 + 1];
         octet X = {0, sizeof(oct), oct};
 
-        // X should be computed here, and should be generated by the prover, it's here only for simplicity
-        ECP_SECP256K1_generator(&G);    // get curve generator
-        BIG_256_56_fromBytesLen(s, session->r1Store->a->val, session->r1Store->a->len);   // load gamma into big
-        ECP_SECP256K1_mul(&G, s);   // compute gamma*G
-        ECP_SECP256K1_toOctet(&X, &G, true); // store gamma*G
-
-        Piaffg_Challenge_gen(&session->paillierKeys[i].paillier_pk, &session->paillierKeys[0].paillier_pk,
-                             &session->pedersenKeys[i].pedersenPub, &X, (session->r2out+i)->F_hat, (session->r1out+i)->K,
-                             (session->r2out+i)->D_hat, &session->PiAffgCommit2[i], (session->ssid + 0), &e2);
-
-        int rc = Piaffg_Verify(&session->paillierKeys[i].paillier_sk, &session->paillierKeys[0].paillier_pk,
-                               &session->pedersenKeys[i].pedersenPriv,session->r1out[i].K, session->r2out[i].D_hat,
-                               &X,session->r2out[i].F_hat, &session->PiAffgCommit2[i],
-                               &e2, &session->PiAffgProof2[i]);
-        if (rc == Piaffg_OK)
-        {
-            printf("\nPlayer %d verified pi-Affg-2 range proof from player 1 successfully!", i+1);
-        }
-        else
-        {
-            printf("\npi-Affg-1 range proof Failed!");
+        // X should be generated by the prover, it's here only for simplicity
+        ECP_SECP256K1_generator(&G);
+        BIG_256_56_fromBytesLen(s, session->r1Store->a->val, session->r1Store->a->len);
+        ECP_SECP256K1_mul(&G, s);
+        ECP_SECP256K1_toOctet(&X, &G, true);
+
+        peer.hisPK = &session->paillierKeys[0].paillier_pk;
+        peer.r1output = session->r1out;
+        peer.r2output = session->r2out + i;
+        peer.X = &X;
+        peer.affgCommit = session->PiAffgCommit1 + i;
+        peer.affgProof = session->PiAffgProof1 + i;
+        peer.affgHatCommit = session->PiAffgCommit2 + i;
+        peer.affgHatProof = session->PiAffgProof2 + i;
+        peer.logCommit = session->PiLogCommit1 + i;
+        peer.logProof = session->PiLogProof1 + i;
+
+        int rc = CG21_PRESIGN_ROUND3_VERIFY_ALL(session->r1out + i, session->paillierKeys + i,
+                                                session->pedersenKeys + i, session->ssid, &peer, 1,
+                                                &verdict, &failed);
+        if (rc != CG21_OK){
+            printf("\npi-Affg and pi-logStar-1 range proofs Failed!");
             exit(rc);
         }
+
+        printf("\nPlayer %d verified pi-Affg and pi-logStar-1 range proofs from player 1 successfully!", i+1);
     }
+    // -------------------------------
 
     for (int i=0; i<t2; i++) {
         for (int j=0; j<t2; j++){
@@ -620,28 +554,31 @@ void CG21_presign_round3(CG21_PRESIGN_SESSION *session){
     }
 
     // ----- PI-LOGSTAR PROOF GENERATION -----
-    // assume only player 1 generates PiLogStar proof for the other players
-    for (int i=1; i<session->setting->t2; i++) {
-
-        PiLogstar_SECRETS PiLogSecrets;
-        int rc = PiLogstar_Sample_and_commit(session->RNG, &session->paillierKeys[0].paillier_sk,
-                                             &session->pedersenKeys[i].pedersenPub,session->r1Store[0].k, session->r3Store1[0].Gamma,
-                                             &PiLogSecrets, &session->PiLogCommit2[i], &session->PiLogCommitOct2[i]);
-        if (rc != PiLogstar_OK){
-            printf("PiLogstar_Sample_and_commit failed!, %d", rc);
-            exit(rc);
-        }
+    // assume only player 1 generates PiLogStar proof for the other players.
+    // A and Y are shared by all the verifiers, only S and D are computed per verifier
+    PiLogstar_SECRETS PiLogSecrets[nv];
+
+    int rc = PiLogstar_Sample_and_commit_multi(session->RNG, &session->paillierKeys[0].paillier_sk,
+                                               pub_com, nv, session->r1Store[0].k, session->r3Store1[0].Gamma,
+                                               PiLogSecrets, session->PiLogCommit2 + 1, session->PiLogCommitOct2 + 1);
+    if (rc != PiLogstar_OK){
+        printf("PiLogstar_Sample_and_commit_multi failed!, %d", rc);
+        exit(rc);
+    }
 
-        char e_[MODBYTES_256_56];
-        octet e = {0, sizeof(e_), e_};
+    char e_[MODBYTES_256_56];
+    octet e = {0, sizeof(e_), e_};
 
-        PiLogstar_Challenge_gen(&session->paillierKeys[0].paillier_pk, &session->pedersenKeys[i].pedersenPub,
-                                (session->r1out+i)->K, &session->PiLogCommit2[i], (session->ssid + 0), session->r3Store1[i].Delta, &e);
+    PiLogstar_Challenge_gen_multi(&session->paillierKeys[0].paillier_pk, pub_com, nv,
+                                  session->r1out[0].K, session->PiLogCommit2 + 1, (session->ssid + 0),
+                                  session->r3Store1[0].Delta, &e);
 
+    for (int i=0; i<nv; i++) {
         PiLogstar_Prove(&session->paillierKeys[0].paillier_sk, session->r1Store[0].k,
-                        session->r1Store[0].rho,&PiLogSecrets, &e, &session->PiLogProof2[i],
-                        &session->PiLogProofOct2[i]);
+                        session->r1Store[0].rho,&PiLogSecrets[i], &e, &session->PiLogProof2[i+1],
+                        &session->PiLogProofOct2[i+1]);
 
+        PiLogstar_clean_secrets(&PiLogSecrets[i]);
     }
     // -------------------------------
 }
@@ -651,16 +588,21 @@ void CG21_presign_output(CG21_PRESIGN_SESSION *session){
     int t2 = session->setting->t2;
 
     // other players verify player 1 Pi_LogStar proof
+    int nv = t2 - 1;
+    PEDERSEN_PUB *pub_com[nv];
+
+    for (int i=0; i<nv; i++) {
+        pub_com[i] = &session->pedersenKeys[i+1].pedersenPub;
+    }
+
     for (int i=1; i<session->setting->t2; i++) {
 
         char e_[MODBYTES_256_56];
         octet e = {0, sizeof(e_), e_};
 
-        ECP_SECP256K1 G;
-        ECP_SECP256K1_generator(&G);
-
-        PiLogstar_Challenge_gen(&session->paillierKeys[0].paillier_pk, &session->pedersenKeys[i].pedersenPub,
-                                (session->r1out+i)->K, &session->PiLogCommit2[i], (session->ssid + 0), session->r3Store1[i].Delta, &e);
+        PiLogstar_Challenge_gen_multi(&session->paillierKeys[0].paillier_pk, pub_com, nv,
+                                      session->r1out[0].K, session->PiLogCommit2 + 1, (session->ssid + 0),
+                                      session->r3Store1[0].Delta, &e);
 
         int rc = PiLogstar_Verify(&session->paillierKeys[0].paillier_pk, &session->pedersenKeys[i].pedersenPriv,
                                   session->r1out[0].K, session->r3Store1[0].Gamma, &session->PiLogCommit2[i], session->r3Store1[0].Delta,
@@ -676,6 +618,35 @@ void CG21_presign_output(CG21_PRESIGN_SESSION *session){
         }
     }
 
+    // a commitment Y_j different from the one bound to the challenge is rejected
+    if (nv > 1){
+        char e_[MODBYTES_256_56];
+        octet e = {0, sizeof(e_), e_};
+
+        ECP_SECP256K1 G;
+        ECP_SECP256K1_generator(&G);
+
+        PiLogstar_COMMITS tampered = session->PiLogCommit2[nv];
+        ECP_SECP256K1_add(&session->PiLogCommit2[nv].Y, &G);
+
+        PiLogstar_Challenge_gen_multi(&session->paillierKeys[0].paillier_pk, pub_com, nv,
+                                      session->r1out[0].K, session->PiLogCommit2 + 1, (session->ssid + 0),
+                                      session->r3Store1[0].Delta, &e);
+
+        int rc = PiLogstar_Verify(&session->paillierKeys[0].paillier_pk, &session->pedersenKeys[nv].pedersenPriv,
+                                  session->r1out[0].K, session->r3Store1[0].Gamma, &session->PiLogCommit2[nv],
+                                  session->r3Store1[0].Delta, &e, &session->PiLogProof2[nv]);
+
+        session->PiLogCommit2[nv] = tampered;
+
+        if (rc == PiLogstar_OK)
+        {
+            printf("\npi-logStar-2 range proof with a tampered Y verified!");
+            exit(EXIT_FAILURE);
+        }
+        printf("\nPlayer %d rejected pi-logStar-2 range proof with a tampered Y", nv+1);
+    }
+
 
     for (int i=0; i<t2; i++) {
         int rc = 0;
@@ -25,6 +25,7 @@
 #include "amcl/schnorr.h"
 #include "amcl/cg21/cg21_utilities.h"
 #include "amcl/cg21/cg21.h"
+#include "amcl/cg21/cg21_derive.h"
 
 bool Debug = false;
 
@@ -199,6 +200,244 @@ int cg21_sign_round2(CG21_SIGN_SESSION *session){
     return 0;
 }
 
+int cg21_sign_batch(CG21_SIGN_SESSION *session){
+    printf("\n\n----------- BATCH SIGNING -----------");
+
+    int t2 = session->setting->t2;
+    int rc;
+
+    // every player loads its presignature into a pool, here a batch of one
+    // signature for the same message, so the presignatures are not reused
+    CG21_PRESIGN_POOL pool[t2];
+    BIG_256_56 pool_r[t2];
+    BIG_256_56 pool_k[t2];
+    BIG_256_56 pool_chi[t2];
+
+    CG21_SIGN_BATCH batch[t2];
+    BIG_256_56 batch_r[t2];
+    BIG_256_56 batch_sigma[t2];
+
+    char packed[t2][EGS_SECP256K1];
+    octet PACKED[t2];
+    init_octets((char *)packed, PACKED, EGS_SECP256K1, t2);
+
+    char hm[SHA256_HASH_SIZE];
+    octet HM = {0, sizeof(hm), hm};
+    octet *HMs[1] = {&HM};
+
+    octet BAD = {SHA256_HASH_SIZE - 1, sizeof(hm), hm};
+    octet *BADs[1] = {&BAD};
+
+    CG21_SIGN_HASH ctx;
+    CG21_SIGN_HASH_INIT(&ctx);
+    CG21_SIGN_HASH_UPDATE(&ctx, session->msg);
+    rc = CG21_SIGN_HASH_FINAL(&ctx, &HM);
+    if (rc != CG21_OK){
+        printf("\nCG21_SIGN_HASH_FINAL failed!, %d", rc);
+        exit(1);
+    }
+
+    for (int i=0; i<t2; i++){
+        rc = CG21_PRESIGN_POOL_LOAD(pool+i, pool_r+i, pool_k+i, pool_chi+i, session->presign+i, 1);
+        if (rc != CG21_OK){
+            printf("\nCG21_PRESIGN_POOL_LOAD failed!, %d", rc);
+            exit(1);
+        }
+
+        batch[i].r = batch_r + i;
+        batch[i].sigma = batch_sigma + i;
+        batch[i].n = 1;
+
+        // a digest of the wrong length is rejected before any presignature is used
+        rc = CG21_SIGN_ROUND1_BATCH(pool+i, BADs, batch+i);
+        if (rc != CG21_SIGN_DIGEST_IS_INVALID || pool[i].next != 0){
+            printf("\nBatch[%d]: invalid digest is NOT rejected", i+1);
+            exit(1);
+        }
+
+        rc = CG21_SIGN_ROUND1_BATCH(pool+i, HMs, batch+i);
+        if (rc != CG21_OK){
+            printf("\nCG21_SIGN_ROUND1_BATCH failed!, %d", rc);
+            exit(1);
+        }
+
+        rc = CG21_SIGN_BATCH_toOctet(PACKED+i, batch+i);
+        if (rc != CG21_OK){
+            printf("\nCG21_SIGN_BATCH_toOctet failed!, %d", rc);
+            exit(1);
+        }
+    }
+
+    for (int i=0; i<t2; i++){
+        octet *his[t2];
+        int c = 0;
+
+        for (int j=0; j<t2; j++){
+            if (i != j){
+                his[c] = PACKED + j;
+                c = c + 1;
+            }
+        }
+
+        rc = CG21_SIGN_ROUND2_BATCH(batch+i, his, c, batch+i);
+        if (rc != CG21_OK){
+            printf("\nCG21_SIGN_ROUND2_BATCH failed!, %d", rc);
+            exit(1);
+        }
+
+        char r_[EGS_SECP256K1];
+        char sigma_[EGS_SECP256K1];
+        octet R = {EGS_SECP256K1, sizeof(r_), r_};
+        octet SIGMA = {EGS_SECP256K1, sizeof(sigma_), sigma_};
+        CG21_SIGN_ROUND2_OUTPUT out = {&R, &SIGMA, i+1};
+
+        BIG_256_56_toBytes(R.val, batch[i].r[0]);
+        BIG_256_56_toBytes(SIGMA.val, batch[i].sigma[0]);
+
+        rc = CG21_SIGN_VALIDATE_PREHASHED(&HM, &out, session->PK);
+        if (rc != CG21_OK || !OCT_comp(&SIGMA, (session->r2out+i)->sigma)){
+            printf("\nBatch[%d]: Signature is NOT valid", i+1);
+            exit(1);
+        }
+        printf("\nBatch[%d]: Signature is valid", i+1);
+
+        CG21_PRESIGN_POOL_KILL(pool+i);
+    }
+
+    return 0;
+}
+
+int cg21_sign_tweaked(CG21_SIGN_SESSION *session){
+    printf("\n\n----------- SIGNING WITH A CHILD KEY -----------");
+
+    int t2 = session->setting->t2;
+    int rc;
+
+    // public chain code of the parent key
+    const char *chainHex = "873dff81c02f525623fd1fe5167eac3a55a049de3d314bb42ee227ffed37d508";
+    char c[CG21_DERIVE_CHAIN_SIZE];
+    octet C = {0, sizeof(c), c};
+
+    char childx[EFS_SECP256K1 + 1];
+    octet CHILDX = {0, sizeof(childx), childx};
+
+    char childc[CG21_DERIVE_CHAIN_SIZE];
+    octet CHILDC = {0, sizeof(childc), childc};
+
+    char tw[EGS_SECP256K1];
+    octet T = {0, sizeof(tw), tw};
+
+    char hm[SHA256_HASH_SIZE];
+    octet HM = {0, sizeof(hm), hm};
+
+    char r1_r[t2][EGS_SECP256K1];
+    char r1_sigma[t2][EGS_SECP256K1];
+    char r1_sigma_out[t2][EGS_SECP256K1];
+    char r2_r[t2][EGS_SECP256K1];
+    char r2_sigma[t2][EGS_SECP256K1];
+
+    octet R1_r[t2];
+    octet R1_sigma[t2];
+    octet R1_sigma_out[t2];
+    octet R2_r[t2];
+    octet R2_sigma[t2];
+
+    init_octets((char *)r1_r, R1_r, EGS_SECP256K1, t2);
+    init_octets((char *)r1_sigma, R1_sigma, EGS_SECP256K1, t2);
+    init_octets((char *)r1_sigma_out, R1_sigma_out, EGS_SECP256K1, t2);
+    init_octets((char *)r2_r, R2_r, EGS_SECP256K1, t2);
+    init_octets((char *)r2_sigma, R2_sigma, EGS_SECP256K1, t2);
+
+    CG21_SIGN_ROUND1_STORE r1store[t2];
+    CG21_SIGN_ROUND1_OUTPUT r1out[t2];
+    CG21_SIGN_ROUND2_OUTPUT r2out[t2];
+
+    for (int i=0; i<t2; i++){
+        r1store[i].r = R1_r + i;
+        r1store[i].sigma = R1_sigma + i;
+        r1out[i].sigma = R1_sigma_out + i;
+        r2out[i].r = R2_r + i;
+        r2out[i].sigma = R2_sigma + i;
+    }
+
+    OCT_fromHex(&C, chainHex);
+
+    // first valid non-hardened child of the parent key
+    unsigned int index = 0;
+    do {
+        rc = CG21_DERIVE_CHILD(session->PK, &C, index, &CHILDX, &CHILDC, &T);
+        index++;
+    } while (rc == CG21_DERIVE_INVALID_CHILD);
+
+    if (rc != CG21_DERIVE_OK){
+        printf("\nCG21_DERIVE_CHILD failed!, %d", rc);
+        exit(1);
+    }
+
+    printf("\nchildX=");
+    OCT_output(&CHILDX);
+
+    CG21_SIGN_HASH ctx;
+    CG21_SIGN_HASH_INIT(&ctx);
+    CG21_SIGN_HASH_UPDATE(&ctx, session->msg);
+    rc = CG21_SIGN_HASH_FINAL(&ctx, &HM);
+    if (rc != CG21_OK){
+        printf("\nCG21_SIGN_HASH_FINAL failed!, %d", rc);
+        exit(1);
+    }
+
+    // the presignatures of the parent key are tweaked at sign time
+    for (int i=0; i<t2; i++){
+        rc = CG21_SIGN_ROUND1_TWEAKED(&HM, &T, session->presign+i, r1store+i, r1out+i);
+        if (rc != CG21_OK){
+            printf("\nCG21_SIGN_ROUND1_TWEAKED failed!, %d", rc);
+            exit(1);
+        }
+    }
+
+    for (int i=0; i<t2; i++){
+
+        for (int j=0; j<t2; j++) {
+            int status = 1;
+
+            if (i == j) {
+                continue;
+            }
+
+            if (j==0 || (j==1 && i==0)){
+                status=0; // first iteration
+            }
+            if (j==t2-1 || (j==t2-2 && i==t2-1)){
+                if (status==0){
+                    status=3; // first iteration is the last iteration (t=2)
+                }else {
+                    status = 2; // last iteration (!= first iteration)
+                }
+            }
+
+            CG21_SIGN_ROUND2(r1store+i, r1out+j, r2out+i, status);
+        }
+    }
+
+    for (int i=0; i<t2; i++){
+        rc = CG21_SIGN_VALIDATE_PREHASHED(&HM, r2out+i, &CHILDX);
+        if (rc != CG21_OK){
+            printf("\nChild[%d]: Signature is NOT valid", i+1);
+            exit(1);
+        }
+
+        // the signature is for the child key only
+        rc = CG21_SIGN_VALIDATE_PREHASHED(&HM, r2out+i, session->PK);
+        if (rc == CG21_OK){
+            printf("\nChild[%d]: Signature is valid for the parent key", i+1);
+            exit(1);
+        }
+        printf("\nChild[%d]: Signature is valid", i+1);
+    }
+
+    return 0;
+}
+
 int cg21_sign_validation(const CG21_SIGN_SESSION *session){
 
     printf("\n\n----------- VALIDATION (using secrets) -----------");
@@ -491,6 +730,10 @@ int main() {
     session.r2out = r2out;
     cg21_sign_round2(&session);
 
+    cg21_sign_batch(&session);
+
+    cg21_sign_tweaked(&session);
+
     cg21_sign_validation(&session);
 
     exit(0);
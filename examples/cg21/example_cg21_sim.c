@@ -0,0 +1,996 @@
+/*
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"); you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+*/
+
+/*
+ * Simulate CG21 in one process and report the latency distribution and the
+ * throughput of parallel sessions.
+ *
+ * usage: example_cg21_sim [sessions] [latency_us] [jitter_us] [t]
+ *
+ * By default the key shares are read from cg21_reshare.csv, as written by
+ * example_cg21_keygen, example_cg21_auxinfo and example_cg21_key_reshare run
+ * in this order. Each session runs presign with CG21_PRESIGN_PHASE, with all its
+ * ZK proofs generated and verified, then sign with CG21_SIGN_PHASE on the new
+ * presignature, and the signature is validated against the PK of the key shares.
+ * The ring-Pedersen parameters of the players are set up from their Paillier
+ * primes, and the SSID the proofs are bound to is formed from the key shares.
+ *
+ * With t, presignatures are dealt by a trusted dealer to t players and only
+ * sign is simulated, so any committee size can be modelled. This is for
+ * modelling only: a dealer knows the private key.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <amcl/amcl.h>
+#include <amcl/randapi.h>
+#include "amcl/parallel.h"
+#include "amcl/cg21/cg21.h"
+#include "amcl/cg21/cg21_session.h"
+#include "amcl/cg21/cg21_sim.h"
+#include "amcl/cg21/cg21_wire.h"
+
+#define EGS EGS_SECP256K1
+#define EFS (EFS_SECP256K1 + 1)
+
+/* Largest presign message for m peers: the round 2 outputs and proofs for all of them */
+#define BODY(m) CG21_WIRE_PRESIGN_ROUND2_ALL_SIZE(m)
+
+/* Paillier primes of the players, as in example_cg21_presign */
+char *PT_hex[8] = {"f592ad30c88d719fd272095257c90395d16f6c613a3ccf1b556646a99c316275ce6bf0565f1f28e705342158c79e0d5614bcfeec3b02d60eb5bd490b930b04c64103b2b0257d73156715012c77f43872024488297b1f03d521200ffadeb3f85e86378837ed34c366b5f58e8dd042e320381d765a871f963f80fc4ac4bb4c096f",
+                   "C6C646679CD5B694841621AAD2FE7840E39B777C0BDEB36597594DA4FA0F07E4FC0B8E719F05203850FF8540A62394A8984E880C3AD0A407736BFE4631D7C501C43EB2463629CDF897BDA60664660FC5209BF73C6A33EF1FD2995C830C8A10339A5ED90EFD0698D470659C244CC927AAB4CD7D1F4D616A135EF250E9BB119673",
+                   "c883b3abc4b6dd37e41d7bcf2b326442a58a874089691af7dd5a4a039f30551b2b2c11aa1a0dd0cfdc66d5a1ed311d6e331599faec066af94f65ebbdc7b1c9813da0216de612e340a7381a6b73d692bdb093f307fc904b0a44b63b478a88454c05730ba2ea071006ab4132bdfc3bc94994f8958636e7e7a1564117cc543043bb",
+                   "ccb0d6ca8525fe14d283a29b4a673ef0b5dae276ff60dc346cb28a83144b3f2f788f7876e817e58eb2944f51cc4b15a815b30f8dfffacf2cac2ddab94a2ff5ac0e14adc2f56ec6bb9bcb66988c165ecb530bd7abc8c7068be9fbc66d53cbd6f42f07b4accab7019d09ec73286d2406d10748209cc0bb1b2d03da14cc7cb7ebdb",
+                   "d4bb5a43bc21ea77eab86aca9636d4e7c0d2596d8bc3a00c1ae26a3e442fa2530fbdb8f93e2fd14fa8e26809e5d27b193cdb092fc1c287aba9d132f54764cd95abc77c6e007cc588022a3ff4910ca54f8ea23e836bf6baaec3b701bb0a1a68a3f2af825971f70f347ea260e6e3bd9cf922229f6c366a4c0e113a4f5f45bfb54f",
+                   "E0EA3822BFB63CBB3F13679A76A840D5B8D6215DFC3842B679B0E66DFC86D6C0F0F70017035C4E2E4A155E87C72FF9CB55C38680BF9F9D7A5DCB6F01717CDD37705385D2DD6F1A2EF4E47E8B568787EF2C7589ABBFE5FFF2D9AF66720B5CF31B0E2940B9C2FDECFC703FA55D50F2BB499F51BA92E9A71607FBA7E36F10D57387",
+                   "FE67C9CECC8E485BB74D130404526F2018589A079A71D73B04B39C38B157E8CA999BDAB1F191918271BEF937A6DA4BA94F40BC9A6A91FD53E57B2494FE2042798D8D929F95689C181E723C45222A8E18DB9CF05A3BF960FBDE98C9518C08D90D553052DBEF7121E0C8CEEAB9E4F6897AB0BA9A7B47183C6E8B0294B637CE6723",
+                   "FE49BB949B4DD772CC62F459370BF5141D44EFFC403C90E5CAA3B0A9ADAB18991E7D653B6D05DA42CAC9A0CC9329951B213977C8576AA711EC1E8F80B49D4ED59404DF46EC04ABE1631E70F4DCCB1A9A01F44969A7845183F705D6395A32FFDFA9BD98E0FF4ECB694C22BBE2A1D58650C9F5A920E5AFA35453F5D71A5CE2CC4F"};
+
+
+
+char *QT_hex[8] = {"c49346cef2c4249b7df76b93191e916db4582549697a526a6aa0094c09d83dc71be94598e64fba8e34f3b27c3a40090be0a44e1818b14c5513e0b9d9cdc9bb19398a29725fa851b08addaacb430ebe55128f6c43d611d2a35ddb7e7fba5edae177c9de0271912110709125ce18dd403be71ce96784ec856115e2fc4462ccd5d5",
+                   "B6A1CED9AD6A84F36615652BB7794062911DFF67275F58F2F6C64356ABE8C1BBD4DB522C544071F15DC1704D0278731F2519EDD143B6F4065250CCB5625888DF1747470A83E515A7B3CCB71D20E661799C5CA21599EEF104989A5DC4399983FCD6ABD2B27802B1B790EEB0DBB8786167B5B41EB9D1EC65F3B4CE0F8129CC0635",
+                   "ff095fd68d025eb5051e4d06c3b581ce23cd599013bdb9485b3775df8f4af936b6b60906269f48380f71fa49eb04970ab15e4d5ed2b1bbcfc1c2b5f8ed1ee5bee8a8d791dbe3e420f672aeb5d830c632ddc02de95b042ea943341ed73bab492ca32f1ba4c0cdace982e8c1c249e5c92a39e272b79eb09caf294fee74a42a330f",
+                   "e93b9900d422108975781193a0b52bd466ed584946251148a37d952df2da8d6366869823aff52b7435ade7ac8a21424db364a63fb2a04375361fe145d3f57cf43fa1cc1b6f52f58ad10ec8f0a9de8bf20a4bb4bcdb82a41eb07e2f1265ebb5d0d490e606dff1a2f5c09fbf3aa68ee4bcc1cb7291ddfad691a27ff277e6126c7b",
+                   "e15a6a18a7b6bf0893c00526202ea5fcb7cde901f780406ea78ca951459ce3130fd65687badb4a8e41bbe676c672ff7b5914ca983bf0937fe5f423f2e655b144302a3ae17d2a3f1ef9d779baac67939924ba1a0210d37bc2badb90c76d38daa74704eb93cec5588f2452b9829511332cc7e5933e08392839b79a8cd8336948ab",
+                   "E139D2FBEEDA6AD968E7423306E001A44DF2EF945E3A6FBA078A8D210C8259C7E5C23BE3B66B335F9332EBB72E72981F6CB82AEE6C2BC0F8667ED1CB7DE10B92148CE23B3A0E516690B600758C1355AD0DB55DD87506A41EEC609CF72FD11B125E47012674CAB2EE0A46E620B70DD69E5E27838442EA0FC547DBB95AD147A9A5",
+                   "CD47D116CEB853057CAE356305FED20E2D551A5D91FB0EDA0042137C5099A16518899B7E3969952C8BBC369FBE0E9FD79B03BAE053FC09A13B340D4E894700604470F9B0F013F5B837202083C595A77B7A85CB12FD2AA33148CC209F8102C04F7A79D5630D5DA3B47D9C13DE68BB7F529DB6F550828054211162E84EA45612CD",
+                   "D3D77DD5E850B2041AC5EC7B690E220823D295353E93C715ECEA21EB0C9E62D33D40E18353AAFB4DC986C435C33777FE03D81592F61EC7614681EE0A11E30978ECA9AA58F328FD2EEEB6738251BA5BB53F0AFD22E6AE700C2B111DDE4DF6850C6E0F0A44E1FEED3C9FA3347C9D46F0F6181785DF61193F1109D8BB0E385880E9"};
+
+/* Memory of one player of the dealer run */
+typedef struct
+{
+    char R[EFS];
+    char k[EGS];
+    char chi[EGS];
+    char r[EGS];
+    char sigma[EGS];
+    char r1sigma[EGS];
+    char outr[EGS];
+    char outsigma[EGS];
+    char box[EGS];
+    char slot[EGS];
+
+    octet oR, ok, ochi, or_, osigma, or1sigma, ooutr, ooutsigma, obox, oslot;
+    octet *outbox[1];
+
+    CG21_PRESIGN_ROUND4_STORE_2 pre;
+    CG21_SIGN_ROUND1_STORE store;
+    CG21_SIGN_ROUND1_OUTPUT r1out;
+    CG21_SIGN_ROUND2_OUTPUT out;
+    CG21_SIGN_SESSION_STATE state;
+    CG21_SESSION_MSG queue[1];
+
+} PLAYER;
+
+/* Memory of one player of the presign and sign run, with m peers */
+typedef struct
+{
+    CG21_PRESIGN_ROUND1_OUTPUT r1out;
+    CG21_PRESIGN_ROUND1_OUTPUT *hisR1out;
+    CG21_PRESIGN_ROUND1_STORE r1store;
+    CG21_PRESIGN_ROUND2_OUTPUT *r2out;
+    CG21_PRESIGN_ROUND2_STORE *r2store;
+    CG21_PRESIGN_ROUND3_OUTPUT r3out;
+    CG21_PRESIGN_ROUND3_STORE_1 r3store1;
+    CG21_PRESIGN_ROUND3_STORE_2 r3store2;
+    CG21_PRESIGN_ROUND4_STORE_1 r4store1;
+    CG21_PRESIGN_ROUND4_STORE_2 pre;
+    CG21_PRESIGN_ROUND4_OUTPUT r4out;
+    CG21_PRESIGN_SESSION_STATE presign;
+
+    CG21_SIGN_ROUND1_STORE store;
+    CG21_SIGN_ROUND1_OUTPUT sr1out;
+    CG21_SIGN_ROUND2_OUTPUT out;
+    CG21_SIGN_SESSION_STATE sign;
+
+    octet *octets;              // octets of all the fields, in mem
+    int used;                   // octets used so far
+    char *mem;                  // memory of the fields
+    int off;                    // bytes of mem used so far
+
+    octet *outbox[3];
+    CG21_SESSION_MSG *queue;
+
+} PARTY;
+
+static void oct_init(octet *O, char *mem, int max)
+{
+    O->len = 0;
+    O->max = max;
+    O->val = mem;
+}
+
+/* Next octet of a party, with max bytes */
+static octet *take(PARTY *p, int max)
+{
+    octet *O = p->octets + p->used;
+
+    oct_init(O, p->mem + p->off, max);
+    p->used++;
+    p->off += max;
+
+    return O;
+}
+
+/* Number of octets of a party with m peers */
+static int party_octets(int m)
+{
+    return 27 + 20 * m;
+}
+
+/* Bytes of the octets of a party with m peers */
+static int party_size(int m)
+{
+    int fixed = 4 * FS_4096 + 18 * EGS + 8 * EFS;
+    int peer = 10 * FS_4096 + 4 * FS_2048 + 2 * EFS;
+
+    return fixed + m * peer + (3 + 2 * m) * BODY(m);
+}
+
+/* Deal additive shares of k and chi = k.x for R = k^{-1}.G */
+static void deal(csprng *RNG, PLAYER *p, int t, octet *X)
+{
+    BIG_256_56 q;
+    BIG_256_56 x;
+    BIG_256_56 k;
+    BIG_256_56 chi;
+    BIG_256_56 share;
+    BIG_256_56 ksum;
+    BIG_256_56 chisum;
+    ECP_SECP256K1 G;
+    ECP_SECP256K1 R;
+
+    char r[EFS];
+    octet OR = {0, sizeof(r), r};
+
+    BIG_256_56_rcopy(q, CURVE_Order_SECP256K1);
+    BIG_256_56_randomnum(x, q, RNG);
+    BIG_256_56_randomnum(k, q, RNG);
+    BIG_256_56_modmul(chi, k, x, q);
+
+    ECP_SECP256K1_generator(&G);
+    ECP_SECP256K1_copy(&R, &G);
+    ECP_SECP256K1_mul(&G, x);
+    ECP_SECP256K1_toOctet(X, &G, true);
+
+    BIG_256_56_invmodp(share, k, q);
+    ECP_SECP256K1_mul(&R, share);
+    ECP_SECP256K1_toOctet(&OR, &R, true);
+
+    BIG_256_56_zero(ksum);
+    BIG_256_56_zero(chisum);
+
+    for (int i = 0; i < t; i++)
+    {
+        BIG_256_56 ki;
+        BIG_256_56 chii;
+
+        if (i < t - 1)
+        {
+            BIG_256_56_randomnum(ki, q, RNG);
+            BIG_256_56_randomnum(chii, q, RNG);
+            BIG_256_56_add(ksum, ksum, ki);
+            BIG_256_56_mod(ksum, q);
+            BIG_256_56_add(chisum, chisum, chii);
+            BIG_256_56_mod(chisum, q);
+        }
+        else
+        {
+            BIG_256_56_modneg(ki, ksum, q);
+            BIG_256_56_add(ki, ki, k);
+            BIG_256_56_mod(ki, q);
+            BIG_256_56_modneg(chii, chisum, q);
+            BIG_256_56_add(chii, chii, chi);
+            BIG_256_56_mod(chii, q);
+        }
+
+        OCT_copy(&p[i].oR, &OR);
+        p[i].ok.len = EGS;
+        BIG_256_56_toBytes(p[i].ok.val, ki);
+        p[i].ochi.len = EGS;
+        BIG_256_56_toBytes(p[i].ochi.val, chii);
+    }
+
+    BIG_256_56_zero(x);
+    BIG_256_56_zero(k);
+    BIG_256_56_zero(chi);
+}
+
+/* Set up the sessions of one signature */
+static void setup(csprng *RNG, PLAYER *p, CG21_SESSION *sessions, int *ids, int *peers, int *seen, int t,
+                  const octet *HM, octet *X)
+{
+    for (int i = 0; i < t; i++)
+    {
+        oct_init(&p[i].oR, p[i].R, EFS);
+        oct_init(&p[i].ok, p[i].k, EGS);
+        oct_init(&p[i].ochi, p[i].chi, EGS);
+        oct_init(&p[i].or_, p[i].r, EGS);
+        oct_init(&p[i].osigma, p[i].sigma, EGS);
+        oct_init(&p[i].or1sigma, p[i].r1sigma, EGS);
+        oct_init(&p[i].ooutr, p[i].outr, EGS);
+        oct_init(&p[i].ooutsigma, p[i].outsigma, EGS);
+        oct_init(&p[i].obox, p[i].box, EGS);
+        oct_init(&p[i].oslot, p[i].slot, EGS);
+        p[i].outbox[0] = &p[i].obox;
+        p[i].queue[0].body = &p[i].oslot;
+    }
+
+    deal(RNG, p, t, X);
+
+    for (int i = 0; i < t; i++)
+    {
+        ids[i] = i + 1;
+
+        p[i].pre.R = &p[i].oR;
+        p[i].pre.k = &p[i].ok;
+        p[i].pre.chi = &p[i].ochi;
+        p[i].pre.i = ids[i];
+        p[i].store.r = &p[i].or_;
+        p[i].store.sigma = &p[i].osigma;
+        p[i].r1out.sigma = &p[i].or1sigma;
+        p[i].out.r = &p[i].ooutr;
+        p[i].out.sigma = &p[i].ooutsigma;
+
+        p[i].state.HM = HM;
+        p[i].state.T = NULL;
+        p[i].state.pre = &p[i].pre;
+        p[i].state.store = &p[i].store;
+        p[i].state.r1out = &p[i].r1out;
+        p[i].state.out = &p[i].out;
+        p[i].state.PK = X;
+
+        // the other players
+        int *mine = peers + i * (t - 1);
+        for (int j = 0, m = 0; j < t; j++)
+        {
+            if (j != i)
+            {
+                mine[m++] = j + 1;
+            }
+        }
+
+        CG21_SESSION_INIT(sessions + i, &CG21_SIGN_PHASE, &p[i].state, mine, seen + i * (t - 1), t - 1,
+                          p[i].queue, 1, p[i].outbox);
+    }
+}
+
+/* Read (t2, n2) and the key shares of the first t2 players from cg21_reshare.csv */
+static int read_reshare(CG21_RESHARE_SETTING *setting, CG21_RESHARE_OUTPUT **out)
+{
+    char line[2048];
+    FILE *file = fopen("cg21_reshare.csv", "r");
+
+    if (file == NULL)
+    {
+        printf("FAILURE could not open cg21_reshare.csv, run the keygen, aux and key reshare examples first\n");
+        return 1;
+    }
+
+    if (fgets(line, sizeof(line), file) == NULL)
+    {
+        fclose(file);
+        return 1;
+    }
+    setting->t1 = atoi(line);
+
+    if (fgets(line, sizeof(line), file) == NULL || sscanf(line, "%d,%d", &setting->t2, &setting->n2) != 2
+        || setting->t2 < 2 || setting->n2 > 8 || setting->t2 > setting->n2)
+    {
+        fclose(file);
+        return 1;
+    }
+
+    int t = setting->t2;
+    int t1 = setting->t1;
+
+    // octets of each player: X, rho, rid, share X and Y, packed X and j
+    CG21_RESHARE_OUTPUT *r = malloc(sizeof(CG21_RESHARE_OUTPUT) * t);
+    octet *o = malloc(sizeof(octet) * 7 * t);
+    char *mem = malloc((size_t)t * (EFS + 4 * EGS + t1 * EFS + t1 * 4 + 1));
+    if (r == NULL || o == NULL || mem == NULL)
+    {
+        fclose(file);
+        return 1;
+    }
+
+    char *m = mem;
+    for (int i = 0; i < t; i++)
+    {
+        octet *oi = o + 7 * i;
+
+        oct_init(oi, m, EFS);                   m += EFS;
+        oct_init(oi + 1, m, EGS);               m += EGS;
+        oct_init(oi + 2, m, EGS);               m += EGS;
+        oct_init(oi + 3, m, EGS);               m += EGS;
+        oct_init(oi + 4, m, EGS);               m += EGS;
+        oct_init(oi + 5, m, t1 * EFS);          m += t1 * EFS;
+        oct_init(oi + 6, m, t1 * 4 + 1);        m += t1 * 4 + 1;
+
+        r[i].pk.X = oi;
+        r[i].rho = oi + 1;
+        r[i].rid = oi + 2;
+        r[i].shares.X = oi + 3;
+        r[i].shares.Y = oi + 4;
+        r[i].pk.X_set_packed = oi + 5;
+        r[i].pk.j_set_packed = oi + 6;
+    }
+
+    // PK, rid and rho are common to all the players
+    if (fgets(line, sizeof(line), file) == NULL)
+    {
+        fclose(file);
+        return 1;
+    }
+
+    const char *X = strtok(line, ",");
+    const char *rid = strtok(NULL, ",");
+    const char *rho = strtok(NULL, ",");
+
+    for (int i = 0; i < t; i++)
+    {
+        OCT_fromHex(r[i].pk.X, X);
+        OCT_fromHex(r[i].rid, rid);
+        OCT_fromHex(r[i].rho, rho);
+
+        r[i].n = setting->n2;
+        r[i].t = t;
+        r[i].myID = i + 1;
+        r[i].pk.pack_size = t1;
+    }
+
+    for (int i = 0; i < t; i++)
+    {
+        if (fgets(line, sizeof(line), file) == NULL)
+        {
+            fclose(file);
+            return 1;
+        }
+
+        OCT_fromHex(r[i].shares.X, strtok(line, ","));
+        OCT_fromHex(r[i].shares.Y, strtok(NULL, ","));
+        OCT_fromHex(r[i].pk.X_set_packed, strtok(NULL, ","));
+        OCT_fromHex(r[i].pk.j_set_packed, strtok(NULL, ","));
+        r[i].pk.j_set_packed->len = t * 2;
+    }
+
+    fclose(file);
+
+    *out = r;
+    return 0;
+}
+
+/* Public key share a.G of a player, with a as CG21_PRESIGN_ROUND1 computes it. The
+ * simulation holds the key shares of all the players, so it is computed from them */
+static void share_X(const CG21_RESHARE_OUTPUT *reshare, CG21_RESHARE_SETTING *setting, octet *X)
+{
+    char l[setting->t2 - 1][EGS];
+    octet L[setting->t2 - 1];
+
+    char a[EGS];
+    octet A = {0, sizeof(a), a};
+
+    BIG_256_56 s;
+    ECP_SECP256K1 G;
+
+    init_octets((char *)l, L, EGS, setting->t2 - 1);
+
+    CG21_lagrange_index_to_octet(setting->t2, setting->T2, reshare->myID, L);
+    SSS_shamir_to_additive(setting->t2, reshare->shares.X, reshare->shares.Y, L, &A);
+
+    BIG_256_56_fromBytesLen(s, A.val, A.len);
+    ECP_SECP256K1_generator(&G);
+    ECP_SECP256K1_mul(&G, s);
+    ECP_SECP256K1_toOctet(X, &G, true);
+
+    BIG_256_56_zero(s);
+    OCT_clear(&A);
+}
+
+/* SSID of the sessions, from the key shares and the ring-Pedersen parameters of
+ * the players. Returns the memory of its fields, to be freed, or NULL */
+static char *form_ssid(csprng *RNG, CG21_SSID *ssid, octet *o, int *n, const CG21_RESHARE_OUTPUT *reshare,
+                       const CG21_RESHARE_SETTING *setting, CG21_PEDERSEN_KEYS *pedersen)
+{
+    int t = setting->t2;
+    int t1 = setting->t1;
+
+    // uid, rid, rho, j and X of the key shares, q, g, then N, s, t and j of the players
+    int sizes[11] = {iLEN, EGS, EGS, t1 * 4 + 1, t1 * EFS, EGS, EFS, t * FS_2048, t * FS_2048, t * FS_2048, t * 4 + 1};
+    int size = 0;
+
+    for (int j = 0; j < 11; j++)
+    {
+        size += sizes[j];
+    }
+
+    char *mem = malloc(size);
+    if (mem == NULL)
+    {
+        return NULL;
+    }
+
+    for (int j = 0, off = 0; j < 11; j++)
+    {
+        oct_init(o + j, mem + off, sizes[j]);
+        off += sizes[j];
+    }
+
+    ssid->uid = o;
+    ssid->rid = o + 1;
+    ssid->rho = o + 2;
+    ssid->j_set_packed = o + 3;
+    ssid->X_set_packed = o + 4;
+    ssid->q = o + 5;
+    ssid->g = o + 6;
+    ssid->N_set_packed = o + 7;
+    ssid->s_set_packed = o + 8;
+    ssid->t_set_packed = o + 9;
+    ssid->j_set_packed2 = o + 10;
+    ssid->n1 = n;
+    ssid->n2 = n + 1;
+
+    // pack the ring-Pedersen parameters as the aux protocol does
+    char j_[t * 4 + 1];
+    char N_[t * FS_2048];
+    char s_[t * FS_2048];
+    char t_[t * FS_2048];
+    char pub[3 * FS_2048];
+
+    octet J = {0, sizeof(j_), j_};
+    octet N = {0, sizeof(N_), N_};
+    octet S = {0, sizeof(s_), s_};
+    octet T = {0, sizeof(t_), t_};
+    octet PUB = {0, sizeof(pub), pub};
+
+    CG21_AUX_OUTPUT aux = {&J, &N, &S, &T};
+    CG21_AUX_ROUND1_STORE_PUB rnd1Pub;
+
+    for (int i = 0; i < t; i++)
+    {
+        OCT_clear(&PUB);
+        CG21_PedersenPub_to_octet(&pedersen[i].pedersenPub, &PUB);
+
+        rnd1Pub.i = i + 1;
+        rnd1Pub.PedPub = &PUB;
+        CG21_AUX_PACK_OUTPUT(&aux, rnd1Pub, i == 0);
+    }
+
+    OCT_rand(ssid->uid, RNG, iLEN);
+    CG21_PRESIGN_GET_SSID(ssid, reshare, t1, t, &aux);
+
+    return mem;
+}
+
+/* Set up the presign and sign state of a party, with its peers in mine */
+static void setup_party(PARTY *p, csprng *RNG, CG21_RESHARE_OUTPUT *reshare, CG21_RESHARE_SETTING *setting,
+                        CG21_PAILLIER_KEYS *keys, PAILLIER_public_key *hisPK, CG21_PEDERSEN_KEYS *pedersen,
+                        PEDERSEN_PUB *hisPedersen, CG21_SSID *ssid, octet *hisX, const int *mine, int m,
+                        const octet *HM)
+{
+    octet *EMPTY = take(p, 0);
+
+    p->r1store.k = take(p, EGS);
+    p->r1store.gamma = take(p, EGS);
+    p->r1store.rho = take(p, FS_4096);
+    p->r1store.nu = take(p, FS_4096);
+    p->r1store.a = take(p, EGS);
+
+    p->r1out.psi = EMPTY;
+    p->r1out.G = take(p, FS_4096);
+    p->r1out.K = take(p, FS_4096);
+
+    for (int k = 0; k < m; k++)
+    {
+        p->hisR1out[k].psi = EMPTY;
+        p->hisR1out[k].G = take(p, FS_4096);
+        p->hisR1out[k].K = take(p, FS_4096);
+    }
+
+    for (int k = 0; k < m; k++)
+    {
+        CG21_PRESIGN_ROUND2_OUTPUT *o = p->r2out + k;
+        CG21_PRESIGN_ROUND2_STORE *s = p->r2store + k;
+
+        o->Gamma = take(p, EFS);
+        o->D = take(p, FS_4096);
+        o->D_hat = take(p, FS_4096);
+        o->F = take(p, FS_4096);
+        o->F_hat = take(p, FS_4096);
+        o->psi = EMPTY;
+        o->psi_hat = EMPTY;
+        o->psi_prime = EMPTY;
+
+        s->r = take(p, FS_4096);
+        s->r_hat = take(p, FS_4096);
+        s->s = take(p, FS_4096);
+        s->s_hat = take(p, FS_4096);
+        s->Gamma = take(p, EFS);
+        s->beta = take(p, FS_2048);
+        s->beta_hat = take(p, FS_2048);
+        s->neg_beta = take(p, FS_2048);
+        s->neg_beta_hat = take(p, FS_2048);
+    }
+
+    p->r3out.delta = take(p, EGS);
+    p->r3out.Delta = take(p, EFS);
+    p->r3out.psi_douplePrime = EMPTY;
+
+    p->r3store1.Gamma = take(p, EFS);
+    p->r3store1.Delta = take(p, EFS);
+    p->r3store2.delta = take(p, EGS);
+    p->r3store2.chi = take(p, EGS);
+
+    p->r4store1.Delta = take(p, EFS);
+    p->r4store1.delta = take(p, EGS);
+
+    p->pre.R = take(p, EFS);
+    p->pre.chi = take(p, EGS);
+    p->pre.k = take(p, EGS);
+
+    p->store.r = take(p, EGS);
+    p->store.sigma = take(p, EGS);
+    p->sr1out.sigma = take(p, EGS);
+    p->out.r = take(p, EGS);
+    p->out.sigma = take(p, EGS);
+
+    for (int r = 0; r < 3; r++)
+    {
+        p->outbox[r] = take(p, BODY(m));
+    }
+
+    for (int k = 0; k < 2 * m; k++)
+    {
+        p->queue[k].body = take(p, BODY(m));
+    }
+
+    p->presign.RNG = RNG;
+    p->presign.reshareOutput = reshare;
+    p->presign.setting = setting;
+    p->presign.myKeys = keys;
+    p->presign.hisPK = hisPK;
+    p->presign.myPedersen = pedersen;
+    p->presign.hisPedersen = hisPedersen;
+    p->presign.ssid = ssid;
+    p->presign.hisX = hisX;
+    p->presign.hisR1out = p->hisR1out;
+    p->presign.peers = mine;
+    p->presign.n = m;
+    p->presign.r1out = &p->r1out;
+    p->presign.r1store = &p->r1store;
+    p->presign.r2out = p->r2out;
+    p->presign.r2store = p->r2store;
+    p->presign.r3out = &p->r3out;
+    p->presign.r3store1 = &p->r3store1;
+    p->presign.r3store2 = &p->r3store2;
+    p->presign.r4store1 = &p->r4store1;
+    p->presign.pre = &p->pre;
+    p->presign.r4out = &p->r4out;
+
+    p->sign.HM = HM;
+    p->sign.T = NULL;
+    p->sign.pre = &p->pre;
+    p->sign.store = &p->store;
+    p->sign.r1out = &p->sr1out;
+    p->sign.out = &p->out;
+    p->sign.PK = reshare->pk.X;
+}
+
+/* Print the latency distribution and the throughput of a phase */
+static void report(const char *phase, const CG21_SIM_HIST *hist, int count, double wall)
+{
+    printf("%s latency: mean %lld us, p50 < %lld us, p99 < %lld us, max %lld us\n", phase,
+           hist->total / hist->n, CG21_SIM_HIST_PERCENTILE(hist, 50),
+           CG21_SIM_HIST_PERCENTILE(hist, 99), hist->max);
+    printf("%s throughput: %.1f sessions/s in this process\n", phase, count / wall);
+
+    for (int b = 0; b < CG21_SIM_HIST_BUCKETS; b++)
+    {
+        if (hist->count[b] != 0)
+        {
+            printf("  [%10lld, %10lld) us  %lld\n", (long long)1 << b, (long long)1 << (b + 1), hist->count[b]);
+        }
+    }
+}
+
+/* Run the simulations and report them, 0 on success */
+static int run(const char *phase, CG21_SIM *sims, int count)
+{
+    CG21_SIM_HIST hist;
+    struct timespec t0;
+    struct timespec t1;
+
+    CG21_SIM_HIST_INIT(&hist);
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    int rc = CG21_SIM_RUN_ALL(sims, count, &hist);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    if (rc != CG21_SIM_OK)
+    {
+        printf("FAILURE %s CG21_SIM_RUN_ALL rc %d\n", phase, rc);
+        return 1;
+    }
+
+    report(phase, &hist, count, (double)(t1.tv_sec - t0.tv_sec) + (double)(t1.tv_nsec - t0.tv_nsec) / 1e9);
+
+    return 0;
+}
+
+/* Presign and sign from the key shares of the key reshare example */
+static int pipeline(csprng *RNG, const octet *HM, int count, long long latency, long long jitter)
+{
+    CG21_RESHARE_SETTING setting;
+    CG21_RESHARE_OUTPUT *reshare;
+
+    if (read_reshare(&setting, &reshare) != 0)
+    {
+        return 1;
+    }
+
+    int t = setting.t2;
+    int m = t - 1;
+    int T2[t];
+
+    for (int i = 0; i < t; i++)
+    {
+        T2[i] = i + 1;
+    }
+    setting.T2 = T2;
+
+    printf("Simulating %d presign and sign sessions by %d players, latency %lld us, jitter %lld us, %d threads\n",
+           count, t, latency, jitter, PARALLEL_get_threads());
+
+    // Paillier keys and ring-Pedersen parameters of the players, and of the peers of each player
+    char p_[HFS_2048];
+    char q_[HFS_2048];
+    octet P = {0, sizeof(p_), p_};
+    octet Q = {0, sizeof(q_), q_};
+
+    CG21_PAILLIER_KEYS *keys = malloc(sizeof(CG21_PAILLIER_KEYS) * t);
+    PAILLIER_public_key *hisPK = malloc(sizeof(PAILLIER_public_key) * t * m);
+    CG21_PEDERSEN_KEYS *pedersen = malloc(sizeof(CG21_PEDERSEN_KEYS) * t);
+    PEDERSEN_PUB *hisPedersen = malloc(sizeof(PEDERSEN_PUB) * t * m);
+    octet *hisX = malloc(sizeof(octet) * t * m);
+    char *xmem = malloc(EFS * t * m);
+    int *peers = malloc(sizeof(int) * t * m);
+
+    PARTY *parties = malloc(sizeof(PARTY) * count * t);
+    CG21_PRESIGN_ROUND1_OUTPUT *hisR1out = malloc(sizeof(CG21_PRESIGN_ROUND1_OUTPUT) * count * t * m);
+    CG21_PRESIGN_ROUND2_OUTPUT *r2out = malloc(sizeof(CG21_PRESIGN_ROUND2_OUTPUT) * count * t * m);
+    CG21_PRESIGN_ROUND2_STORE *r2store = malloc(sizeof(CG21_PRESIGN_ROUND2_STORE) * count * t * m);
+    CG21_SESSION_MSG *queue = malloc(sizeof(CG21_SESSION_MSG) * count * t * 2 * m);
+    octet *octets = malloc(sizeof(octet) * count * t * party_octets(m));
+    char *mem = malloc((size_t)count * t * party_size(m));
+
+    int *ids = malloc(sizeof(int) * count * t);
+    int *seen = malloc(sizeof(int) * count * t * m);
+    CG21_SESSION *sessions = malloc(sizeof(CG21_SESSION) * count * t);
+    CG21_SIM_EVENT *events = malloc(sizeof(CG21_SIM_EVENT) * count * 3 * t * m);
+    octet *bodies = malloc(sizeof(octet) * count * 3 * t * m);
+    char *bmem = malloc((size_t)count * 3 * t * m * BODY(m));
+    csprng *rngs = malloc(sizeof(csprng) * 2 * count);
+    CG21_SIM *sims = malloc(sizeof(CG21_SIM) * count);
+
+    if (keys == NULL || hisPK == NULL || pedersen == NULL || hisPedersen == NULL || hisX == NULL || xmem == NULL
+        || peers == NULL || parties == NULL || hisR1out == NULL || r2out == NULL || r2store == NULL
+        || queue == NULL || octets == NULL || mem == NULL || ids == NULL || seen == NULL || sessions == NULL
+        || events == NULL || bodies == NULL || bmem == NULL || rngs == NULL || sims == NULL)
+    {
+        printf("FAILURE out of memory\n");
+        return 1;
+    }
+
+    for (int i = 0; i < t; i++)
+    {
+        OCT_fromHex(&P, PT_hex[i]);
+        OCT_fromHex(&Q, QT_hex[i]);
+        PAILLIER_KEY_PAIR(NULL, &P, &Q, &keys[i].paillier_pk, &keys[i].paillier_sk);
+
+        ring_Pedersen_setup(RNG, &pedersen[i].pedersenPriv, &P, &Q);
+        Pedersen_get_public_param(&pedersen[i].pedersenPub, &pedersen[i].pedersenPriv);
+    }
+
+    CG21_SSID ssid;
+    octet ssid_octets[11];
+    int ssid_n[2];
+
+    char *ssid_mem = form_ssid(RNG, &ssid, ssid_octets, ssid_n, reshare, &setting, pedersen);
+    if (ssid_mem == NULL)
+    {
+        printf("FAILURE out of memory\n");
+        return 1;
+    }
+
+    for (int i = 0; i < t; i++)
+    {
+        for (int j = 0, k = 0; j < t; j++)
+        {
+            if (j != i)
+            {
+                peers[i * m + k] = j + 1;
+                hisPK[i * m + k] = keys[j].paillier_pk;
+                hisPedersen[i * m + k] = pedersen[j].pedersenPub;
+
+                oct_init(hisX + i * m + k, xmem + (i * m + k) * EFS, EFS);
+                share_X(reshare + j, &setting, hisX + i * m + k);
+                k++;
+            }
+        }
+    }
+
+    char seed[32];
+
+    for (int s = 0; s < count; s++)
+    {
+        PARTY *ps = parties + s * t;
+        int e = s * 3 * t * m;
+
+        for (int r = 0; r < 2; r++)
+        {
+            for (int i = 0; i < 32; i++)
+            {
+                seed[i] = (char)RAND_byte(RNG);
+            }
+            RAND_seed(rngs + 2 * s + r, 32, seed);
+        }
+
+        for (int i = 0; i < t; i++)
+        {
+            PARTY *p = ps + i;
+            int pi = s * t + i;
+
+            p->hisR1out = hisR1out + pi * m;
+            p->r2out = r2out + pi * m;
+            p->r2store = r2store + pi * m;
+            p->queue = queue + pi * 2 * m;
+            p->octets = octets + pi * party_octets(m);
+            p->mem = mem + (size_t)pi * party_size(m);
+            p->used = 0;
+            p->off = 0;
+
+            // the players of a session run in one thread and share its RNG
+            setup_party(p, rngs + 2 * s + 1, reshare + i, &setting, keys + i, hisPK + i * m, pedersen + i,
+                        hisPedersen + i * m, &ssid, hisX + i * m, peers + i * m, m, HM);
+
+            ids[pi] = i + 1;
+            CG21_SESSION_INIT(sessions + pi, &CG21_PRESIGN_PHASE, &p->presign, peers + i * m, seen + pi * m, m,
+                              p->queue, 2 * m, p->outbox);
+        }
+
+        for (int j = 0; j < 3 * t * m; j++)
+        {
+            oct_init(bodies + e + j, bmem + (size_t)(e + j) * BODY(m), BODY(m));
+            events[e + j].msg.body = bodies + e + j;
+        }
+
+        sims[s].party = sessions + s * t;
+        sims[s].ids = ids + s * t;
+        sims[s].n = t;
+        sims[s].latency = latency;
+        sims[s].jitter = jitter;
+        sims[s].RNG = rngs + 2 * s;
+        sims[s].events = events + e;
+        sims[s].max_events = 3 * t * m;
+    }
+
+    if (run("presign", sims, count) != 0)
+    {
+        return 1;
+    }
+
+    // sign with the new presignatures, the signature is validated against the PK
+    for (int s = 0; s < count * t; s++)
+    {
+        CG21_SESSION_INIT(sessions + s, &CG21_SIGN_PHASE, &parties[s].sign, peers + (s % t) * m, seen + s * m, m,
+                          parties[s].queue, 2 * m, parties[s].outbox);
+    }
+
+    if (run("sign", sims, count) != 0)
+    {
+        return 1;
+    }
+
+    for (int i = 0; i < t; i++)
+    {
+        PAILLIER_PRIVATE_KEY_KILL(&keys[i].paillier_sk);
+        CG21_Pedersen_Private_Kill(&pedersen[i].pedersenPriv);
+    }
+
+    free(keys);
+    free(hisPK);
+    free(pedersen);
+    free(hisPedersen);
+    free(hisX);
+    free(xmem);
+    free(ssid_mem);
+    free(peers);
+    free(parties);
+    free(hisR1out);
+    free(r2out);
+    free(r2store);
+    free(queue);
+    free(octets);
+    free(mem);
+    free(ids);
+    free(seen);
+    free(sessions);
+    free(events);
+    free(bodies);
+    free(bmem);
+    free(rngs);
+    free(sims);
+
+    return 0;
+}
+
+/* Sign with presignatures dealt to t players */
+static int dealer(csprng *RNG, const octet *HM, int t, int count, long long latency, long long jitter)
+{
+    char seed[32];
+
+    PLAYER *players = malloc(sizeof(PLAYER) * count * t);
+    int *ids = malloc(sizeof(int) * count * t);
+    int *peers = malloc(sizeof(int) * count * t * (t - 1));
+    int *seen = malloc(sizeof(int) * count * t * (t - 1));
+    char *xs = malloc(EFS * count);
+    octet *X = malloc(sizeof(octet) * count);
+    CG21_SESSION *sessions = malloc(sizeof(CG21_SESSION) * count * t);
+    CG21_SIM_EVENT *events = malloc(sizeof(CG21_SIM_EVENT) * count * t * (t - 1));
+    octet *bodies = malloc(sizeof(octet) * count * t * (t - 1));
+    char *bmem = malloc(EGS * count * t * (t - 1));
+    csprng *rngs = malloc(sizeof(csprng) * count);
+    CG21_SIM *sims = malloc(sizeof(CG21_SIM) * count);
+
+    if (players == NULL || ids == NULL || peers == NULL || seen == NULL || xs == NULL || X == NULL
+        || sessions == NULL || events == NULL || bodies == NULL || bmem == NULL || rngs == NULL || sims == NULL)
+    {
+        printf("FAILURE out of memory\n");
+        return 1;
+    }
+
+    printf("Simulating %d signatures by %d players, latency %lld us, jitter %lld us, %d threads\n",
+           count, t, latency, jitter, PARALLEL_get_threads());
+
+    for (int s = 0; s < count; s++)
+    {
+        PLAYER *p = players + s * t;
+        int e = s * t * (t - 1);
+
+        oct_init(X + s, xs + s * EFS, EFS);
+        setup(RNG, p, sessions + s * t, ids + s * t, peers + e, seen + e, t, HM, X + s);
+
+        for (int j = 0; j < t * (t - 1); j++)
+        {
+            oct_init(bodies + e + j, bmem + (e + j) * EGS, EGS);
+            events[e + j].msg.body = bodies + e + j;
+        }
+
+        for (int i = 0; i < 32; i++)
+        {
+            seed[i] = (char)RAND_byte(RNG);
+        }
+        RAND_seed(rngs + s, 32, seed);
+
+        sims[s].party = sessions + s * t;
+        sims[s].ids = ids + s * t;
+        sims[s].n = t;
+        sims[s].latency = latency;
+        sims[s].jitter = jitter;
+        sims[s].RNG = rngs + s;
+        sims[s].events = events + e;
+        sims[s].max_events = t * (t - 1);
+    }
+
+    int rc = run("sign", sims, count);
+
+    free(players);
+    free(ids);
+    free(peers);
+    free(seen);
+    free(xs);
+    free(X);
+    free(sessions);
+    free(events);
+    free(bodies);
+    free(bmem);
+    free(rngs);
+    free(sims);
+
+    return rc;
+}
+
+int main(int argc, char *argv[])
+{
+    int count = argc > 1 ? atoi(argv[1]) : 16;
+    long long latency = argc > 2 ? atoll(argv[2]) : 50000;
+    long long jitter = argc > 3 ? atoll(argv[3]) : 10000;
+    int t = argc > 4 ? atoi(argv[4]) : 0;
+    int rc;
+
+    if (count < 1 || (argc > 4 && t < 2))
+    {
+        printf("usage: %s [sessions >= 1] [latency_us] [jitter_us] [t >= 2]\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    char seed[32] = {0};
+    csprng RNG;
+
+    char hm[SHA256_HASH_SIZE];
+    octet HM = {0, sizeof(hm), hm};
+
+    char msg[] = "CG21 simulated signature";
+    octet MSG = {sizeof(msg) - 1, sizeof(msg), msg};
+
+    CG21_SIGN_HASH H;
+
+    for (int i = 0; i < 32; i++)
+    {
+        seed[i] = (char)(i + 1);
+    }
+    RAND_seed(&RNG, 32, seed);
+
+    CG21_SIGN_HASH_INIT(&H);
+    CG21_SIGN_HASH_UPDATE(&H, &MSG);
+    CG21_SIGN_HASH_FINAL(&H, &HM);
+
+    if (t == 0)
+    {
+        rc = pipeline(&RNG, &HM, count, latency, jitter);
+    }
+    else
+    {
+        rc = dealer(&RNG, &HM, t, count, latency, jitter);
+    }
+
+    KILL_CSPRNG(&RNG);
+
+    if (rc != 0)
+    {
+        exit(EXIT_FAILURE);
+    }
+
+    printf("SUCCESS\n");
+    exit(EXIT_SUCCESS);
+}
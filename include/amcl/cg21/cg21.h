@@ -17,7 +17,8 @@ specific language governing permissions and limitations
 under the License.
 */
 
-
+#ifndef CG21_H
+#define CG21_H
 
 #include <amcl/amcl.h>
 #include <amcl/big_512_60.h>
@@ -32,9 +33,12 @@ under the License.
 #include <amcl/paillier.h>
 #include "amcl/hash_utils.h"
 #include "amcl/schnorr.h"
+#include "amcl/parallel.h"
 #include "cg21_pi_mod.h"
 #include "cg21_pi_prm.h"
 #include "cg21_pi_factor.h"
+#include "cg21_rp_pi_affg.h"
+#include "cg21_rp_pi_logstar.h"
 
 
 #define CG21_KEY_ERROR                       3130101
@@ -57,6 +61,14 @@ under the License.
 #define CG21_SIGN_SIGMA_IS_ZERO              3130119
 #define CG21_SIGN_SIGNATURE_IS_INVALID       3130120
 #define CG21_RESHARE_t1_IS_SMALL             3130121
+#define CG21_PRESIGN_POOL_EMPTY              3130122
+#define CG21_SIGN_DIGEST_IS_INVALID          3130123
+#define CG21_PRESIGN_AFFG_NOT_VALID          3130124
+#define CG21_PRESIGN_AFFG_HAT_NOT_VALID      3130125
+#define CG21_PRESIGN_LOGSTAR_NOT_VALID       3130126
+#define CG21_PRESIGN_POOL_MIXED_IDS          3130127
+#define CG21_PRESIGN_ENC_NOT_VALID           3130128
+#define CG21_PRESIGN_LOGSTAR_DELTA_NOT_VALID 3130129
 
 
 #define CG21_MINIMUM_N_LENGTH  (256 * 8 - 1)               /**<  Minimum bit-length of N*/
@@ -201,6 +213,15 @@ typedef struct
     CG21_PiFACTOR_COMMIT factorCommits;
 } CG21_AUX_ROUND3;
 
+typedef struct
+{
+    const CG21_SSID *prmSsid;           // session ID of his Pi-prm proof
+    const CG21_SSID *ssid;              // session ID of his Pi-mod and Pi-factor proofs
+    CG21_AUX_ROUND1_STORE_PUB *rnd1Pub; // his Paillier and Pedersen public parameters
+    CG21_AUX_ROUND3 *rnd3;              // his round 3 proofs
+
+} CG21_AUX_ROUND3_PEER;
+
 typedef struct
 {
     octet *j;     // packed j values
@@ -350,6 +371,55 @@ typedef struct
 
 } CG21_PRESIGN_ROUND2_STORE;
 
+typedef struct
+{
+    const CG21_PRESIGN_ROUND1_OUTPUT *r1output;  // his round 1 output
+    PAILLIER_public_key *hisPK;                 // his Paillier PK
+    PEDERSEN_PUB *hisPedersen;                  // his ring-Pedersen parameters
+
+    CG21_PRESIGN_ROUND2_OUTPUT *r2output;
+    CG21_PRESIGN_ROUND2_STORE *r2store;
+
+    // PiAffg for (D, K, F, Gamma), pre is optional
+    Piaffg_PRECOMMITS *affgPre;
+    Piaffg_COMMITS *affgCommit;
+    Piaffg_COMMITS_OCT *affgCommitOct;
+    Piaffg_PROOFS *affgProof;
+    Piaffg_PROOFS_OCT *affgProofOct;
+
+    // PiAffg for (D_hat, K, F_hat, X), pre is optional
+    Piaffg_PRECOMMITS *affgHatPre;
+    Piaffg_COMMITS *affgHatCommit;
+    Piaffg_COMMITS_OCT *affgHatCommitOct;
+    Piaffg_PROOFS *affgHatProof;
+    Piaffg_PROOFS_OCT *affgHatProofOct;
+
+    // PiLogstar for (G, Gamma)
+    PiLogstar_COMMITS *logCommit;
+    PiLogstar_COMMITS_OCT *logCommitOct;
+    PiLogstar_PROOFS *logProof;
+    PiLogstar_PROOFS_OCT *logProofOct;
+
+    int rc;     // result for this peer
+
+} CG21_PRESIGN_ROUND2_PEER;
+
+typedef struct
+{
+    PAILLIER_public_key *hisPK;                 // his Paillier PK
+    const CG21_PRESIGN_ROUND1_OUTPUT *r1output; // his round 1 output
+    const CG21_PRESIGN_ROUND2_OUTPUT *r2output; // his round 2 output sent to me
+    octet *X;                                   // his public key share
+
+    Piaffg_COMMITS *affgCommit;                 // PiAffg for (D, K, F, Gamma)
+    Piaffg_PROOFS *affgProof;
+    Piaffg_COMMITS *affgHatCommit;              // PiAffg for (D_hat, K, F_hat, X)
+    Piaffg_PROOFS *affgHatProof;
+    PiLogstar_COMMITS *logCommit;               // PiLogstar for (G, Gamma)
+    PiLogstar_PROOFS *logProof;
+
+} CG21_PRESIGN_ROUND3_PEER;
+
 typedef struct
 {
     octet *delta;
@@ -422,6 +492,31 @@ typedef struct
 
 } CG21_SIGN_ROUND2_OUTPUT;
 
+typedef struct
+{
+    BIG_256_56 *r;      // r = R_x mod q of each presignature
+    BIG_256_56 *k;      // k of each presignature
+    BIG_256_56 *chi;    // chi of each presignature
+    int n;              // number of presignatures
+    int next;           // index of the next unused presignature
+    int i;              // my id
+
+} CG21_PRESIGN_POOL;    // presignatures in structure-of-arrays form
+
+typedef struct
+{
+    BIG_256_56 *r;      // r component of each signature
+    BIG_256_56 *sigma;  // s component, or partial s component, of each signature
+    int n;              // number of signatures
+
+} CG21_SIGN_BATCH;
+
+typedef struct
+{
+    hash256 sha;        // SHA256 state over the message processed so far
+
+} CG21_SIGN_HASH;       // streaming message digest for the PREHASHED sign and validate
+
 
 
 #define iLEN 32
@@ -686,6 +781,16 @@ extern int CG21_PI_MOD_PROVE_HELPER(csprng *RNG, CG21_AUX_ROUND1_STORE_PRIV *rnd
 extern int CG21_PI_MOD_VERIFY_HELPER(CG21_AUX_ROUND1_STORE_PUB *rnd1Pub, const CG21_SSID *ssid,
                                         CG21_AUX_ROUND3 *rnd3);
 
+/**	@brief Verify proof for correctness of Paillier, batching the zi checks
+*
+*  @param RNG               pointer to a cryptographically secure random number generator
+*  @param rnd1Pub           hold Paillier and Pedersen public parameters in packed form
+*  @param ssid              system-wide session-ID, refers to the same notation as in CG21
+*  @param rnd3              output of round3
+*/
+extern int CG21_PI_MOD_VERIFY_BATCH_HELPER(csprng *RNG, CG21_AUX_ROUND1_STORE_PUB *rnd1Pub, const CG21_SSID *ssid,
+                                           CG21_AUX_ROUND3 *rnd3);
+
 /**	@brief Generate proof for correctness of Pedersen parameters
 *
 *  @param rnd1Pub           hold Paillier and Pedersen public parameters in packed form
@@ -715,6 +820,21 @@ int CG21_PI_FACTOR_PROVE_HELPER(csprng *RNG, const CG21_SSID *ssid, CG21_AUX_ROU
 int CG21_PI_FACTOR_VERIFY_HELPER(const CG21_SSID *ssid, CG21_AUX_ROUND3 *rnd4pub, CG21_AUX_ROUND1_STORE_PUB *rnd1Pub,
                                  CG21_AUX_ROUND1_STORE_PRIV *rnd1Priv);
 
+/**	@brief Verify the Pi-prm, Pi-mod and Pi-factor proofs of all the peers in parallel
+*
+*  The peers are verified with PARALLEL_verify, the remaining verifications
+*  are cancelled as soon as one of them fails
+*
+*  @param rnd1Priv          my Paillier and Pedersen private parameters in packed form
+*  @param peers             public data and proofs of each peer
+*  @param n                 number of peers
+*  @param verdicts          result of each peer, PARALLEL_SKIPPED if cancelled
+*  @param failed            index of the first peer to fail, -1 if none did
+*  @return                  CG21_OK if all the proofs are valid, the error of the failed peer otherwise
+*/
+extern int CG21_AUX_ROUND3_VERIFY_ALL(CG21_AUX_ROUND1_STORE_PRIV *rnd1Priv, CG21_AUX_ROUND3_PEER *peers, int n,
+                                      int *verdicts, int *failed);
+
 /**	@brief Pack players' Pedersen parameters and IDs
 *   Note: Paillier and Pedersen share the same N
 *
@@ -845,6 +965,25 @@ extern void CG21_KEY_RESHARE_ENCRYPT_SHARES(csprng *RNG, PAILLIER_public_key *pk
                                             CG21_RESHARE_ROUND1_STORE_PUB_T1 storePub,
                                             CG21_RESHARE_ROUND3_OUTPUT *output);
 
+/**	@brief Encrypt the ECDSA shares of all the receivers at once
+*
+*  The share of the receiver with ID hisID[i] is the (hisID[i]-1)-th VSS share. It
+*  is encrypted under the PK of pools[i] with a precomputed nonce from that pool,
+*  see CG21_PAILLIER_NONCE_POOL_FILL. The receivers are processed with PARALLEL_for
+*
+*  @param pools         nonce pools, one per receiver
+*  @param hisID         IDs of the receivers
+*  @param n             number of receivers
+*  @param storeSecret   secret data to be stored and used in the next round
+*  @param storePub      shared output with the other players in round2
+*  @param output        outputs of the function, one per receiver
+*  @return              CG21_OK or CG21_NONCE_POOL_EMPTY
+*/
+extern int CG21_KEY_RESHARE_ENCRYPT_ALL_SHARES(CG21_PAILLIER_NONCE_POOL *pools, const int *hisID, int n,
+                                               CG21_RESHARE_ROUND1_STORE_SECRET_T1 *storeSecret,
+                                               CG21_RESHARE_ROUND1_STORE_PUB_T1 storePub,
+                                               CG21_RESHARE_ROUND3_OUTPUT *output);
+
 /**	@brief Encrypt ECDSA shares using receivers' Paillier PKs
 *
 *
@@ -856,6 +995,19 @@ extern void CG21_KEY_RESHARE_DECRYPT_SHARES(PAILLIER_private_key *sk,
                                             CG21_RESHARE_ROUND3_OUTPUT *r3output,
                                             SSS_shares *share);
 
+/**	@brief Decrypt the ECDSA shares received from all the players at once
+*
+*  The decryptions are run with CG21_PAILLIER_DECRYPT_REDUCE_Q
+*
+*  @param sk            Paillier private key
+*  @param r3output      outputs of the round3, one per sender
+*  @param share         decryption results, one per sender
+*  @param n             number of senders
+*/
+extern void CG21_KEY_RESHARE_DECRYPT_ALL_SHARES(PAILLIER_private_key *sk,
+                                                CG21_RESHARE_ROUND3_OUTPUT *r3output,
+                                                SSS_shares *share, int n);
+
 
 /**	@brief each user in N2 that receives a message from N2-T1:
 *
@@ -1014,6 +1166,21 @@ extern int CG21_PRESIGN_ROUND1(csprng *RNG, const CG21_RESHARE_OUTPUT *reshareOu
                                 CG21_RESHARE_SETTING *setting, CG21_PRESIGN_ROUND1_OUTPUT *output,
                                 CG21_PRESIGN_ROUND1_STORE *store, PAILLIER_public_key *keys);
 
+/**	@brief Homomorphic evaluation of MtA
+*
+*  Computes D = K^x * Enc(y, s) = K^x * (1+N)^y * s^N mod N^2 with one
+*  simultaneous exponentiation, on operands already parsed
+*
+*  @param pk            Paillier PK of the owner of K
+*  @param K             ciphertext, FFLEN_4096
+*  @param x             multiplier, HFLEN_4096
+*  @param y             additive term, HFLEN_4096 and smaller than N
+*  @param s             Paillier randomness in Z*_N, FFLEN_4096
+*  @param D             on exit the ciphertext D, FFLEN_4096
+*/
+extern void CG21_MTA_EVAL(PAILLIER_public_key *pk, BIG_512_60 *K, BIG_512_60 *x, BIG_512_60 *y, BIG_512_60 *s,
+                          BIG_512_60 *D);
+
 /**	@brief Operations in CG21:Round2 as follows:
 *
 *  1: compute Gamma = gamma*G
@@ -1034,6 +1201,50 @@ extern int CG21_PRESIGN_ROUND2(csprng *RNG, CG21_PRESIGN_ROUND2_OUTPUT *r2output
                                const CG21_PRESIGN_ROUND1_OUTPUT *r1output, const CG21_PRESIGN_ROUND1_STORE *r1store,
                                PAILLIER_public_key *hisPK, PAILLIER_public_key *myPK);
 
+/**	@brief Round 2 of CG21 for all the peers, run in parallel
+*
+*  For each peer j, runs CG21_PRESIGN_ROUND2 and generates the proofs sent to j:
+*  PiAffg for (D, K_j, F, Gamma), PiAffg for (D_hat, K_j, F_hat, X) and
+*  PiLogstar for (G, Gamma). The peers are processed with PARALLEL_for, each
+*  with its own csprng seeded from RNG, and the result of each peer is stored in
+*  peers[j].rc
+*
+*  @param RNG           pointer to a cryptographically secure random number generator
+*  @param r1store       data that are stored in round 1
+*  @param r1output      my output of round 1
+*  @param myKeys        my Paillier keys
+*  @param ssid          system-wide session-ID
+*  @param peers         inputs and outputs of each peer
+*  @param n             number of peers
+*  @return              CG21_OK if all the peers succeeded, CG21_PRESIGN_FAILED otherwise
+*/
+extern int CG21_PRESIGN_ROUND2_ALL(csprng *RNG, const CG21_PRESIGN_ROUND1_STORE *r1store,
+                                   const CG21_PRESIGN_ROUND1_OUTPUT *r1output, CG21_PAILLIER_KEYS *myKeys,
+                                   CG21_SSID *ssid, CG21_PRESIGN_ROUND2_PEER *peers, int n);
+
+/**	@brief Verify the proofs sent by all the peers in round 2, in parallel
+*
+*  For each peer, verifies PiAffg for (D, K, F, Gamma), PiAffg for (D_hat, K, F_hat, X)
+*  and PiLogstar for (G, Gamma) as generated by CG21_PRESIGN_ROUND2_ALL. The peers
+*  are verified with PARALLEL_verify, the remaining verifications are cancelled as
+*  soon as one of them fails
+*
+*  @param r1output      my output of round 1
+*  @param myKeys        my Paillier keys
+*  @param myPedersen    my ring-Pedersen parameters
+*  @param ssid          system-wide session-ID
+*  @param peers         outputs and proofs of each peer
+*  @param n             number of peers
+*  @param verdicts      result of each peer: CG21_OK, CG21_PRESIGN_AFFG_NOT_VALID,
+*                       CG21_PRESIGN_AFFG_HAT_NOT_VALID, CG21_PRESIGN_LOGSTAR_NOT_VALID
+*                       or PARALLEL_SKIPPED if cancelled
+*  @param failed        index of the first peer to fail, -1 if none did
+*  @return              CG21_OK if all the proofs are valid, the error of the failed peer otherwise
+*/
+extern int CG21_PRESIGN_ROUND3_VERIFY_ALL(const CG21_PRESIGN_ROUND1_OUTPUT *r1output, CG21_PAILLIER_KEYS *myKeys,
+                                          CG21_PEDERSEN_KEYS *myPedersen, CG21_SSID *ssid,
+                                          CG21_PRESIGN_ROUND3_PEER *peers, int n, int *verdicts, int *failed);
+
 /**	@brief Compute Gamma and Delta in CG21:Round3 as follows:
 *
 *  1: compute Gamma = \prod Gamma_j
@@ -1120,6 +1331,132 @@ extern int CG21_SIGN_ROUND1(octet *msg,
                             CG21_SIGN_ROUND1_STORE *store,
                             CG21_SIGN_ROUND1_OUTPUT *out);
 
+/**	@brief Compute sigma_i = k_i*m + r*\chi_i mod q for a message digest
+*
+*  Same as CG21_SIGN_ROUND1, with the message already hashed by the caller
+*
+*  @param HM        SHA256 digest of the message, see CG21_SIGN_HASH_FINAL
+*  @param pre       generated data in presign
+*  @param store     data to be stored in db in round 1
+*  @param out       data to be broadcast once round 1 ends
+*  @return          CG21_OK, CG21_SIGN_DIGEST_IS_INVALID, CG21_INVALID_ECP,
+*                   CG21_SIGN_r_IS_ZERO or CG21_SIGN_SIGMA_IS_ZERO
+*/
+extern int CG21_SIGN_ROUND1_PREHASHED(const octet *HM,
+                                      const CG21_PRESIGN_ROUND4_STORE_2 *pre,
+                                      CG21_SIGN_ROUND1_STORE *store,
+                                      CG21_SIGN_ROUND1_OUTPUT *out);
+
+/**	@brief Compute sigma_i = k_i*m + r*(\chi_i + t*k_i) mod q for the child key X + t*G
+*
+*  Signs for a key derived with CG21_DERIVE_CHILD or CG21_DERIVE_PATH, using a
+*  presignature generated for the parent key X, so presignatures can be generated
+*  before the child key is known. Every player applies the same public tweak t.
+*  Do not use with presignatures generated from a tweaked key re-sharing output
+*
+*  @param HM        SHA256 digest of the message, see CG21_SIGN_HASH_FINAL
+*  @param T         tweak t, or NULL for the parent key
+*  @param pre       generated data in presign
+*  @param store     data to be stored in db in round 1
+*  @param out       data to be broadcast once round 1 ends
+*  @return          same as CG21_SIGN_ROUND1_PREHASHED
+*/
+extern int CG21_SIGN_ROUND1_TWEAKED(const octet *HM,
+                                    const octet *T,
+                                    const CG21_PRESIGN_ROUND4_STORE_2 *pre,
+                                    CG21_SIGN_ROUND1_STORE *store,
+                                    CG21_SIGN_ROUND1_OUTPUT *out);
+
+/**	@brief Start hashing a message to be signed
+*
+*  @param ctx       hash context
+*/
+extern void CG21_SIGN_HASH_INIT(CG21_SIGN_HASH *ctx);
+
+/**	@brief Hash the next chunk of a message to be signed
+*
+*  @param ctx       hash context, initialised with CG21_SIGN_HASH_INIT
+*  @param M         next bytes of the message
+*/
+extern void CG21_SIGN_HASH_UPDATE(CG21_SIGN_HASH *ctx, const octet *M);
+
+/**	@brief Output the digest of a message to be signed
+*
+*  The digest is the one CG21_SIGN_ROUND1 and CG21_SIGN_VALIDATE compute from
+*  the whole message, and can be passed to every player and to the validator
+*
+*  @param ctx       hash context, not to be updated afterwards
+*  @param HM        SHA256_HASH_SIZE bytes digest on exit
+*  @return          CG21_OK or CG21_SIGN_DIGEST_IS_INVALID if HM is too small, ctx is
+*                   left untouched
+*/
+extern int CG21_SIGN_HASH_FINAL(CG21_SIGN_HASH *ctx, octet *HM);
+
+/**	@brief Load presignatures into a pool for batch signing
+*
+*  R is decompressed and reduced to r once per presignature, using PARALLEL_verify
+*
+*  @param pool      pool on exit
+*  @param r         storage for n values of r
+*  @param k         storage for n values of k
+*  @param chi       storage for n values of chi
+*  @param pre       generated data in presign, one per presignature
+*  @param n         number of presignatures
+*  @return          CG21_OK, CG21_INVALID_ECP, CG21_SIGN_r_IS_ZERO or CG21_PRESIGN_POOL_MIXED_IDS
+*                   if the presignatures are not all of the same player
+*/
+extern int CG21_PRESIGN_POOL_LOAD(CG21_PRESIGN_POOL *pool, BIG_256_56 *r, BIG_256_56 *k, BIG_256_56 *chi,
+                                  const CG21_PRESIGN_ROUND4_STORE_2 *pre, int n);
+
+/**	@brief Zero the unused presignatures of a pool
+*
+*  @param pool      pool to clean
+*/
+extern void CG21_PRESIGN_POOL_KILL(CG21_PRESIGN_POOL *pool);
+
+/**	@brief Compute sigma_i = k_i*m + r*\chi_i mod q for a batch of message digests
+*
+*  Consumes out->n presignatures from the pool, in order. k and chi are zeroed once
+*  used, so a presignature is never used twice. The signatures are computed with
+*  PARALLEL_for
+*
+*  @param pool      presignatures
+*  @param HM        digests of the messages to be signed, out->n of them
+*  @param out       r and partial sigma of each signature on exit
+*  @return          CG21_OK, CG21_PRESIGN_POOL_EMPTY, CG21_SIGN_DIGEST_IS_INVALID
+*                   or CG21_SIGN_SIGMA_IS_ZERO. No presignature is consumed on the
+*                   first two errors
+*/
+extern int CG21_SIGN_ROUND1_BATCH(CG21_PRESIGN_POOL *pool, octet *HM[], CG21_SIGN_BATCH *out);
+
+/**	@brief Batch version of CG21_SIGN_ROUND1_TWEAKED
+*
+*  @param pool      presignatures, generated for the parent key
+*  @param HM        digests of the messages to be signed, out->n of them
+*  @param T         tweak of the child key of each message, or NULL for the parent key
+*  @param out       r and partial sigma of each signature on exit
+*  @return          same as CG21_SIGN_ROUND1_BATCH
+*/
+extern int CG21_SIGN_ROUND1_BATCH_TWEAKED(CG21_PRESIGN_POOL *pool, octet *HM[], octet *T[], CG21_SIGN_BATCH *out);
+
+/**	@brief Pack the sigma components of a batch, EGS_SECP256K1 bytes each
+*
+*  @param O         packed sigmas on exit
+*  @param batch     batch of signatures
+*  @return          CG21_OK or CG21_UTILITIES_WRONG_PACKED_SIZE if O is too small
+*/
+extern int CG21_SIGN_BATCH_toOctet(octet *O, const CG21_SIGN_BATCH *batch);
+
+/**	@brief Compute sigma = \sum sigma_j for a batch of signatures in one pass
+*
+*  @param mine      my batch from CG21_SIGN_ROUND1_BATCH
+*  @param his       packed sigmas of the other players, see CG21_SIGN_BATCH_toOctet
+*  @param t         number of other players
+*  @param out       signatures on exit, may be the same as mine
+*  @return          CG21_OK or CG21_UTILITIES_WRONG_PACKED_SIZE
+*/
+extern int CG21_SIGN_ROUND2_BATCH(const CG21_SIGN_BATCH *mine, octet *his[], int t, CG21_SIGN_BATCH *out);
+
 /**	@brief Compute sigma = \sum sigma_j
 *
 *  @param mystore       data stored in db in round 1
@@ -1142,3 +1479,16 @@ extern int CG21_SIGN_VALIDATE(const octet *msg,
                               CG21_SIGN_ROUND2_OUTPUT *out,
                               octet *PK);
 
+/**	@brief Validate a generated signature for a message digest using PK
+*
+*  Same as CG21_SIGN_VALIDATE, with the message already hashed by the caller
+*
+*  @param HM        SHA256 digest of the message, see CG21_SIGN_HASH_FINAL
+*  @param out       (r, sigma): components of a signature
+*  @param PK        ECDSA PK
+*/
+extern int CG21_SIGN_VALIDATE_PREHASHED(const octet *HM,
+                                        CG21_SIGN_ROUND2_OUTPUT *out,
+                                        octet *PK);
+
+#endif
@@ -0,0 +1,97 @@
+/*
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"); you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+*/
+
+/**
+ * @file cg21_derive.h
+ * @brief Non-hardened (BIP32 style) derivation of child keys from a threshold key
+ *
+ * A child key is X' = X + t*G, where the tweak t is public and is derived from
+ * X, a chain code and an index as in BIP32 CKDpub:
+ *      I = HMAC-SHA512(chain code, X || ser32(index)),  t = I_L,  chain code' = I_R
+ * Since t is public, the players apply it locally without extra rounds, either
+ * to the output of key re-sharing before presign, or to the presignature at
+ * sign time, which keeps presignatures independent of the child key.
+ */
+
+#ifndef CG21_DERIVE_H
+#define CG21_DERIVE_H
+
+#include "amcl/amcl.h"
+#include "cg21.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define CG21_DERIVE_OK                      0           /**< Success */
+#define CG21_DERIVE_INVALID_INDEX           3131001     /**< The index is hardened, i.e. not smaller than 2^31 */
+#define CG21_DERIVE_INVALID_CHILD           3131002     /**< I_L is not smaller than q or X' is infinity, use the next index */
+#define CG21_DERIVE_INVALID_PK              3131003     /**< X or a partial PK is not a valid compressed point */
+#define CG21_DERIVE_INVALID_CHAIN           3131004     /**< The chain code is not CG21_DERIVE_CHAIN_SIZE bytes */
+
+#define CG21_DERIVE_CHAIN_SIZE      32                  /**< Length of a chain code in bytes */
+#define CG21_DERIVE_HARDENED        0x80000000U         /**< First hardened index */
+
+/**	@brief Derive the child key X' = X + t*G at a non-hardened index
+*
+*  @param X                 parent ECDSA PK, compressed
+*  @param C                 parent chain code, CG21_DERIVE_CHAIN_SIZE bytes
+*  @param index             child index, smaller than CG21_DERIVE_HARDENED
+*  @param childX            child ECDSA PK on exit, compressed
+*  @param childC            child chain code on exit
+*  @param T                 tweak t on exit, EGS_SECP256K1 bytes
+*  @return                  CG21_DERIVE_OK or an error code
+*/
+extern int CG21_DERIVE_CHILD(octet *X, octet *C, unsigned int index, octet *childX, octet *childC, octet *T);
+
+/**	@brief Derive a child key along a path of non-hardened indexes
+*
+*  The tweaks of the steps are summed mod q, so X' = X + t*G for the whole path
+*
+*  @param X                 parent ECDSA PK, compressed
+*  @param C                 parent chain code, CG21_DERIVE_CHAIN_SIZE bytes
+*  @param path              child indexes, from the parent down
+*  @param depth             number of indexes in the path
+*  @param childX            child ECDSA PK on exit, compressed
+*  @param childC            child chain code on exit
+*  @param T                 tweak t on exit, EGS_SECP256K1 bytes
+*  @return                  CG21_DERIVE_OK or an error code
+*/
+extern int CG21_DERIVE_PATH(octet *X, octet *C, const unsigned int *path, int depth,
+                            octet *childX, octet *childC, octet *T);
+
+/**	@brief Apply a tweak to the output of key re-sharing
+*
+*  Every Shamir share is moved by t, so the additive shares computed in presign
+*  sum to x + t. X and the first partial PK in X_set_packed are moved by t*G, so
+*  CG21_VALIDATE_PARTIAL_PKS still holds. Presignatures generated from the tweaked
+*  output are bound to the child key and must be used with CG21_SIGN_ROUND1
+*
+*  @param output            output of key re-sharing, tweaked in place
+*  @param T                 tweak t from CG21_DERIVE_CHILD or CG21_DERIVE_PATH
+*  @return                  CG21_DERIVE_OK or CG21_DERIVE_INVALID_PK
+*/
+extern int CG21_DERIVE_TWEAK_RESHARE_OUTPUT(CG21_RESHARE_OUTPUT *output, const octet *T);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,152 @@
+/*
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"); you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+*/
+
+/**
+ * @file cg21_keystore.h
+ * @brief Encrypted binary store of key shares with their parsed keys
+ *
+ * Each record holds a key share, the Paillier and Pedersen keys of the party
+ * and the public keys of its peers as limb arrays, with the values derived
+ * from them (Paillier private key, N^2, ...). Loading a record is one read
+ * and one AES-256-GCM decryption, without parsing or recomputation.
+ *
+ * File layout: a header followed by fixed size records
+ *      magic (7) | version (1) | key size (4) | peer size (4) | peers (4)
+ *      IV (12) | encrypted key and peers | tag (16)
+ * The header and the record index are authenticated as header data, so
+ * records can not be swapped. The limb arrays are stored as they are in
+ * memory: a file written by a build with another layout is rejected, and
+ * the keys are imported again from their octet encoding. Appending to a
+ * file must be serialised by the caller.
+ */
+
+#ifndef CG21_KEYSTORE_H
+#define CG21_KEYSTORE_H
+
+#include <stdio.h>
+#include "amcl/amcl.h"
+#include "cg21_utilities.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define CG21_KEYSTORE_OK                    0           /**< Success */
+#define CG21_KEYSTORE_IO_ERROR              3131501     /**< The keystore file can not be read or written */
+#define CG21_KEYSTORE_INVALID_FILE          3131502     /**< The keystore file has an invalid header or size */
+#define CG21_KEYSTORE_INVALID_LAYOUT        3131503     /**< The keystore file was written by a build with another layout */
+#define CG21_KEYSTORE_INVALID_KEY           3131504     /**< The keystore key has an invalid length */
+#define CG21_KEYSTORE_INVALID_INDEX         3131505     /**< There is no record with this index */
+#define CG21_KEYSTORE_INVALID_RECORD        3131506     /**< A record failed authentication */
+
+#define CG21_KEYSTORE_VERSION       1                   /**< Version of the file format */
+#define CG21_KEYSTORE_KEY_SIZE      32                  /**< AES-256 key length in bytes */
+#define CG21_KEYSTORE_IV_SIZE       12                  /**< GCM IV length in bytes */
+#define CG21_KEYSTORE_TAG_SIZE      16                  /**< GCM tag length in bytes */
+#define CG21_KEYSTORE_HEADER_SIZE   20                  /**< Length of the file header in bytes */
+#define CG21_KEYSTORE_ID_SIZE       32                  /**< Length of a key identifier in bytes */
+
+/** @brief Key share of a party, with its parsed Paillier and Pedersen keys */
+typedef struct
+{
+    char id[CG21_KEYSTORE_ID_SIZE];         /**< Identifier of the key, e.g. a hash of its public key */
+    int j;                                  /**< Identifier of the party */
+    int t;                                  /**< Threshold */
+    char X[EFS_SECP256K1 + 1];              /**< Compressed ECDSA public key */
+    char share[EGS_SECP256K1];              /**< Secret share of the ECDSA key */
+    CG21_PAILLIER_KEYS paillier;            /**< Paillier keys of the party */
+    CG21_PEDERSEN_KEYS pedersen;            /**< Ring-Pedersen parameters of the party */
+} CG21_KEYSTORE_KEY;
+
+/** @brief Public keys of a peer */
+typedef struct
+{
+    int j;                                  /**< Identifier of the peer */
+    char X[EFS_SECP256K1 + 1];              /**< Compressed partial ECDSA public key of the peer */
+    PAILLIER_public_key paillier;           /**< Paillier public key, with N^2 */
+    PEDERSEN_PUB pedersen;                  /**< Ring-Pedersen parameters */
+} CG21_KEYSTORE_PEER;
+
+/** @brief Open keystore file */
+typedef struct
+{
+    FILE *fp;                               /**< Keystore file */
+    char header[CG21_KEYSTORE_HEADER_SIZE]; /**< Header of the file */
+    int n;                                  /**< Number of peers of each key */
+    int count;                              /**< Number of records */
+} CG21_KEYSTORE;
+
+/**	@brief Open a keystore, creating it if it does not exist
+*
+*  An existing file that can not be opened for reading and writing is never
+*  truncated, CG21_KEYSTORE_IO_ERROR is returned instead.
+*
+*  @param ks                keystore on exit
+*  @param path              path of the keystore file
+*  @param n                 number of peers of each key, must match an existing file
+*  @return                  CG21_KEYSTORE_OK or an error code
+*/
+extern int CG21_KEYSTORE_OPEN(CG21_KEYSTORE *ks, const char *path, int n);
+
+/**	@brief Close a keystore
+*
+*  @param ks                keystore
+*  @return                  CG21_KEYSTORE_OK or CG21_KEYSTORE_IO_ERROR
+*/
+extern int CG21_KEYSTORE_CLOSE(CG21_KEYSTORE *ks);
+
+/**	@brief Encrypt a key share and append it to the keystore
+*
+*  @param RNG               is a pointer to a cryptographically secure random number generator
+*  @param ks                keystore
+*  @param K                 AES-256 key, CG21_KEYSTORE_KEY_SIZE bytes
+*  @param key               key share
+*  @param peers             public keys of the ks->n peers
+*  @param index             index of the record on exit, can be NULL
+*  @return                  CG21_KEYSTORE_OK or an error code
+*/
+extern int CG21_KEYSTORE_APPEND(csprng *RNG, CG21_KEYSTORE *ks, const octet *K, const CG21_KEYSTORE_KEY *key,
+                                const CG21_KEYSTORE_PEER *peers, int *index);
+
+/**	@brief Load and decrypt a key share
+*
+*  On failure key is wiped
+*
+*  @param ks                keystore
+*  @param K                 AES-256 key, CG21_KEYSTORE_KEY_SIZE bytes
+*  @param index             index of the record
+*  @param key               key share on exit
+*  @param peers             public keys of the ks->n peers on exit
+*  @return                  CG21_KEYSTORE_OK or an error code
+*/
+extern int CG21_KEYSTORE_LOAD(CG21_KEYSTORE *ks, const octet *K, int index, CG21_KEYSTORE_KEY *key,
+                              CG21_KEYSTORE_PEER *peers);
+
+/**	@brief Wipe the secrets of a key share
+*
+*  @param key               key share
+*/
+extern void CG21_KEYSTORE_KEY_KILL(CG21_KEYSTORE_KEY *key);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
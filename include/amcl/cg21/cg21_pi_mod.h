@@ -46,17 +46,39 @@ typedef struct
 
 #define iLEN 32
 
+#define CG21_PI_MOD_BATCH_BITS      32      /**< Bit length of the random exponents used in batch verification */
+#define CG21_PI_MOD_BATCH_ROUNDS    6       /**< Number of independent batch checks of zi^N = yi */
+#define CG21_PI_MOD_BATCH_SIEVE     4096    /**< N is trial divided by the primes below this bound before batching */
+#define CG21_PI_MOD_CHUNK           16      /**< Iterations of a chunk given to CG21_PI_MOD_VERIFY_STREAM_UPDATE */
+
+/** @brief State of a PiMod verification fed with chunks of iterations */
+typedef struct
+{
+    hash256 sha;                                    /**< Hash of the common values of the challenges */
+    BIG_512_60 n_[FFLEN_4096];                      /**< N, padded for products */
+    BIG_1024_58 n_2048[FFLEN_2048];                 /**< N */
+    BIG_512_60 w[HFLEN_4096];                       /**< w of the proof */
+    bool ab[CG21_PAILLIER_PROOF_ITERS][2];          /**< (ai,bi) of the proof */
+    int recover_ab;                                 /**< 1 if (ai,bi) are recovered from xi */
+    int next;                                       /**< Index of the next iteration */
+} CG21_PI_MOD_STREAM;
+
 /**	@brief Generate proof that N is a Paillier-Blum modulus
 *
 *  1: choose random w ← ZN of Jacobi symbol −1
 *  2: generate (ai,bi,xi)
 *  3: generate zi
 *
+*  (ai,bi) are encoded as a bitmap of CG21_PAILLIER_PROOF_AB_SIZE bytes.
+*  They are determined by xi and yi, so the sender may empty paillierProof->ab
+*  to save bandwidth, and the verifier recovers them.
+*
 *  @param RNG               is a pointer to a cryptographically secure random number generator
 *  @param paillierKeys
 *  @param ssid              system-wide session-ID, refers to the same notation as in CG21
-*  @param paillierProof     generated proof
+*  @param paillierProof     generated proof, ab must hold CG21_PAILLIER_PROOF_AB_SIZE bytes
 *  @param n                 size of packed elements in SSID
+*  @return                  CG21_OK, CG21_UTILITIES_WRONG_PACKED_SIZE if ab is too short, or an error code
 */
 extern int CG21_PI_MOD_PROVE(csprng *RNG, CG21_PAILLIER_KEYS paillierKeys, const CG21_SSID *ssid,
                              CG21_PIMOD_PROOF_OCT *paillierProof, int n);
@@ -67,10 +89,69 @@ extern int CG21_PI_MOD_PROVE(csprng *RNG, CG21_PAILLIER_KEYS paillierKeys, const
 *  2: generate yi and validate zi
 *  3: validate (xi,a,b)
 *
+*  All the iterations are checked in one parallel loop, each iteration decoding
+*  its xi and zi and deriving its yi, so the proof is never decoded in full.
+*
+*  paillierProof->ab is a bitmap of CG21_PAILLIER_PROOF_AB_SIZE bytes, the legacy
+*  string of 2*CG21_PAILLIER_PROOF_ITERS '0'/'1' characters, or empty, in which
+*  case each (ai,bi) is the one for which xi^4 = (-1)^ai w^bi yi, if any.
+*
 *  @param paillierProof     generated proof
 *  @param ssid              system-wide session-ID, refers to the same notation as in CG21
 *  @param pk                Paillier public key
 *  @param n                 size of packed elements in SSID
 */
 extern int CG21_PI_MOD_VERIFY(CG21_PIMOD_PROOF_OCT *paillierProof, const CG21_SSID *ssid,
-                              PAILLIER_public_key pk, int n);
\ No newline at end of file
+                              PAILLIER_public_key pk, int n);
+
+/**	@brief Validate proofs that N is a Paillier-Blum modulus, batching the zi checks
+*
+*  Same as CG21_PI_MOD_VERIFY, but the m checks zi^N = yi are replaced by
+*  CG21_PI_MOD_BATCH_ROUNDS checks (prod_i zi^ei)^N = prod_i yi^ei for random
+*  ei of CG21_PI_MOD_BATCH_BITS bits. If N has a factor below CG21_PI_MOD_BATCH_SIEVE
+*  or a batch check fails, the zi are checked one by one.
+*
+*  @param RNG               is a pointer to a cryptographically secure random number generator
+*  @param paillierProof     generated proof
+*  @param ssid              system-wide session-ID, refers to the same notation as in CG21
+*  @param pk                Paillier public key
+*  @param n                 size of packed elements in SSID
+*/
+extern int CG21_PI_MOD_VERIFY_BATCH(csprng *RNG, CG21_PIMOD_PROOF_OCT *paillierProof, const CG21_SSID *ssid,
+                                    PAILLIER_public_key pk, int n);
+
+/**	@brief Start the verification of a proof received in chunks of iterations
+*
+*  Check N is an odd composite number and bind the challenges to w. Only
+*  O(CG21_PI_MOD_CHUNK) values are decoded at once, so the proof does not
+*  need to be received in full before it is checked.
+*
+*  @param S                 verification state on exit
+*  @param W                 w of the proof
+*  @param AB                (ai,bi) of the proof, as in CG21_PI_MOD_VERIFY
+*  @param ssid              system-wide session-ID, refers to the same notation as in CG21
+*  @param pk                Paillier public key
+*  @param n                 size of packed elements in SSID
+*  @return                  CG21_OK or an error code
+*/
+extern int CG21_PI_MOD_VERIFY_STREAM_INIT(CG21_PI_MOD_STREAM *S, const octet *W, const octet *AB, const CG21_SSID *ssid,
+                                          PAILLIER_public_key pk, int n);
+
+/**	@brief Verify the next chunk of iterations
+*
+*  X and Z hold the same number of consecutive xi and zi, FS_2048 bytes each,
+*  starting from the first iteration not yet verified.
+*
+*  @param S                 verification state
+*  @param X                 chunk of the xi
+*  @param Z                 chunk of the zi
+*  @return                  CG21_OK, CG21_PAILLIER_PROVE_FAIL or CG21_PAILLIER_PROOF_INVALID
+*/
+extern int CG21_PI_MOD_VERIFY_STREAM_UPDATE(CG21_PI_MOD_STREAM *S, const octet *X, const octet *Z);
+
+/**	@brief Finish the verification of a proof received in chunks
+*
+*  @param S                 verification state
+*  @return                  CG21_OK if all the iterations are verified, CG21_PAILLIER_PROOF_INVALID otherwise
+*/
+extern int CG21_PI_MOD_VERIFY_STREAM_FINAL(const CG21_PI_MOD_STREAM *S);
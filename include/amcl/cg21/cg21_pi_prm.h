@@ -48,6 +48,23 @@ typedef struct
     octet *it;
 } CG21_PIPRM_PROOF_OCT;
 
+#define CG21_PI_PRM_CHUNK       16      /**< Iterations checked at once by CG21_PI_PRM_VERIFY */
+
+/** @brief State of a PiPrm verification fed with chunks of iterations */
+typedef struct
+{
+    PEDERSEN_PUB *pub;              /**< Ring-Pedersen public parameters */
+    hash256 sha;                    /**< Challenge of the h1 DLOG ZKP */
+    hash256 isha;                   /**< Challenge of the h0 DLOG ZKP */
+    int committed;                  /**< Number of iterations of the commitments in the challenges */
+    hash256 crho;                   /**< Hash of the chunks of rho given to the challenges */
+    hash256 cirho;                  /**< Hash of the chunks of irho given to the challenges */
+    hash256 urho;                   /**< Hash of the chunks of rho verified */
+    hash256 uirho;                  /**< Hash of the chunks of irho verified */
+    HDLOG_verify_state v;           /**< Verification of the h1 DLOG ZKP */
+    HDLOG_verify_state iv;          /**< Verification of the h0 DLOG ZKP */
+} CG21_PI_PRM_STREAM;
+
 /**	@brief Generate ZKP for Ring-Pedersen Parameters
 *
 *  @param RNG       is a pointer to a cryptographically secure random number generator
@@ -60,9 +77,57 @@ extern int CG21_PI_PRM_PROVE(csprng *RNG, PEDERSEN_PRIV *priv, const CG21_SSID *
 
 /**	@brief Verify ZKP for Ring-Pedersen Parameters
 *
+*  The iterations are checked CG21_PI_PRM_CHUNK at a time with CG21_PI_PRM_STREAM.
+*
 *  @param pub       Ring-Pedersen public parameters
 *  @param ssid      system-wide session-ID, refers to the same notation as in CG21
 *  @param proofOct  ZKP in octet form
 *  @param n         number of the players
 */
-extern int CG21_PI_PRM_VERIFY(PEDERSEN_PUB *pub, const CG21_SSID *ssid, CG21_PIPRM_PROOF_OCT *proofOct, int n);
\ No newline at end of file
+extern int CG21_PI_PRM_VERIFY(PEDERSEN_PUB *pub, const CG21_SSID *ssid, CG21_PIPRM_PROOF_OCT *proofOct, int n);
+
+/**	@brief Start the verification of a ZKP received in chunks of iterations
+*
+*  The challenges hash all the commitments, so the chunks of rho and irho are
+*  first given to CG21_PI_PRM_VERIFY_STREAM_COMMIT, then the chunks of the
+*  proofs to CG21_PI_PRM_VERIFY_STREAM_UPDATE with the same commitments. Only
+*  O(CG21_PI_PRM_CHUNK) values are decoded at once. The commitments given to
+*  both are hashed, and CG21_PI_PRM_VERIFY_STREAM_FINAL rejects the proof if
+*  they differ.
+*
+*  @param S         verification state on exit
+*  @param pub       Ring-Pedersen public parameters, used until the end of the verification
+*  @param ssid      system-wide session-ID, refers to the same notation as in CG21
+*  @param n         number of the players
+*  @return          CG21_OK or an error code
+*/
+extern int CG21_PI_PRM_VERIFY_STREAM_INIT(CG21_PI_PRM_STREAM *S, PEDERSEN_PUB *pub, const CG21_SSID *ssid, int n);
+
+/**	@brief Add the next chunk of the commitments to the challenges
+*
+*  @param S         verification state
+*  @param rho       chunk of the commitment for the h1 DLOG ZKP, FS_2048 bytes per iteration
+*  @param irho      chunk of the commitment for the h0 DLOG ZKP, same length as rho
+*  @return          CG21_OK or CG21_PI_PRM_INVALID_FORMAT
+*/
+extern int CG21_PI_PRM_VERIFY_STREAM_COMMIT(CG21_PI_PRM_STREAM *S, const octet *rho, const octet *irho);
+
+/**	@brief Verify the next chunk of iterations, once all the commitments are added
+*
+*  @param S         verification state
+*  @param rho       chunk of the commitment for the h1 DLOG ZKP
+*  @param irho      chunk of the commitment for the h0 DLOG ZKP
+*  @param t         chunk of the proof for the h1 DLOG ZKP
+*  @param it        chunk of the proof for the h0 DLOG ZKP
+*  @return          CG21_OK, CG21_PI_PRM_INVALID_PROOF or CG21_PI_PRM_INVALID_FORMAT
+*/
+extern int CG21_PI_PRM_VERIFY_STREAM_UPDATE(CG21_PI_PRM_STREAM *S, const octet *rho, const octet *irho,
+                                            const octet *t, const octet *it);
+
+/**	@brief Finish the verification of a ZKP received in chunks
+*
+*  @param S         verification state
+*  @return          CG21_OK if all the iterations are verified with the commitments of the challenges,
+*                   CG21_PI_PRM_INVALID_PROOF if the commitments differ, CG21_PI_PRM_INVALID_FORMAT otherwise
+*/
+extern int CG21_PI_PRM_VERIFY_STREAM_FINAL(const CG21_PI_PRM_STREAM *S);
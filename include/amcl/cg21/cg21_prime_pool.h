@@ -0,0 +1,115 @@
+/*
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"); you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+*/
+
+/**
+ * @file cg21_prime_pool.h
+ * @brief Persistent pool of pre-generated safe primes
+ *
+ * Safe primes are generated ahead of time, e.g. by a background thread during
+ * idle time, and stored in a local file encrypted with AES-256-GCM. Each
+ * prime is burned in the file before it is returned, so it is used only once.
+ *
+ * File layout: an 8 bytes header followed by fixed size records
+ *      status (1) | IV (12) | encrypted P (HFS_2048) | tag (16)
+ * The record index is authenticated as header data, so records can not be
+ * swapped. Each call holds a POSIX record lock on the file while it uses it,
+ * so FILL and TAKE can run in different processes. The lock is per process,
+ * calls from threads of the same process must be serialised by the caller.
+ */
+
+#ifndef CG21_PRIME_POOL_H
+#define CG21_PRIME_POOL_H
+
+#include "amcl/amcl.h"
+#include "amcl/paillier.h"
+#include "cg21_utilities.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define CG21_PRIME_POOL_OK                  0           /**< Success */
+#define CG21_PRIME_POOL_IO_ERROR            3130901     /**< The pool file can not be read or written */
+#define CG21_PRIME_POOL_INVALID_FILE        3130902     /**< The pool file has an invalid header or size */
+#define CG21_PRIME_POOL_INVALID_KEY         3130903     /**< The pool key has an invalid length */
+#define CG21_PRIME_POOL_EMPTY               3130904     /**< There are not enough unused primes in the pool */
+#define CG21_PRIME_POOL_INVALID_RECORD      3130905     /**< A record failed authentication */
+#define CG21_PRIME_POOL_INVALID_OUTPUT      3130906     /**< The output octet is too small for a prime */
+
+#define CG21_PRIME_POOL_KEY_SIZE    32                  /**< AES-256 key length in bytes */
+#define CG21_PRIME_POOL_IV_SIZE     12                  /**< GCM IV length in bytes */
+#define CG21_PRIME_POOL_TAG_SIZE    16                  /**< GCM tag length in bytes */
+#define CG21_PRIME_POOL_HEADER_SIZE 8                   /**< Length of the file header in bytes */
+#define CG21_PRIME_POOL_RECORD_SIZE (1 + CG21_PRIME_POOL_IV_SIZE + HFS_2048 + CG21_PRIME_POOL_TAG_SIZE) /**< Length of a record in bytes */
+
+/**	@brief Generate safe primes and append them to the pool
+*
+*  The primes are generated with safe_prime_gen_parallel. The file is
+*  created if it does not exist and flushed after each prime, so the
+*  generation can be interrupted at any time
+*
+*  @param RNG               is a pointer to a cryptographically secure random number generator
+*  @param path              path of the pool file
+*  @param K                 AES-256 key, CG21_PRIME_POOL_KEY_SIZE bytes
+*  @param count             number of safe primes to generate
+*  @return                  CG21_PRIME_POOL_OK or an error code
+*/
+extern int CG21_PRIME_POOL_FILL(csprng *RNG, const char *path, const octet *K, int count);
+
+/**	@brief Count the unused primes in the pool
+*
+*  @param path              path of the pool file
+*  @param available         number of unused primes
+*  @return                  CG21_PRIME_POOL_OK or an error code
+*/
+extern int CG21_PRIME_POOL_AVAILABLE(const char *path, int *available);
+
+/**	@brief Take the next unused safe prime from the pool
+*
+*  The record is marked as used and its ciphertext wiped before
+*  decryption, so a prime is never returned twice
+*
+*  @param path              path of the pool file
+*  @param K                 AES-256 key, CG21_PRIME_POOL_KEY_SIZE bytes
+*  @param P                 safe prime P = 2p+1, at least HFS_2048 bytes long
+*  @return                  CG21_PRIME_POOL_OK or an error code
+*/
+extern int CG21_PRIME_POOL_TAKE(const char *path, const octet *K, octet *P);
+
+/**	@brief Generate Paillier and Pedersen keys for aux-info from pooled safe primes
+*
+*  Takes two primes from the pool, both or none, and uses them for both Paillier and Pedersen
+*  parameters, as PAILLIER_KEY_PAIR and ring_Pedersen_setup do in aux-info
+*
+*  @param RNG               is a pointer to a cryptographically secure random number generator
+*  @param path              path of the pool file
+*  @param K                 AES-256 key, CG21_PRIME_POOL_KEY_SIZE bytes
+*  @param paillier          generated Paillier keys
+*  @param pedersen          generated Pedersen parameters
+*  @return                  CG21_PRIME_POOL_OK or an error code
+*/
+extern int CG21_PRIME_POOL_AUX_KEYS(csprng *RNG, const char *path, const octet *K,
+                                    CG21_PAILLIER_KEYS *paillier, CG21_PEDERSEN_KEYS *pedersen);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
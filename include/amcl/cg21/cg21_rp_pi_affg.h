@@ -40,6 +40,7 @@ extern "C"
 #define Piaffg_BX_OK            3130407
 #define Piaffg_BX_FAIL          3130408
 #define PiAffg_RNG_IS_NULL      3130409
+#define Piaffg_INVALID_PRECOMMIT 3130410           /**< The precommitments were computed for other keys, or already used */
 
 
 typedef struct
@@ -76,6 +77,22 @@ typedef struct
     BIG_1024_58 wy[FFLEN_2048];
 } Piaffg_PROOFS;
 
+/** \brief Input independent part of the commitment
+ *
+ *  Computed ahead of time for a (prover key, verifier key) pair,
+ *  it must be used for a single proof
+ */
+typedef struct
+{
+    Piaffg_SECRETS secrets;                 /**< Prover's secret randoms */
+    BIG_512_60 A[FFLEN_4096];               /**< (1+N0)^beta r^N0 mod N0^2, C^alpha is added online */
+    ECP_SECP256K1  Bx;                      /**< alpha*G */
+    BIG_1024_58 By[2 * FFLEN_2048];         /**< (1+N1)^beta ry^N1 mod N1^2 */
+    BIG_1024_58 E[FFLEN_2048];              /**< s^alpha t^gamma mod Nt */
+    BIG_1024_58 F[FFLEN_2048];              /**< s^beta t^delta mod Nt */
+    char key_id[SHA256];                    /**< Hash of the verifier's Paillier and Pedersen public keys */
+} Piaffg_PRECOMMITS;
+
 typedef struct
 {
     octet *A;
@@ -137,6 +154,51 @@ typedef struct
 extern int Piaffg_Sample_and_Commit(csprng *RNG, PAILLIER_private_key *paillier_priv, PAILLIER_public_key *paillier_pub,
                                      PEDERSEN_PUB *pedersen_pub, octet *x, octet *y, Piaffg_SECRETS *secrets,
                                      Piaffg_COMMITS *commit, Piaffg_COMMITS_OCT *commitsOct, octet *C);
+
+/** \brief Offline part of the commitment generation
+ *
+ *  Sample all the secret randoms and compute the commitments that do not
+ *  depend on x, y and C: E, F, Bx, By and (1+N0)^{\beta}r^{N0}. This can run
+ *  ahead of time, as soon as the keys of the prover and the verifier are known.
+ *
+ *  @param RNG              csprng for random generation
+ *  @param paillier_priv    Provers's Paillier private key
+ *  @param paillier_pub     Verifier's Paillier public key
+ *  @param pedersen_pub     Verifier's Ring Pederesen public parameters (Nt,s,t)
+ *  @param pre              Destination precommitments
+ *  @return                 Piaffg_OK or an error code
+ */
+extern int Piaffg_Precommit(csprng *RNG, PAILLIER_private_key *paillier_priv, PAILLIER_public_key *paillier_pub,
+                            PEDERSEN_PUB *pedersen_pub, Piaffg_PRECOMMITS *pre);
+
+/** \brief Online part of the commitment generation
+ *
+ *  Compute S, T and multiply C^{\alpha} into A. The output is the same as
+ *  Piaffg_Sample_and_Commit. The precommitments are consumed and cleared.
+ *  The keys must be the ones given to Piaffg_Precommit, this is checked against
+ *  a hash of the keys stored in the precommitments.
+ *
+ *  @param paillier_pub     Verifier's Paillier public key, as given to Piaffg_Precommit
+ *  @param pedersen_pub     Verifier's Ring Pederesen public parameters, as given to Piaffg_Precommit
+ *  @param x                Message to prove its ranges
+ *  @param y                Message to prove its ranges
+ *  @param C                Ciphertext given to the prover from the verifier
+ *  @param pre              Precommitments generated by Piaffg_Precommit
+ *  @param secrets          Prover's secret randoms
+ *  @param commit           Prover's commitments to his secret randoms
+ *  @param commitsOct       Prover's commitments in Octet form
+ *  @return                 Piaffg_OK, or Piaffg_INVALID_PRECOMMIT if pre was computed
+ *                          for other keys or already used
+ */
+extern int Piaffg_Commit_online(PAILLIER_public_key *paillier_pub, PEDERSEN_PUB *pedersen_pub, octet *x, octet *y,
+                                octet *C, Piaffg_PRECOMMITS *pre, Piaffg_SECRETS *secrets,
+                                Piaffg_COMMITS *commit, Piaffg_COMMITS_OCT *commitsOct);
+
+/** \brief Clean the memory containing unused precommitments
+ *
+ *  @param pre         Precommitments to clean
+ */
+extern void Piaffg_Kill_precommits(Piaffg_PRECOMMITS *pre);
 /** \brief Dump the commitment to octets
  *
  *  @param commitsOct  Destination Octet for the commitment
@@ -109,6 +109,32 @@ typedef struct
 extern void PiEnc_Challenge_gen(PAILLIER_public_key *pub_key, PEDERSEN_PUB *pub_com, const octet *K,
                                 PiEnc_COMMITS *secrets, CG21_SSID *ssid, octet *E);
 
+/** \brief Deterministic RP Challenge generation for a multi-verifier proof
+ *
+ *  Generate a single challenge binding, for each verifier in order, its index,
+ *  its Pedersen parameters and its commitments S, A and C
+ *
+ *  <ol>
+ *  <li> \f$ e = H( N0 | K | n | \{ j | \tilde{N}_j | s_j | t_j | S_j | A_j | C_j \}_{j<n} | SSID ) \f$
+ *  </ol>
+ *
+ *  All the verifiers compute the same challenge, so each of them needs the
+ *  commitments sent to the others. A_j is the same for all the honest verifiers,
+ *  it is hashed for each of them so that the copy checked by PiEnc_Verify is the
+ *  one bound to the challenge. A per-verifier challenge is not an option,
+ *  since two responses z1 = alpha + e k with the same alpha and different e reveal k.
+ *
+ *  @param pub_key    Public Paillier key of the prover
+ *  @param pub_com    Public BC modulus of the n verifiers
+ *  @param n          Number of verifiers
+ *  @param K          Encrypted Message to PiEnc_Prove knowledge and range
+ *  @param commits    Commitments of the prover, one per verifier
+ *  @param ssid       system-wide session-ID, refers to the same notation as in CG21
+ *  @param E          Destination challenge
+ */
+extern void PiEnc_Challenge_gen_multi(PAILLIER_public_key *pub_key, PEDERSEN_PUB *pub_com[], int n,
+                                      const octet *K, PiEnc_COMMITS *commits, CG21_SSID *ssid, octet *E);
+
 /** \brief Commitment Generation
  *
  *  Generate a commitment for the ZKP
@@ -136,6 +162,27 @@ extern void PiEnc_Challenge_gen(PAILLIER_public_key *pub_key, PEDERSEN_PUB *pub_
 extern int PiEnc_Sample_randoms_and_commit(csprng *RNG, PAILLIER_private_key *priv_key, PEDERSEN_PUB *pub_com, octet *k,
                                            PiEnc_SECRETS *secrets, PiEnc_COMMITS *commits, PiEnc_COMMITS_OCT *commitsOct);
 
+/** \brief Commitment Generation for n verifiers
+ *
+ *  Same as PiEnc_Sample_randoms_and_commit, but alpha, r and the Paillier
+ *  commitment A do not depend on the verifier and are computed only once.
+ *  Only gamma, mu, S and C are computed for each verifier. The challenge must be
+ *  generated with PiEnc_Challenge_gen_multi, then PiEnc_Prove is run with
+ *  secrets[j] to obtain the proof for verifier j, which verifies with PiEnc_Verify.
+ *
+ *  @param RNG            csprng for random generation
+ *  @param priv_key       Paillier priv_key used to encrypt X
+ *  @param pub_com        Public BC modulus of the n verifiers
+ *  @param n              Number of verifiers
+ *  @param k              Value to prove its range
+ *  @param secrets        Random values (alpha, mu, r, gamma), one per verifier
+ *  @param commits        Destination commitment (S, A, C), one per verifier
+ *  @param commitsOct     Destination commitments in Octet form, one per verifier
+ */
+extern int PiEnc_Sample_randoms_and_commit_multi(csprng *RNG, PAILLIER_private_key *priv_key, PEDERSEN_PUB *pub_com[], int n,
+                                                 octet *k, PiEnc_SECRETS *secrets, PiEnc_COMMITS *commits,
+                                                 PiEnc_COMMITS_OCT *commitsOct);
+
 /** \brief Verify a Proof
  *
  *  <ol>
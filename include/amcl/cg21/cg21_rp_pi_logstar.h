@@ -120,6 +120,33 @@ extern void PiLogstar_Challenge_gen(PAILLIER_public_key *pub_key, PEDERSEN_PUB *
                                     const octet *C, PiLogstar_COMMITS *commits, CG21_SSID *ssid,
                                     const octet *X, octet *E);
 
+/** \brief Deterministic RP Challenge generation for a multi-verifier proof
+ *
+ *  Generate a single challenge binding, for each verifier in order, its index,
+ *  its Pedersen parameters and its commitments S, A, Y and D
+ *
+ *  <ol>
+ *  <li> \f$ e = H( N0 | C | X | n | \{ j | \tilde{N}_j | s_j | t_j | S_j | A_j | Y_j | D_j \}_{j<n} | SSID ) \f$
+ *  </ol>
+ *
+ *  Each verifier needs the commitments sent to the others to recompute the challenge.
+ *  A_j and Y_j are the same for all the honest verifiers, they are hashed for each
+ *  of them so that the copies checked by PiLogstar_Verify are bound to the challenge.
+ *  The challenge is shared since alpha and r are shared, see PiEnc_Challenge_gen_multi.
+ *
+ *  @param pub_key    Public Paillier key of the prover
+ *  @param pub_com    Public BC modulus of the n verifiers
+ *  @param n          Number of verifiers
+ *  @param C          Encrypted Message to PiLogstar_Prove knowledge and range
+ *  @param commits    Commitments of the prover, one per verifier
+ *  @param ssid       system-wide session-ID, refers to the same notation as in CG21
+ *  @param X          xG, where G is a group generator
+ *  @param E          Destination challenge
+ */
+extern void PiLogstar_Challenge_gen_multi(PAILLIER_public_key *pub_key, PEDERSEN_PUB *pub_com[], int n,
+                                          const octet *C, PiLogstar_COMMITS *commits, CG21_SSID *ssid,
+                                          const octet *X, octet *E);
+
 /** \brief Commitment Generation
  *
  *  Generate a commitment for the ZKP
@@ -151,6 +178,28 @@ extern int PiLogstar_Sample_and_commit(csprng *RNG, PAILLIER_private_key *priv_k
                                        octet *x, octet *g, PiLogstar_SECRETS *secrets,
                                        PiLogstar_COMMITS *commits, PiLogstar_COMMITS_OCT *commitsOct);
 
+/** \brief Commitment Generation for n verifiers
+ *
+ *  Same as PiLogstar_Sample_and_commit, but alpha, r and the commitments A and Y
+ *  do not depend on the verifier and are computed only once. Only gamma, mu, S and D
+ *  are computed for each verifier. The challenge must be generated with
+ *  PiLogstar_Challenge_gen_multi, then PiLogstar_Prove is run with secrets[j] to
+ *  obtain the proof for verifier j, which verifies with PiLogstar_Verify.
+ *
+ *  @param RNG            csprng for random generation
+ *  @param priv_key       Paillier priv_key used to encrypt X
+ *  @param pub_com        Public BC modulus of the n verifiers
+ *  @param n              Number of verifiers
+ *  @param x              Value to prove its range
+ *  @param g              A curve point
+ *  @param secrets        Random values (alpha, mu, r, gamma), one per verifier
+ *  @param commits        Destination commitment (S, A, D, Y), one per verifier
+ *  @param commitsOct     Destination commitments in Octet form, one per verifier
+ */
+extern int PiLogstar_Sample_and_commit_multi(csprng *RNG, PAILLIER_private_key *priv_key, PEDERSEN_PUB *pub_com[], int n,
+                                             octet *x, octet *g, PiLogstar_SECRETS *secrets,
+                                             PiLogstar_COMMITS *commits, PiLogstar_COMMITS_OCT *commitsOct);
+
 /** \brief Verify a Proof
  *
  *  <ol>
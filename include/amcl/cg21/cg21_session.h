@@ -0,0 +1,230 @@
+/*
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"); you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+*/
+
+/**
+ * @file cg21_session.h
+ * @brief Round-driven session of one player in a phase of CG21
+ *
+ * A phase is described by CG21_SESSION_PHASE: how to compute my message of a
+ * round, how to process the message of a peer in a round and how to finish.
+ * The session accepts the messages of the peers in any order. A message of the
+ * current round is processed as soon as it arrives, with the first/middle/last
+ * status the round functions of CG21 expect. Messages of later rounds are queued.
+ * Once all the messages of a round are processed, my message of the next round
+ * is written to the outbox, to be sent by the caller. An error of the phase
+ * aborts the session, and every later call fails.
+ *
+ * A session keeps no global state and allocates no memory, so any number of
+ * sessions can run in one process. A session must not be used by two threads
+ * at the same time.
+ */
+
+#ifndef CG21_SESSION_H
+#define CG21_SESSION_H
+
+#include "amcl/amcl.h"
+#include "cg21.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define CG21_SESSION_OK                     0           /**< Success */
+#define CG21_SESSION_UNKNOWN_PEER           3131101     /**< The sender is not a peer of the session */
+#define CG21_SESSION_INVALID_ROUND          3131102     /**< The round of the message is not a round of the phase */
+#define CG21_SESSION_DUPLICATE_MESSAGE      3131103     /**< A message of this round was already received from the sender */
+#define CG21_SESSION_QUEUE_FULL             3131104     /**< There is no free slot to queue a message of a later round */
+#define CG21_SESSION_FINISHED               3131105     /**< The session is already finished */
+#define CG21_SESSION_ALREADY_STARTED        3131106     /**< The session is already started */
+#define CG21_SESSION_ABORTED                3131107     /**< The session was aborted by an error of the phase */
+
+#define CG21_SESSION_MAX_ROUNDS     16                  /**< Maximum number of rounds of a phase */
+
+/** @brief Message of a player in a round */
+typedef struct
+{
+    int round;      // round of the message, from 1, or 0 for a free queue slot
+    int from;       // id of the sender
+    octet *body;    // payload
+
+} CG21_SESSION_MSG;
+
+/** @brief Rounds of a phase */
+typedef struct
+{
+    int rounds;     // number of rounds, at most CG21_SESSION_MAX_ROUNDS
+
+    /* compute my message of a round, once the previous round is processed */
+    int (*start)(void *state, int round, octet *out);
+
+    /* process the message of a peer, with status 0 first, 1 middle, 2 last or 3 first and last */
+    int (*process)(void *state, int round, int from, octet *in, int status);
+
+    /* conclude the phase, once the last round is processed */
+    int (*finish)(void *state);
+
+} CG21_SESSION_PHASE;
+
+/** @brief Session of one player */
+typedef struct
+{
+    const CG21_SESSION_PHASE *phase;
+    void *state;                // state of the phase, passed to its functions
+    const int *peers;           // ids of the other players
+    int *seen;                  // for each peer, bit r-1 is set once its message of round r is processed
+    int n;                      // number of other players
+    int round;                  // current round, 0 before start and rounds + 1 once finished
+    int processed;              // messages processed in the current round
+    int aborted;                // set once the phase returns an error
+    CG21_SESSION_MSG *queue;    // slots for messages of later rounds
+    int queue_max;              // number of slots
+    octet **outbox;             // my message of each round
+
+} CG21_SESSION;
+
+/**	@brief Map the position of a call to the status of the round functions of CG21
+*
+*  @param processed         number of peers already processed in the round
+*  @param n                 number of peers in the round
+*  @return                  0 first call, 1 middle call, 2 last call, 3 first and last call
+*/
+extern int CG21_SESSION_STATUS(int processed, int n);
+
+/**	@brief Initialise a session
+*
+*  @param s                 session to initialise
+*  @param phase             rounds of the phase
+*  @param state             state of the phase
+*  @param peers             ids of the other players
+*  @param seen              storage for n flags
+*  @param n                 number of other players, at least 1
+*  @param queue             slots for messages of later rounds, with body large enough for any message
+*  @param queue_max         number of slots
+*  @param outbox            one octet for my message of each round
+*/
+extern void CG21_SESSION_INIT(CG21_SESSION *s, const CG21_SESSION_PHASE *phase, void *state,
+                              const int *peers, int *seen, int n,
+                              CG21_SESSION_MSG *queue, int queue_max, octet **outbox);
+
+/**	@brief Start a session
+*
+*  Computes my message of round 1 and processes the messages queued so far.
+*  An error of the phase aborts the session
+*
+*  @param s                 session
+*  @param sent              on exit, bit r-1 is set if my message of round r is in the outbox
+*  @return                  CG21_SESSION_OK, a CG21_SESSION error or the error of the phase
+*/
+extern int CG21_SESSION_START(CG21_SESSION *s, int *sent);
+
+/**	@brief Receive the message of a peer
+*
+*  The message is processed at once if it belongs to the current round, and
+*  copied into the queue otherwise. An error of the phase aborts the session,
+*  and every later message is rejected with CG21_SESSION_ABORTED
+*
+*  @param s                 session
+*  @param msg               message of a peer
+*  @param sent              on exit, bit r-1 is set if my message of round r is in the outbox
+*  @return                  CG21_SESSION_OK, a CG21_SESSION error or the error of the phase
+*/
+extern int CG21_SESSION_PUSH(CG21_SESSION *s, const CG21_SESSION_MSG *msg, int *sent);
+
+/**	@brief Check whether a session is finished
+*
+*  @param s                 session
+*  @return                  1 once the last round is processed and the phase concluded, 0 otherwise
+*/
+extern int CG21_SESSION_DONE(const CG21_SESSION *s);
+
+/*  ------------- PRESIGN ----------------  */
+
+/** @brief State of a presign session
+*
+*  Round 1 broadcasts (G, K) with a PiEnc proof for each peer. Round 2 runs
+*  CG21_PRESIGN_ROUND2_ALL and broadcasts the outputs for all the peers in one
+*  message, each with its PiAffg, PiAffg-hat and PiLogstar proofs, and each peer
+*  keeps the section addressed to it. Round 3 broadcasts (delta, Delta) with a
+*  PiLogstar proof of Delta for each peer. The messages are encoded with cg21_wire.h,
+*  the largest one takes CG21_WIRE_PRESIGN_ROUND2_ALL_SIZE(n) bytes.
+*
+*  The proofs of a peer are verified before its message is used: PiEnc before
+*  the MtA, the round 2 proofs before D and D_hat are decrypted, and the proof
+*  of Delta before delta is accumulated. A proof that does not verify aborts the
+*  session with CG21_PRESIGN_ENC_NOT_VALID, CG21_PRESIGN_AFFG_NOT_VALID,
+*  CG21_PRESIGN_AFFG_HAT_NOT_VALID, CG21_PRESIGN_LOGSTAR_NOT_VALID or
+*  CG21_PRESIGN_LOGSTAR_DELTA_NOT_VALID.
+*
+*  Only presign and sign are provided as session phases. Keygen, aux and key
+*  reshare are run once per key and are still driven round by round by the caller.
+*/
+typedef struct
+{
+    csprng *RNG;                                // cryptographically secure random number generator
+    const CG21_RESHARE_OUTPUT *reshareOutput;   // my key share
+    CG21_RESHARE_SETTING *setting;              // holds (t2,n2) and T2
+    CG21_PAILLIER_KEYS *myKeys;                 // my Paillier keys
+    PAILLIER_public_key *hisPK;                 // Paillier PK of each peer, in the order of peers
+    CG21_PEDERSEN_KEYS *myPedersen;             // my ring-Pedersen parameters, to verify the proofs of the peers
+    PEDERSEN_PUB *hisPedersen;                  // ring-Pedersen parameters of each peer, in the order of peers
+    CG21_SSID *ssid;                            // system-wide session-ID the proofs are bound to
+    octet *hisX;                                // public key share a_j.G of each peer, in the order of peers
+    CG21_PRESIGN_ROUND1_OUTPUT *hisR1out;       // G and K of each peer kept from round 1, with FS_4096 bytes each
+    const int *peers;                           // ids of the other players, as in the session
+    int n;                                      // number of other players
+    CG21_PRESIGN_ROUND1_OUTPUT *r1out;          // data broadcast in round 1, psi is not used
+    CG21_PRESIGN_ROUND1_STORE *r1store;         // data stored in round 1
+    CG21_PRESIGN_ROUND2_OUTPUT *r2out;          // data sent to each peer in round 2, in the order of peers, psi* are not used
+    CG21_PRESIGN_ROUND2_STORE *r2store;         // data stored for each peer in round 2, in the order of peers
+    CG21_PRESIGN_ROUND3_OUTPUT *r3out;          // data broadcast in round 3, psi_douplePrime is not used
+    CG21_PRESIGN_ROUND3_STORE_1 *r3store1;      // public data stored in round 3
+    CG21_PRESIGN_ROUND3_STORE_2 *r3store2;      // private data stored in round 3
+    CG21_PRESIGN_ROUND4_STORE_1 *r4store1;      // delta and Delta checked at the end of the session
+    CG21_PRESIGN_ROUND4_STORE_2 *pre;           // presignature once the session is finished
+    CG21_PRESIGN_ROUND4_OUTPUT *r4out;          // result of presign
+
+} CG21_PRESIGN_SESSION_STATE;
+
+/** @brief Presign phase: CG21_PRESIGN_ROUND1 to CG21_PRESIGN_OUTPUT_2_2 */
+extern const CG21_SESSION_PHASE CG21_PRESIGN_PHASE;
+
+/*  ------------- SIGN ----------------  */
+
+/** @brief State of a sign session. Round 1 broadcasts sigma_i */
+typedef struct
+{
+    const octet *HM;                            // SHA256 digest of the message
+    const octet *T;                             // tweak of the child key, or NULL
+    const CG21_PRESIGN_ROUND4_STORE_2 *pre;     // generated data in presign
+    CG21_SIGN_ROUND1_STORE *store;              // data stored in round 1
+    CG21_SIGN_ROUND1_OUTPUT *r1out;             // data broadcast in round 1
+    CG21_SIGN_ROUND2_OUTPUT *out;               // signature once the session is finished
+    octet *PK;                                  // ECDSA PK to validate the signature, or NULL
+
+} CG21_SIGN_SESSION_STATE;
+
+/** @brief Sign phase: CG21_SIGN_ROUND1_TWEAKED, CG21_SIGN_ROUND2 and CG21_SIGN_VALIDATE_PREHASHED */
+extern const CG21_SESSION_PHASE CG21_SIGN_PHASE;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,136 @@
+/*
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"); you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+*/
+
+/**
+ * @file cg21_sim.h
+ * @brief In-process simulation of the n players of a CG21 phase
+ *
+ * The players run as CG21_SESSION in one process and exchange their messages
+ * over an in-memory transport. Time is virtual: a message sent at time t is
+ * delivered at t + latency + jitter, or once the receiver is idle, and each
+ * player is then busy for the CPU time it actually spends on the message.
+ * That is the CPU time of the thread running the player, so simulations run
+ * side by side do not slow each other down. Work a player spreads over worker
+ * threads is not counted, which only happens when a single simulation runs
+ * with threads enabled.
+ * The elapsed virtual time of a simulation models the latency of the phase
+ * on a network with the given latency, for any committee size.
+ *
+ * The outbox message of each round is broadcast to all the other players.
+ */
+
+#ifndef CG21_SIM_H
+#define CG21_SIM_H
+
+#include "amcl/amcl.h"
+#include "amcl/randapi.h"
+#include "cg21_session.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define CG21_SIM_OK                         0           /**< Success */
+#define CG21_SIM_TOO_MANY_EVENTS            3131201     /**< There is no free slot for a message in flight */
+#define CG21_SIM_STALLED                    3131202     /**< No message is in flight but some player is not finished */
+
+#define CG21_SIM_HIST_BUCKETS       32                  /**< Number of buckets of a latency histogram */
+
+/** @brief Histogram of latencies. Bucket b counts latencies in [2^b, 2^(b+1)) microseconds */
+typedef struct
+{
+    long long count[CG21_SIM_HIST_BUCKETS];
+    long long total;            // sum of the latencies, microseconds
+    long long max;              // largest latency, microseconds
+    long long n;                // number of latencies
+
+} CG21_SIM_HIST;
+
+/** @brief Message in flight */
+typedef struct
+{
+    long long at;               // virtual delivery time, microseconds
+    int to;                     // index of the receiver
+    CG21_SESSION_MSG msg;       // message, round 0 for a free slot
+
+} CG21_SIM_EVENT;
+
+/** @brief One simulated run of a phase */
+typedef struct
+{
+    CG21_SESSION *party;        // initialised, not started, session of each player
+    const int *ids;             // id of each player
+    int n;                      // number of players
+    long long latency;          // one-way latency of a message, microseconds
+    long long jitter;           // extra latency, uniform in [0, jitter) microseconds
+    csprng *RNG;                // source of the jitter, NULL for no jitter
+    CG21_SIM_EVENT *events;     // slots for messages in flight, with body large enough for any message
+    int max_events;             // number of slots
+    long long elapsed;          // virtual duration of the phase on exit, microseconds
+    int rc;                     // result of the run on exit
+
+} CG21_SIM;
+
+/**	@brief Run all the players of a simulation to the end of the phase
+*
+*  @param sim               simulation
+*  @return                  CG21_SIM_OK, a CG21_SIM error or the error of a player
+*/
+extern int CG21_SIM_RUN(CG21_SIM *sim);
+
+/**	@brief Run independent simulations, in parallel with PARALLEL_for
+*
+*  Simulations must not share sessions, slots or RNG
+*
+*  @param sims              simulations
+*  @param count             number of simulations
+*  @param hist              elapsed time of the successful runs is added, can be NULL
+*  @return                  CG21_SIM_OK or the error of the first failed simulation
+*/
+extern int CG21_SIM_RUN_ALL(CG21_SIM *sims, int count, CG21_SIM_HIST *hist);
+
+/**	@brief Empty a histogram
+*
+*  @param hist              histogram
+*/
+extern void CG21_SIM_HIST_INIT(CG21_SIM_HIST *hist);
+
+/**	@brief Add a latency to a histogram
+*
+*  @param hist              histogram
+*  @param us                latency, microseconds
+*/
+extern void CG21_SIM_HIST_ADD(CG21_SIM_HIST *hist, long long us);
+
+/**	@brief Latency below which a fraction of the latencies lies
+*
+*  The result is the upper bound of the bucket that holds the percentile
+*
+*  @param hist              histogram
+*  @param p                 percentile, in [0, 100]
+*  @return                  latency, microseconds
+*/
+extern long long CG21_SIM_HIST_PERCENTILE(const CG21_SIM_HIST *hist, int p);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -29,9 +29,11 @@ under the License.
 #define CG21_INVALID_ECP                    3130306
 #define CG21_PI_PRM_INVALID_PROOF           3130307     /**< The Proof of well formednes is invalid */
 #define CG21_PI_PRM_INVALID_FORMAT          3130308     /**< An octet value has an invalid format */
+#define CG21_NONCE_POOL_EMPTY               3130309     /**< All the precomputed Paillier nonces are used */
 
 #define CG21_PAILLIER_PROOF_SIZE  CG21_PAILLIER_PROOF_ITERS * FS_2048 /**< Length of components of the Proof in bytes */
 #define CG21_PAILLIER_PROOF_ITERS           128                        /**< Iterations necessary for the Proof of Paillier N */
+#define CG21_PAILLIER_PROOF_AB_SIZE  (CG21_PAILLIER_PROOF_ITERS / 4)       /**< Length of the (ai,bi) bitmap of the Proof in bytes */
 
 #include "amcl/amcl.h"
 #include "amcl/modulus.h"
@@ -97,6 +99,15 @@ typedef struct
 
 } CG21_PEDERSEN_KEYS;
 
+/*! \brief Pool of precomputed Paillier nonces r^N mod N^2 for one public key */
+typedef struct
+{
+    PAILLIER_public_key *pk;    /**< Paillier PK the nonces are computed for */
+    BIG_512_60 *rN;             /**< n blocks of FFLEN_4096 limbs, r^N mod N^2 */
+    int n;                      /**< Number of nonces */
+    int next;                   /**< Index of the next unused nonce */
+} CG21_PAILLIER_NONCE_POOL;
+
 /*
  * Find random element of order p in Z/PZ
  * Assuming P = 2p + 1 is a safe prime, i.e. phi(P) = 2p
@@ -106,9 +117,28 @@ void BC_find_generator(csprng *RNG, BIG_1024_58* x, BIG_1024_58 *P, int n);
 /*
  * Generate a safe prime P, such that P = 2 * p + 1
  * n is the size of P in BIGs
+ *
+ * Candidates are sieved with the residues of p and P modulo
+ * the small primes before running any primality test
  */
 extern void safe_prime_gen (csprng *RNG, BIG_1024_58 *p, BIG_1024_58 *P, int n);
 
+/*
+ * Same as safe_prime_gen, searching independent candidate streams on
+ * PARALLEL_get_threads() threads, each seeded from RNG. The first safe
+ * prime found is returned and the other workers are stopped.
+ * Falls back to safe_prime_gen in single-threaded builds
+ * n is the size of P in BIGs, at most HFLEN_2048
+ */
+extern void safe_prime_gen_parallel(csprng *RNG, BIG_1024_58 *p, BIG_1024_58 *P, int n);
+
+/*
+ * Return x mod s for a positive s < 2^31, using the limbs of x directly
+ * Used to sieve the safe prime candidates
+ * n is the size of x in BIGs
+ */
+extern sign32 CG21_FF_2048_residue(BIG_1024_58 *x, sign32 s, int n);
+
 /** \brief Pack Pedersen private parameters into one octet
  *
  *   @param priv    input:  Pedersen private parameters
@@ -204,6 +234,15 @@ extern void CG21_hash_pubKey2x_pubCom(hash256 *sha, PAILLIER_public_key *pub_key
  */
 extern void ring_Pedersen_setup(csprng *RNG, PEDERSEN_PRIV *m, octet *P, octet *Q);
 
+/*! \brief Same as ring_Pedersen_setup, generating P and Q with safe_prime_gen_parallel
+ *
+ * @param RNG   CSPRNG to generate P, Q, B0 and ALPHA
+ * @param m     Private modulus to populate
+ * @param P     Safe prime 2p+1. Generated if NULL
+ * @param Q     Safe prime 2q+1. Generated if NULL
+ */
+extern void ring_Pedersen_setup_parallel(csprng *RNG, PEDERSEN_PRIV *m, octet *P, octet *Q);
+
 /*! \brief Export the public part of the modulus
  *
  * @param pub   The destination public modulus
@@ -263,6 +302,20 @@ extern void CG21_FF_2048_amod(BIG_1024_58 *r, BIG_1024_58 *x, int xlen, BIG_1024
 extern void CG21_Pedersen_verify(BIG_1024_58 *proof, PEDERSEN_PRIV *st, BIG_1024_58 *z1,
                                  BIG_1024_58 *z3, BIG_1024_58 *S, BIG_1024_58 *e, BIG_1024_58 *p, bool reduce_s1);
 
+/*! \brief computes s^z1 * t^z3 * S^(-e) mod P and mod Q, with the halves run by PARALLEL_crt
+ *
+ * @param p_proof       on exit = s^z1 * t^z3 * S^(-e) mod P
+ * @param q_proof       on exit = s^z1 * t^z3 * S^(-e) mod Q
+ * @param st            Pedersen private parameters
+ * @param z1            a component of proof
+ * @param z3            a component of proof
+ * @param S             a component of commitment
+ * @param e             generated challenge
+ * @param reduce_s1     if 1, then reduce z1
+ */
+extern void CG21_Pedersen_verify_crt(BIG_1024_58 *p_proof, BIG_1024_58 *q_proof, PEDERSEN_PRIV *st, BIG_1024_58 *z1,
+                                     BIG_1024_58 *z3, BIG_1024_58 *S, BIG_1024_58 *e, bool reduce_s1);
+
 /**	@brief Initialize an array of octets
 *
 *
@@ -329,6 +382,47 @@ extern void CG21_get_G(octet *g);
 */
 extern void CG21_get_q(octet *q);
 
+/**	@brief Decrypt a batch of Paillier ciphertexts and reduce the plaintexts mod q
+*
+*  The ciphertexts are decrypted with PARALLEL_for, q is the curve order
+*
+*  @param sk      Paillier private key
+*  @param CT      ciphertexts
+*  @param OUT     plaintexts mod q on exit, EGS_SECP256K1 bytes each
+*  @param n       number of ciphertexts
+*/
+extern void CG21_PAILLIER_DECRYPT_REDUCE_Q(PAILLIER_private_key *sk, octet *CT[], octet *OUT[], int n);
+
+/**	@brief Fill a pool with n fresh Paillier nonces r^N mod N^2
+*
+*  The r are sampled in order from RNG, the exponentiations are run with PARALLEL_for
+*
+*  @param RNG     pointer to a cryptographically secure random number generator
+*  @param pool    pool to fill
+*  @param pk      Paillier PK
+*  @param mem     storage for the nonces, n * FFLEN_4096 limbs
+*  @param n       number of nonces
+*/
+extern void CG21_PAILLIER_NONCE_POOL_FILL(csprng *RNG, CG21_PAILLIER_NONCE_POOL *pool, PAILLIER_public_key *pk,
+                                          BIG_512_60 *mem, int n);
+
+/**	@brief Paillier encryption with the next nonce of a pool
+*
+*  The nonce is zeroed once used, so it is never used twice
+*
+*  @param pool    pool of nonces for the recipient PK
+*  @param PT      plaintext, at most HFS_4096 bytes
+*  @param CT      ciphertext (1+N)^PT * r^N mod N^2 on exit
+*  @return        CG21_OK or CG21_NONCE_POOL_EMPTY
+*/
+extern int CG21_PAILLIER_ENCRYPT_POOL(CG21_PAILLIER_NONCE_POOL *pool, octet *PT, octet *CT);
+
+/**	@brief Zero the unused nonces of a pool
+*
+*  @param pool    pool to clean
+*/
+extern void CG21_PAILLIER_NONCE_POOL_KILL(CG21_PAILLIER_NONCE_POOL *pool);
+
 /**	@brief Add two curve points
 *
 *  1: convert first point from octet to ECP
@@ -406,6 +500,8 @@ extern void CG21_lagrange_calc_coeff(int k, const octet *X_j, const octet *X, BI
 extern int CG21_CALC_XI(int t, const octet *i, const octet *checks, ECP_SECP256K1 *V);
 
 /**	@brief  Calculate jacobi Symbol (a/p) - not constant time
+ *
+ *  Kept for compatibility, forwards to CG21_FF_4096_jacobi
  *
 	@param a BIG number
 	@param p BIG number
@@ -413,6 +509,26 @@ extern int CG21_CALC_XI(int t, const octet *i, const octet *checks, ECP_SECP256K
  */
 extern int FF_4096_jacobi(BIG_512_60 a[HFLEN_4096], BIG_512_60 p[HFLEN_4096]);
 
+/**	@brief  Calculate jacobi Symbol (a/p) using the binary algorithm - not constant time
+ *
+ *  Only uses word-level shifts, subtractions and comparisons, no FF_4096_mod
+ *
+	@param a BIG number
+	@param p odd BIG number
+	@return Jacobi symbol, -1,0 or 1
+ */
+extern int CG21_FF_4096_jacobi(BIG_512_60 a[HFLEN_4096], BIG_512_60 p[HFLEN_4096]);
+
+/**	@brief  Calculate jacobi Symbol (a/p) using the binary algorithm - not constant time
+ *
+ *  Same as CG21_FF_4096_jacobi for half-length 2048 values, e.g. mod one of the Paillier primes
+ *
+	@param a BIG number
+	@param p odd BIG number
+	@return Jacobi symbol, -1,0 or 1
+ */
+extern int CG21_FF_2048_jacobi(BIG_1024_58 a[HFLEN_2048], BIG_1024_58 p[HFLEN_2048]);
+
 /**	@brief Tonelli–Shanks algorithm to check sqrt exist
 *
 *  @param a         non-zero value to check it has a sqrt
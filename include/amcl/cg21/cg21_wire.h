@@ -0,0 +1,406 @@
+/*
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"); you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+*/
+
+/**
+ * @file cg21_wire.h
+ * @brief Versioned, length-prefixed binary encoding of the CG21 round messages
+ *
+ * A message is encoded as
+ *      version (1) | type (1) | count (1) | count x ( length (4, big endian) | field )
+ * Integer fields are 4 bytes, big endian. Each field of a typed message must
+ * have the exact length of its encoding, e.g. FS_4096 for a Paillier
+ * ciphertext and EFS+1 for a compressed point. The ZK proof fields of the
+ * presign messages hold an encoded proof message: psi of round 1 a PiEnc proof,
+ * psi and psi_hat of round 2 a PiAffg proof, psi_prime of round 2 and
+ * psi_douplePrime of round 3 a PiLogstar proof. The proofs are not produced by
+ * the round functions, the caller encodes them with the proof encoders below.
+ * PiEnc and the PiLogstar proof of round 3 are addressed to one verifier, the
+ * _ALL messages of round 1 and 3 carry a proof for each peer.
+ *
+ * Decoding does not copy: each field is returned as an octet view into the
+ * received message, so no field needs to be allocated in advance. The views
+ * are valid as long as the received message, and must not be extended.
+ */
+
+#ifndef CG21_WIRE_H
+#define CG21_WIRE_H
+
+#include "amcl/amcl.h"
+#include "cg21.h"
+#include "cg21_rp_pi_enc.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define CG21_WIRE_OK                        0           /**< Success */
+#define CG21_WIRE_BUFFER_TOO_SMALL          3131401     /**< The output octet is too small for the message */
+#define CG21_WIRE_TRUNCATED                 3131402     /**< The message ends within a header or a field */
+#define CG21_WIRE_INVALID_VERSION           3131403     /**< The message has an unknown version */
+#define CG21_WIRE_INVALID_TYPE              3131404     /**< The message has an unexpected type */
+#define CG21_WIRE_INVALID_COUNT             3131405     /**< The message has an unexpected number of fields */
+#define CG21_WIRE_INVALID_FIELD             3131406     /**< A field does not have its expected length */
+#define CG21_WIRE_TRAILING_DATA             3131407     /**< The message has bytes after its last field */
+#define CG21_WIRE_NO_SECTION                3131408     /**< The message has no section for this player */
+
+#define CG21_WIRE_VERSION           1                   /**< Version of the encoding */
+#define CG21_WIRE_HEADER_SIZE       3                   /**< Length of the message header in bytes */
+#define CG21_WIRE_LENGTH_SIZE       4                   /**< Length of a field length in bytes */
+
+/* Message types and their number of fields */
+#define CG21_WIRE_PRESIGN_ROUND1    1                   /**< CG21_PRESIGN_ROUND1_OUTPUT */
+#define CG21_WIRE_PRESIGN_ROUND2    2                   /**< CG21_PRESIGN_ROUND2_OUTPUT */
+#define CG21_WIRE_PIAFFG_COMMITS    3                   /**< Piaffg_COMMITS_OCT */
+#define CG21_WIRE_PIAFFG_PROOFS     4                   /**< Piaffg_PROOFS_OCT */
+#define CG21_WIRE_PIMOD_PROOF       5                   /**< CG21_PIMOD_PROOF_OCT */
+#define CG21_WIRE_AUX_ROUND3        6                   /**< CG21_AUX_ROUND3 */
+#define CG21_WIRE_PRESIGN_ROUND2_ALL 7                  /**< CG21_PRESIGN_ROUND2_OUTPUT for each peer */
+#define CG21_WIRE_PRESIGN_ROUND3    8                   /**< CG21_PRESIGN_ROUND3_OUTPUT */
+#define CG21_WIRE_PIENC_PROOF       9                   /**< PiEnc_COMMITS_OCT and PiEnc_PROOFS_OCT */
+#define CG21_WIRE_PILOGSTAR_PROOF   10                  /**< PiLogstar_COMMITS_OCT and PiLogstar_PROOFS_OCT */
+#define CG21_WIRE_PIAFFG_PROOF      11                  /**< Piaffg_COMMITS_OCT and Piaffg_PROOFS_OCT */
+#define CG21_WIRE_PRESIGN_ROUND1_ALL 12                 /**< CG21_PRESIGN_ROUND1_OUTPUT with a psi for each peer */
+#define CG21_WIRE_PRESIGN_ROUND3_ALL 13                 /**< CG21_PRESIGN_ROUND3_OUTPUT with a psi_douplePrime for each peer */
+
+#define CG21_WIRE_PRESIGN_ROUND1_FIELDS     4
+#define CG21_WIRE_PRESIGN_ROUND2_FIELDS     10
+#define CG21_WIRE_PIAFFG_COMMITS_FIELDS     7
+#define CG21_WIRE_PIAFFG_PROOFS_FIELDS      6
+#define CG21_WIRE_PIMOD_PROOF_FIELDS        4
+#define CG21_WIRE_AUX_ROUND3_FIELDS         18
+#define CG21_WIRE_PRESIGN_ROUND3_FIELDS     4
+#define CG21_WIRE_PIENC_PROOF_FIELDS        6
+#define CG21_WIRE_PILOGSTAR_PROOF_FIELDS    7
+#define CG21_WIRE_PIAFFG_PROOF_FIELDS       13
+
+/* The _ALL messages of round 1 and 3 have 3 common fields, then (j, psi) for each peer */
+#define CG21_WIRE_PRESIGN_ALL_FIELDS        3
+#define CG21_WIRE_PRESIGN_SECTION_FIELDS    2
+
+#define CG21_WIRE_POINT_SIZE        (EFS_SECP256K1 + 1) /**< Length of a compressed point */
+
+/** Length of an encoded PiEnc proof */
+#define CG21_WIRE_PIENC_PROOF_SIZE  (CG21_WIRE_HEADER_SIZE + CG21_WIRE_PIENC_PROOF_FIELDS * CG21_WIRE_LENGTH_SIZE + \
+                                     3 * FS_2048 + FS_4096 + 2 * HFS_2048 + HFS_4096)
+
+/** Length of an encoded PiLogstar proof */
+#define CG21_WIRE_PILOGSTAR_PROOF_SIZE  (CG21_WIRE_HEADER_SIZE + CG21_WIRE_PILOGSTAR_PROOF_FIELDS * CG21_WIRE_LENGTH_SIZE + \
+                                         3 * FS_2048 + FS_4096 + 2 * HFS_2048 + HFS_4096 + CG21_WIRE_POINT_SIZE)
+
+/** Length of an encoded PiAffg proof */
+#define CG21_WIRE_PIAFFG_PROOF_SIZE (CG21_WIRE_HEADER_SIZE + CG21_WIRE_PIAFFG_PROOF_FIELDS * CG21_WIRE_LENGTH_SIZE + \
+                                     2 * FS_4096 + CG21_WIRE_POINT_SIZE + 10 * FS_2048 + 2 * HFS_2048)
+
+/** Length of a PRESIGN_ROUND2_ALL message for n peers, the largest message of presign */
+#define CG21_WIRE_PRESIGN_ROUND2_ALL_SIZE(n) (CG21_WIRE_HEADER_SIZE + (n) * \
+                                              (CG21_WIRE_PRESIGN_ROUND2_FIELDS * CG21_WIRE_LENGTH_SIZE + \
+                                               CG21_WIRE_POINT_SIZE + 4 * FS_4096 + 2 * CG21_WIRE_PIAFFG_PROOF_SIZE + \
+                                               CG21_WIRE_PILOGSTAR_PROOF_SIZE + 8))
+
+/**	@brief Encode fields into a message
+*
+*  @param O                 message on exit
+*  @param type              type of the message
+*  @param fields            fields of the message
+*  @param n                 number of fields, at most 255
+*  @return                  CG21_WIRE_OK or CG21_WIRE_BUFFER_TOO_SMALL
+*/
+extern int CG21_WIRE_ENCODE(octet *O, int type, octet *const *fields, int n);
+
+/**	@brief Decode the fields of a message as views into the message
+*
+*  @param I                 message
+*  @param type              expected type of the message
+*  @param views             on exit, a view of each field
+*  @param sizes             expected length of each field, or NULL to accept any length
+*  @param n                 expected number of fields
+*  @return                  CG21_WIRE_OK or an error code
+*/
+extern int CG21_WIRE_DECODE(const octet *I, int type, octet *views, const int *sizes, int n);
+
+/**	@brief Read the type of a message, to dispatch it
+*
+*  @param I                 message
+*  @param type              type of the message on exit
+*  @return                  CG21_WIRE_OK, CG21_WIRE_TRUNCATED or CG21_WIRE_INVALID_VERSION
+*/
+extern int CG21_WIRE_TYPE(const octet *I, int *type);
+
+/**	@brief Encode the output of round 1 of presign
+*
+*  @param O                 message on exit
+*  @param out               output of round 1
+*  @return                  CG21_WIRE_OK or CG21_WIRE_BUFFER_TOO_SMALL
+*/
+extern int CG21_WIRE_PRESIGN_ROUND1_toOctet(octet *O, const CG21_PRESIGN_ROUND1_OUTPUT *out);
+
+/**	@brief Decode the output of round 1 of presign
+*
+*  @param I                 message
+*  @param out               output of round 1 on exit, with fields pointing to views
+*  @param views             storage for CG21_WIRE_PRESIGN_ROUND1_FIELDS views
+*  @return                  CG21_WIRE_OK or an error code
+*/
+extern int CG21_WIRE_PRESIGN_ROUND1_fromOctet(const octet *I, CG21_PRESIGN_ROUND1_OUTPUT *out, octet *views);
+
+/**	@brief Encode the output of round 2 of presign
+*
+*  @param O                 message on exit
+*  @param out               output of round 2
+*  @return                  CG21_WIRE_OK or CG21_WIRE_BUFFER_TOO_SMALL
+*/
+extern int CG21_WIRE_PRESIGN_ROUND2_toOctet(octet *O, const CG21_PRESIGN_ROUND2_OUTPUT *out);
+
+/**	@brief Decode the output of round 2 of presign
+*
+*  @param I                 message
+*  @param out               output of round 2 on exit, with fields pointing to views
+*  @param views             storage for CG21_WIRE_PRESIGN_ROUND2_FIELDS views
+*  @return                  CG21_WIRE_OK or an error code
+*/
+extern int CG21_WIRE_PRESIGN_ROUND2_fromOctet(const octet *I, CG21_PRESIGN_ROUND2_OUTPUT *out, octet *views);
+
+/**	@brief Encode the outputs of round 2 of presign for all the peers in one message
+*
+*  The message has CG21_WIRE_PRESIGN_ROUND2_FIELDS fields for each peer, so it can
+*  be broadcast and each peer keeps the section addressed to it
+*
+*  @param O                 message on exit
+*  @param out               output of round 2 for each peer
+*  @param n                 number of peers, at most 255 / CG21_WIRE_PRESIGN_ROUND2_FIELDS
+*  @return                  CG21_WIRE_OK, CG21_WIRE_INVALID_COUNT or CG21_WIRE_BUFFER_TOO_SMALL
+*/
+extern int CG21_WIRE_PRESIGN_ROUND2_ALL_toOctet(octet *O, const CG21_PRESIGN_ROUND2_OUTPUT *out, int n);
+
+/**	@brief Decode the output of round 2 of presign addressed to a player
+*
+*  @param I                 message
+*  @param j                 id of the player
+*  @param n                 number of peers in the message
+*  @param out               output of round 2 for j on exit, with fields pointing to views
+*  @param views             storage for n * CG21_WIRE_PRESIGN_ROUND2_FIELDS views
+*  @return                  CG21_WIRE_OK, CG21_WIRE_NO_SECTION or an error code
+*/
+extern int CG21_WIRE_PRESIGN_ROUND2_ALL_fromOctet(const octet *I, int j, int n, CG21_PRESIGN_ROUND2_OUTPUT *out,
+                                                  octet *views);
+
+/**	@brief Encode the output of round 3 of presign
+*
+*  @param O                 message on exit
+*  @param out               output of round 3
+*  @return                  CG21_WIRE_OK or CG21_WIRE_BUFFER_TOO_SMALL
+*/
+extern int CG21_WIRE_PRESIGN_ROUND3_toOctet(octet *O, const CG21_PRESIGN_ROUND3_OUTPUT *out);
+
+/**	@brief Decode the output of round 3 of presign
+*
+*  @param I                 message
+*  @param out               output of round 3 on exit, with fields pointing to views
+*  @param views             storage for CG21_WIRE_PRESIGN_ROUND3_FIELDS views
+*  @return                  CG21_WIRE_OK or an error code
+*/
+extern int CG21_WIRE_PRESIGN_ROUND3_fromOctet(const octet *I, CG21_PRESIGN_ROUND3_OUTPUT *out, octet *views);
+
+/**	@brief Encode the output of round 1 of presign with the PiEnc proof for each peer
+*
+*  The message has the fields G, K and i of out, then j and psi for each peer,
+*  so it can be broadcast and each peer keeps the proof addressed to it. out->psi is not used
+*
+*  @param O                 message on exit
+*  @param out               output of round 1
+*  @param psi               encoded PiEnc proof for each peer
+*  @param to                id of each peer
+*  @param n                 number of peers, at most 126
+*  @return                  CG21_WIRE_OK, CG21_WIRE_INVALID_COUNT or CG21_WIRE_BUFFER_TOO_SMALL
+*/
+extern int CG21_WIRE_PRESIGN_ROUND1_ALL_toOctet(octet *O, const CG21_PRESIGN_ROUND1_OUTPUT *out, octet *const *psi,
+                                                const int *to, int n);
+
+/**	@brief Decode the output of round 1 of presign with the PiEnc proof addressed to a player
+*
+*  @param I                 message
+*  @param j                 id of the player
+*  @param n                 number of peers in the message
+*  @param out               output of round 1 on exit, with psi addressed to j and fields pointing to views
+*  @param views             storage for CG21_WIRE_PRESIGN_ALL_FIELDS + n * CG21_WIRE_PRESIGN_SECTION_FIELDS views
+*  @return                  CG21_WIRE_OK, CG21_WIRE_NO_SECTION or an error code
+*/
+extern int CG21_WIRE_PRESIGN_ROUND1_ALL_fromOctet(const octet *I, int j, int n, CG21_PRESIGN_ROUND1_OUTPUT *out,
+                                                  octet *views);
+
+/**	@brief Encode the output of round 3 of presign with the PiLogstar proof for each peer
+*
+*  The message has the fields delta, Delta and i of out, then j and psi_douplePrime
+*  for each peer. out->psi_douplePrime is not used
+*
+*  @param O                 message on exit
+*  @param out               output of round 3
+*  @param psi               encoded PiLogstar proof for each peer
+*  @param to                id of each peer
+*  @param n                 number of peers, at most 126
+*  @return                  CG21_WIRE_OK, CG21_WIRE_INVALID_COUNT or CG21_WIRE_BUFFER_TOO_SMALL
+*/
+extern int CG21_WIRE_PRESIGN_ROUND3_ALL_toOctet(octet *O, const CG21_PRESIGN_ROUND3_OUTPUT *out, octet *const *psi,
+                                                const int *to, int n);
+
+/**	@brief Decode the output of round 3 of presign with the PiLogstar proof addressed to a player
+*
+*  @param I                 message
+*  @param j                 id of the player
+*  @param n                 number of peers in the message
+*  @param out               output of round 3 on exit, with psi_douplePrime addressed to j and fields pointing to views
+*  @param views             storage for CG21_WIRE_PRESIGN_ALL_FIELDS + n * CG21_WIRE_PRESIGN_SECTION_FIELDS views
+*  @return                  CG21_WIRE_OK, CG21_WIRE_NO_SECTION or an error code
+*/
+extern int CG21_WIRE_PRESIGN_ROUND3_ALL_fromOctet(const octet *I, int j, int n, CG21_PRESIGN_ROUND3_OUTPUT *out,
+                                                  octet *views);
+
+/**	@brief Encode a PiEnc proof, with its commitment
+*
+*  @param O                 message on exit, of CG21_WIRE_PIENC_PROOF_SIZE bytes
+*  @param c                 commitment
+*  @param p                 proof
+*  @return                  CG21_WIRE_OK or CG21_WIRE_BUFFER_TOO_SMALL
+*/
+extern int CG21_WIRE_PIENC_PROOF_toOctet(octet *O, const PiEnc_COMMITS_OCT *c, const PiEnc_PROOFS_OCT *p);
+
+/**	@brief Decode a PiEnc proof, with its commitment
+*
+*  @param I                 message
+*  @param c                 commitment on exit, with fields pointing to views
+*  @param p                 proof on exit, with fields pointing to views
+*  @param views             storage for CG21_WIRE_PIENC_PROOF_FIELDS views
+*  @return                  CG21_WIRE_OK or an error code
+*/
+extern int CG21_WIRE_PIENC_PROOF_fromOctet(const octet *I, PiEnc_COMMITS_OCT *c, PiEnc_PROOFS_OCT *p, octet *views);
+
+/**	@brief Encode a PiLogstar proof, with its commitment
+*
+*  @param O                 message on exit, of CG21_WIRE_PILOGSTAR_PROOF_SIZE bytes
+*  @param c                 commitment
+*  @param p                 proof
+*  @return                  CG21_WIRE_OK or CG21_WIRE_BUFFER_TOO_SMALL
+*/
+extern int CG21_WIRE_PILOGSTAR_PROOF_toOctet(octet *O, const PiLogstar_COMMITS_OCT *c, const PiLogstar_PROOFS_OCT *p);
+
+/**	@brief Decode a PiLogstar proof, with its commitment
+*
+*  @param I                 message
+*  @param c                 commitment on exit, with fields pointing to views
+*  @param p                 proof on exit, with fields pointing to views
+*  @param views             storage for CG21_WIRE_PILOGSTAR_PROOF_FIELDS views
+*  @return                  CG21_WIRE_OK or an error code
+*/
+extern int CG21_WIRE_PILOGSTAR_PROOF_fromOctet(const octet *I, PiLogstar_COMMITS_OCT *c, PiLogstar_PROOFS_OCT *p,
+                                               octet *views);
+
+/**	@brief Encode a PiAffg proof, with its commitment
+*
+*  @param O                 message on exit, of CG21_WIRE_PIAFFG_PROOF_SIZE bytes
+*  @param c                 commitment
+*  @param p                 proof
+*  @return                  CG21_WIRE_OK or CG21_WIRE_BUFFER_TOO_SMALL
+*/
+extern int CG21_WIRE_PIAFFG_PROOF_toOctet(octet *O, const Piaffg_COMMITS_OCT *c, const Piaffg_PROOFS_OCT *p);
+
+/**	@brief Decode a PiAffg proof, with its commitment
+*
+*  @param I                 message
+*  @param c                 commitment on exit, with fields pointing to views
+*  @param p                 proof on exit, with fields pointing to views
+*  @param views             storage for CG21_WIRE_PIAFFG_PROOF_FIELDS views
+*  @return                  CG21_WIRE_OK or an error code
+*/
+extern int CG21_WIRE_PIAFFG_PROOF_fromOctet(const octet *I, Piaffg_COMMITS_OCT *c, Piaffg_PROOFS_OCT *p,
+                                            octet *views);
+
+/**	@brief Encode the commitment of a PiAffg proof
+*
+*  @param O                 message on exit
+*  @param c                 commitment
+*  @return                  CG21_WIRE_OK or CG21_WIRE_BUFFER_TOO_SMALL
+*/
+extern int CG21_WIRE_PIAFFG_COMMITS_toOctet(octet *O, const Piaffg_COMMITS_OCT *c);
+
+/**	@brief Decode the commitment of a PiAffg proof
+*
+*  @param I                 message
+*  @param c                 commitment on exit, with fields pointing to views
+*  @param views             storage for CG21_WIRE_PIAFFG_COMMITS_FIELDS views
+*  @return                  CG21_WIRE_OK or an error code
+*/
+extern int CG21_WIRE_PIAFFG_COMMITS_fromOctet(const octet *I, Piaffg_COMMITS_OCT *c, octet *views);
+
+/**	@brief Encode a PiAffg proof
+*
+*  @param O                 message on exit
+*  @param p                 proof
+*  @return                  CG21_WIRE_OK or CG21_WIRE_BUFFER_TOO_SMALL
+*/
+extern int CG21_WIRE_PIAFFG_PROOFS_toOctet(octet *O, const Piaffg_PROOFS_OCT *p);
+
+/**	@brief Decode a PiAffg proof
+*
+*  @param I                 message
+*  @param p                 proof on exit, with fields pointing to views
+*  @param views             storage for CG21_WIRE_PIAFFG_PROOFS_FIELDS views
+*  @return                  CG21_WIRE_OK or an error code
+*/
+extern int CG21_WIRE_PIAFFG_PROOFS_fromOctet(const octet *I, Piaffg_PROOFS_OCT *p, octet *views);
+
+/**	@brief Encode a PiMod proof
+*
+*  @param O                 message on exit
+*  @param p                 proof
+*  @return                  CG21_WIRE_OK or CG21_WIRE_BUFFER_TOO_SMALL
+*/
+extern int CG21_WIRE_PIMOD_PROOF_toOctet(octet *O, const CG21_PIMOD_PROOF_OCT *p);
+
+/**	@brief Decode a PiMod proof
+*
+*  @param I                 message
+*  @param p                 proof on exit, with fields pointing to views
+*  @param views             storage for CG21_WIRE_PIMOD_PROOF_FIELDS views
+*  @return                  CG21_WIRE_OK or an error code
+*/
+extern int CG21_WIRE_PIMOD_PROOF_fromOctet(const octet *I, CG21_PIMOD_PROOF_OCT *p, octet *views);
+
+/**	@brief Encode the output of round 3 of the auxiliary information protocol
+*
+*  @param O                 message on exit
+*  @param r3                output of round 3, with its PiMod and PiFactor proofs
+*  @return                  CG21_WIRE_OK or CG21_WIRE_BUFFER_TOO_SMALL
+*/
+extern int CG21_WIRE_AUX_ROUND3_toOctet(octet *O, const CG21_AUX_ROUND3 *r3);
+
+/**	@brief Decode the output of round 3 of the auxiliary information protocol
+*
+*  @param I                 message
+*  @param r3                output of round 3 on exit, with fields pointing to views
+*  @param views             storage for CG21_WIRE_AUX_ROUND3_FIELDS views
+*  @return                  CG21_WIRE_OK or an error code
+*/
+extern int CG21_WIRE_AUX_ROUND3_fromOctet(const octet *I, CG21_AUX_ROUND3 *r3, octet *views);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -41,6 +41,7 @@ extern "C"
 #define HDLOG_PROOF_ITERS       128                         /**< Iterations necessary for the Proof */
 #define HDLOG_CHALLENGE_SIZE HDLOG_PROOF_ITERS / 8    /**< Length of the challenge necessary for the chosen Proof iterations */
 #define HDLOG_VALUES_SIZE HDLOG_PROOF_ITERS * FS_2048 /**< Length of the values encoding */
+#define HDLOG_VERIFY_TABLE_SIZE 16                  /**< Number of precomputed powers of B0 used in verification */
 
 typedef struct
 {
@@ -60,6 +61,17 @@ typedef struct
 /*! \brief Holds the values for each iteration of the protocol */
 typedef BIG_1024_58 HDLOG_iter_values[HDLOG_PROOF_ITERS][FFLEN_2048];
 
+/*! \brief State of a verification fed with chunks of iterations */
+typedef struct
+{
+    BIG_1024_58 N[FFLEN_2048];                              /**< Public Modulus */
+    BIG_1024_58 B1[FFLEN_2048];                             /**< Public Value of the DLOG */
+    BIG_1024_58 ND[FFLEN_2048];                             /**< Montgomery constant of N */
+    BIG_1024_58 PT[HDLOG_VERIFY_TABLE_SIZE][FFLEN_2048];    /**< Precomputed powers of B0 */
+    char e[HDLOG_CHALLENGE_SIZE];                           /**< Challenge of the ZKP */
+    int next;                                               /**< Index of the next iteration */
+} HDLOG_verify_state;
+
 /*! \brief Generate a commitment for the ZKPs
  *
  * @param RNG   CSPRNG
@@ -95,6 +107,34 @@ extern void HDLOG_challenge(BIG_1024_58 *N, BIG_1024_58 *B0, BIG_1024_58 *B1, HD
  */
 extern int HDLOG_challenge_CG21(BIG_1024_58 *N, BIG_1024_58 *B0, BIG_1024_58 *B1, HDLOG_iter_values RHO, const HDLOG_SSID *ssid, octet *E, int n);
 
+/*! \brief Start a challenge with the commitment given in chunks
+ *
+ * Same challenge as HDLOG_challenge_CG21, the commitment is added
+ * with HDLOG_challenge_CG21_update
+ *
+ * @param sha   Hash of the challenge
+ * @param N     Public Modulus
+ * @param B0    Base of the DLOG
+ * @param B1    Public Value of the DLOG
+ * @param ssid  System-wide session ID
+ * @param n     Number of the octets packed in a package
+ */
+extern int HDLOG_challenge_CG21_init(hash256 *sha, BIG_1024_58 *N, BIG_1024_58 *B0, BIG_1024_58 *B1, const HDLOG_SSID *ssid, int n);
+
+/*! \brief Add a chunk of the encoded commitment to a challenge
+ *
+ * @param sha   Hash of the challenge
+ * @param RHO   Consecutive values of the commitment, FS_2048 bytes each
+ */
+extern void HDLOG_challenge_CG21_update(hash256 *sha, const octet *RHO);
+
+/*! \brief Output a challenge
+ *
+ * @param sha   Hash of the challenge
+ * @param E     Generated challenge for the ZKP
+ */
+extern void HDLOG_challenge_CG21_final(hash256 *sha, octet *E);
+
 /*! \brief Prove knowledge of the DLOG
  *
  * @param ord   Order of B0
@@ -118,6 +158,39 @@ extern void HDLOG_prove(BIG_1024_58 *ord, BIG_1024_58 *alpha, HDLOG_iter_values
  */
 extern int HDLOG_verify(BIG_1024_58 *N, BIG_1024_58 *B0, BIG_1024_58 *B1, HDLOG_iter_values RHO, const octet *E, HDLOG_iter_values T);
 
+/*! \brief Start the verification of a ZKP given in chunks of iterations
+ *
+ * @param S     Verification state
+ * @param N     Public Modulus
+ * @param B0    Base of the DLOG
+ * @param B1    Public Value of the DLOG
+ * @param E     Challenge of the ZKP, HDLOG_CHALLENGE_SIZE bytes
+ *
+ * @return      Returns HDLOG_OK or HDLOG_INVALID_VALUES if E has another length
+ */
+extern int HDLOG_verify_init(HDLOG_verify_state *S, BIG_1024_58 *N, BIG_1024_58 *B0, BIG_1024_58 *B1, const octet *E);
+
+/*! \brief Verify the next chunk of iterations
+ *
+ * RHO and T hold the same number of consecutive encoded values,
+ * starting from the first iteration not yet verified
+ *
+ * @param S     Verification state
+ * @param RHO   Chunk of the commitment
+ * @param T     Chunk of the proof
+ *
+ * @return      Returns HDLOG_OK if the chunk is valid or an error code
+ */
+extern int HDLOG_verify_chunk(HDLOG_verify_state *S, const octet *RHO, const octet *T);
+
+/*! \brief Finish the verification of a ZKP given in chunks
+ *
+ * @param S     Verification state
+ *
+ * @return      Returns HDLOG_OK if all the iterations are verified or HDLOG_INVALID_VALUES
+ */
+extern int HDLOG_verify_final(const HDLOG_verify_state *S);
+
 /*! \brief Encode v into an octet
  *
  * @param O      Destination Octet
@@ -0,0 +1,183 @@
+/*
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"); you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+*/
+
+/**
+ * @file parallel.h
+ * @brief Execution of independent loop iterations across threads
+ *
+ */
+
+#ifndef PARALLEL
+#define PARALLEL
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define PARALLEL_MAX_THREADS 64     /**< Upper bound on the number of threads used by the internal executor */
+#define PARALLEL_SKIPPED -1         /**< Verdict of a check cancelled by PARALLEL_verify */
+
+/*! \brief Body of a loop, runs iteration i
+ *
+ * Each iteration must only write to its own outputs, so the result
+ * does not depend on the order in which the iterations are run
+ *
+ * @param ctx   Data shared by all the iterations
+ * @param i     Index of the iteration
+ */
+typedef void (*PARALLEL_task)(void *ctx, int i);
+
+/*! \brief Caller supplied executor, e.g. backed by an existing thread pool
+ *
+ * Must run task(ctx, i) for every i in [0, n) and only return once all the
+ * iterations are complete. It is never re-entered from one of its own
+ * iterations, see PARALLEL_for
+ *
+ * @param pool  Opaque pointer given to PARALLEL_set_executor
+ * @param task  Body of the loop
+ * @param ctx   Data shared by all the iterations
+ * @param n     Number of iterations
+ */
+typedef void (*PARALLEL_executor)(void *pool, PARALLEL_task task, void *ctx, int n);
+
+/*! \brief Use a caller supplied executor for all the parallel loops
+ *
+ * Not thread safe, call once before running any protocol. A NULL executor
+ * restores the internal behaviour
+ *
+ * @param executor  Executor function
+ * @param pool      Opaque pointer passed to the executor
+ */
+extern void PARALLEL_set_executor(PARALLEL_executor executor, void *pool);
+
+/*! \brief Set the number of threads used by the internal executor
+ *
+ * Only effective when the library is built with MPC_THREADS. Not thread safe,
+ * call once before running any protocol. A value smaller than 1 selects the
+ * number of online processors
+ *
+ * @param threads   Number of threads
+ */
+extern void PARALLEL_set_threads(int threads);
+
+/*! \brief Run the two CRT halves of an operation on separate threads
+ *
+ * Disabled by default. Worth enabling when there is little parallelism
+ * across peers, since the halves then run in place of two cores that
+ * would otherwise be idle. Not thread safe, call once before running any
+ * protocol
+ *
+ * @param enable    Non zero to run the halves concurrently
+ */
+extern void PARALLEL_set_crt(int enable);
+
+/*! \brief Run task(ctx, i) for every i in [0, n)
+ *
+ * Uses the caller supplied executor if any. Otherwise the iterations are split
+ * in contiguous blocks across pthreads when built with MPC_THREADS, or run in
+ * order on the calling thread
+ *
+ * The functions in this file can be called from an iteration, e.g. a proof
+ * verified by PARALLEL_verify that splits its own iterations. Only the
+ * outermost loop is spread across threads: the nested loops, CRT halves and
+ * races run in order on the thread of the iteration that started them, so
+ * they neither oversubscribe the cores nor wait on a busy executor
+ *
+ * @param task  Body of the loop
+ * @param ctx   Data shared by all the iterations
+ * @param n     Number of iterations
+ */
+extern void PARALLEL_for(PARALLEL_task task, void *ctx, int n);
+
+/*! \brief Run task(ctx, 0) and task(ctx, 1), e.g. the mod p and mod q halves of a CRT
+ *
+ * The two halves run concurrently if enabled with PARALLEL_set_crt, on
+ * the caller supplied executor if any or on a pthread when built with
+ * MPC_THREADS. Otherwise they are run in order on the calling thread
+ *
+ * @param task  Body of each half
+ * @param ctx   Data shared by the two halves
+ */
+extern void PARALLEL_crt(PARALLEL_task task, void *ctx);
+
+/*! \brief Polled by the workers of PARALLEL_race
+ *
+ * @param token Opaque pointer given to the worker
+ * @return      Non zero if the worker should give up
+ */
+typedef int (*PARALLEL_stop)(void *token);
+
+/*! \brief Worker of PARALLEL_race
+ *
+ * @param ctx   Data shared by all the workers
+ * @param i     Index of the worker
+ * @param stop  Function to poll regularly, the worker should return 0 once it returns non zero
+ * @param token Argument for stop
+ * @return      Non zero if the worker succeeded
+ */
+typedef int (*PARALLEL_race_task)(void *ctx, int i, PARALLEL_stop stop, void *token);
+
+/*! \brief Number of threads used by the internal executor
+ *
+ * @return      1 unless the library is built with MPC_THREADS
+ */
+extern int PARALLEL_get_threads(void);
+
+/*! \brief Run n workers concurrently until the first one succeeds
+ *
+ * The other workers are signalled through their stop function and
+ * joined before returning. Only the internal pthreads executor runs
+ * the workers concurrently, otherwise they are run in order until one
+ * succeeds
+ *
+ * @param task  Worker function
+ * @param ctx   Data shared by all the workers
+ * @param n     Number of workers, at most PARALLEL_MAX_THREADS
+ * @return      Index of the first worker to succeed, -1 if none did
+ */
+extern int PARALLEL_race(PARALLEL_race_task task, void *ctx, int n);
+
+/*! \brief Check run by PARALLEL_verify, e.g. the verification of a proof
+ *
+ * @param ctx   Data shared by all the checks
+ * @param i     Index of the check
+ * @return      0 if check i passed, a non negative error code otherwise
+ */
+typedef int (*PARALLEL_check)(void *ctx, int i);
+
+/*! \brief Run task(ctx, i) for every i in [0, n) until the first failure
+ *
+ * The checks are run with PARALLEL_for. Once a check fails, the checks
+ * that have not started yet are cancelled and their verdict is set to
+ * PARALLEL_SKIPPED, while the ones already running are completed
+ *
+ * @param task      Check function
+ * @param ctx       Data shared by all the checks
+ * @param n         Number of checks
+ * @param verdicts  Result of each check, or PARALLEL_SKIPPED if cancelled
+ * @return          Index of the first check to fail, -1 if all passed
+ */
+extern int PARALLEL_verify(PARALLEL_check task, void *ctx, int n, int *verdicts);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
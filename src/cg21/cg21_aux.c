@@ -348,6 +348,23 @@ int CG21_PI_MOD_VERIFY_HELPER(CG21_AUX_ROUND1_STORE_PUB *rnd1Pub, const CG21_SSI
     return rc;
 }
 
+int CG21_PI_MOD_VERIFY_BATCH_HELPER(csprng *RNG, CG21_AUX_ROUND1_STORE_PUB *rnd1Pub, const CG21_SSID *ssid,
+                                    CG21_AUX_ROUND3 *rnd3){
+
+    PAILLIER_public_key PaiPub;
+
+    // recover Paillier public parameters from packed octet
+    int rc = CG21_PaillierPub_from_octet(&PaiPub, rnd1Pub->PaiPub);
+    if (rc!=CG21_OK){
+        return rc;
+    }
+
+    // verify the ZKP for Paillier parameters
+    rc = CG21_PI_MOD_VERIFY_BATCH(RNG, &rnd3->paillierProof, ssid, PaiPub,rnd1Pub->t);
+
+    return rc;
+}
+
 int CG21_PI_PRM_VERIFY_HELPER(CG21_AUX_ROUND1_STORE_PUB *rnd1Pub, const CG21_SSID *ssid){
 
     PEDERSEN_PUB PedPub;
@@ -440,6 +457,47 @@ int CG21_PI_FACTOR_VERIFY_HELPER(const CG21_SSID *ssid, CG21_AUX_ROUND3 *rnd3pub
     return CG21_OK;
 }
 
+/* Shared state for the verification of the peers in CG21_AUX_ROUND3_VERIFY_ALL */
+typedef struct
+{
+    CG21_AUX_ROUND1_STORE_PRIV *rnd1Priv;
+    CG21_AUX_ROUND3_PEER *peers;
+} CG21_AUX_ROUND3_VERIFY_CTX;
+
+static int CG21_AUX_ROUND3_verify_peer(void *arg, int i)
+{
+    CG21_AUX_ROUND3_VERIFY_CTX *c = (CG21_AUX_ROUND3_VERIFY_CTX *)arg;
+    CG21_AUX_ROUND3_PEER *p = c->peers + i;
+
+    int rc = CG21_PI_PRM_VERIFY_HELPER(p->rnd1Pub, p->prmSsid);
+    if (rc != CG21_OK){
+        return rc;
+    }
+
+    rc = CG21_PI_MOD_VERIFY_HELPER(p->rnd1Pub, p->ssid, p->rnd3);
+    if (rc != CG21_OK){
+        return rc;
+    }
+
+    return CG21_PI_FACTOR_VERIFY_HELPER(p->ssid, p->rnd3, p->rnd1Pub, c->rnd1Priv);
+}
+
+int CG21_AUX_ROUND3_VERIFY_ALL(CG21_AUX_ROUND1_STORE_PRIV *rnd1Priv, CG21_AUX_ROUND3_PEER *peers, int n,
+                               int *verdicts, int *failed){
+
+    CG21_AUX_ROUND3_VERIFY_CTX ctx;
+
+    ctx.rnd1Priv = rnd1Priv;
+    ctx.peers = peers;
+
+    *failed = PARALLEL_verify(CG21_AUX_ROUND3_verify_peer, &ctx, n, verdicts);
+    if (*failed >= 0){
+        return verdicts[*failed];
+    }
+
+    return CG21_OK;
+}
+
 void CG21_AUX_PACK_OUTPUT(CG21_AUX_OUTPUT *output, CG21_AUX_ROUND1_STORE_PUB rnd1Pub, bool first_entry){
     char hex_string[5];
 
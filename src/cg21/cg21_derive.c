@@ -0,0 +1,193 @@
+/*
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"); you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+*/
+
+/* Non-hardened derivation of child keys from a threshold key */
+
+#include "amcl/cg21/cg21_derive.h"
+
+int CG21_DERIVE_CHILD(octet *X, octet *C, unsigned int index, octet *childX, octet *childC, octet *T)
+{
+    BIG_256_56 q;
+    BIG_256_56 t;
+
+    ECP_SECP256K1 P;
+    ECP_SECP256K1 G;
+
+    char m[EFS_SECP256K1 + 1 + 4];
+    octet M = {0, sizeof(m), m};
+
+    char ii[2 * CG21_DERIVE_CHAIN_SIZE];
+    octet I = {0, sizeof(ii), ii};
+
+    if (index >= CG21_DERIVE_HARDENED)
+    {
+        return CG21_DERIVE_INVALID_INDEX;
+    }
+
+    if (C->len != CG21_DERIVE_CHAIN_SIZE)
+    {
+        return CG21_DERIVE_INVALID_CHAIN;
+    }
+
+    if (X->len != EFS_SECP256K1 + 1 || !ECP_SECP256K1_fromOctet(&P, X))
+    {
+        return CG21_DERIVE_INVALID_PK;
+    }
+
+    // I = HMAC-SHA512(C, X || ser32(index))
+    OCT_copy(&M, X);
+    OCT_jint(&M, (int)index, 4);
+    HMAC(SHA512, &M, C, sizeof(ii), &I);
+
+    // t = I_L, chain code = I_R
+    BIG_256_56_rcopy(q, CURVE_Order_SECP256K1);
+    BIG_256_56_fromBytesLen(t, I.val, CG21_DERIVE_CHAIN_SIZE);
+    if (BIG_256_56_comp(t, q) >= 0)
+    {
+        BIG_256_56_zero(t);
+        OCT_clear(&I);
+        return CG21_DERIVE_INVALID_CHILD;
+    }
+
+    // X' = X + t.G
+    ECP_SECP256K1_generator(&G);
+    ECP_SECP256K1_mul(&G, t);
+    ECP_SECP256K1_add(&P, &G);
+    if (ECP_SECP256K1_isinf(&P))
+    {
+        BIG_256_56_zero(t);
+        OCT_clear(&I);
+        return CG21_DERIVE_INVALID_CHILD;
+    }
+
+    ECP_SECP256K1_toOctet(childX, &P, true);
+    OCT_chop(&I, childC, CG21_DERIVE_CHAIN_SIZE);
+
+    T->len = EGS_SECP256K1;
+    BIG_256_56_toBytes(T->val, t);
+
+    BIG_256_56_zero(t);
+    OCT_clear(&I);
+
+    return CG21_DERIVE_OK;
+}
+
+int CG21_DERIVE_PATH(octet *X, octet *C, const unsigned int *path, int depth,
+                     octet *childX, octet *childC, octet *T)
+{
+    BIG_256_56 q;
+    BIG_256_56 t;
+    BIG_256_56 sum;
+
+    char x[EFS_SECP256K1 + 1];
+    octet XX = {0, sizeof(x), x};
+
+    char c[CG21_DERIVE_CHAIN_SIZE];
+    octet CC = {0, sizeof(c), c};
+
+    char tt[EGS_SECP256K1];
+    octet TT = {0, sizeof(tt), tt};
+
+    int rc;
+
+    if (C->len != CG21_DERIVE_CHAIN_SIZE)
+    {
+        return CG21_DERIVE_INVALID_CHAIN;
+    }
+
+    BIG_256_56_rcopy(q, CURVE_Order_SECP256K1);
+    BIG_256_56_zero(sum);
+
+    OCT_copy(childX, X);
+    OCT_copy(childC, C);
+
+    for (int j = 0; j < depth; j++)
+    {
+        OCT_copy(&XX, childX);
+        OCT_copy(&CC, childC);
+
+        rc = CG21_DERIVE_CHILD(&XX, &CC, path[j], childX, childC, &TT);
+        if (rc != CG21_DERIVE_OK)
+        {
+            BIG_256_56_zero(sum);
+            return rc;
+        }
+
+        // tweaks add up along the path
+        BIG_256_56_fromBytesLen(t, TT.val, TT.len);
+        BIG_256_56_add(sum, sum, t);
+        BIG_256_56_mod(sum, q);
+    }
+
+    T->len = EGS_SECP256K1;
+    BIG_256_56_toBytes(T->val, sum);
+
+    BIG_256_56_zero(t);
+    BIG_256_56_zero(sum);
+    OCT_clear(&TT);
+
+    return CG21_DERIVE_OK;
+}
+
+int CG21_DERIVE_TWEAK_RESHARE_OUTPUT(CG21_RESHARE_OUTPUT *output, const octet *T)
+{
+    BIG_256_56 q;
+    BIG_256_56 t;
+    BIG_256_56 y;
+
+    ECP_SECP256K1 G;
+    ECP_SECP256K1 P;
+    ECP_SECP256K1 X1;
+
+    // first partial PK, updated in place in the packed set
+    octet X0 = {EFS_SECP256K1 + 1, EFS_SECP256K1 + 1, output->pk.X_set_packed->val};
+
+    if (output->pk.X_set_packed->len < EFS_SECP256K1 + 1
+        || !ECP_SECP256K1_fromOctet(&P, output->pk.X)
+        || !ECP_SECP256K1_fromOctet(&X1, &X0))
+    {
+        return CG21_DERIVE_INVALID_PK;
+    }
+
+    BIG_256_56_rcopy(q, CURVE_Order_SECP256K1);
+    BIG_256_56_fromBytesLen(t, T->val, T->len);
+    BIG_256_56_mod(t, q);
+
+    // y_i + t are the shares of f(x) + t
+    BIG_256_56_fromBytesLen(y, output->shares.Y->val, output->shares.Y->len);
+    BIG_256_56_add(y, y, t);
+    BIG_256_56_mod(y, q);
+    output->shares.Y->len = EGS_SECP256K1;
+    BIG_256_56_toBytes(output->shares.Y->val, y);
+
+    // X + t.G and X_1 + t.G, so the partial PKs still add up to X
+    ECP_SECP256K1_generator(&G);
+    ECP_SECP256K1_mul(&G, t);
+
+    ECP_SECP256K1_add(&P, &G);
+    ECP_SECP256K1_toOctet(output->pk.X, &P, true);
+
+    ECP_SECP256K1_add(&X1, &G);
+    ECP_SECP256K1_toOctet(&X0, &X1, true);
+
+    BIG_256_56_zero(t);
+    BIG_256_56_zero(y);
+
+    return CG21_DERIVE_OK;
+}
@@ -0,0 +1,387 @@
+/*
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"); you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+*/
+
+/* Encrypted binary store of key shares with their parsed keys */
+
+#define _POSIX_C_SOURCE 200809L
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include "amcl/cg21/cg21_keystore.h"
+
+#define CG21_KEYSTORE_MAGIC_SIZE    7
+#define CG21_KEYSTORE_CHUNK         1024    // bytes encrypted at once, a multiple of the AES block
+
+static const char CG21_KEYSTORE_MAGIC[CG21_KEYSTORE_MAGIC_SIZE] = {'C','G','2','1','K','S','T'};
+
+/* Plaintext of a record: the key followed by the peers */
+typedef struct
+{
+    char *region[2];
+    int len[2];
+} CG21_KEYSTORE_plain;
+
+static void CG21_KEYSTORE_put32(char *b, int x)
+{
+    b[0] = (char)((x >> 24) & 0xFF);
+    b[1] = (char)((x >> 16) & 0xFF);
+    b[2] = (char)((x >> 8) & 0xFF);
+    b[3] = (char)(x & 0xFF);
+}
+
+/* Header of a keystore with n peers, for this build */
+static void CG21_KEYSTORE_header(char *header, int n)
+{
+    memcpy(header, CG21_KEYSTORE_MAGIC, CG21_KEYSTORE_MAGIC_SIZE);
+    header[CG21_KEYSTORE_MAGIC_SIZE] = CG21_KEYSTORE_VERSION;
+
+    CG21_KEYSTORE_put32(header + 8, (int)sizeof(CG21_KEYSTORE_KEY));
+    CG21_KEYSTORE_put32(header + 12, (int)sizeof(CG21_KEYSTORE_PEER));
+    CG21_KEYSTORE_put32(header + 16, n);
+}
+
+/* Length of the plaintext of a record */
+static long CG21_KEYSTORE_plain_size(const CG21_KEYSTORE *ks)
+{
+    return (long)sizeof(CG21_KEYSTORE_KEY) + (long)ks->n * (long)sizeof(CG21_KEYSTORE_PEER);
+}
+
+/* Length of a record */
+static long CG21_KEYSTORE_record_size(const CG21_KEYSTORE *ks)
+{
+    return CG21_KEYSTORE_IV_SIZE + CG21_KEYSTORE_plain_size(ks) + CG21_KEYSTORE_TAG_SIZE;
+}
+
+/* Authenticated data of record i: file header and record index */
+static void CG21_KEYSTORE_ad(const CG21_KEYSTORE *ks, char *ad, int i)
+{
+    memcpy(ad, ks->header, CG21_KEYSTORE_HEADER_SIZE);
+    CG21_KEYSTORE_put32(ad + CG21_KEYSTORE_HEADER_SIZE, i);
+}
+
+/* Copy len bytes of the plaintext from offset into buf, or from buf into the plaintext */
+static void CG21_KEYSTORE_copy(CG21_KEYSTORE_plain *p, long offset, char *buf, int len, int gather)
+{
+    long base = 0;
+
+    for (int r = 0; r < 2; r++)
+    {
+        long from = offset > base ? offset : base;
+        long to = offset + len < base + p->len[r] ? offset + len : base + p->len[r];
+
+        if (from < to)
+        {
+            if (gather)
+            {
+                memcpy(buf + (from - offset), p->region[r] + (from - base), (size_t)(to - from));
+            }
+            else
+            {
+                memcpy(p->region[r] + (from - base), buf + (from - offset), (size_t)(to - from));
+            }
+        }
+
+        base += p->len[r];
+    }
+}
+
+int CG21_KEYSTORE_OPEN(CG21_KEYSTORE *ks, const char *path, int n)
+{
+    char header[CG21_KEYSTORE_HEADER_SIZE];
+    long size;
+
+    if (n < 0)
+    {
+        return CG21_KEYSTORE_INVALID_FILE;
+    }
+
+    ks->n = n;
+    ks->count = 0;
+    CG21_KEYSTORE_header(ks->header, n);
+
+    ks->fp = fopen(path, "r+b");
+
+    // create the file only if it does not exist, "w+b" truncates it
+    if (ks->fp == NULL && errno == ENOENT)
+    {
+        ks->fp = fopen(path, "w+b");
+    }
+
+    if (ks->fp == NULL)
+    {
+        return CG21_KEYSTORE_IO_ERROR;
+    }
+
+    if (fseek(ks->fp, 0, SEEK_END) != 0 || (size = ftell(ks->fp)) < 0)
+    {
+        CG21_KEYSTORE_CLOSE(ks);
+        return CG21_KEYSTORE_IO_ERROR;
+    }
+
+    // New file, write the header
+    if (size == 0)
+    {
+        if (fwrite(ks->header, 1, CG21_KEYSTORE_HEADER_SIZE, ks->fp) != CG21_KEYSTORE_HEADER_SIZE ||
+            fflush(ks->fp) != 0)
+        {
+            CG21_KEYSTORE_CLOSE(ks);
+            return CG21_KEYSTORE_IO_ERROR;
+        }
+
+        return CG21_KEYSTORE_OK;
+    }
+
+    if (size < CG21_KEYSTORE_HEADER_SIZE)
+    {
+        CG21_KEYSTORE_CLOSE(ks);
+        return CG21_KEYSTORE_INVALID_FILE;
+    }
+
+    if (fseek(ks->fp, 0, SEEK_SET) != 0 ||
+        fread(header, 1, CG21_KEYSTORE_HEADER_SIZE, ks->fp) != CG21_KEYSTORE_HEADER_SIZE)
+    {
+        CG21_KEYSTORE_CLOSE(ks);
+        return CG21_KEYSTORE_IO_ERROR;
+    }
+
+    if (memcmp(header, ks->header, CG21_KEYSTORE_MAGIC_SIZE + 1) != 0 ||
+        memcmp(header + 16, ks->header + 16, 4) != 0)
+    {
+        CG21_KEYSTORE_CLOSE(ks);
+        return CG21_KEYSTORE_INVALID_FILE;
+    }
+
+    // Same format, but limbs of another size or alignment
+    if (memcmp(header + 8, ks->header + 8, 8) != 0)
+    {
+        CG21_KEYSTORE_CLOSE(ks);
+        return CG21_KEYSTORE_INVALID_LAYOUT;
+    }
+
+    if ((size - CG21_KEYSTORE_HEADER_SIZE) % CG21_KEYSTORE_record_size(ks) != 0)
+    {
+        CG21_KEYSTORE_CLOSE(ks);
+        return CG21_KEYSTORE_INVALID_FILE;
+    }
+
+    ks->count = (int)((size - CG21_KEYSTORE_HEADER_SIZE) / CG21_KEYSTORE_record_size(ks));
+
+    return CG21_KEYSTORE_OK;
+}
+
+int CG21_KEYSTORE_CLOSE(CG21_KEYSTORE *ks)
+{
+    int rc = CG21_KEYSTORE_OK;
+
+    if (ks->fp != NULL && fclose(ks->fp) != 0)
+    {
+        rc = CG21_KEYSTORE_IO_ERROR;
+    }
+
+    ks->fp = NULL;
+
+    return rc;
+}
+
+int CG21_KEYSTORE_APPEND(csprng *RNG, CG21_KEYSTORE *ks, const octet *K, const CG21_KEYSTORE_KEY *key,
+                         const CG21_KEYSTORE_PEER *peers, int *index)
+{
+    gcm g;
+    long offset;
+    long len = CG21_KEYSTORE_plain_size(ks);
+    int rc = CG21_KEYSTORE_OK;
+
+    char ad[CG21_KEYSTORE_HEADER_SIZE + 4];
+    char iv[CG21_KEYSTORE_IV_SIZE];
+    char tag[CG21_KEYSTORE_TAG_SIZE];
+    char pt[CG21_KEYSTORE_CHUNK];
+    char ct[CG21_KEYSTORE_CHUNK];
+
+    CG21_KEYSTORE_plain p;
+
+    if (K->len != CG21_KEYSTORE_KEY_SIZE)
+    {
+        return CG21_KEYSTORE_INVALID_KEY;
+    }
+
+    p.region[0] = (char *)key;
+    p.len[0] = (int)sizeof(CG21_KEYSTORE_KEY);
+    p.region[1] = (char *)peers;
+    p.len[1] = ks->n * (int)sizeof(CG21_KEYSTORE_PEER);
+
+    for (int j = 0; j < CG21_KEYSTORE_IV_SIZE; j++)
+    {
+        iv[j] = (char)RAND_byte(RNG);
+    }
+
+    CG21_KEYSTORE_ad(ks, ad, ks->count);
+
+    GCM_init(&g, CG21_KEYSTORE_KEY_SIZE, K->val, CG21_KEYSTORE_IV_SIZE, iv);
+    GCM_add_header(&g, ad, sizeof(ad));
+
+    offset = CG21_KEYSTORE_HEADER_SIZE + (long)ks->count * CG21_KEYSTORE_record_size(ks);
+    if (fseek(ks->fp, offset, SEEK_SET) != 0 ||
+        fwrite(iv, 1, CG21_KEYSTORE_IV_SIZE, ks->fp) != CG21_KEYSTORE_IV_SIZE)
+    {
+        rc = CG21_KEYSTORE_IO_ERROR;
+    }
+
+    // Encrypt the key and the peers one chunk at a time
+    for (long i = 0; i < len && rc == CG21_KEYSTORE_OK; i += CG21_KEYSTORE_CHUNK)
+    {
+        int m = len - i < CG21_KEYSTORE_CHUNK ? (int)(len - i) : CG21_KEYSTORE_CHUNK;
+
+        CG21_KEYSTORE_copy(&p, i, pt, m, 1);
+        GCM_add_plain(&g, ct, pt, m);
+
+        if (fwrite(ct, 1, (size_t)m, ks->fp) != (size_t)m)
+        {
+            rc = CG21_KEYSTORE_IO_ERROR;
+        }
+    }
+
+    GCM_finish(&g, tag);
+
+    if (rc == CG21_KEYSTORE_OK &&
+        (fwrite(tag, 1, CG21_KEYSTORE_TAG_SIZE, ks->fp) != CG21_KEYSTORE_TAG_SIZE || fflush(ks->fp) != 0))
+    {
+        rc = CG21_KEYSTORE_IO_ERROR;
+    }
+
+    // clean up
+    memset(pt, 0, sizeof(pt));
+
+    if (rc != CG21_KEYSTORE_OK)
+    {
+        // Drop the partial record, so the file keeps a valid size
+        fflush(ks->fp);
+        if (ftruncate(fileno(ks->fp), offset) != 0)
+        {
+            return CG21_KEYSTORE_IO_ERROR;
+        }
+
+        return rc;
+    }
+
+    if (index != NULL)
+    {
+        *index = ks->count;
+    }
+
+    ks->count++;
+
+    return CG21_KEYSTORE_OK;
+}
+
+int CG21_KEYSTORE_LOAD(CG21_KEYSTORE *ks, const octet *K, int index, CG21_KEYSTORE_KEY *key,
+                       CG21_KEYSTORE_PEER *peers)
+{
+    gcm g;
+    long len = CG21_KEYSTORE_plain_size(ks);
+    int rc = CG21_KEYSTORE_OK;
+    char diff = 0;
+
+    char ad[CG21_KEYSTORE_HEADER_SIZE + 4];
+    char iv[CG21_KEYSTORE_IV_SIZE];
+    char tag[CG21_KEYSTORE_TAG_SIZE];
+    char t[CG21_KEYSTORE_TAG_SIZE];
+    char pt[CG21_KEYSTORE_CHUNK];
+    char ct[CG21_KEYSTORE_CHUNK];
+
+    CG21_KEYSTORE_plain p;
+
+    if (K->len != CG21_KEYSTORE_KEY_SIZE)
+    {
+        return CG21_KEYSTORE_INVALID_KEY;
+    }
+
+    if (index < 0 || index >= ks->count)
+    {
+        return CG21_KEYSTORE_INVALID_INDEX;
+    }
+
+    p.region[0] = (char *)key;
+    p.len[0] = (int)sizeof(CG21_KEYSTORE_KEY);
+    p.region[1] = (char *)peers;
+    p.len[1] = ks->n * (int)sizeof(CG21_KEYSTORE_PEER);
+
+    if (fseek(ks->fp, CG21_KEYSTORE_HEADER_SIZE + (long)index * CG21_KEYSTORE_record_size(ks), SEEK_SET) != 0 ||
+        fread(iv, 1, CG21_KEYSTORE_IV_SIZE, ks->fp) != CG21_KEYSTORE_IV_SIZE)
+    {
+        return CG21_KEYSTORE_IO_ERROR;
+    }
+
+    CG21_KEYSTORE_ad(ks, ad, index);
+
+    GCM_init(&g, CG21_KEYSTORE_KEY_SIZE, K->val, CG21_KEYSTORE_IV_SIZE, iv);
+    GCM_add_header(&g, ad, sizeof(ad));
+
+    // Decrypt the key and the peers one chunk at a time, in place
+    for (long i = 0; i < len && rc == CG21_KEYSTORE_OK; i += CG21_KEYSTORE_CHUNK)
+    {
+        int m = len - i < CG21_KEYSTORE_CHUNK ? (int)(len - i) : CG21_KEYSTORE_CHUNK;
+
+        if (fread(ct, 1, (size_t)m, ks->fp) != (size_t)m)
+        {
+            rc = CG21_KEYSTORE_IO_ERROR;
+            break;
+        }
+
+        GCM_add_cipher(&g, pt, ct, m);
+        CG21_KEYSTORE_copy(&p, i, pt, m, 0);
+    }
+
+    GCM_finish(&g, t);
+
+    if (rc == CG21_KEYSTORE_OK && fread(tag, 1, CG21_KEYSTORE_TAG_SIZE, ks->fp) != CG21_KEYSTORE_TAG_SIZE)
+    {
+        rc = CG21_KEYSTORE_IO_ERROR;
+    }
+
+    // Constant time tag comparison
+    for (int j = 0; j < CG21_KEYSTORE_TAG_SIZE; j++)
+    {
+        diff |= t[j] ^ tag[j];
+    }
+
+    if (rc == CG21_KEYSTORE_OK && diff != 0)
+    {
+        rc = CG21_KEYSTORE_INVALID_RECORD;
+    }
+
+    // clean up
+    memset(pt, 0, sizeof(pt));
+
+    if (rc != CG21_KEYSTORE_OK)
+    {
+        CG21_KEYSTORE_KEY_KILL(key);
+    }
+
+    return rc;
+}
+
+void CG21_KEYSTORE_KEY_KILL(CG21_KEYSTORE_KEY *key)
+{
+    volatile char *b = (volatile char *)key;
+
+    for (size_t i = 0; i < sizeof(CG21_KEYSTORE_KEY); i++)
+    {
+        b[i] = 0;
+    }
+}
@@ -23,11 +23,16 @@ under the License.
 #include "amcl/hash_utils.h"
 #include "amcl/ff_4096.h"
 #include "amcl/ff_2048.h"
+#include "amcl/parallel.h"
+
+/* Window of the multi-exponentiation in CG21_PI_MOD_BATCH_VERIFY_Zi, and size of its tables */
+#define CG21_PI_MOD_BATCH_WINDOW 2
+#define CG21_PI_MOD_BATCH_TABLE (CG21_PAILLIER_PROOF_ITERS << (CG21_PI_MOD_BATCH_WINDOW - 1))
 
 static void CG21_PI_MOD_GET_W(csprng *RNG, BIG_512_60 n[HFLEN_4096], BIG_512_60 ws1[HFLEN_4096]){
     while(1){
         FF_4096_randomnum(ws1, n, RNG,HFLEN_4096);
-        int rc = FF_4096_jacobi(ws1,n);
+        int rc = CG21_FF_4096_jacobi(ws1,n);
         if (rc==-1) {
             break;
         }
@@ -44,11 +49,8 @@ static void CG21_PI_MOD_GET_W(csprng *RNG, BIG_512_60 n[HFLEN_4096], BIG_512_60
 *  @param yi            generated challenges
 *  @param n             size of packed elements in SSID
 */
-static int CG21_PI_MOD_CHALLENGE(BIG_1024_58 *N, octet w, const CG21_SSID *ssid,
-                          BIG_1024_58 yi[CG21_PAILLIER_PROOF_ITERS][FFLEN_2048], int n){
-    hash256 sha;
-    hash256 sha_k;
-    HASH256_init(&sha);
+static int CG21_PI_MOD_CHALLENGE_init(hash256 *sha, BIG_1024_58 *N, octet w, const CG21_SSID *ssid, int n){
+    HASH256_init(sha);
 
     char n_[FS_2048];
     octet N_Oct = {0, sizeof(n_), n_};
@@ -60,135 +62,242 @@ static int CG21_PI_MOD_CHALLENGE(BIG_1024_58 *N, octet w, const CG21_SSID *ssid,
     octet q_oct = {0, sizeof(qq), qq};
 
     FF_2048_toOctet(&N_Oct, N, FFLEN_2048);
-    HASH_UTILS_hash_oct(&sha, &N_Oct);
-    HASH_UTILS_hash_oct(&sha, ssid->rid);
-    HASH_UTILS_hash_oct(&sha, ssid->rho);
-    HASH_UTILS_hash_oct(&sha, &w);
+    HASH_UTILS_hash_oct(sha, &N_Oct);
+    HASH_UTILS_hash_oct(sha, ssid->rid);
+    HASH_UTILS_hash_oct(sha, ssid->rho);
+    HASH_UTILS_hash_oct(sha, &w);
 
     CG21_get_G(&G_oct);
     CG21_get_q(&q_oct);
 
-    HASH_UTILS_hash_oct(&sha, &G_oct);
-    HASH_UTILS_hash_oct(&sha, &q_oct);
+    HASH_UTILS_hash_oct(sha, &G_oct);
+    HASH_UTILS_hash_oct(sha, &q_oct);
 
     // sort partial X[i] based on j_packed and process them into sha
-    int rc = CG21_hash_set_X(&sha, ssid->X_set_packed, ssid->j_set_packed, n, EFS_SECP256K1 + 1);
+    return CG21_hash_set_X(sha, ssid->X_set_packed, ssid->j_set_packed, n, EFS_SECP256K1 + 1);
+}
+
+/* Generate the i-th challenge from the hash of the common values */
+static void CG21_PI_MOD_CHALLENGE_y(const hash256 *sha, int i, BIG_1024_58 *N, BIG_1024_58 *yi){
+    hash256 sha_k;
+
+    HASH_UTILS_hash_copy(&sha_k, sha);
+    HASH_UTILS_hash_i2osp4(&sha_k, i);
+    HASH_UTILS_sample_mod_FF(&sha_k, N, yi);
+}
+
+static int CG21_PI_MOD_CHALLENGE(BIG_1024_58 *N, octet w, const CG21_SSID *ssid,
+                          BIG_1024_58 yi[CG21_PAILLIER_PROOF_ITERS][FFLEN_2048], int n){
+    hash256 sha;
+
+    int rc = CG21_PI_MOD_CHALLENGE_init(&sha, N, w, ssid, n);
     if (rc!=CG21_OK){
         return rc;
     }
 
     for (int i=0;i<CG21_PAILLIER_PROOF_ITERS;i++){
-        HASH_UTILS_hash_copy(&sha_k, &sha);
-        HASH_UTILS_hash_i2osp4(&sha_k, i);
-        HASH_UTILS_sample_mod_FF(&sha_k, N, yi[i]);
+        CG21_PI_MOD_CHALLENGE_y(&sha, i, N, yi[i]);
     }
 
     return CG21_OK;
 }
 
-static void CG21_PI_MOD_GEN_Xi(CG21_PIMOD_PROOF *pimodProof, CG21_PAILLIER_KEYS paillierKeys){
-    bool ab_[4][2]={{0,0},{0,1},{1,0},{1,1}};
+/* Shared state for the iterations of CG21_PI_MOD_GEN_Xi */
+typedef struct
+{
+    CG21_PIMOD_PROOF *pimodProof;
+    CG21_PAILLIER_KEYS *paillierKeys;
+    BIG_512_60 *n_;
+    BIG_1024_58 *n_2048;
+    int jwp;
+    int jwq;
+} CG21_PI_MOD_GEN_Xi_ctx;
+
+/* Choose (ai,bi) and compute xi for the i-th challenge */
+static void CG21_PI_MOD_GEN_Xi_iter(void *arg, int i){
+    CG21_PI_MOD_GEN_Xi_ctx *c = (CG21_PI_MOD_GEN_Xi_ctx *)arg;
+    CG21_PIMOD_PROOF *pimodProof = c->pimodProof;
+    CG21_PAILLIER_KEYS *paillierKeys = c->paillierKeys;
+
+    int jyp;
+    int jyq;
+    bool ai;
+    bool bi;
     BIG_512_60 yi_[HFLEN_4096];
     BIG_512_60 yMULw[FFLEN_4096];
-    BIG_512_60 n_[FFLEN_4096];
     BIG_1024_58 r1[FFLEN_2048];
     BIG_1024_58 r2[FFLEN_2048];
     BIG_1024_58 r11[FFLEN_2048];
     BIG_1024_58 r22[FFLEN_2048];
     BIG_1024_58 yi_2048[FFLEN_2048];
-    BIG_1024_58 n_2048[FFLEN_2048];
+    BIG_1024_58 t[HFLEN_2048];
 
     char oct[2*FS_2048];
     octet OCT = {0, sizeof(oct), oct};
 
-    FF_4096_zero(n_,FFLEN_4096);
-    FF_4096_copy(n_,paillierKeys.paillier_pk.n,HFLEN_4096);
-
-    // convert paillier_pk.n from BIG_512_60[HFLEN_4096] to BIG_1024_58[FFLEN_2048]
-    FF_4096_toOctet(&OCT, paillierKeys.paillier_pk.n, HFLEN_4096);
-    FF_2048_fromOctet(n_2048, &OCT, FFLEN_2048);
+    // Jacobi symbols of yi mod p and q
+    FF_2048_dmod(t, pimodProof->yi[i], paillierKeys->paillier_sk.p, HFLEN_2048);
+    jyp = CG21_FF_2048_jacobi(t, paillierKeys->paillier_sk.p);
 
-    // for each yi[i] we need to choose (ai,bi) from ab_ such that y'i has 4th root
-    for (int i=0;i<CG21_PAILLIER_PROOF_ITERS;i++){
+    FF_2048_dmod(t, pimodProof->yi[i], paillierKeys->paillier_sk.q, HFLEN_2048);
+    jyq = CG21_FF_2048_jacobi(t, paillierKeys->paillier_sk.q);
 
-        // convert yi from BIG_1024_58[FFLEN_2048] to y_oct
-        char oct2[2 * FS_2048];
-        octet y_oct = {0, sizeof(oct2), oct2};
-        FF_2048_toOctet(&y_oct, pimodProof->yi[i], FFLEN_2048);
+    // yi shares a factor with N, none of the combinations has a 4th root
+    if (jyp == 0 || jyq == 0 || c->jwp*c->jwq != -1){
+        return;
+    }
 
-        for (int j=0;j<4;j++){
+    /* p = q = 3 mod 4, so (-1/p) = (-1/q) = -1, and (w/p) = -(w/q) since (w/N) = -1.
+     * bi flips the symbol mod exactly one of the primes, so it is used to make
+     * the symbols mod p and q equal, then ai flips both of them to 1.
+     * This replaces the trial square roots over the four combinations of (ai,bi)
+     */
+    bi = (jyp*jyq == -1);
+    ai = ((bi ? c->jwp*jyp : jyp) == -1);
 
-            // convert y_oct to BIG_512_60[HFLEN_4096]
-            FF_4096_zero(yi_, HFLEN_4096);
-            FF_4096_fromOctet(yi_, &y_oct, HFLEN_4096);
+    // convert yi from BIG_1024_58[FFLEN_2048] to y_oct
+    char oct2[2 * FS_2048];
+    octet y_oct = {0, sizeof(oct2), oct2};
+    FF_2048_toOctet(&y_oct, pimodProof->yi[i], FFLEN_2048);
 
-            // if ai=1 -> (-1)^{ai} becomes -1 -> we compute -yi mod N = N - yi
-            // note: if ai=0 -> (-1)^{ai} becomes 0 -> we don't need to do anything
-            if (ab_[j][0]) {
-                FF_4096_sub(yi_, paillierKeys.paillier_pk.n, yi_, HFLEN_4096);
-                FF_4096_norm(yi_, HFLEN_4096);
-            }
-
-            // if bi=1 -> we compute yi = w * yi
-            if (ab_[j][1]) {
-                FF_4096_zero(yMULw, FFLEN_4096);
-                FF_4096_mul(yMULw, yi_, pimodProof->w, HFLEN_4096);
-                FF_4096_mod(yMULw, n_, FFLEN_4096);
-                FF_4096_copy(yi_, yMULw, HFLEN_4096);
-            }
+    // convert y_oct to BIG_512_60[HFLEN_4096]
+    FF_4096_zero(yi_, HFLEN_4096);
+    FF_4096_fromOctet(yi_, &y_oct, HFLEN_4096);
 
-            // convert yi_ from BIG_512_60[HFLEN_4096] to BIG_1024_58[FFLEN_2048]
-            FF_4096_toOctet(&OCT, yi_, HFLEN_4096);
-            FF_2048_fromOctet(yi_2048, &OCT, FFLEN_2048);
+    // if ai=1 -> (-1)^{ai} becomes -1 -> we compute -yi mod N = N - yi
+    // note: if ai=0 -> (-1)^{ai} becomes 0 -> we don't need to do anything
+    if (ai) {
+        FF_4096_sub(yi_, paillierKeys->paillier_pk.n, yi_, HFLEN_4096);
+        FF_4096_norm(yi_, HFLEN_4096);
+    }
 
-            // check whether yi_2048 has any square root in mod p and q
-            bool rc1 = CG21_check_sqrt_exist(yi_2048, paillierKeys.paillier_sk.p);
-            bool rc2 = CG21_check_sqrt_exist(yi_2048, paillierKeys.paillier_sk.q);
+    // if bi=1 -> we compute yi = w * yi
+    if (bi) {
+        FF_4096_zero(yMULw, FFLEN_4096);
+        FF_4096_mul(yMULw, yi_, pimodProof->w, HFLEN_4096);
+        FF_4096_mod(yMULw, c->n_, FFLEN_4096);
+        FF_4096_copy(yi_, yMULw, HFLEN_4096);
+    }
 
-            if (rc1 && rc2){
+    // convert yi_ from BIG_512_60[HFLEN_4096] to BIG_1024_58[FFLEN_2048]
+    FF_4096_toOctet(&OCT, yi_, HFLEN_4096);
+    FF_2048_fromOctet(yi_2048, &OCT, FFLEN_2048);
 
-                // 4th root of yi_2048 mod p
-                CG21_sqrt(r1,yi_2048,paillierKeys.paillier_sk.p);
-                CG21_sqrt(r11,r1,paillierKeys.paillier_sk.p);
+    // 4th root of yi_2048 mod p
+    CG21_sqrt(r1,yi_2048,paillierKeys->paillier_sk.p);
+    CG21_sqrt(r11,r1,paillierKeys->paillier_sk.p);
 
-                // 4th root of yi_2048 mod q
-                CG21_sqrt(r2,yi_2048,paillierKeys.paillier_sk.q);
-                CG21_sqrt(r22,r2,paillierKeys.paillier_sk.q);
+    // 4th root of yi_2048 mod q
+    CG21_sqrt(r2,yi_2048,paillierKeys->paillier_sk.q);
+    CG21_sqrt(r22,r2,paillierKeys->paillier_sk.q);
 
-                // combine r11 and r22 using CRT to get the final result xi
-                FF_2048_crt(pimodProof->xi[i], r11, r22, paillierKeys.paillier_sk.p, paillierKeys.paillier_sk.invpq, n_2048, HFLEN_2048);
+    // combine r11 and r22 using CRT to get the final result xi
+    FF_2048_crt(pimodProof->xi[i], r11, r22, paillierKeys->paillier_sk.p, paillierKeys->paillier_sk.invpq, c->n_2048, HFLEN_2048);
 
-                // stores ai and bi values, verifier needs these values
-                pimodProof->ab[i][0] = ab_[j][0];
-                pimodProof->ab[i][1] = ab_[j][1];
-
-                // don't need to check the other combinations of ai and bi
-                break;
-            }
-        }
-    }
+    // stores ai and bi values, verifier needs these values
+    pimodProof->ab[i][0] = ai;
+    pimodProof->ab[i][1] = bi;
 
     // clean up
     FF_4096_zero(yi_, HFLEN_4096);
     FF_4096_zero(yMULw, FFLEN_4096);
-    FF_4096_zero(n_, FFLEN_4096);
 
     FF_2048_zero(r1, FFLEN_2048);
     FF_2048_zero(r2, HFLEN_2048);
     FF_2048_zero(r11, FFLEN_2048);
     FF_2048_zero(r22, HFLEN_2048);
     FF_2048_zero(yi_2048, FFLEN_2048);
+    FF_2048_zero(t, HFLEN_2048);
+
+    OCT_clear(&OCT);
+}
+
+static void CG21_PI_MOD_GEN_Xi(CG21_PIMOD_PROOF *pimodProof, CG21_PAILLIER_KEYS paillierKeys){
+    CG21_PI_MOD_GEN_Xi_ctx ctx;
+    BIG_512_60 n_[FFLEN_4096];
+    BIG_1024_58 n_2048[FFLEN_2048];
+    BIG_1024_58 w_2048[FFLEN_2048];
+    BIG_1024_58 t[HFLEN_2048];
+
+    char oct[2*FS_2048];
+    octet OCT = {0, sizeof(oct), oct};
+
+    FF_4096_zero(n_,FFLEN_4096);
+    FF_4096_copy(n_,paillierKeys.paillier_pk.n,HFLEN_4096);
+
+    // convert paillier_pk.n from BIG_512_60[HFLEN_4096] to BIG_1024_58[FFLEN_2048]
+    FF_4096_toOctet(&OCT, paillierKeys.paillier_pk.n, HFLEN_4096);
+    FF_2048_fromOctet(n_2048, &OCT, FFLEN_2048);
+
+    // Jacobi symbols of w mod p and q, the same for all the iterations
+    FF_4096_toOctet(&OCT, pimodProof->w, HFLEN_4096);
+    FF_2048_fromOctet(w_2048, &OCT, FFLEN_2048);
+
+    FF_2048_dmod(t, w_2048, paillierKeys.paillier_sk.p, HFLEN_2048);
+    ctx.jwp = CG21_FF_2048_jacobi(t, paillierKeys.paillier_sk.p);
+
+    FF_2048_dmod(t, w_2048, paillierKeys.paillier_sk.q, HFLEN_2048);
+    ctx.jwq = CG21_FF_2048_jacobi(t, paillierKeys.paillier_sk.q);
+
+    // for each yi[i] we need to choose (ai,bi) such that y'i has 4th root
+    ctx.pimodProof = pimodProof;
+    ctx.paillierKeys = &paillierKeys;
+    ctx.n_ = n_;
+    ctx.n_2048 = n_2048;
+
+    PARALLEL_for(CG21_PI_MOD_GEN_Xi_iter, &ctx, CG21_PAILLIER_PROOF_ITERS);
+
+    // clean up
+    FF_4096_zero(n_, FFLEN_4096);
+
     FF_2048_zero(n_2048, FFLEN_2048);
+    FF_2048_zero(w_2048, FFLEN_2048);
+    FF_2048_zero(t, HFLEN_2048);
 
     OCT_clear(&OCT);
 }
 
+/* Shared state for the iterations of CG21_PI_MOD_GEN_Zi */
+typedef struct
+{
+    CG21_PIMOD_PROOF *pimodProof;
+    CG21_PAILLIER_KEYS *paillierKeys;
+    BIG_1024_58 *Mp;
+    BIG_1024_58 *Mq;
+    BIG_1024_58 *n_2048;
+} CG21_PI_MOD_GEN_Zi_ctx;
+
+/* Compute zi ← yi^T mod PQ for the i-th challenge */
+static void CG21_PI_MOD_GEN_Zi_iter(void *arg, int i){
+    CG21_PI_MOD_GEN_Zi_ctx *c = (CG21_PI_MOD_GEN_Zi_ctx *)arg;
+    CG21_PAILLIER_KEYS *paillierKeys = c->paillierKeys;
+
+    BIG_1024_58 Xp[HFLEN_2048];
+    BIG_1024_58 Xq[HFLEN_2048];
+
+    // Xp = yi % p
+    FF_2048_dmod(Xp, c->pimodProof->yi[i], paillierKeys->paillier_sk.p, HFLEN_2048);
+
+    // Xq = yi % q
+    FF_2048_dmod(Xq, c->pimodProof->yi[i], paillierKeys->paillier_sk.q, HFLEN_2048);
+
+    // Compute zi^M using Mp, Mq and CRT
+    FF_2048_ct_pow(Xp, Xp, c->Mp, paillierKeys->paillier_sk.p, HFLEN_2048, HFLEN_2048);
+    FF_2048_ct_pow(Xq, Xq, c->Mq, paillierKeys->paillier_sk.q, HFLEN_2048, HFLEN_2048);
+
+    // zi ← yi^T mod PQ, for i ∈ [1 ... m]
+    FF_2048_crt(c->pimodProof->zi[i], Xp, Xq, paillierKeys->paillier_sk.p, paillierKeys->paillier_sk.invpq, c->n_2048, HFLEN_2048);
+
+    // clean up
+    FF_2048_zero(Xp,HFLEN_2048);
+    FF_2048_zero(Xq,HFLEN_2048);
+}
+
 static void CG21_PI_MOD_GEN_Zi(CG21_PIMOD_PROOF *pimodProof, CG21_PAILLIER_KEYS paillierKeys){
 
+    CG21_PI_MOD_GEN_Zi_ctx ctx;
     BIG_1024_58 Mp[HFLEN_2048];
     BIG_1024_58 Mq[HFLEN_2048];
-    BIG_1024_58 Xp[HFLEN_2048];
-    BIG_1024_58 Xq[HFLEN_2048];
     BIG_1024_58 ws[FFLEN_2048];
     BIG_1024_58 n_2048[FFLEN_2048];
 
@@ -241,37 +350,44 @@ static void CG21_PI_MOD_GEN_Zi(CG21_PIMOD_PROOF *pimodProof, CG21_PAILLIER_KEYS
     FF_4096_toOctet(&OCT, paillierKeys.paillier_pk.n, HFLEN_4096);
     FF_2048_fromOctet(n_2048, &OCT, FFLEN_2048);
 
-    for (int i=0; i<CG21_PAILLIER_PROOF_ITERS;i++){
-
-        // Xp = yi % p
-        FF_2048_dmod(Xp, pimodProof->yi[i], paillierKeys.paillier_sk.p, HFLEN_2048);
+    ctx.pimodProof = pimodProof;
+    ctx.paillierKeys = &paillierKeys;
+    ctx.Mp = Mp;
+    ctx.Mq = Mq;
+    ctx.n_2048 = n_2048;
 
-        // Xq = yi % q
-        FF_2048_dmod(Xq, pimodProof->yi[i], paillierKeys.paillier_sk.q, HFLEN_2048);
-
-        // Compute zi^M using Mp, Mq and CRT
-        FF_2048_ct_pow(Xp, Xp, Mp, paillierKeys.paillier_sk.p, HFLEN_2048, HFLEN_2048);
-        FF_2048_ct_pow(Xq, Xq, Mq, paillierKeys.paillier_sk.q, HFLEN_2048, HFLEN_2048);
-
-        // zi ← yi^T mod PQ, for i ∈ [1 ... m]
-        FF_2048_crt(pimodProof->zi[i], Xp, Xq, paillierKeys.paillier_sk.p, paillierKeys.paillier_sk.invpq, n_2048, HFLEN_2048);
-    }
+    PARALLEL_for(CG21_PI_MOD_GEN_Zi_iter, &ctx, CG21_PAILLIER_PROOF_ITERS);
 
     // clean up
     FF_2048_zero(Mp,HFLEN_2048);
     FF_2048_zero(Mq,HFLEN_2048);
-    FF_2048_zero(Xp,HFLEN_2048);
-    FF_2048_zero(Xq,FFLEN_2048);
     FF_2048_zero(ws,FFLEN_2048);
 }
 
-static void boolToChar(const bool arr[][2], char* result) {
-    for(int i=0; i<CG21_PAILLIER_PROOF_ITERS; i++) {
-        result[i*2] = arr[i][0] ? '1' : '0';
-        result[i*2+1] = arr[i][1] ? '1' : '0';
+/* Pack (ai,bi) as a bitmap, ai in bit 2i and bi in bit 2i+1, most significant bit first */
+static void CG21_PI_MOD_ab_toBits(const bool arr[][2], char *bits) {
+    for (int k = 0; k < CG21_PAILLIER_PROOF_AB_SIZE; k++) {
+        bits[k] = 0;
+    }
+
+    for (int i = 0; i < CG21_PAILLIER_PROOF_ITERS; i++) {
+        for (int j = 0; j < 2; j++) {
+            if (arr[i][j]) {
+                bits[(2*i+j) / 8] |= (char)(0x80 >> ((2*i+j) % 8));
+            }
+        }
+    }
+}
+
+static void CG21_PI_MOD_ab_fromBits(const char *bits, bool arr[][2]) {
+    for (int i = 0; i < CG21_PAILLIER_PROOF_ITERS; i++) {
+        for (int j = 0; j < 2; j++) {
+            arr[i][j] = (bits[(2*i+j) / 8] & (0x80 >> ((2*i+j) % 8))) != 0;
+        }
     }
 }
 
+/* Legacy encoding of (ai,bi) as a string of '0'/'1' characters */
 static void charToBool(const char* str, bool arr[][2]) {
     for(int i=0; i<CG21_PAILLIER_PROOF_ITERS; i++) {
         arr[i][0] = (str[i*2] == '1') ? true : false;
@@ -279,9 +395,31 @@ static void charToBool(const char* str, bool arr[][2]) {
     }
 }
 
-static int CG21_PI_MOD_proof_fromOCTET(CG21_PIMOD_PROOF_OCT *paillierProof, CG21_PIMOD_PROOF *pimodProof){
-    char result2[CG21_PAILLIER_PROOF_ITERS*2+1];
+/* Decode (ai,bi) from a bitmap, a legacy string, or nothing, in which case they are recovered from xi */
+static int CG21_PI_MOD_ab_fromOctet(const octet *AB, bool ab[][2], int *recover_ab){
+    *recover_ab = 0;
+    if (AB->len == CG21_PAILLIER_PROOF_AB_SIZE)
+    {
+        CG21_PI_MOD_ab_fromBits(AB->val, ab);
+    }
+    else if (AB->len == 2 * CG21_PAILLIER_PROOF_ITERS)
+    {
+        charToBool(AB->val, ab);
+    }
+    else if (AB->len == 0)
+    {
+        *recover_ab = 1;
+    }
+    else
+    {
+        return CG21_PAILLIER_PROOF_INVALID;
+    }
 
+    return CG21_OK;
+}
+
+static int CG21_PI_MOD_proof_fromOCTET(CG21_PIMOD_PROOF_OCT *paillierProof, CG21_PIMOD_PROOF *pimodProof,
+                                       int *recover_ab){
     char w[FS_2048];
     octet W = {0, sizeof(w), w};
 
@@ -309,17 +447,20 @@ static int CG21_PI_MOD_proof_fromOCTET(CG21_PIMOD_PROOF_OCT *paillierProof, CG21
     FF_4096_fromOctet(pimodProof->w, paillierProof->w, HFLEN_4096);
 
     // convert ab from octet to ab[CG21_PAILLIER_PROOF_ITERS][2]
-    OCT_toStr(paillierProof->ab, result2);
-    charToBool(result2, pimodProof->ab);
-
-    return CG21_OK;
+    return CG21_PI_MOD_ab_fromOctet(paillierProof->ab, pimodProof->ab, recover_ab);
 }
 
-static void CG21_PI_MOD_proof_toOctet(CG21_PIMOD_PROOF_OCT *paillierProof, CG21_PIMOD_PROOF pimodProof)
+static int CG21_PI_MOD_proof_toOctet(CG21_PIMOD_PROOF_OCT *paillierProof, CG21_PIMOD_PROOF pimodProof)
 {
     char w[FS_2048];
     octet W = {0, sizeof(w), w};
 
+    // the bitmap is written in place, check it fits
+    if (paillierProof->ab->max < CG21_PAILLIER_PROOF_AB_SIZE)
+    {
+        return CG21_UTILITIES_WRONG_PACKED_SIZE;
+    }
+
     OCT_clear(paillierProof->x);
     OCT_clear(paillierProof->z);
 
@@ -333,12 +474,11 @@ static void CG21_PI_MOD_proof_toOctet(CG21_PIMOD_PROOF_OCT *paillierProof, CG21_
         OCT_joctet(paillierProof->z, &W);
     }
 
-    char result[CG21_PAILLIER_PROOF_ITERS*2+1];
-    boolToChar(pimodProof.ab, result);
-    result[CG21_PAILLIER_PROOF_ITERS*2] = '\0';  // add null terminator to result string
-
     OCT_clear(paillierProof->ab);
-    OCT_jstring(paillierProof->ab,result);
+    CG21_PI_MOD_ab_toBits(pimodProof.ab, paillierProof->ab->val);
+    paillierProof->ab->len = CG21_PAILLIER_PROOF_AB_SIZE;
+
+    return CG21_OK;
 }
 
 int CG21_PI_MOD_PROVE(csprng *RNG, CG21_PAILLIER_KEYS paillierKeys,
@@ -371,24 +511,260 @@ int CG21_PI_MOD_PROVE(csprng *RNG, CG21_PAILLIER_KEYS paillierKeys,
     CG21_PI_MOD_GEN_Zi(&pimodProof, paillierKeys);
 
     // convert the proofs into octet
-    CG21_PI_MOD_proof_toOctet(paillierProof, pimodProof);
+    return CG21_PI_MOD_proof_toOctet(paillierProof, pimodProof);
+}
+
+/* Reject N with a prime factor below CG21_PI_MOD_BATCH_SIEVE, returns 1 if N has such a factor */
+static int CG21_PI_MOD_small_factor(BIG_1024_58 N[FFLEN_2048]){
+    sign32 sf=1;
+
+    for (sign32 p=3; p<CG21_PI_MOD_BATCH_SIEVE; p+=2){
+        bool prime = true;
+        for (sign32 d=3; d*d<=p; d+=2){
+            if (p%d==0){
+                prime = false;
+                break;
+            }
+        }
+        if (!prime){
+            continue;
+        }
+
+        // flush the product of primes once it would no longer fit in a sign32
+        if (sf > 0x7FFFFFFF/p){
+            if (FF_2048_cfactor(N, sf, FFLEN_2048)){
+                return 1;
+            }
+            sf=1;
+        }
+        sf*=p;
+    }
+
+    return FF_2048_cfactor(N, sf, FFLEN_2048);
+}
+
+/* Precompute the Montgomery tables of the bases b_i for CG21_PI_MOD_small_multi_pow */
+static void CG21_PI_MOD_small_precompute(BIG_1024_58 *T[CG21_PI_MOD_BATCH_TABLE], BIG_1024_58 t[CG21_PI_MOD_BATCH_TABLE][FFLEN_2048],
+                                         BIG_1024_58 b[CG21_PAILLIER_PROOF_ITERS][FFLEN_2048],
+                                         BIG_1024_58 N[FFLEN_2048], BIG_1024_58 ND[FFLEN_2048]){
+    BIG_1024_58 *B[CG21_PAILLIER_PROOF_ITERS];
+
+    for (int i=0; i<CG21_PAILLIER_PROOF_ITERS; i++){
+        B[i] = b[i];
+    }
+
+    for (int i=0; i<CG21_PI_MOD_BATCH_TABLE; i++){
+        T[i] = t[i];
+    }
+
+    FF_2048_bi_precompute(B, T, CG21_PAILLIER_PROOF_ITERS, CG21_PI_MOD_BATCH_WINDOW, N, ND, FFLEN_2048);
+}
+
+/* Set r = prod_i b_i^e_i mod N, for the bases precomputed in T and small exponents e_i.
+ * The products and squares stay in the Montgomery domain, and the squares are
+ * shared by all the bases */
+static void CG21_PI_MOD_small_multi_pow(BIG_1024_58 r[FFLEN_2048], BIG_1024_58 *T[CG21_PI_MOD_BATCH_TABLE],
+                                        BIG_1024_58 e[CG21_PAILLIER_PROOF_ITERS][1],
+                                        BIG_1024_58 N[FFLEN_2048], BIG_1024_58 ND[FFLEN_2048]){
+    BIG_1024_58 *E[CG21_PAILLIER_PROOF_ITERS];
+
+    for (int i=0; i<CG21_PAILLIER_PROOF_ITERS; i++){
+        E[i] = e[i];
+    }
+
+    FF_2048_bi_pow(r, T, E, CG21_PAILLIER_PROOF_ITERS, CG21_PI_MOD_BATCH_WINDOW, N, ND, FFLEN_2048, 1);
+}
+
+/* Check zi^N = yi, returns 0 if it holds */
+static int CG21_PI_MOD_check_Zi(BIG_1024_58 *zi, BIG_1024_58 *yi, BIG_1024_58 *n_2048){
+    BIG_1024_58 ws[FFLEN_2048];
+
+    FF_2048_nt_pow(ws, zi, n_2048, n_2048, FFLEN_2048, FFLEN_2048);
+
+    return FF_2048_comp(ws, yi, FFLEN_2048);
+}
+
+/* Compare ws with (-1)^a w^b yi mod N, returns 0 if they are equal */
+static int CG21_PI_MOD_check_Xi_ab(BIG_1024_58 *ws, BIG_1024_58 *yi, BIG_512_60 *w, BIG_512_60 *n_, bool a, bool b){
+    BIG_512_60 yi_[HFLEN_4096];
+    BIG_512_60 yMULw[FFLEN_4096];
+    BIG_1024_58 yi_2048[FFLEN_2048];
+
+    char oct[2*FS_2048];
+    octet OCT = {0, sizeof(oct), oct};
+
+    char oct2[2 * FS_2048];
+    octet y_oct = {0, sizeof(oct2), oct2};
+    FF_2048_toOctet(&y_oct, yi, FFLEN_2048);
+
+    FF_4096_zero(yi_, HFLEN_4096);
+    FF_4096_fromOctet(yi_, &y_oct, HFLEN_4096);
+    // if ai=1 -> (-1)^{ai} becomes -1 -> we compute -yi mod N = N - yi
+    // note: if ai=0 -> (-1)^{ai} becomes 0 -> we don't need to do anything
+    if (a) {
+        FF_4096_sub(yi_, n_, yi_, HFLEN_4096);
+        FF_4096_norm(yi_, HFLEN_4096);
+    }
+
+    // if bi=1 -> we compute yi = w * yi
+    if (b) {
+        FF_4096_zero(yMULw, FFLEN_4096);
+        FF_4096_mul(yMULw, yi_, w, HFLEN_4096);
+        FF_4096_mod(yMULw, n_, FFLEN_4096);
+        FF_4096_copy(yi_, yMULw, HFLEN_4096);
+    }
+
+    FF_4096_toOctet(&OCT, yi_, HFLEN_4096);
+    FF_2048_fromOctet(yi_2048, &OCT, FFLEN_2048);
+
+    return FF_2048_comp(ws, yi_2048, FFLEN_2048);
+}
+
+/* Check xi^4 = (-1)^ai w^bi yi, returns 0 if it holds.
+ * With recover_ab set, ab is the (ai,bi) for which this holds on exit */
+static int CG21_PI_MOD_check_Xi(BIG_1024_58 *xi, BIG_1024_58 *yi, BIG_512_60 *w, BIG_512_60 *n_,
+                                BIG_1024_58 *n_2048, bool ab[2], int recover_ab){
+    BIG_1024_58 ws[FFLEN_2048];
+
+    FF_2048_nt_pow_int(ws, xi, 4, n_2048, FFLEN_2048);
+
+    if (!recover_ab) {
+        return CG21_PI_MOD_check_Xi_ab(ws, yi, w, n_, ab[0], ab[1]);
+    }
+
+    int rc = 1;
+    for (int k = 0; k < 4 && rc != 0; k++) {
+        ab[0] = (k & 1) != 0;
+        ab[1] = (k & 2) != 0;
+        rc = CG21_PI_MOD_check_Xi_ab(ws, yi, w, n_, ab[0], ab[1]);
+    }
+
+    return rc;
+}
+
+/* Shared state for the iterations of the PiMod verification */
+typedef struct
+{
+    CG21_PIMOD_PROOF *pimodProof;
+    BIG_512_60 *n_;
+    BIG_1024_58 *n_2048;
+    int recover_ab;
+    int *rc;
+} CG21_PI_MOD_VERIFY_ctx;
+
+/* Check zi^N = yi for the i-th challenge */
+static void CG21_PI_MOD_VERIFY_Zi_iter(void *arg, int i){
+    CG21_PI_MOD_VERIFY_ctx *c = (CG21_PI_MOD_VERIFY_ctx *)arg;
+
+    c->rc[i] = CG21_PI_MOD_check_Zi(c->pimodProof->zi[i], c->pimodProof->yi[i], c->n_2048);
+}
+
+/* Check xi^4 = (-1)^ai w^bi yi for the i-th challenge */
+static void CG21_PI_MOD_VERIFY_Xi_iter(void *arg, int i){
+    CG21_PI_MOD_VERIFY_ctx *c = (CG21_PI_MOD_VERIFY_ctx *)arg;
+    CG21_PIMOD_PROOF *pimodProof = c->pimodProof;
+
+    c->rc[i] = CG21_PI_MOD_check_Xi(pimodProof->xi[i], pimodProof->yi[i], pimodProof->w, c->n_,
+                                    c->n_2048, pimodProof->ab[i], c->recover_ab);
+}
+
+/* Run one of the verification iterations for all the challenges */
+static int CG21_PI_MOD_VERIFY_all(PARALLEL_task task, CG21_PI_MOD_VERIFY_ctx *ctx){
+    int rc[CG21_PAILLIER_PROOF_ITERS];
+
+    ctx->rc = rc;
+    PARALLEL_for(task, ctx, CG21_PAILLIER_PROOF_ITERS);
+    ctx->rc = NULL;
+
+    for (int i=0; i<CG21_PAILLIER_PROOF_ITERS;i++){
+        if (rc[i] != 0)
+        {
+            return CG21_PAILLIER_PROVE_FAIL;
+        }
+    }
 
     return CG21_OK;
 }
 
-int CG21_PI_MOD_VERIFY(CG21_PIMOD_PROOF_OCT *paillierProof, const CG21_SSID *ssid, PAILLIER_public_key pk, int n){
+/* Check zi^N = yi for all the iterations, one by one */
+static int CG21_PI_MOD_VERIFY_Zi(CG21_PIMOD_PROOF *pimodProof, BIG_1024_58 n_2048[FFLEN_2048]){
+    CG21_PI_MOD_VERIFY_ctx ctx;
+
+    ctx.pimodProof = pimodProof;
+    ctx.n_ = NULL;
+    ctx.n_2048 = n_2048;
+    ctx.recover_ab = 0;
+
+    return CG21_PI_MOD_VERIFY_all(CG21_PI_MOD_VERIFY_Zi_iter, &ctx);
+}
+
+/* Check zi^N = yi for all the iterations at once
+ *
+ * For random small ei check (prod_i zi^ei)^N = prod_i yi^ei, so only one full
+ * exponentiation by N is needed per round. A failing zi only passes if its error
+ * has a small order dividing N, which is ruled out by trial division of N and by
+ * repeating the check with independent exponents. On failure the iterations are
+ * checked one by one, so the result is the same as CG21_PI_MOD_VERIFY_Zi
+ */
+static int CG21_PI_MOD_BATCH_VERIFY_Zi(csprng *RNG, CG21_PIMOD_PROOF *pimodProof, BIG_1024_58 n_2048[FFLEN_2048]){
+    char eb[CG21_PI_MOD_BATCH_BITS/8];
+    BIG_1024_58 e[CG21_PAILLIER_PROOF_ITERS][1];
+    BIG_1024_58 nd[FFLEN_2048];
+    BIG_1024_58 zacc[FFLEN_2048];
+    BIG_1024_58 yacc[FFLEN_2048];
+    BIG_1024_58 ws[FFLEN_2048];
+
+    // the tables only depend on the bases, so they are shared by all the rounds
+    BIG_1024_58 zt[CG21_PI_MOD_BATCH_TABLE][FFLEN_2048];
+    BIG_1024_58 yt[CG21_PI_MOD_BATCH_TABLE][FFLEN_2048];
+    BIG_1024_58 *ZT[CG21_PI_MOD_BATCH_TABLE];
+    BIG_1024_58 *YT[CG21_PI_MOD_BATCH_TABLE];
+
+    if (CG21_PI_MOD_small_factor(n_2048)){
+        return CG21_PI_MOD_VERIFY_Zi(pimodProof, n_2048);
+    }
+
+    FF_2048_invmod2m(nd, n_2048, FFLEN_2048);
+
+    CG21_PI_MOD_small_precompute(ZT, zt, pimodProof->zi, n_2048, nd);
+    CG21_PI_MOD_small_precompute(YT, yt, pimodProof->yi, n_2048, nd);
+
+    for (int k=0; k<CG21_PI_MOD_BATCH_ROUNDS; k++){
+
+        // random small exponents, unknown to the prover
+        for (int i=0; i<CG21_PAILLIER_PROOF_ITERS; i++){
+            for (int j=0; j<CG21_PI_MOD_BATCH_BITS/8; j++){
+                eb[j] = RAND_byte(RNG);
+            }
+            BIG_1024_58_fromBytesLen(e[i][0], eb, CG21_PI_MOD_BATCH_BITS/8);
+        }
+
+        CG21_PI_MOD_small_multi_pow(zacc, ZT, e, n_2048, nd);
+        CG21_PI_MOD_small_multi_pow(yacc, YT, e, n_2048, nd);
+
+        FF_2048_nt_pow(ws, zacc, n_2048, n_2048, FFLEN_2048, FFLEN_2048);
+
+        if (FF_2048_comp(ws, yacc, FFLEN_2048) != 0)
+        {
+            // fallback to the individual checks
+            return CG21_PI_MOD_VERIFY_Zi(pimodProof, n_2048);
+        }
+    }
+
+    return CG21_OK;
+}
+
+static int CG21_PI_MOD_VERIFY_COMMON(csprng *RNG, CG21_PIMOD_PROOF_OCT *paillierProof, const CG21_SSID *ssid,
+                                     PAILLIER_public_key pk, int n){
 
     BIG_512_60 r[HFLEN_4096];
     BIG_512_60 num2[HFLEN_4096];
-    BIG_512_60 yi_[HFLEN_4096];
-    BIG_512_60 yMULw[FFLEN_4096];
     BIG_512_60 n_[FFLEN_4096];
 
-    BIG_1024_58 ws[FFLEN_2048];
     BIG_1024_58 n_2048[FFLEN_2048];
-    BIG_1024_58 yi_2048[FFLEN_2048];
 
     CG21_PIMOD_PROOF pimodProof;
+    CG21_PI_MOD_VERIFY_ctx ctx;
 
     char oct[2*FS_2048];
     octet OCT = {0, sizeof(oct), oct};
@@ -411,7 +787,7 @@ int CG21_PI_MOD_VERIFY(CG21_PIMOD_PROOF_OCT *paillierProof, const CG21_SSID *ssi
         return CG21_PAILLIER_N_IS_EVEN;
     }
 
-    int rc = CG21_PI_MOD_proof_fromOCTET(paillierProof, &pimodProof);
+    int rc = CG21_PI_MOD_proof_fromOCTET(paillierProof, &pimodProof, &ctx.recover_ab);
     if (rc != CG21_OK){
         return rc;
     }
@@ -422,48 +798,160 @@ int CG21_PI_MOD_VERIFY(CG21_PIMOD_PROOF_OCT *paillierProof, const CG21_SSID *ssi
         return rc;
     }
 
-    for (int i=0; i<CG21_PAILLIER_PROOF_ITERS;i++){
+    if (RNG == NULL){
+        rc = CG21_PI_MOD_VERIFY_Zi(&pimodProof, n_2048);
+    }
+    else{
+        rc = CG21_PI_MOD_BATCH_VERIFY_Zi(RNG, &pimodProof, n_2048);
+    }
+    if (rc != CG21_OK){
+        return rc;
+    }
 
-        FF_2048_nt_pow(ws, pimodProof.zi[i], n_2048, n_2048, FFLEN_2048, FFLEN_2048);
+    ctx.pimodProof = &pimodProof;
+    ctx.n_ = n_;
+    ctx.n_2048 = n_2048;
 
-        // These values are all public, so it is ok to terminate early
-        if (FF_2048_comp(ws, pimodProof.yi[i], FFLEN_2048) != 0)
-        {
-            return CG21_PAILLIER_PROVE_FAIL;
-        }
+    return CG21_PI_MOD_VERIFY_all(CG21_PI_MOD_VERIFY_Xi_iter, &ctx);
+}
+
+int CG21_PI_MOD_VERIFY_STREAM_INIT(CG21_PI_MOD_STREAM *S, const octet *W, const octet *AB, const CG21_SSID *ssid,
+                                   PAILLIER_public_key pk, int n){
+    BIG_512_60 r[HFLEN_4096];
+    BIG_512_60 num2[HFLEN_4096];
+
+    char oct[2*FS_2048];
+    octet OCT = {0, sizeof(oct), oct};
+
+    S->next = 0;
+
+    FF_4096_zero(S->n_,FFLEN_4096);
+    FF_4096_copy(S->n_,pk.n,HFLEN_4096);
+
+    // convert paillier_pk.n from BIG_512_60[HFLEN_4096] to BIG_1024_58[FFLEN_2048]
+    FF_4096_toOctet(&OCT, pk.n, HFLEN_4096);
+    FF_2048_fromOctet(S->n_2048, &OCT, FFLEN_2048);
+
+    FF_4096_init(num2,2,HFLEN_4096);
+    FF_4096_copy(r,pk.n,HFLEN_4096);
+
+    // r = n % 2
+    FF_4096_mod(r, num2,HFLEN_4096);
+
+    // n should be an odd composite number
+    if (FF_4096_iszilch(r, HFLEN_4096)){
+        return CG21_PAILLIER_N_IS_EVEN;
     }
 
-    for (int i=0; i<CG21_PAILLIER_PROOF_ITERS;i++){
-        char oct2[2 * FS_2048];
-        octet y_oct = {0, sizeof(oct2), oct2};
-        FF_2048_toOctet(&y_oct, pimodProof.yi[i], FFLEN_2048);
-
-        FF_4096_zero(yi_, HFLEN_4096);
-        FF_4096_fromOctet(yi_, &y_oct, HFLEN_4096);
-        // if ai=1 -> (-1)^{ai} becomes -1 -> we compute -yi mod N = N - yi
-        // note: if ai=0 -> (-1)^{ai} becomes 0 -> we don't need to do anything
-        if (pimodProof.ab[i][0]) {
-            FF_4096_sub(yi_, pk.n, yi_, HFLEN_4096);
-            FF_4096_norm(yi_, HFLEN_4096);
-        }
+    int rc = CG21_PI_MOD_ab_fromOctet(AB, S->ab, &S->recover_ab);
+    if (rc != CG21_OK){
+        return rc;
+    }
 
-        // if bi=1 -> we compute yi = w * yi
-        if (pimodProof.ab[i][1]) {
-            FF_4096_zero(yMULw, FFLEN_4096);
-            FF_4096_mul(yMULw, yi_, pimodProof.w, HFLEN_4096);
-            FF_4096_mod(yMULw, n_, FFLEN_4096);
-            FF_4096_copy(yi_, yMULw, HFLEN_4096);
-        }
+    // w is copied, since decoding reads from a mutable octet
+    OCT_clear(&OCT);
+    OCT_joctet(&OCT, W);
 
-        FF_4096_toOctet(&OCT, yi_, HFLEN_4096);
-        FF_2048_fromOctet(yi_2048, &OCT, FFLEN_2048);
-        FF_2048_nt_pow_int(ws,pimodProof.xi[i],4,n_2048,FFLEN_2048);
+    FF_4096_zero(S->w, HFLEN_4096);
+    FF_4096_fromOctet(S->w, &OCT, HFLEN_4096);
 
-        if (FF_2048_comp(ws, yi_2048, FFLEN_2048) != 0)
-        {
+    return CG21_PI_MOD_CHALLENGE_init(&S->sha, S->n_2048, OCT, ssid, n);
+}
+
+/* Shared state for the iterations of a chunk of the PiMod verification */
+typedef struct
+{
+    CG21_PI_MOD_STREAM *S;
+    const octet *X;
+    const octet *Z;
+    int *rc;
+} CG21_PI_MOD_STREAM_ctx;
+
+/* Decode and check the i-th iteration of a chunk */
+static void CG21_PI_MOD_STREAM_iter(void *arg, int i){
+    CG21_PI_MOD_STREAM_ctx *c = (CG21_PI_MOD_STREAM_ctx *)arg;
+    CG21_PI_MOD_STREAM *S = c->S;
+
+    BIG_1024_58 xi[FFLEN_2048];
+    BIG_1024_58 yi[FFLEN_2048];
+    BIG_1024_58 zi[FFLEN_2048];
+
+    octet V = {FS_2048, FS_2048, c->X->val + i * FS_2048};
+    FF_2048_fromOctet(xi, &V, FFLEN_2048);
+
+    V.val = c->Z->val + i * FS_2048;
+    FF_2048_fromOctet(zi, &V, FFLEN_2048);
+
+    CG21_PI_MOD_CHALLENGE_y(&S->sha, S->next + i, S->n_2048, yi);
+
+    c->rc[i] = CG21_PI_MOD_check_Zi(zi, yi, S->n_2048);
+    if (c->rc[i] == 0){
+        c->rc[i] = CG21_PI_MOD_check_Xi(xi, yi, S->w, S->n_, S->n_2048, S->ab[S->next + i], S->recover_ab);
+    }
+}
+
+int CG21_PI_MOD_VERIFY_STREAM_UPDATE(CG21_PI_MOD_STREAM *S, const octet *X, const octet *Z){
+    CG21_PI_MOD_STREAM_ctx ctx;
+
+    if (X->len != Z->len || X->len <= 0 || X->len % FS_2048 != 0){
+        return CG21_PAILLIER_PROOF_INVALID;
+    }
+
+    int k = X->len / FS_2048;
+    if (k > CG21_PAILLIER_PROOF_ITERS - S->next){
+        return CG21_PAILLIER_PROOF_INVALID;
+    }
+
+    int rc[k];
+
+    ctx.S = S;
+    ctx.X = X;
+    ctx.Z = Z;
+    ctx.rc = rc;
+
+    PARALLEL_for(CG21_PI_MOD_STREAM_iter, &ctx, k);
+
+    for (int i=0; i<k; i++){
+        if (rc[i] != 0){
             return CG21_PAILLIER_PROVE_FAIL;
         }
     }
 
+    S->next += k;
+
     return CG21_OK;
 }
+
+int CG21_PI_MOD_VERIFY_STREAM_FINAL(const CG21_PI_MOD_STREAM *S){
+    if (S->next != CG21_PAILLIER_PROOF_ITERS){
+        return CG21_PAILLIER_PROOF_INVALID;
+    }
+
+    return CG21_OK;
+}
+
+int CG21_PI_MOD_VERIFY(CG21_PIMOD_PROOF_OCT *paillierProof, const CG21_SSID *ssid, PAILLIER_public_key pk, int n){
+    CG21_PI_MOD_STREAM S;
+
+    if (paillierProof->x->len != CG21_PAILLIER_PROOF_SIZE || paillierProof->z->len != CG21_PAILLIER_PROOF_SIZE){
+        return CG21_PAILLIER_PROOF_INVALID;
+    }
+
+    int rc = CG21_PI_MOD_VERIFY_STREAM_INIT(&S, paillierProof->w, paillierProof->ab, ssid, pk, n);
+    if (rc != CG21_OK){
+        return rc;
+    }
+
+    // the proof is in memory, so all the iterations are checked in a single chunk
+    rc = CG21_PI_MOD_VERIFY_STREAM_UPDATE(&S, paillierProof->x, paillierProof->z);
+    if (rc != CG21_OK){
+        return rc;
+    }
+
+    return CG21_PI_MOD_VERIFY_STREAM_FINAL(&S);
+}
+
+int CG21_PI_MOD_VERIFY_BATCH(csprng *RNG, CG21_PIMOD_PROOF_OCT *paillierProof, const CG21_SSID *ssid,
+                             PAILLIER_public_key pk, int n){
+    return CG21_PI_MOD_VERIFY_COMMON(RNG, paillierProof, ssid, pk, n);
+}
@@ -17,6 +17,7 @@ specific language governing permissions and limitations
 under the License.
 */
 
+#include <string.h>
 #include "amcl/cg21/cg21_pi_prm.h"
 
 static void CG21_PI_PRM_PROOF_to_OCT(CG21_PIPRM_PROOF *proof, CG21_PIPRM_PROOF_OCT *proofOct){
@@ -89,31 +90,184 @@ int CG21_PI_PRM_OCT_to_PROOF(CG21_PIPRM_PROOF *proof, CG21_PIPRM_PROOF_OCT *proo
     return CG21_OK;
 }
 
-int CG21_PI_PRM_VERIFY(PEDERSEN_PUB *pub, const CG21_SSID *ssid, CG21_PIPRM_PROOF_OCT *proofOct, int n){
+int CG21_PI_PRM_VERIFY_STREAM_INIT(CG21_PI_PRM_STREAM *S, PEDERSEN_PUB *pub, const CG21_SSID *ssid, int n){
+    S->pub = pub;
+    S->committed = 0;
 
-    CG21_PIPRM_PROOF proof;
+    HASH256_init(&S->crho);
+    HASH256_init(&S->cirho);
+    HASH256_init(&S->urho);
+    HASH256_init(&S->uirho);
 
+    int rc = HDLOG_challenge_CG21_init(&S->sha, pub->N, pub->b0, pub->b1, (const HDLOG_SSID *) ssid, n);
+    if (rc != HDLOG_OK)
+    {
+        return rc;
+    }
+
+    rc = HDLOG_challenge_CG21_init(&S->isha, pub->N, pub->b1, pub->b0, (const HDLOG_SSID *) ssid, n);
+    if (rc != HDLOG_OK)
+    {
+        return rc;
+    }
+
+    return CG21_OK;
+}
+
+int CG21_PI_PRM_VERIFY_STREAM_COMMIT(CG21_PI_PRM_STREAM *S, const octet *rho, const octet *irho){
     char e[HDLOG_CHALLENGE_SIZE];
     octet E = {0, sizeof(e), e};
 
-    // load proof from octet
-    CG21_PI_PRM_OCT_to_PROOF(&proof, proofOct);
+    if (rho->len != irho->len || rho->len <= 0 || rho->len % FS_2048 != 0)
+    {
+        return CG21_PI_PRM_INVALID_FORMAT;
+    }
+
+    int k = rho->len / FS_2048;
+    if (k > HDLOG_PROOF_ITERS - S->committed)
+    {
+        return CG21_PI_PRM_INVALID_FORMAT;
+    }
+
+    HDLOG_challenge_CG21_update(&S->sha, rho);
+    HDLOG_challenge_CG21_update(&S->isha, irho);
+    HASH_UTILS_hash_oct(&S->crho, rho);
+    HASH_UTILS_hash_oct(&S->cirho, irho);
+    S->committed += k;
+
+    // all the commitments are bound, the proofs can be checked
+    if (S->committed == HDLOG_PROOF_ITERS)
+    {
+        HDLOG_challenge_CG21_final(&S->sha, &E);
+        if (HDLOG_verify_init(&S->v, S->pub->N, S->pub->b0, S->pub->b1, &E) != HDLOG_OK)
+        {
+            return CG21_PI_PRM_INVALID_FORMAT;
+        }
+
+        HDLOG_challenge_CG21_final(&S->isha, &E);
+        if (HDLOG_verify_init(&S->iv, S->pub->N, S->pub->b1, S->pub->b0, &E) != HDLOG_OK)
+        {
+            return CG21_PI_PRM_INVALID_FORMAT;
+        }
+    }
+
+    return CG21_OK;
+}
+
+int CG21_PI_PRM_VERIFY_STREAM_UPDATE(CG21_PI_PRM_STREAM *S, const octet *rho, const octet *irho,
+                                     const octet *t, const octet *it){
+    if (S->committed != HDLOG_PROOF_ITERS)
+    {
+        return CG21_PI_PRM_INVALID_FORMAT;
+    }
 
     // Verify knowledge of DLOG of b1
-    HDLOG_challenge_CG21(pub->N, pub->b0, pub->b1, proof.rho, (const HDLOG_SSID *) ssid, &E, n);
-    int rc = HDLOG_verify(pub->N, pub->b0, pub->b1, proof.rho, &E, proof.t);
+    int rc = HDLOG_verify_chunk(&S->v, rho, t);
+    if (rc == HDLOG_INVALID_VALUES)
+    {
+        return CG21_PI_PRM_INVALID_FORMAT;
+    }
     if (rc != HDLOG_OK)
     {
         return CG21_PI_PRM_INVALID_PROOF;
     }
 
-    // Verify knowledge of DLOG of b1
-    HDLOG_challenge_CG21(pub->N, pub->b1, pub->b0, proof.irho, (const HDLOG_SSID *) ssid, &E, n);
-    rc = HDLOG_verify(pub->N, pub->b1, pub->b0, proof.irho, &E, proof.it);
+    // Verify knowledge of DLOG of b0
+    rc = HDLOG_verify_chunk(&S->iv, irho, it);
+    if (rc == HDLOG_INVALID_VALUES)
+    {
+        return CG21_PI_PRM_INVALID_FORMAT;
+    }
     if (rc != HDLOG_OK)
     {
         return CG21_PI_PRM_INVALID_PROOF;
     }
 
+    HASH_UTILS_hash_oct(&S->urho, rho);
+    HASH_UTILS_hash_oct(&S->uirho, irho);
+
     return CG21_OK;
 }
+
+/* Check that the same commitments were hashed into a and b */
+static int CG21_PI_PRM_same(hash256 a, hash256 b){
+    char da[SHA256];
+    char db[SHA256];
+
+    HASH256_hash(&a, da);
+    HASH256_hash(&b, db);
+
+    return memcmp(da, db, SHA256) == 0;
+}
+
+int CG21_PI_PRM_VERIFY_STREAM_FINAL(const CG21_PI_PRM_STREAM *S){
+    if (S->committed != HDLOG_PROOF_ITERS ||
+        HDLOG_verify_final(&S->v) != HDLOG_OK || HDLOG_verify_final(&S->iv) != HDLOG_OK)
+    {
+        return CG21_PI_PRM_INVALID_FORMAT;
+    }
+
+    // the proofs were verified against the commitments bound in the challenges
+    if (!CG21_PI_PRM_same(S->crho, S->urho) || !CG21_PI_PRM_same(S->cirho, S->uirho))
+    {
+        return CG21_PI_PRM_INVALID_PROOF;
+    }
+
+    return CG21_OK;
+}
+
+/* View of k iterations of an encoded proof component, from iteration i */
+static octet CG21_PI_PRM_chunk(const octet *O, int i, int k){
+    octet V = {k * FS_2048, k * FS_2048, O->val + i * FS_2048};
+
+    return V;
+}
+
+int CG21_PI_PRM_VERIFY(PEDERSEN_PUB *pub, const CG21_SSID *ssid, CG21_PIPRM_PROOF_OCT *proofOct, int n){
+
+    CG21_PI_PRM_STREAM S;
+
+    if (proofOct->rho->len != HDLOG_VALUES_SIZE || proofOct->irho->len != HDLOG_VALUES_SIZE ||
+        proofOct->t->len != HDLOG_VALUES_SIZE || proofOct->it->len != HDLOG_VALUES_SIZE)
+    {
+        return CG21_PI_PRM_INVALID_FORMAT;
+    }
+
+    int rc = CG21_PI_PRM_VERIFY_STREAM_INIT(&S, pub, ssid, n);
+    if (rc != CG21_OK)
+    {
+        return rc;
+    }
+
+    for (int i = 0; i < HDLOG_PROOF_ITERS; i += CG21_PI_PRM_CHUNK)
+    {
+        int k = HDLOG_PROOF_ITERS - i < CG21_PI_PRM_CHUNK ? HDLOG_PROOF_ITERS - i : CG21_PI_PRM_CHUNK;
+
+        octet rho = CG21_PI_PRM_chunk(proofOct->rho, i, k);
+        octet irho = CG21_PI_PRM_chunk(proofOct->irho, i, k);
+
+        rc = CG21_PI_PRM_VERIFY_STREAM_COMMIT(&S, &rho, &irho);
+        if (rc != CG21_OK)
+        {
+            return rc;
+        }
+    }
+
+    for (int i = 0; i < HDLOG_PROOF_ITERS; i += CG21_PI_PRM_CHUNK)
+    {
+        int k = HDLOG_PROOF_ITERS - i < CG21_PI_PRM_CHUNK ? HDLOG_PROOF_ITERS - i : CG21_PI_PRM_CHUNK;
+
+        octet rho = CG21_PI_PRM_chunk(proofOct->rho, i, k);
+        octet irho = CG21_PI_PRM_chunk(proofOct->irho, i, k);
+        octet t = CG21_PI_PRM_chunk(proofOct->t, i, k);
+        octet it = CG21_PI_PRM_chunk(proofOct->it, i, k);
+
+        rc = CG21_PI_PRM_VERIFY_STREAM_UPDATE(&S, &rho, &irho, &t, &it);
+        if (rc != CG21_OK)
+        {
+            return rc;
+        }
+    }
+
+    return CG21_PI_PRM_VERIFY_STREAM_FINAL(&S);
+}
@@ -19,6 +19,9 @@ under the License.
 
 #include "amcl/cg21/cg21.h"
 
+// Seed length of the per-peer RNGs of CG21_PRESIGN_ROUND2_ALL
+#define CG21_PRESIGN_SEED 32
+
 // ------------------ PRE-SIGN -----------------------
 int CG21_VALIDATE_PARTIAL_PKS(CG21_RESHARE_OUTPUT *reshareOutput){
     int size = reshareOutput->pk.pack_size;
@@ -207,6 +210,27 @@ void CG21_MTA_decrypt_reduce_q(octet *T, octet *ALPHA)
 }
 
 
+void CG21_MTA_EVAL(PAILLIER_public_key *pk, BIG_512_60 *K, BIG_512_60 *x, BIG_512_60 *y, BIG_512_60 *s, BIG_512_60 *D)
+{
+    BIG_512_60 ws[FFLEN_4096];
+    BIG_512_60 dws[2 * FFLEN_4096];
+
+    // (1+N)^y = 1 + y*N mod N^2
+    FF_4096_mul(ws, pk->n, y, HFLEN_4096);
+    FF_4096_inc(ws, 1, FFLEN_4096);
+    FF_4096_norm(ws, FFLEN_4096);
+
+    // K^x * s^N mod N^2 in a single exponentiation
+    FF_4096_ct_pow_2(D, K, x, s, pk->n, pk->n2, FFLEN_4096, HFLEN_4096);
+
+    FF_4096_mul(dws, D, ws, FFLEN_4096);
+    FF_4096_dmod(D, dws, pk->n2, FFLEN_4096);
+
+    // Clean memory
+    FF_4096_zero(ws, FFLEN_4096);
+    FF_4096_zero(dws, 2 * FFLEN_4096);
+}
+
 int CG21_PRESIGN_ROUND2(csprng *RNG, CG21_PRESIGN_ROUND2_OUTPUT *r2output, CG21_PRESIGN_ROUND2_STORE *r2store,
                         const CG21_PRESIGN_ROUND1_OUTPUT *r1output, const CG21_PRESIGN_ROUND1_STORE *r1store,
                         PAILLIER_public_key *hisPK, PAILLIER_public_key *myPK){
@@ -313,79 +337,351 @@ int CG21_PRESIGN_ROUND2(csprng *RNG, CG21_PRESIGN_ROUND2_OUTPUT *r2output, CG21_
 
 
     /*
-     * ---------STEP 5: compute H and H_hat -----------
-     * H:                   Enc(-Beta, s)
-     * H_hat:               Enc(-Beta_hat, s_hat)
+     * ---------STEP 5: store -Beta and -Beta_hat -----------
      */
 
     BIG_1024_58 t_[FFLEN_2048];
 
-    char H[FS_4096];
-    octet H_oct = {0, sizeof(H), H};
-
-    char H_hat[FS_4096];
-    octet H_hat_oct = {0, sizeof(H_hat), H_hat};
-
-    char ct[FS_4096];
-    octet CT = {0, sizeof(ct), ct};
-
-    // store -Beta
     OCT_pad(r2store->neg_beta, HFS_4096);
     FF_2048_fromOctet(t, r2store->beta,FFLEN_2048);
     FF_2048_sub(t_, q5, t,FFLEN_2048); // t_ = -beta mod q5
     FF_2048_norm(t_, FFLEN_2048);
     FF_2048_toOctet(r2store->neg_beta,t_, FFLEN_2048);
 
-    // Enc(Beta, s)
-    PAILLIER_ENCRYPT(NULL, hisPK, r2store->beta, &H_oct, r2store->s);
-
-    // store -Beta_hat
     OCT_pad(r2store->neg_beta_hat, HFS_4096);
     FF_2048_fromOctet(t, r2store->beta_hat,FFLEN_2048);
     FF_2048_sub(t_, q5, t,FFLEN_2048); // -beta_hat mod q5
     FF_2048_norm(t_, FFLEN_2048);
     FF_2048_toOctet(r2store->neg_beta_hat,t_, FFLEN_2048);
 
-    // Enc(Beta_hat, s_hat)
-    PAILLIER_ENCRYPT(NULL, hisPK, r2store->beta_hat, &H_hat_oct, r2store->s_hat);
-
     FF_2048_zero(t, FFLEN_2048);
     FF_2048_zero(t_, FFLEN_2048);
 
     /*
     * ---------STEP 6: compute D and D_hat -----------
-    * D:                   K*gamma + H
-    * D_hat:               K*a + H_hat ('a' is the additive share computed in Round1)
+    * D:                   K^gamma * Enc(Beta, s)
+    * D_hat:               K^a * Enc(Beta_hat, s_hat) ('a' is the additive share computed in Round1)
     */
 
+    BIG_512_60 k[FFLEN_4096];
+    BIG_512_60 x[HFLEN_4096];
+    BIG_512_60 y[HFLEN_4096];
+    BIG_512_60 rs[FFLEN_4096];
+    BIG_512_60 d[FFLEN_4096];
+
     char oct11[FS_2048];
-    char oct22[FS_2048];
     octet OCT1 = {0, sizeof(oct11), oct11};
-    octet OCT2 = {0, sizeof(oct22), oct22};
 
+    // K is shared by D and D_hat
+    FF_4096_fromOctet(k, r1output->K, FFLEN_4096);
+
+    // D = K^gamma * (1+N)^Beta * s^N
     OCT_copy(&OCT1, r1store->gamma);
-    OCT_copy(&OCT2, r1store->a);
+    OCT_pad(&OCT1, HFS_4096);
+    FF_4096_fromOctet(x, &OCT1, HFLEN_4096);
 
-    // PAILLIER_MULT takes plaintext as BIG_512_60 pt[HFLEN_4096], so we should pad our PTs
+    OCT_copy(&OCT1, r2store->beta);
     OCT_pad(&OCT1, HFS_4096);
-    OCT_pad(&OCT2, HFS_4096);
+    FF_4096_fromOctet(y, &OCT1, HFLEN_4096);
 
-    // CT = E_A(K.gamma)
-    PAILLIER_MULT(hisPK, r1output->K, &OCT1, &CT);
+    FF_4096_fromOctet(rs, r2store->s, FFLEN_4096);
 
-    // D = E_A(K.gamma + H)
-    PAILLIER_ADD(hisPK, &CT, &H_oct, r2output->D);
+    CG21_MTA_EVAL(hisPK, k, x, y, rs, d);
+    FF_4096_toOctet(r2output->D, d, FFLEN_4096);
 
-    // CT = E_A(K.a)
-    PAILLIER_MULT(hisPK, r1output->K, &OCT2, &CT);
+    // D_hat = K^a * (1+N)^Beta_hat * s_hat^N
+    OCT_copy(&OCT1, r1store->a);
+    OCT_pad(&OCT1, HFS_4096);
+    FF_4096_fromOctet(x, &OCT1, HFLEN_4096);
+
+    OCT_copy(&OCT1, r2store->beta_hat);
+    OCT_pad(&OCT1, HFS_4096);
+    FF_4096_fromOctet(y, &OCT1, HFLEN_4096);
+
+    FF_4096_fromOctet(rs, r2store->s_hat, FFLEN_4096);
 
-    // D_hat = E_A(K.a + H_hat)
-    PAILLIER_ADD(hisPK, &CT, &H_hat_oct, r2output->D_hat);
+    CG21_MTA_EVAL(hisPK, k, x, y, rs, d);
+    FF_4096_toOctet(r2output->D_hat, d, FFLEN_4096);
 
     OCT_clear(&OCT1);
-    OCT_clear(&OCT2);
-    OCT_clear(&H_hat_oct);
-    OCT_clear(&CT);
+    FF_4096_zero(x, HFLEN_4096);
+    FF_4096_zero(y, HFLEN_4096);
+    FF_4096_zero(rs, FFLEN_4096);
+
+    return CG21_OK;
+}
+
+/* Shared state for the per-peer tasks of CG21_PRESIGN_ROUND2_ALL */
+typedef struct
+{
+    csprng *RNG;
+    const CG21_PRESIGN_ROUND1_STORE *r1store;
+    const CG21_PRESIGN_ROUND1_OUTPUT *r1output;
+    CG21_PAILLIER_KEYS *myKeys;
+    CG21_SSID *ssid;
+    octet *g;
+    octet *X;
+    CG21_PRESIGN_ROUND2_PEER *peers;
+} CG21_PRESIGN_ROUND2_CTX;
+
+static void CG21_PRESIGN_ROUND2_peer(void *arg, int i)
+{
+    CG21_PRESIGN_ROUND2_CTX *c = (CG21_PRESIGN_ROUND2_CTX *)arg;
+    CG21_PRESIGN_ROUND2_PEER *p = c->peers + i;
+    csprng *RNG = c->RNG + i;
+    PAILLIER_public_key *myPK = &c->myKeys->paillier_pk;
+
+    Piaffg_SECRETS affgSecrets;
+    PiLogstar_SECRETS logSecrets;
+
+    char e_[MODBYTES_256_56];
+    octet e = {0, sizeof(e_), e_};
+
+    p->rc = CG21_PRESIGN_ROUND2(RNG, p->r2output, p->r2store, p->r1output, c->r1store, p->hisPK, myPK);
+    if (p->rc != CG21_OK)
+    {
+        return;
+    }
+
+    // ----- PI-AFFG (D, K, F, GAMMA) -----
+    if (p->affgPre != NULL)
+    {
+        p->rc = Piaffg_Commit_online(p->hisPK, p->hisPedersen, c->r1store->gamma, p->r2store->beta, p->r1output->K,
+                                     p->affgPre, &affgSecrets, p->affgCommit, p->affgCommitOct);
+        if (p->rc != Piaffg_OK)
+        {
+            p->rc = CG21_PRESIGN_FAILED;
+            return;
+        }
+    }
+    else
+    {
+        p->rc = Piaffg_Sample_and_Commit(RNG, &c->myKeys->paillier_sk, p->hisPK, p->hisPedersen,
+                                         c->r1store->gamma, p->r2store->beta, &affgSecrets,
+                                         p->affgCommit, p->affgCommitOct, p->r1output->K);
+        if (p->rc != Piaffg_OK)
+        {
+            p->rc = CG21_PRESIGN_FAILED;
+            return;
+        }
+    }
+
+    Piaffg_Challenge_gen(p->hisPK, myPK, p->hisPedersen, p->r2store->Gamma, p->r2output->F, p->r1output->K,
+                         p->r2output->D, p->affgCommit, c->ssid, &e);
+
+    Piaffg_Prove(myPK, p->hisPK, &affgSecrets, c->r1store->gamma, p->r2store->beta,
+                 p->r2store->s, p->r2store->r, &e, p->affgProof, p->affgProofOct);
+
+    Piaffg_Kill_secrets(&affgSecrets);
+
+    // ----- PI-AFFG (D-hat, K, F-hat, X) -----
+    if (p->affgHatPre != NULL)
+    {
+        p->rc = Piaffg_Commit_online(p->hisPK, p->hisPedersen, c->r1store->a, p->r2store->beta_hat, p->r1output->K,
+                                     p->affgHatPre, &affgSecrets, p->affgHatCommit, p->affgHatCommitOct);
+        if (p->rc != Piaffg_OK)
+        {
+            p->rc = CG21_PRESIGN_FAILED;
+            return;
+        }
+    }
+    else
+    {
+        p->rc = Piaffg_Sample_and_Commit(RNG, &c->myKeys->paillier_sk, p->hisPK, p->hisPedersen,
+                                         c->r1store->a, p->r2store->beta_hat, &affgSecrets,
+                                         p->affgHatCommit, p->affgHatCommitOct, p->r1output->K);
+        if (p->rc != Piaffg_OK)
+        {
+            p->rc = CG21_PRESIGN_FAILED;
+            return;
+        }
+    }
+
+    Piaffg_Challenge_gen(p->hisPK, myPK, p->hisPedersen, c->X, p->r2output->F_hat, p->r1output->K,
+                         p->r2output->D_hat, p->affgHatCommit, c->ssid, &e);
+
+    Piaffg_Prove(myPK, p->hisPK, &affgSecrets, c->r1store->a, p->r2store->beta_hat,
+                 p->r2store->s_hat, p->r2store->r_hat, &e, p->affgHatProof, p->affgHatProofOct);
+
+    Piaffg_Kill_secrets(&affgSecrets);
+
+    // ----- PI-LOGSTAR (G, GAMMA) -----
+    p->rc = PiLogstar_Sample_and_commit(RNG, &c->myKeys->paillier_sk, p->hisPedersen, c->r1store->gamma, c->g,
+                                        &logSecrets, p->logCommit, p->logCommitOct);
+    if (p->rc != PiLogstar_OK)
+    {
+        p->rc = CG21_PRESIGN_FAILED;
+        return;
+    }
+
+    PiLogstar_Challenge_gen(myPK, p->hisPedersen, c->r1output->G, p->logCommit, c->ssid, p->r2store->Gamma, &e);
+
+    PiLogstar_Prove(&c->myKeys->paillier_sk, c->r1store->gamma, c->r1store->nu, &logSecrets, &e,
+                    p->logProof, p->logProofOct);
+
+    PiLogstar_clean_secrets(&logSecrets);
+
+    p->rc = CG21_OK;
+}
+
+int CG21_PRESIGN_ROUND2_ALL(csprng *RNG, const CG21_PRESIGN_ROUND1_STORE *r1store,
+                            const CG21_PRESIGN_ROUND1_OUTPUT *r1output, CG21_PAILLIER_KEYS *myKeys,
+                            CG21_SSID *ssid, CG21_PRESIGN_ROUND2_PEER *peers, int n)
+{
+    if (n <= 0)
+    {
+        return CG21_OK;
+    }
+
+    int rc = CG21_OK;
+    char seed[CG21_PRESIGN_SEED];
+    csprng rngs[n];
+
+    BIG_256_56 s;
+    ECP_SECP256K1 G;
+
+    char g_[EFS_SECP256K1 + 1];
+    octet g = {0, sizeof(g_), g_};
+
+    char x_[EFS_SECP256K1 + 1];
+    octet X = {0, sizeof(x_), x_};
+
+    CG21_PRESIGN_ROUND2_CTX ctx;
+
+    // Shared by all the peers: g = G and X = a*G
+    ECP_SECP256K1_generator(&G);
+    ECP_SECP256K1_toOctet(&g, &G, true);
+
+    BIG_256_56_fromBytesLen(s, r1store->a->val, r1store->a->len);
+    ECP_SECP256K1_mul(&G, s);
+    ECP_SECP256K1_toOctet(&X, &G, true);
+    BIG_256_56_zero(s);
+
+    // Independent RNG for each peer, seeded from the caller's RNG
+    for (int i = 0; i < n; i++)
+    {
+        for (int j = 0; j < CG21_PRESIGN_SEED; j++)
+        {
+            seed[j] = (char)RAND_byte(RNG);
+        }
+
+        RAND_seed(&rngs[i], CG21_PRESIGN_SEED, seed);
+    }
+
+    ctx.RNG = rngs;
+    ctx.r1store = r1store;
+    ctx.r1output = r1output;
+    ctx.myKeys = myKeys;
+    ctx.ssid = ssid;
+    ctx.g = &g;
+    ctx.X = &X;
+    ctx.peers = peers;
+
+    PARALLEL_for(CG21_PRESIGN_ROUND2_peer, &ctx, n);
+
+    for (int i = 0; i < n; i++)
+    {
+        if (peers[i].rc != CG21_OK)
+        {
+            rc = CG21_PRESIGN_FAILED;
+        }
+
+        RAND_clean(&rngs[i]);
+    }
+
+    for (int j = 0; j < CG21_PRESIGN_SEED; j++)
+    {
+        seed[j] = 0;
+    }
+
+    return rc;
+}
+
+/* Shared state for the verification of the peers in CG21_PRESIGN_ROUND3_VERIFY_ALL */
+typedef struct
+{
+    const CG21_PRESIGN_ROUND1_OUTPUT *r1output;
+    CG21_PAILLIER_KEYS *myKeys;
+    CG21_PEDERSEN_KEYS *myPedersen;
+    CG21_SSID *ssid;
+    octet *g;
+    CG21_PRESIGN_ROUND3_PEER *peers;
+} CG21_PRESIGN_ROUND3_VERIFY_CTX;
+
+static int CG21_PRESIGN_ROUND3_verify_peer(void *arg, int i)
+{
+    CG21_PRESIGN_ROUND3_VERIFY_CTX *c = (CG21_PRESIGN_ROUND3_VERIFY_CTX *)arg;
+    CG21_PRESIGN_ROUND3_PEER *p = c->peers + i;
+    PAILLIER_public_key *myPK = &c->myKeys->paillier_pk;
+    PEDERSEN_PUB *myPedPub = &c->myPedersen->pedersenPub;
+    octet *K = c->r1output->K;
+
+    int rc;
+
+    char e_[MODBYTES_256_56];
+    octet e = {0, sizeof(e_), e_};
+
+    // ----- PI-AFFG (D, K, F, GAMMA) -----
+    Piaffg_Challenge_gen(myPK, p->hisPK, myPedPub, p->r2output->Gamma, p->r2output->F, K,
+                         p->r2output->D, p->affgCommit, c->ssid, &e);
+
+    rc = Piaffg_Verify(&c->myKeys->paillier_sk, p->hisPK, &c->myPedersen->pedersenPriv, K, p->r2output->D,
+                       p->r2output->Gamma, p->r2output->F, p->affgCommit, &e, p->affgProof);
+    if (rc != Piaffg_OK)
+    {
+        return CG21_PRESIGN_AFFG_NOT_VALID;
+    }
+
+    // ----- PI-AFFG (D-hat, K, F-hat, X) -----
+    Piaffg_Challenge_gen(myPK, p->hisPK, myPedPub, p->X, p->r2output->F_hat, K,
+                         p->r2output->D_hat, p->affgHatCommit, c->ssid, &e);
+
+    rc = Piaffg_Verify(&c->myKeys->paillier_sk, p->hisPK, &c->myPedersen->pedersenPriv, K, p->r2output->D_hat,
+                       p->X, p->r2output->F_hat, p->affgHatCommit, &e, p->affgHatProof);
+    if (rc != Piaffg_OK)
+    {
+        return CG21_PRESIGN_AFFG_HAT_NOT_VALID;
+    }
+
+    // ----- PI-LOGSTAR (G, GAMMA) -----
+    PiLogstar_Challenge_gen(p->hisPK, myPedPub, p->r1output->G, p->logCommit, c->ssid, p->r2output->Gamma, &e);
+
+    rc = PiLogstar_Verify(p->hisPK, &c->myPedersen->pedersenPriv, p->r1output->G, c->g, p->logCommit,
+                          p->r2output->Gamma, &e, p->logProof);
+    if (rc != PiLogstar_OK)
+    {
+        return CG21_PRESIGN_LOGSTAR_NOT_VALID;
+    }
+
+    return CG21_OK;
+}
+
+int CG21_PRESIGN_ROUND3_VERIFY_ALL(const CG21_PRESIGN_ROUND1_OUTPUT *r1output, CG21_PAILLIER_KEYS *myKeys,
+                                   CG21_PEDERSEN_KEYS *myPedersen, CG21_SSID *ssid,
+                                   CG21_PRESIGN_ROUND3_PEER *peers, int n, int *verdicts, int *failed)
+{
+    ECP_SECP256K1 G;
+
+    char g_[EFS_SECP256K1 + 1];
+    octet g = {0, sizeof(g_), g_};
+
+    CG21_PRESIGN_ROUND3_VERIFY_CTX ctx;
+
+    ECP_SECP256K1_generator(&G);
+    ECP_SECP256K1_toOctet(&g, &G, true);
+
+    ctx.r1output = r1output;
+    ctx.myKeys = myKeys;
+    ctx.myPedersen = myPedersen;
+    ctx.ssid = ssid;
+    ctx.g = &g;
+    ctx.peers = peers;
+
+    *failed = PARALLEL_verify(CG21_PRESIGN_ROUND3_verify_peer, &ctx, n, verdicts);
+    if (*failed >= 0)
+    {
+        return verdicts[*failed];
+    }
 
     return CG21_OK;
 }
@@ -517,15 +813,11 @@ int CG21_PRESIGN_ROUND3_2_2(const CG21_PRESIGN_ROUND2_OUTPUT *r2hisOutput,
     * alpha_hat:            Decryption(D_hat)
     */
 
-    char pt1[FS_2048];
-    char pt2[FS_2048];
     char tt1[EGS_SECP256K1];
     char tt2[EGS_SECP256K1];
     char beta[EGS_SECP256K1];
     char beta_hat[EGS_SECP256K1];
 
-    octet PT1 = {0, sizeof(pt1), pt1};
-    octet PT2 = {0, sizeof(pt2), pt2};
     octet Alpha = {0, sizeof(tt1), tt1};
     octet Alpha_hat = {0, sizeof(tt2), tt2};
     octet Beta = {0, sizeof(beta), beta};
@@ -540,11 +832,10 @@ int CG21_PRESIGN_ROUND3_2_2(const CG21_PRESIGN_ROUND2_OUTPUT *r2hisOutput,
     r3Output->i = r2Store->i;
     OCT_copy(r3Output->Delta, r3Store1->Delta);
 
-    PAILLIER_DECRYPT(myKeys, r2hisOutput->D, &PT1);
-    PAILLIER_DECRYPT(myKeys, r2hisOutput->D_hat, &PT2);
+    octet *CT[2] = {r2hisOutput->D, r2hisOutput->D_hat};
+    octet *ALPHA[2] = {&Alpha, &Alpha_hat};
 
-    CG21_MTA_decrypt_reduce_q(&PT1, &Alpha);
-    CG21_MTA_decrypt_reduce_q(&PT2, &Alpha_hat);
+    CG21_PAILLIER_DECRYPT_REDUCE_Q(myKeys, CT, ALPHA, 2);
 
     CG21_MTA_decrypt_reduce_q(r2Store->neg_beta, &Beta);
     CG21_MTA_decrypt_reduce_q(r2Store->neg_beta_hat, &Beta_hat);
@@ -593,8 +884,6 @@ int CG21_PRESIGN_ROUND3_2_2(const CG21_PRESIGN_ROUND2_OUTPUT *r2hisOutput,
     OCT_clear(&Alpha_hat);
     OCT_clear(&Beta);
     OCT_clear(&Beta_hat);
-    OCT_clear(&PT1);
-    OCT_clear(&PT2);
 
     return CG21_OK;
 }
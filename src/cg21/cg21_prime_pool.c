@@ -0,0 +1,387 @@
+/*
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"); you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+*/
+
+/* Persistent pool of pre-generated safe primes */
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <fcntl.h>
+#include "amcl/cg21/cg21_prime_pool.h"
+
+#define CG21_PRIME_POOL_UNUSED  0
+#define CG21_PRIME_POOL_USED    1
+
+static const char CG21_PRIME_POOL_MAGIC[CG21_PRIME_POOL_HEADER_SIZE] = {'C','G','2','1','S','P','P',1};
+
+/* Authenticated data of record i: file header and record index */
+static void CG21_PRIME_POOL_ad(char *ad, int i)
+{
+    for (int j = 0; j < CG21_PRIME_POOL_HEADER_SIZE; j++)
+    {
+        ad[j] = CG21_PRIME_POOL_MAGIC[j];
+    }
+
+    ad[CG21_PRIME_POOL_HEADER_SIZE]     = (char)((i >> 24) & 0xFF);
+    ad[CG21_PRIME_POOL_HEADER_SIZE + 1] = (char)((i >> 16) & 0xFF);
+    ad[CG21_PRIME_POOL_HEADER_SIZE + 2] = (char)((i >> 8) & 0xFF);
+    ad[CG21_PRIME_POOL_HEADER_SIZE + 3] = (char)(i & 0xFF);
+}
+
+/* Lock the whole pool file until it is closed, shared if it is only read */
+static int CG21_PRIME_POOL_lock(FILE *fp, int shared)
+{
+    struct flock fl;
+
+    fl.l_type = shared ? F_RDLCK : F_WRLCK;
+    fl.l_whence = SEEK_SET;
+    fl.l_start = 0;
+    fl.l_len = 0;
+
+    // wait for the other processes using the pool
+    return fcntl(fileno(fp), F_SETLKW, &fl);
+}
+
+/* Open and lock the pool file, check its header and return the number of records */
+static int CG21_PRIME_POOL_open(const char *path, const char *mode, FILE **fp, int *records)
+{
+    char header[CG21_PRIME_POOL_HEADER_SIZE];
+    long size;
+
+    *fp = fopen(path, mode);
+    if (*fp == NULL)
+    {
+        return CG21_PRIME_POOL_IO_ERROR;
+    }
+
+    // The size, and so the index of an appended record, is only read once the lock is held
+    if (CG21_PRIME_POOL_lock(*fp, mode[0] == 'r' && mode[1] != '+') != 0)
+    {
+        fclose(*fp);
+        return CG21_PRIME_POOL_IO_ERROR;
+    }
+
+    if (fseek(*fp, 0, SEEK_END) != 0 || (size = ftell(*fp)) < 0)
+    {
+        fclose(*fp);
+        return CG21_PRIME_POOL_IO_ERROR;
+    }
+
+    // New file opened for appending, write the header
+    if (size == 0 && mode[0] == 'a')
+    {
+        if (fwrite(CG21_PRIME_POOL_MAGIC, 1, CG21_PRIME_POOL_HEADER_SIZE, *fp) != CG21_PRIME_POOL_HEADER_SIZE)
+        {
+            fclose(*fp);
+            return CG21_PRIME_POOL_IO_ERROR;
+        }
+
+        *records = 0;
+        return CG21_PRIME_POOL_OK;
+    }
+
+    if (size < CG21_PRIME_POOL_HEADER_SIZE || (size - CG21_PRIME_POOL_HEADER_SIZE) % CG21_PRIME_POOL_RECORD_SIZE != 0)
+    {
+        fclose(*fp);
+        return CG21_PRIME_POOL_INVALID_FILE;
+    }
+
+    if (fseek(*fp, 0, SEEK_SET) != 0 ||
+        fread(header, 1, CG21_PRIME_POOL_HEADER_SIZE, *fp) != CG21_PRIME_POOL_HEADER_SIZE)
+    {
+        fclose(*fp);
+        return CG21_PRIME_POOL_IO_ERROR;
+    }
+
+    for (int j = 0; j < CG21_PRIME_POOL_HEADER_SIZE; j++)
+    {
+        if (header[j] != CG21_PRIME_POOL_MAGIC[j])
+        {
+            fclose(*fp);
+            return CG21_PRIME_POOL_INVALID_FILE;
+        }
+    }
+
+    *records = (int)((size - CG21_PRIME_POOL_HEADER_SIZE) / CG21_PRIME_POOL_RECORD_SIZE);
+
+    return CG21_PRIME_POOL_OK;
+}
+
+int CG21_PRIME_POOL_FILL(csprng *RNG, const char *path, const octet *K, int count)
+{
+    FILE *fp;
+    gcm g;
+    int records;
+    int rc = CG21_PRIME_POOL_OK;
+
+    BIG_1024_58 p[HFLEN_2048];
+    BIG_1024_58 P[HFLEN_2048];
+
+    char ad[CG21_PRIME_POOL_HEADER_SIZE + 4];
+    char record[CG21_PRIME_POOL_RECORD_SIZE];
+    char *iv = record + 1;
+    char *ct = iv + CG21_PRIME_POOL_IV_SIZE;
+    char *tag = ct + HFS_2048;
+
+    char pp[HFS_2048];
+    octet PP = {0, sizeof(pp), pp};
+
+    if (K->len != CG21_PRIME_POOL_KEY_SIZE)
+    {
+        return CG21_PRIME_POOL_INVALID_KEY;
+    }
+
+    for (int k = 0; k < count; k++)
+    {
+        safe_prime_gen_parallel(RNG, p, P, HFLEN_2048);
+        FF_2048_toOctet(&PP, P, HFLEN_2048);
+
+        // Append the prime, reopening the file each time keeps it
+        // consistent if the generation is interrupted
+        rc = CG21_PRIME_POOL_open(path, "a+b", &fp, &records);
+        if (rc != CG21_PRIME_POOL_OK)
+        {
+            break;
+        }
+
+        record[0] = CG21_PRIME_POOL_UNUSED;
+        for (int j = 0; j < CG21_PRIME_POOL_IV_SIZE; j++)
+        {
+            iv[j] = (char)RAND_byte(RNG);
+        }
+
+        CG21_PRIME_POOL_ad(ad, records);
+
+        GCM_init(&g, CG21_PRIME_POOL_KEY_SIZE, K->val, CG21_PRIME_POOL_IV_SIZE, iv);
+        GCM_add_header(&g, ad, sizeof(ad));
+        GCM_add_plain(&g, ct, PP.val, HFS_2048);
+        GCM_finish(&g, tag);
+
+        // The header has just been read, so the stream must be positioned before writing
+        if (fseek(fp, 0, SEEK_END) != 0 ||
+            fwrite(record, 1, CG21_PRIME_POOL_RECORD_SIZE, fp) != CG21_PRIME_POOL_RECORD_SIZE)
+        {
+            rc = CG21_PRIME_POOL_IO_ERROR;
+        }
+
+        if (fclose(fp) != 0)
+        {
+            rc = CG21_PRIME_POOL_IO_ERROR;
+        }
+
+        if (rc != CG21_PRIME_POOL_OK)
+        {
+            break;
+        }
+    }
+
+    // clean up
+    FF_2048_zero(p, HFLEN_2048);
+    FF_2048_zero(P, HFLEN_2048);
+    OCT_clear(&PP);
+
+    return rc;
+}
+
+int CG21_PRIME_POOL_AVAILABLE(const char *path, int *available)
+{
+    FILE *fp;
+    int records;
+    char status;
+
+    *available = 0;
+
+    int rc = CG21_PRIME_POOL_open(path, "rb", &fp, &records);
+    if (rc != CG21_PRIME_POOL_OK)
+    {
+        return rc;
+    }
+
+    for (int i = 0; i < records; i++)
+    {
+        if (fseek(fp, CG21_PRIME_POOL_HEADER_SIZE + (long)i * CG21_PRIME_POOL_RECORD_SIZE, SEEK_SET) != 0 ||
+            fread(&status, 1, 1, fp) != 1)
+        {
+            fclose(fp);
+            return CG21_PRIME_POOL_IO_ERROR;
+        }
+
+        if (status == CG21_PRIME_POOL_UNUSED)
+        {
+            (*available)++;
+        }
+    }
+
+    fclose(fp);
+
+    return CG21_PRIME_POOL_OK;
+}
+
+/* Take the next count unused primes, all of them or none */
+static int CG21_PRIME_POOL_take(const char *path, const octet *K, octet **P, int count)
+{
+    FILE *fp;
+    gcm g;
+    int records;
+    int found = 0;
+    int rc = CG21_PRIME_POOL_OK;
+
+    int idx[count];
+    char ad[CG21_PRIME_POOL_HEADER_SIZE + 4];
+    char record[count][CG21_PRIME_POOL_RECORD_SIZE];
+    char burned[CG21_PRIME_POOL_RECORD_SIZE] = {0};
+    char t[CG21_PRIME_POOL_TAG_SIZE];
+
+    if (K->len != CG21_PRIME_POOL_KEY_SIZE)
+    {
+        return CG21_PRIME_POOL_INVALID_KEY;
+    }
+
+    for (int k = 0; k < count; k++)
+    {
+        if (P[k]->max < HFS_2048)
+        {
+            return CG21_PRIME_POOL_INVALID_OUTPUT;
+        }
+    }
+
+    rc = CG21_PRIME_POOL_open(path, "r+b", &fp, &records);
+    if (rc != CG21_PRIME_POOL_OK)
+    {
+        return rc;
+    }
+
+    // Find the first count unused records
+    for (int i = 0; i < records && found < count; i++)
+    {
+        if (fseek(fp, CG21_PRIME_POOL_HEADER_SIZE + (long)i * CG21_PRIME_POOL_RECORD_SIZE, SEEK_SET) != 0 ||
+            fread(record[found], 1, CG21_PRIME_POOL_RECORD_SIZE, fp) != CG21_PRIME_POOL_RECORD_SIZE)
+        {
+            rc = CG21_PRIME_POOL_IO_ERROR;
+            break;
+        }
+
+        if (record[found][0] == CG21_PRIME_POOL_UNUSED)
+        {
+            idx[found++] = i;
+        }
+    }
+
+    if (rc == CG21_PRIME_POOL_OK && found < count)
+    {
+        rc = CG21_PRIME_POOL_EMPTY;
+    }
+
+    // Burn the records before using them, so a prime is never handed out twice
+    burned[0] = CG21_PRIME_POOL_USED;
+    for (int k = 0; k < count && rc == CG21_PRIME_POOL_OK; k++)
+    {
+        if (fseek(fp, CG21_PRIME_POOL_HEADER_SIZE + (long)idx[k] * CG21_PRIME_POOL_RECORD_SIZE, SEEK_SET) != 0 ||
+            fwrite(burned, 1, CG21_PRIME_POOL_RECORD_SIZE, fp) != CG21_PRIME_POOL_RECORD_SIZE)
+        {
+            rc = CG21_PRIME_POOL_IO_ERROR;
+        }
+    }
+
+    if (fflush(fp) != 0 && rc == CG21_PRIME_POOL_OK)
+    {
+        rc = CG21_PRIME_POOL_IO_ERROR;
+    }
+
+    fclose(fp);
+
+    for (int k = 0; k < count && rc == CG21_PRIME_POOL_OK; k++)
+    {
+        char *iv = record[k] + 1;
+        char *ct = iv + CG21_PRIME_POOL_IV_SIZE;
+        char *tag = ct + HFS_2048;
+        char diff = 0;
+
+        CG21_PRIME_POOL_ad(ad, idx[k]);
+
+        GCM_init(&g, CG21_PRIME_POOL_KEY_SIZE, K->val, CG21_PRIME_POOL_IV_SIZE, iv);
+        GCM_add_header(&g, ad, sizeof(ad));
+        GCM_add_cipher(&g, P[k]->val, ct, HFS_2048);
+        GCM_finish(&g, t);
+
+        // Constant time tag comparison
+        for (int j = 0; j < CG21_PRIME_POOL_TAG_SIZE; j++)
+        {
+            diff |= t[j] ^ tag[j];
+        }
+
+        if (diff != 0)
+        {
+            rc = CG21_PRIME_POOL_INVALID_RECORD;
+        }
+
+        P[k]->len = HFS_2048;
+    }
+
+    // clean up
+    for (int k = 0; k < count; k++)
+    {
+        for (int j = 0; j < CG21_PRIME_POOL_RECORD_SIZE; j++)
+        {
+            record[k][j] = 0;
+        }
+
+        if (rc != CG21_PRIME_POOL_OK)
+        {
+            OCT_clear(P[k]);
+        }
+    }
+
+    return rc;
+}
+
+int CG21_PRIME_POOL_TAKE(const char *path, const octet *K, octet *P)
+{
+    return CG21_PRIME_POOL_take(path, K, &P, 1);
+}
+
+int CG21_PRIME_POOL_AUX_KEYS(csprng *RNG, const char *path, const octet *K,
+                             CG21_PAILLIER_KEYS *paillier, CG21_PEDERSEN_KEYS *pedersen)
+{
+    char p[HFS_2048];
+    octet P = {0, sizeof(p), p};
+
+    char q[HFS_2048];
+    octet Q = {0, sizeof(q), q};
+
+    octet *PQ[2] = {&P, &Q};
+
+    // Both primes are taken at once, so none is lost if the pool has only one left
+    int rc = CG21_PRIME_POOL_take(path, K, PQ, 2);
+    if (rc != CG21_PRIME_POOL_OK)
+    {
+        return rc;
+    }
+
+    // note: based on the CG21(CSS20):Figure 5, same safe primes p,q are used for both Paillier and Pedersen
+    PAILLIER_KEY_PAIR(NULL, &P, &Q, &paillier->paillier_pk, &paillier->paillier_sk);
+
+    ring_Pedersen_setup(RNG, &pedersen->pedersenPriv, &P, &Q);
+    Pedersen_get_public_param(&pedersen->pedersenPub, &pedersen->pedersenPriv);
+
+    // clean up
+    OCT_clear(&P);
+    OCT_clear(&Q);
+
+    return CG21_PRIME_POOL_OK;
+}
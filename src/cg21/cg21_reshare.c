@@ -511,26 +511,91 @@ void CG21_KEY_RESHARE_ENCRYPT_SHARES(csprng *RNG, PAILLIER_public_key *pk, int h
 }
 
 
+/* Shared state for the receivers of CG21_KEY_RESHARE_ENCRYPT_ALL_SHARES */
+typedef struct
+{
+    CG21_PAILLIER_NONCE_POOL *pools;
+    const int *hisID;
+    CG21_RESHARE_ROUND1_STORE_SECRET_T1 *storeSecret;
+    CG21_RESHARE_ROUND1_STORE_PUB_T1 *storePub;
+    CG21_RESHARE_ROUND3_OUTPUT *output;
+    int *rc;
+} CG21_reshare_encrypt_ctx;
+
+static void CG21_reshare_encrypt_iter(void *arg, int i){
+    CG21_reshare_encrypt_ctx *c = (CG21_reshare_encrypt_ctx *)arg;
+    int k = c->hisID[i] - 1;
+
+    // encrypt y-coord
+    c->rc[i] = CG21_PAILLIER_ENCRYPT_POOL(c->pools + i, c->storeSecret->shares.Y + k, c->output[i].C);
+
+    // copy x-coord into output->X
+    OCT_copy(c->output[i].X, c->storeSecret->shares.X + k);
+
+    *(c->output[i].i) = *c->storePub->i;
+    *(c->output[i].j) = c->hisID[i];
+}
+
+int CG21_KEY_RESHARE_ENCRYPT_ALL_SHARES(CG21_PAILLIER_NONCE_POOL *pools, const int *hisID, int n,
+                                        CG21_RESHARE_ROUND1_STORE_SECRET_T1 *storeSecret,
+                                        CG21_RESHARE_ROUND1_STORE_PUB_T1 storePub,
+                                        CG21_RESHARE_ROUND3_OUTPUT *output){
+
+    if (n <= 0){
+        return CG21_OK;
+    }
+
+    int rc[n];
+    CG21_reshare_encrypt_ctx ctx;
+
+    ctx.pools = pools;
+    ctx.hisID = hisID;
+    ctx.storeSecret = storeSecret;
+    ctx.storePub = &storePub;
+    ctx.output = output;
+    ctx.rc = rc;
+
+    PARALLEL_for(CG21_reshare_encrypt_iter, &ctx, n);
+
+    for (int i = 0; i < n; i++){
+        if (rc[i] != CG21_OK){
+            return rc[i];
+        }
+    }
+
+    return CG21_OK;
+}
+
 void CG21_KEY_RESHARE_DECRYPT_SHARES(PAILLIER_private_key *sk,
                                      CG21_RESHARE_ROUND3_OUTPUT *r3output,
                                      SSS_shares *share){
 
-    char pt[FS_2048];
-    octet PT = {0, sizeof(pt), pt};
+    CG21_KEY_RESHARE_DECRYPT_ALL_SHARES(sk, r3output, share, 1);
+}
+
+void CG21_KEY_RESHARE_DECRYPT_ALL_SHARES(PAILLIER_private_key *sk,
+                                         CG21_RESHARE_ROUND3_OUTPUT *r3output,
+                                         SSS_shares *share, int n){
 
-    char y[EGS_SECP256K1];
-    octet Y = {0, sizeof(y), y};
+    if (n <= 0){
+        return;
+    }
 
-    // Decrypt C to get y-coord of the received point
-    PAILLIER_DECRYPT(sk, r3output->C, &PT);
+    octet *CT[n];
+    octet *Y[n];
 
-    // remove the zeros from y-coord
-    OCT_chop( &PT, &Y,PT.len - EGS_SECP256K1);
+    for (int i = 0; i < n; i++){
+        CT[i] = r3output[i].C;
+        Y[i] = share[i].Y;
+    }
 
-    // form the shared point as SSS_shares
-    OCT_copy(share->X, r3output->X );
-    OCT_copy(share->Y, &Y );
+    // Decrypt C to get y-coord of the received points, y-coords are smaller than q
+    CG21_PAILLIER_DECRYPT_REDUCE_Q(sk, CT, Y, n);
 
+    // form the shared points as SSS_shares
+    for (int i = 0; i < n; i++){
+        OCT_copy(share[i].X, r3output[i].X);
+    }
 }
 
 
@@ -17,18 +17,31 @@ specific language governing permissions and limitations
 under the License.
 */
 
+#include <string.h>
 #include "amcl/cg21/cg21_rp_pi_affg.h"
 #include "amcl/hash_utils.h"
 
-int Piaffg_Sample_and_Commit(csprng *RNG, PAILLIER_private_key *paillier_priv, PAILLIER_public_key *paillier_pub,
-                              PEDERSEN_PUB *pedersen_pub, octet *x, octet *y, Piaffg_SECRETS *secrets,
-                              Piaffg_COMMITS *commit, Piaffg_COMMITS_OCT *commitsOct, octet *C){
+/* alpha < q^3 fits in HFS_2048 bytes, so C^alpha only needs this many FF_4096 limbs */
+#define Piaffg_ALPHA_LEN_4096 ((HFS_2048) / MODBYTES_512_60)
+
+/* Hash of the verifier's keys the precommitments are computed for */
+static void Piaffg_key_id(PAILLIER_public_key *paillier_pub, PEDERSEN_PUB *pedersen_pub, char *id)
+{
+    hash256 sha;
+
+    HASH256_init(&sha);
+    CG21_hash_pubKey_pubCom(&sha, paillier_pub, pedersen_pub);
+    HASH256_hash(&sha, id);
+}
+
+int Piaffg_Precommit(csprng *RNG, PAILLIER_private_key *paillier_priv, PAILLIER_public_key *paillier_pub,
+                     PEDERSEN_PUB *pedersen_pub, Piaffg_PRECOMMITS *pre){
 
     // ------------ VARIABLE DEFINITION ----------
     ECP_SECP256K1 G;
+    Piaffg_SECRETS *secrets = &pre->secrets;
 
     BIG_1024_58 n_b[FFLEN_2048];
-    BIG_1024_58 n2_b[2 * FFLEN_2048];
     BIG_1024_58 q[HFLEN_2048];          //q:256 bits
     BIG_1024_58 q2[FFLEN_2048];         //q^2
     BIG_1024_58 q3[FFLEN_2048];         //q^3
@@ -41,13 +54,9 @@ int Piaffg_Sample_and_Commit(csprng *RNG, PAILLIER_private_key *paillier_priv, P
     BIG_1024_58 m_mod[2 * FFLEN_2048];
     BIG_1024_58 mu_mod[2 * FFLEN_2048];
 
-    BIG_1024_58 x_[2 * FFLEN_2048];
-    BIG_1024_58 y_[2 * FFLEN_2048];
-
     BIG_512_60 ws1[FFLEN_4096];
     BIG_512_60 ws2[FFLEN_4096];
     BIG_512_60 dws[2 * FFLEN_4096];
-    BIG_512_60 alpha[HFLEN_4096];
     BIG_512_60 r_[FFLEN_4096];
     BIG_512_60 beta[FFLEN_4096];
     BIG_1024_58 tws[FFLEN_2048 + HFLEN_2048];
@@ -55,34 +64,27 @@ int Piaffg_Sample_and_Commit(csprng *RNG, PAILLIER_private_key *paillier_priv, P
     char oct1[2 * FS_2048];
     octet OCT = {0, sizeof(oct1), oct1};
 
-    char oct4[2*FS_2048];
-    octet rx_oct = {0, sizeof(oct4), oct4};
-
     char oct5[2*FS_2048];
     octet ry_oct = {0, sizeof(oct5), oct5};
 
-    char oct2[2 * FS_2048];
-    octet alpha_oct = {0, sizeof(oct2), oct2};
-
     char oct6[2 * FS_2048];
     octet beta_oct = {0, sizeof(oct6), oct6};
 
     char oct3[2*FS_2048];
     octet CT_oct = {0, sizeof(oct3), oct3};
 
+    if (RNG == NULL) {
+        return PiAffg_RNG_IS_NULL;
+    }
+
+    Piaffg_key_id(paillier_pub, pedersen_pub, pre->key_id);
+
     // Curve order
     CG21_GET_CURVE_ORDER(q);
 
-    // Calculate N and N^2 parameters based on p and q
+    // Calculate N parameter based on p and q
     FF_2048_mul(n_b, paillier_priv->p, paillier_priv->q, HFLEN_2048);
 
-    FF_2048_sqr(n2_b, n_b, FFLEN_2048);
-    FF_2048_norm(n2_b, 2 * FFLEN_2048);
-
-    if (RNG == NULL) {
-        return PiAffg_RNG_IS_NULL;
-    }
-
     FF_2048_sqr(q2, q, HFLEN_2048);
     FF_2048_mul(q3, q, q2, HFLEN_2048);
     FF_2048_mul(q5, q3, q2, FFLEN_2048);
@@ -136,46 +138,19 @@ int Piaffg_Sample_and_Commit(csprng *RNG, PAILLIER_private_key *paillier_priv, P
     FF_2048_random(secrets->mu, RNG, FFLEN_2048 + HFLEN_2048);         //mu: a (1024+2048)-bit number
     FF_2048_mod(secrets->mu, mu_mod, FFLEN_2048 + HFLEN_2048);             //mu: (256+2048)-bit number
 
-
-    // ------------ READING INPUTS ----------
-    OCT_copy(&OCT, x);
-    OCT_pad(&OCT, HFS_2048);
-    FF_2048_zero(x_, FFLEN_2048 + HFLEN_2048);       // Set x_ to zero
-    FF_2048_fromOctet(x_, &OCT, HFLEN_2048);
-
-    OCT_copy(&OCT, y);
-    OCT_pad(&OCT, HFS_4096);
-    FF_2048_zero(y_, 2*FFLEN_2048);       // Set y_ to zero
-    FF_2048_fromOctet(y_, &OCT, FFLEN_2048);
-
     // ------------ COMMITMENT ----------
     // Compute E
     FF_2048_zero(tws, FFLEN_2048 + HFLEN_2048);
     FF_2048_copy(tws, secrets->alpha, HFLEN_2048);
-    FF_2048_ct_pow_2(commit->E, pedersen_pub->b0, tws, pedersen_pub->b1, secrets->gamma, pedersen_pub->N,
-                     FFLEN_2048, FFLEN_2048 + HFLEN_2048);
-
-    // Compute S
-    FF_2048_ct_pow_2(commit->S, pedersen_pub->b0, x_, pedersen_pub->b1, secrets->m, pedersen_pub->N,
+    FF_2048_ct_pow_2(pre->E, pedersen_pub->b0, tws, pedersen_pub->b1, secrets->gamma, pedersen_pub->N,
                      FFLEN_2048, FFLEN_2048 + HFLEN_2048);
 
     // Compute F
     FF_2048_copy(tws, secrets->beta, FFLEN_2048);
-    FF_2048_ct_pow_2(commit->F, pedersen_pub->b0, tws, pedersen_pub->b1, secrets->delta, pedersen_pub->N,
+    FF_2048_ct_pow_2(pre->F, pedersen_pub->b0, tws, pedersen_pub->b1, secrets->delta, pedersen_pub->N,
                      FFLEN_2048, FFLEN_2048 + HFLEN_2048);
 
-    // Compute T
-    FF_2048_ct_pow_2(commit->T, pedersen_pub->b0, y_, pedersen_pub->b1, secrets->mu, pedersen_pub->N,
-                     FFLEN_2048, FFLEN_2048 + HFLEN_2048);
-
-    // Compute A = C^alpha * g^beta * r^N mod n2
-    FF_4096_fromOctet(ws2, C, FFLEN_4096);
-
-    FF_2048_toOctet(&alpha_oct, secrets->alpha, HFLEN_2048);
-    OCT_pad(&alpha_oct, HFS_4096);
-    FF_4096_fromOctet(alpha, &alpha_oct, HFLEN_4096);
-
-
+    // Compute the input independent part of A = g^beta * r^N mod n2
     FF_2048_toOctet(&beta_oct, secrets->beta, FFLEN_2048);
     OCT_pad(&beta_oct, HFS_4096);
     FF_4096_fromOctet(beta, &beta_oct, HFLEN_4096);
@@ -190,16 +165,13 @@ int Piaffg_Sample_and_Commit(csprng *RNG, PAILLIER_private_key *paillier_priv, P
     FF_4096_inc(ws1, 1, FFLEN_4096);
     FF_4096_norm(ws1, FFLEN_4096);
 
-    // C^alpha * r^N0 mod n2
-    FF_4096_ct_pow_2(ws2, ws2, alpha, r_, paillier_pub->n, paillier_pub->n2, FFLEN_4096, HFLEN_4096);
+    // r^N0 mod n2
+    FF_4096_ct_pow(ws2, r_, paillier_pub->n, paillier_pub->n2, FFLEN_4096, HFLEN_4096);
 
-    // (N0 * beta + 1) * C^alpha * r^N0 mod N0^2
+    // (N0 * beta + 1) * r^N0 mod N0^2
     FF_4096_zero(dws, 2 * FFLEN_4096);
     FF_4096_mul(dws, ws1, ws2, FFLEN_4096);
-    FF_4096_dmod(ws1, dws, paillier_pub->n2, FFLEN_4096);
-
-    FF_4096_toOctet(&OCT, ws1, FFLEN_4096);
-    FF_2048_fromOctet(commit->A, &OCT, 2 * FFLEN_2048);
+    FF_4096_dmod(pre->A, dws, paillier_pub->n2, FFLEN_4096);
 
     // Form PAILLIER_public_key using prover's PK
     FF_2048_toOctet(&OCT, n_b, FFLEN_2048);
@@ -215,26 +187,22 @@ int Piaffg_Sample_and_Commit(csprng *RNG, PAILLIER_private_key *paillier_priv, P
     OCT_pad(&ry_oct, FS_4096);
 
     PAILLIER_ENCRYPT(NULL, &PUB, &beta_oct, &CT_oct,&ry_oct);
-    FF_2048_fromOctet(commit->By, &CT_oct, 2 * FFLEN_2048);
+    FF_2048_fromOctet(pre->By, &CT_oct, 2 * FFLEN_2048);
 
     // Computes Bx
     ECP_SECP256K1_generator(&G);
     ECP_mul_1024(&G, secrets->alpha);
-    ECP_SECP256K1_copy(&commit->Bx,&G);
-
-    Piaffg_Commitment_toOctets_enc(commitsOct, commit);
+    ECP_SECP256K1_copy(&pre->Bx,&G);
 
     // ------------ CLEAN MEMORY ----------
     OCT_clear(&OCT);
-    OCT_clear(&rx_oct);
     OCT_clear(&ry_oct);
-    OCT_clear(&alpha_oct);
     OCT_clear(&beta_oct);
     OCT_clear(&CT_oct);
-    FF_2048_zero(x_, FFLEN_2048 + HFLEN_2048);
-    FF_2048_zero(y_, HFLEN_4096);
     FF_2048_zero(tws, FFLEN_2048 + HFLEN_2048);
     FF_4096_zero(r, FFLEN_4096);
+    FF_4096_zero(r_, FFLEN_4096);
+    FF_4096_zero(beta, FFLEN_4096);
     FF_4096_zero(ws1, FFLEN_4096);
     FF_4096_zero(ws2, FFLEN_4096);
     FF_4096_zero(dws, 2*FFLEN_4096);
@@ -246,6 +214,115 @@ int Piaffg_Sample_and_Commit(csprng *RNG, PAILLIER_private_key *paillier_priv, P
     return Piaffg_OK;
 }
 
+int Piaffg_Commit_online(PAILLIER_public_key *paillier_pub, PEDERSEN_PUB *pedersen_pub, octet *x, octet *y,
+                         octet *C, Piaffg_PRECOMMITS *pre, Piaffg_SECRETS *secrets,
+                         Piaffg_COMMITS *commit, Piaffg_COMMITS_OCT *commitsOct){
+
+    // ------------ VARIABLE DEFINITION ----------
+    BIG_1024_58 x_[2 * FFLEN_2048];
+    BIG_1024_58 y_[2 * FFLEN_2048];
+
+    BIG_512_60 ws1[FFLEN_4096];
+    BIG_512_60 dws[2 * FFLEN_4096];
+    BIG_512_60 alpha[Piaffg_ALPHA_LEN_4096];
+
+    char oct1[2 * FS_2048];
+    octet OCT = {0, sizeof(oct1), oct1};
+
+    char id[SHA256];
+
+    // ------------ CHECKING INPUTS ----------
+    Piaffg_key_id(paillier_pub, pedersen_pub, id);
+    if (memcmp(id, pre->key_id, SHA256) != 0) {
+        return Piaffg_INVALID_PRECOMMIT;
+    }
+
+    // ------------ READING INPUTS ----------
+    OCT_copy(&OCT, x);
+    OCT_pad(&OCT, HFS_2048);
+    FF_2048_zero(x_, FFLEN_2048 + HFLEN_2048);       // Set x_ to zero
+    FF_2048_fromOctet(x_, &OCT, HFLEN_2048);
+
+    OCT_copy(&OCT, y);
+    OCT_pad(&OCT, HFS_4096);
+    FF_2048_zero(y_, 2*FFLEN_2048);       // Set y_ to zero
+    FF_2048_fromOctet(y_, &OCT, FFLEN_2048);
+
+    // ------------ COMMITMENT ----------
+    // Compute S
+    FF_2048_ct_pow_2(commit->S, pedersen_pub->b0, x_, pedersen_pub->b1, pre->secrets.m, pedersen_pub->N,
+                     FFLEN_2048, FFLEN_2048 + HFLEN_2048);
+
+    // Compute T
+    FF_2048_ct_pow_2(commit->T, pedersen_pub->b0, y_, pedersen_pub->b1, pre->secrets.mu, pedersen_pub->N,
+                     FFLEN_2048, FFLEN_2048 + HFLEN_2048);
+
+    // Complete A = C^alpha * g^beta * r^N mod n2
+    FF_4096_fromOctet(ws1, C, FFLEN_4096);
+
+    FF_2048_toOctet(&OCT, pre->secrets.alpha, HFLEN_2048);
+    FF_4096_fromOctet(alpha, &OCT, Piaffg_ALPHA_LEN_4096);
+
+    FF_4096_ct_pow(ws1, ws1, alpha, paillier_pub->n2, FFLEN_4096, Piaffg_ALPHA_LEN_4096);
+
+    FF_4096_zero(dws, 2 * FFLEN_4096);
+    FF_4096_mul(dws, ws1, pre->A, FFLEN_4096);
+    FF_4096_dmod(ws1, dws, paillier_pub->n2, FFLEN_4096);
+
+    FF_4096_toOctet(&OCT, ws1, FFLEN_4096);
+    FF_2048_fromOctet(commit->A, &OCT, 2 * FFLEN_2048);
+
+    // Input independent commitments
+    FF_2048_copy(commit->E, pre->E, FFLEN_2048);
+    FF_2048_copy(commit->F, pre->F, FFLEN_2048);
+    FF_2048_copy(commit->By, pre->By, 2 * FFLEN_2048);
+    ECP_SECP256K1_copy(&commit->Bx, &pre->Bx);
+
+    Piaffg_Commitment_toOctets_enc(commitsOct, commit);
+
+    // Hand the secrets over, the precommitments can not be used again
+    FF_2048_copy(secrets->alpha, pre->secrets.alpha, HFLEN_2048);
+    FF_2048_copy(secrets->beta, pre->secrets.beta, FFLEN_2048);
+    FF_2048_copy(secrets->r, pre->secrets.r, FFLEN_2048);
+    FF_2048_copy(secrets->ry, pre->secrets.ry, 2 * FFLEN_2048);
+    FF_2048_copy(secrets->gamma, pre->secrets.gamma, FFLEN_2048 + HFLEN_2048);
+    FF_2048_copy(secrets->m, pre->secrets.m, FFLEN_2048 + HFLEN_2048);
+    FF_2048_copy(secrets->delta, pre->secrets.delta, FFLEN_2048 + HFLEN_2048);
+    FF_2048_copy(secrets->mu, pre->secrets.mu, FFLEN_2048 + HFLEN_2048);
+
+    Piaffg_Kill_precommits(pre);
+
+    // ------------ CLEAN MEMORY ----------
+    OCT_clear(&OCT);
+    FF_2048_zero(x_, FFLEN_2048 + HFLEN_2048);
+    FF_2048_zero(y_, HFLEN_4096);
+    FF_4096_zero(alpha, Piaffg_ALPHA_LEN_4096);
+    FF_4096_zero(ws1, FFLEN_4096);
+    FF_4096_zero(dws, 2*FFLEN_4096);
+
+    return Piaffg_OK;
+}
+
+void Piaffg_Kill_precommits(Piaffg_PRECOMMITS *pre){
+    Piaffg_Kill_secrets(&pre->secrets);
+    FF_4096_zero(pre->A, FFLEN_4096);
+    memset(pre->key_id, 0, SHA256);
+}
+
+int Piaffg_Sample_and_Commit(csprng *RNG, PAILLIER_private_key *paillier_priv, PAILLIER_public_key *paillier_pub,
+                              PEDERSEN_PUB *pedersen_pub, octet *x, octet *y, Piaffg_SECRETS *secrets,
+                              Piaffg_COMMITS *commit, Piaffg_COMMITS_OCT *commitsOct, octet *C){
+
+    Piaffg_PRECOMMITS pre;
+
+    int rc = Piaffg_Precommit(RNG, paillier_priv, paillier_pub, pedersen_pub, &pre);
+    if (rc != Piaffg_OK) {
+        return rc;
+    }
+
+    return Piaffg_Commit_online(paillier_pub, pedersen_pub, x, y, C, &pre, secrets, commit, commitsOct);
+}
+
 void Piaffg_Commitment_toOctets_enc(Piaffg_COMMITS_OCT *commitsOct, Piaffg_COMMITS *commit){
 
     FF_2048_toOctet(commitsOct->A, commit->A, 2 * FFLEN_2048);
@@ -558,8 +635,7 @@ int Piaffg_Verify(PAILLIER_private_key *verifier_paillier_priv, PAILLIER_public_
 
     // ------------ VALIDATES THE PROOF - PART1 ----------
     // Split check s^z1 * t^z3 * S^(-e) == E mod PQ using CRT
-    CG21_Pedersen_verify(p_proof, pedersen_priv, proofs->z1, proofs->z3, commits->S, e, pedersen_priv->mod.p, false);
-    CG21_Pedersen_verify(q_proof, pedersen_priv, proofs->z1, proofs->z3, commits->S, e, pedersen_priv->mod.q, false);
+    CG21_Pedersen_verify_crt(p_proof, q_proof, pedersen_priv, proofs->z1, proofs->z3, commits->S, e, false);
 
     FF_2048_dmod(p_gt, commits->E, pedersen_priv->mod.p, HFLEN_2048);
     FF_2048_dmod(q_gt, commits->E, pedersen_priv->mod.q, HFLEN_2048);
@@ -579,8 +655,7 @@ int Piaffg_Verify(PAILLIER_private_key *verifier_paillier_priv, PAILLIER_public_
 
     // ------------ VALIDATES THE PROOF - PART2 ----------
     // Split check s^z2 * t^z4 * T^(-e) == F mod PQ using CRT
-    CG21_Pedersen_verify(p_proof, pedersen_priv, proofs->z2, proofs->z4, commits->T, e, pedersen_priv->mod.p, 1);
-    CG21_Pedersen_verify(q_proof, pedersen_priv, proofs->z2, proofs->z4, commits->T, e, pedersen_priv->mod.q, 1);
+    CG21_Pedersen_verify_crt(p_proof, q_proof, pedersen_priv, proofs->z2, proofs->z4, commits->T, e, 1);
 
     FF_2048_dmod(p_gt, commits->F, pedersen_priv->mod.p, HFLEN_2048);
     FF_2048_dmod(q_gt, commits->F, pedersen_priv->mod.q, HFLEN_2048);
@@ -17,16 +17,30 @@ specific language governing permissions and limitations
 under the License.
 */
 
+#include <string.h>
 #include "amcl/cg21/cg21_rp_pi_affp.h"
 #include "amcl/hash_utils.h"
 
-int PiAffp_Sample_and_Commit(csprng *RNG, PAILLIER_private_key *paillier_priv, PAILLIER_public_key *paillier_pub,
-                              PEDERSEN_PUB *pedersen_pub, octet *x, octet *y, PiAffp_SECRETS *secrets,
-                              PiAffp_COMMITS *commit, PiAffp_COMMITS_OCT *commitsOct, octet *C){
+/* alpha < q^3 fits in HFS_2048 bytes, so C^alpha only needs this many FF_4096 limbs */
+#define PiAffp_ALPHA_LEN_4096 ((HFS_2048) / MODBYTES_512_60)
+
+/* Hash of the verifier's keys the precommitments are computed for */
+static void PiAffp_key_id(PAILLIER_public_key *paillier_pub, PEDERSEN_PUB *pedersen_pub, char *id)
+{
+    hash256 sha;
+
+    HASH256_init(&sha);
+    CG21_hash_pubKey_pubCom(&sha, paillier_pub, pedersen_pub);
+    HASH256_hash(&sha, id);
+}
+
+int PiAffp_Precommit(csprng *RNG, PAILLIER_private_key *paillier_priv, PAILLIER_public_key *paillier_pub,
+                     PEDERSEN_PUB *pedersen_pub, PiAffp_PRECOMMITS *pre){
 
     // ------------ VARIABLE DEFINITION ----------
+    PiAffp_SECRETS *secrets = &pre->secrets;
+
     BIG_1024_58 n_b[FFLEN_2048];
-    BIG_1024_58 n2_b[2 * FFLEN_2048];
 
     BIG_1024_58 q[HFLEN_2048];          //q:256 bits
     BIG_1024_58 q2[FFLEN_2048];         //q^2
@@ -40,13 +54,9 @@ int PiAffp_Sample_and_Commit(csprng *RNG, PAILLIER_private_key *paillier_priv, P
     BIG_1024_58 m_mod[2 * FFLEN_2048];
     BIG_1024_58 mu_mod[2 * FFLEN_2048];
 
-    BIG_1024_58 x_[2 * FFLEN_2048];
-    BIG_1024_58 y_[2 * FFLEN_2048];
-
     BIG_512_60 ws1[FFLEN_4096];
     BIG_512_60 ws2[FFLEN_4096];
     BIG_512_60 dws[2 * FFLEN_4096];
-    BIG_512_60 alpha[HFLEN_4096];
     BIG_512_60 r_[FFLEN_4096];
     BIG_512_60 beta[FFLEN_4096];
     BIG_1024_58 tws[FFLEN_2048 + HFLEN_2048];
@@ -71,19 +81,19 @@ int PiAffp_Sample_and_Commit(csprng *RNG, PAILLIER_private_key *paillier_priv, P
 
     PAILLIER_public_key PUB;
 
+    if (RNG == NULL)
+    {
+        return PiAffp_RNG_IS_NULL;
+    }
+
+    PiAffp_key_id(paillier_pub, pedersen_pub, pre->key_id);
+
     // Curve order
     CG21_GET_CURVE_ORDER(q);
 
-    // Calculate N and N^2 parameters based on p and q
+    // Calculate N parameter based on p and q
     FF_2048_mul(n_b, paillier_priv->p, paillier_priv->q, HFLEN_2048);
 
-    FF_2048_sqr(n2_b, n_b, FFLEN_2048);
-    FF_2048_norm(n2_b, 2 * FFLEN_2048);
-
-    if (RNG == NULL)
-    {
-        return PiAffp_RNG_IS_NULL;
-    }
     FF_2048_sqr(q2, q, HFLEN_2048);
     FF_2048_mul(q3, q, q2, HFLEN_2048);
     FF_2048_mul(q5, q3, q2, FFLEN_2048);
@@ -133,47 +143,24 @@ int PiAffp_Sample_and_Commit(csprng *RNG, PAILLIER_private_key *paillier_priv, P
     FF_2048_random(secrets->mu, RNG, FFLEN_2048 + HFLEN_2048);  //mu: (1024+2048)-bit random number
     FF_2048_mod(secrets->mu, mu_mod, FFLEN_2048 + HFLEN_2048);  //mu: (1024+2048)-bit reduced to (256+2048)-bit number
 
-
-    // ------------ READING INPUTS ----------
-    OCT_copy(&OCT, x);
-    OCT_pad(&OCT, HFS_2048);
-    FF_2048_zero(x_, FFLEN_2048 + HFLEN_2048);
-    FF_2048_fromOctet(x_, &OCT, HFLEN_2048);
-
-    OCT_copy(&OCT, y);
-    OCT_pad(&OCT, HFS_4096);
-    FF_2048_zero(y_, HFLEN_4096);
-    FF_2048_fromOctet(y_, &OCT, FFLEN_2048);
-
     // ------------ COMMITMENT ----------
     // Compute E: b0^alpha * b1^gamma mod hat{N}
     FF_2048_zero(tws, FFLEN_2048 + HFLEN_2048);
     FF_2048_copy(tws, secrets->alpha, HFLEN_2048);
 
     // b0 is s and b1 is t from paper's fig.26
-    FF_2048_ct_pow_2(commit->E, pedersen_pub->b0, tws, pedersen_pub->b1, secrets->gamma,
-                     pedersen_pub->N, FFLEN_2048, FFLEN_2048 + HFLEN_2048);
-
-    // Compute S: b0^x * b1^m mod hat{N}
-    FF_2048_ct_pow_2(commit->S, pedersen_pub->b0, x_, pedersen_pub->b1, secrets->m,
+    FF_2048_ct_pow_2(pre->E, pedersen_pub->b0, tws, pedersen_pub->b1, secrets->gamma,
                      pedersen_pub->N, FFLEN_2048, FFLEN_2048 + HFLEN_2048);
 
     // Compute F: b0^beta * b1^delta mod hat{N}
     FF_2048_zero(tws, FFLEN_2048 + HFLEN_2048);
     FF_2048_copy(tws, secrets->beta, FFLEN_2048);
-    FF_2048_ct_pow_2(commit->F, pedersen_pub->b0, tws, pedersen_pub->b1, secrets->delta,
-                     pedersen_pub->N, FFLEN_2048, FFLEN_2048 + HFLEN_2048);
-
-    // Compute T: b0^y * b1^mu mod hat{N}
-    FF_2048_ct_pow_2(commit->T, pedersen_pub->b0, y_, pedersen_pub->b1, secrets->mu,
+    FF_2048_ct_pow_2(pre->F, pedersen_pub->b0, tws, pedersen_pub->b1, secrets->delta,
                      pedersen_pub->N, FFLEN_2048, FFLEN_2048 + HFLEN_2048);
 
-    // Compute A = C^alpha * g^beta * r^N mod n2
-    FF_4096_fromOctet(ws2, C, FFLEN_4096);
-
+    // Compute the input independent part of A = g^beta * r^N mod n2
     FF_2048_toOctet(&alpha_oct, secrets->alpha, HFLEN_2048);
     OCT_pad(&alpha_oct, HFS_4096);
-    FF_4096_fromOctet(alpha, &alpha_oct, HFLEN_4096);
 
     FF_2048_toOctet(&beta_oct, secrets->beta, FFLEN_2048);
     OCT_pad(&beta_oct, HFS_4096);
@@ -189,16 +176,13 @@ int PiAffp_Sample_and_Commit(csprng *RNG, PAILLIER_private_key *paillier_priv, P
     FF_4096_inc(ws1, 1, FFLEN_4096);
     FF_4096_norm(ws1, FFLEN_4096);
 
-    // C^alpha * r^N0 mod n2
-    FF_4096_ct_pow_2(ws2, ws2, alpha, r_, paillier_pub->n, paillier_pub->n2, FFLEN_4096, HFLEN_4096);
+    // r^N0 mod n2
+    FF_4096_ct_pow(ws2, r_, paillier_pub->n, paillier_pub->n2, FFLEN_4096, HFLEN_4096);
 
-    // (N0 * beta + 1) * C^alpha * r^N0 mod N0^2
+    // (N0 * beta + 1) * r^N0 mod N0^2
     FF_4096_zero(dws, 2 * FFLEN_4096);
     FF_4096_mul(dws, ws1, ws2, FFLEN_4096);
-    FF_4096_dmod(ws1, dws, paillier_pub->n2, FFLEN_4096);
-
-    FF_4096_toOctet(&OCT, ws1, FFLEN_4096);
-    FF_2048_fromOctet(commit->A, &OCT, 2 * FFLEN_2048);
+    FF_4096_dmod(pre->A, dws, paillier_pub->n2, FFLEN_4096);
 
     // Form PAILLIER_public_key using prover's PK
     FF_2048_toOctet(&OCT, n_b, FFLEN_2048);
@@ -216,12 +200,10 @@ int PiAffp_Sample_and_Commit(csprng *RNG, PAILLIER_private_key *paillier_priv, P
     OCT_pad(&ry_oct, FS_4096);
 
     PAILLIER_ENCRYPT(NULL, &PUB, &alpha_oct, &CT_oct,&rx_oct); // Bx = Enc(alpha; rx)
-    FF_2048_fromOctet(commit->Bx, &CT_oct, 2 * FFLEN_2048);
+    FF_2048_fromOctet(pre->Bx, &CT_oct, 2 * FFLEN_2048);
 
     PAILLIER_ENCRYPT(NULL, &PUB, &beta_oct, &CT_oct,&ry_oct);  // By = Enc(beta; ry)
-    FF_2048_fromOctet(commit->By, &CT_oct, 2 * FFLEN_2048);
-
-    PiAffp_Commitment_toOctets_enc(commitsOct, commit);
+    FF_2048_fromOctet(pre->By, &CT_oct, 2 * FFLEN_2048);
 
     // ------------ CLEAN MEMORY ----------
     OCT_clear(&OCT);
@@ -230,10 +212,10 @@ int PiAffp_Sample_and_Commit(csprng *RNG, PAILLIER_private_key *paillier_priv, P
     OCT_clear(&alpha_oct);
     OCT_clear(&beta_oct);
     OCT_clear(&CT_oct);
-    FF_2048_zero(x_, FFLEN_2048 + HFLEN_2048);
-    FF_2048_zero(y_, HFLEN_4096);
     FF_2048_zero(tws, FFLEN_2048 + HFLEN_2048);
     FF_4096_zero(r, FFLEN_4096);
+    FF_4096_zero(r_, FFLEN_4096);
+    FF_4096_zero(beta, FFLEN_4096);
     FF_4096_zero(ws1, FFLEN_4096);
     FF_4096_zero(ws2, FFLEN_4096);
     FF_4096_zero(dws, 2*FFLEN_4096);
@@ -241,6 +223,118 @@ int PiAffp_Sample_and_Commit(csprng *RNG, PAILLIER_private_key *paillier_priv, P
     return PiAffp_OK;
 }
 
+int PiAffp_Commit_online(PAILLIER_public_key *paillier_pub, PEDERSEN_PUB *pedersen_pub, octet *x, octet *y,
+                         octet *C, PiAffp_PRECOMMITS *pre, PiAffp_SECRETS *secrets,
+                         PiAffp_COMMITS *commit, PiAffp_COMMITS_OCT *commitsOct){
+
+    // ------------ VARIABLE DEFINITION ----------
+    BIG_1024_58 x_[2 * FFLEN_2048];
+    BIG_1024_58 y_[2 * FFLEN_2048];
+
+    BIG_512_60 ws1[FFLEN_4096];
+    BIG_512_60 dws[2 * FFLEN_4096];
+    BIG_512_60 alpha[PiAffp_ALPHA_LEN_4096];
+
+    char oct1[2 * FS_2048];
+    octet OCT = {0, sizeof(oct1), oct1};
+
+    char id[SHA256];
+
+    // ------------ CHECKING INPUTS ----------
+    PiAffp_key_id(paillier_pub, pedersen_pub, id);
+    if (memcmp(id, pre->key_id, SHA256) != 0)
+    {
+        return PiAffp_INVALID_PRECOMMIT;
+    }
+
+    // ------------ READING INPUTS ----------
+    OCT_copy(&OCT, x);
+    OCT_pad(&OCT, HFS_2048);
+    FF_2048_zero(x_, FFLEN_2048 + HFLEN_2048);
+    FF_2048_fromOctet(x_, &OCT, HFLEN_2048);
+
+    OCT_copy(&OCT, y);
+    OCT_pad(&OCT, HFS_4096);
+    FF_2048_zero(y_, HFLEN_4096);
+    FF_2048_fromOctet(y_, &OCT, FFLEN_2048);
+
+    // ------------ COMMITMENT ----------
+    // Compute S: b0^x * b1^m mod hat{N}
+    FF_2048_ct_pow_2(commit->S, pedersen_pub->b0, x_, pedersen_pub->b1, pre->secrets.m,
+                     pedersen_pub->N, FFLEN_2048, FFLEN_2048 + HFLEN_2048);
+
+    // Compute T: b0^y * b1^mu mod hat{N}
+    FF_2048_ct_pow_2(commit->T, pedersen_pub->b0, y_, pedersen_pub->b1, pre->secrets.mu,
+                     pedersen_pub->N, FFLEN_2048, FFLEN_2048 + HFLEN_2048);
+
+    // Complete A = C^alpha * g^beta * r^N mod n2
+    FF_4096_fromOctet(ws1, C, FFLEN_4096);
+
+    FF_2048_toOctet(&OCT, pre->secrets.alpha, HFLEN_2048);
+    FF_4096_fromOctet(alpha, &OCT, PiAffp_ALPHA_LEN_4096);
+
+    FF_4096_ct_pow(ws1, ws1, alpha, paillier_pub->n2, FFLEN_4096, PiAffp_ALPHA_LEN_4096);
+
+    FF_4096_zero(dws, 2 * FFLEN_4096);
+    FF_4096_mul(dws, ws1, pre->A, FFLEN_4096);
+    FF_4096_dmod(ws1, dws, paillier_pub->n2, FFLEN_4096);
+
+    FF_4096_toOctet(&OCT, ws1, FFLEN_4096);
+    FF_2048_fromOctet(commit->A, &OCT, 2 * FFLEN_2048);
+
+    // Input independent commitments
+    FF_2048_copy(commit->E, pre->E, FFLEN_2048);
+    FF_2048_copy(commit->F, pre->F, FFLEN_2048);
+    FF_2048_copy(commit->Bx, pre->Bx, 2 * FFLEN_2048);
+    FF_2048_copy(commit->By, pre->By, 2 * FFLEN_2048);
+
+    PiAffp_Commitment_toOctets_enc(commitsOct, commit);
+
+    // Hand the secrets over, the precommitments can not be used again
+    FF_2048_copy(secrets->alpha, pre->secrets.alpha, HFLEN_2048);
+    FF_2048_copy(secrets->beta, pre->secrets.beta, FFLEN_2048);
+    FF_2048_copy(secrets->r, pre->secrets.r, FFLEN_2048);
+    FF_2048_copy(secrets->rx, pre->secrets.rx, 2 * FFLEN_2048);
+    FF_2048_copy(secrets->ry, pre->secrets.ry, 2 * FFLEN_2048);
+    FF_2048_copy(secrets->gamma, pre->secrets.gamma, FFLEN_2048 + HFLEN_2048);
+    FF_2048_copy(secrets->m, pre->secrets.m, FFLEN_2048 + HFLEN_2048);
+    FF_2048_copy(secrets->delta, pre->secrets.delta, FFLEN_2048 + HFLEN_2048);
+    FF_2048_copy(secrets->mu, pre->secrets.mu, FFLEN_2048 + HFLEN_2048);
+
+    PiAffp_Kill_precommits(pre);
+
+    // ------------ CLEAN MEMORY ----------
+    OCT_clear(&OCT);
+    FF_2048_zero(x_, FFLEN_2048 + HFLEN_2048);
+    FF_2048_zero(y_, HFLEN_4096);
+    FF_4096_zero(alpha, PiAffp_ALPHA_LEN_4096);
+    FF_4096_zero(ws1, FFLEN_4096);
+    FF_4096_zero(dws, 2*FFLEN_4096);
+
+    return PiAffp_OK;
+}
+
+void PiAffp_Kill_precommits(PiAffp_PRECOMMITS *pre){
+    PiAffp_Kill_secrets(&pre->secrets);
+    FF_4096_zero(pre->A, FFLEN_4096);
+    memset(pre->key_id, 0, SHA256);
+}
+
+int PiAffp_Sample_and_Commit(csprng *RNG, PAILLIER_private_key *paillier_priv, PAILLIER_public_key *paillier_pub,
+                              PEDERSEN_PUB *pedersen_pub, octet *x, octet *y, PiAffp_SECRETS *secrets,
+                              PiAffp_COMMITS *commit, PiAffp_COMMITS_OCT *commitsOct, octet *C){
+
+    PiAffp_PRECOMMITS pre;
+
+    int rc = PiAffp_Precommit(RNG, paillier_priv, paillier_pub, pedersen_pub, &pre);
+    if (rc != PiAffp_OK)
+    {
+        return rc;
+    }
+
+    return PiAffp_Commit_online(paillier_pub, pedersen_pub, x, y, C, &pre, secrets, commit, commitsOct);
+}
+
 void PiAffp_Commitment_toOctets_enc(PiAffp_COMMITS_OCT *commitsOct, PiAffp_COMMITS *commit){
 
     FF_2048_toOctet(&commitsOct->A, commit->A, 2 * FFLEN_2048);
@@ -559,8 +653,7 @@ int PiAffp_Verify(PAILLIER_private_key *verifier_paillier_priv, PAILLIER_public_
 
     // ------------ VALIDATES THE PROOF - PART1 ----------
     // Split check s^z1 * t^z3 * S^(-e) == E mod PQ using CRT
-    CG21_Pedersen_verify(p_proof, pedersen_priv, proofs->z1, proofs->z3, commits->S, e, pedersen_priv->mod.p, false);
-    CG21_Pedersen_verify(q_proof, pedersen_priv, proofs->z1, proofs->z3, commits->S, e, pedersen_priv->mod.q, false);
+    CG21_Pedersen_verify_crt(p_proof, q_proof, pedersen_priv, proofs->z1, proofs->z3, commits->S, e, false);
 
     FF_2048_dmod(p_gt, commits->E, pedersen_priv->mod.p, HFLEN_2048);
     FF_2048_dmod(q_gt, commits->E, pedersen_priv->mod.q, HFLEN_2048);
@@ -580,8 +673,7 @@ int PiAffp_Verify(PAILLIER_private_key *verifier_paillier_priv, PAILLIER_public_
 
     // ------------ VALIDATES THE PROOF - PART2 ----------
     // Split check s^z2 * t^z4 * T^(-e) == F mod PQ using CRT
-    CG21_Pedersen_verify(p_proof, pedersen_priv, proofs->z2, proofs->z4, commits->T, e, pedersen_priv->mod.p, 1);
-    CG21_Pedersen_verify(q_proof, pedersen_priv, proofs->z2, proofs->z4, commits->T, e, pedersen_priv->mod.q, 1);
+    CG21_Pedersen_verify_crt(p_proof, q_proof, pedersen_priv, proofs->z2, proofs->z4, commits->T, e, 1);
 
     FF_2048_dmod(p_gt, commits->F, pedersen_priv->mod.p, HFLEN_2048);
     FF_2048_dmod(q_gt, commits->F, pedersen_priv->mod.q, HFLEN_2048);
@@ -19,40 +19,74 @@ under the License.
 
 #include "amcl/cg21/cg21_rp_pi_enc.h"
 #include "amcl/hash_utils.h"
+#include "amcl/parallel.h"
 
-int PiEnc_Sample_randoms_and_commit(csprng *RNG, PAILLIER_private_key *priv_key, PEDERSEN_PUB *pub_com,
-                                    octet *k, PiEnc_SECRETS *secrets, PiEnc_COMMITS *commits, PiEnc_COMMITS_OCT *commitsOct)
+/* Shared state for the two CRT halves of the Paillier commitment A */
+typedef struct
 {
+    PAILLIER_private_key *priv_key;
+    BIG_1024_58 *r;
+    BIG_1024_58 *n;
+    BIG_1024_58 *dws2;
+    BIG_1024_58 *out[2];
+} PiEnc_commit_A_ctx;
+
+/* Compute (1 + n * alpha) * r^n mod P^2 for i = 0 or mod Q^2 for i = 1 */
+static void PiEnc_commit_A_half(void *arg, int i)
+{
+    PiEnc_commit_A_ctx *c = (PiEnc_commit_A_ctx *)arg;
+    BIG_1024_58 *m = (i == 0) ? c->priv_key->p2 : c->priv_key->q2;
 
-    /*
-     * ---------STEP 1: choosing randoms -----------
-     * alpha:       random from [0, q^3]
-     * mu_mod:      q + \hat{N} bits
-     * r:           Z_{N_0}
-     * gamma_mod:   q^3 + \hat{N} bits
-     */
+    BIG_1024_58 ws3[FFLEN_2048];
+    BIG_1024_58 t[2 * FFLEN_2048];
 
-     /* ---------STEP 2: commitment --------------
-     * S = s^k x t^mu_mod pub_com \hat{N}
-     * A = (1 + N0)^alpha x r^N0 pub_com N0^2
-     * C = s^alpha x t^gamma_mod pub_com \hat{N}
-     */
+    FF_2048_dmod(ws3, c->dws2, m, FFLEN_2048);
+    FF_2048_inc(ws3, 1, FFLEN_2048);
+    FF_2048_norm(ws3, FFLEN_2048);
 
+    FF_2048_ct_pow(c->out[i], c->r, c->n, m, FFLEN_2048, FFLEN_2048);
 
-    // ------------ CHECKING INPUTS -------------
-    if (RNG == NULL){
-        return PiEnc_RNG_IS_NULL;
-    }
-    if (priv_key == NULL){
-        return PiEnc_PAILLIER_SK_IS_NULL;
-    }
-    if (pub_com == NULL){
-        return PiEnc_COM_PUB_IS_NULL;
-    }
-    if (k == NULL){
-        return PiEnc_INPUT_IS_NULL;
-    }
+    FF_2048_mul(t, c->out[i], ws3, FFLEN_2048);
+    FF_2048_dmod(c->out[i], t, m, FFLEN_2048);
+
+    FF_2048_zero(ws3, FFLEN_2048);
+    FF_2048_zero(t, 2 * FFLEN_2048);
+}
+
+/* Shared state for the two CRT halves of z2 */
+typedef struct
+{
+    PAILLIER_private_key *priv_key;
+    BIG_1024_58 *rho;
+    BIG_1024_58 *r;
+    BIG_1024_58 *e;
+    BIG_1024_58 *out[2];
+} PiEnc_prove_z2_ctx;
+
+/* Compute r * rho^e mod P for i = 0 or mod Q for i = 1 */
+static void PiEnc_prove_z2_half(void *arg, int i)
+{
+    PiEnc_prove_z2_ctx *c = (PiEnc_prove_z2_ctx *)arg;
+    BIG_1024_58 *m = (i == 0) ? c->priv_key->p : c->priv_key->q;
+
+    BIG_1024_58 hws[HFLEN_2048];
+    BIG_1024_58 ws1[FFLEN_2048];
 
+    CG21_FF_2048_amod(hws, c->rho, 2 * FFLEN_2048, m, HFLEN_2048);
+    FF_2048_dmod(c->out[i], c->r, m, HFLEN_2048);
+    FF_2048_nt_pow(hws, hws, c->e, m, HFLEN_2048, HFLEN_2048);
+    FF_2048_mul(ws1, c->out[i], hws,  HFLEN_2048);
+    FF_2048_dmod(c->out[i], ws1, m, HFLEN_2048);
+
+    FF_2048_zero(hws, HFLEN_2048);
+    FF_2048_zero(ws1, FFLEN_2048);
+}
+
+/* Sample alpha, r and compute the Paillier commitment A.
+ * None of these depend on the verifier */
+static void PiEnc_sample_paillier(csprng *RNG, PAILLIER_private_key *priv_key,
+                                  PiEnc_SECRETS *secrets, BIG_512_60 *A)
+{
     // ------------ VARIABLE DEFINITION ----------
     BIG_1024_58 q[HFLEN_2048];
     BIG_1024_58 q2[FFLEN_2048];
@@ -61,16 +95,14 @@ int PiEnc_Sample_randoms_and_commit(csprng *RNG, PAILLIER_private_key *priv_key,
     BIG_1024_58 n[FFLEN_2048];
     BIG_1024_58 invp2q2[FFLEN_2048];
     BIG_1024_58 n2[2 * FFLEN_2048];
-    BIG_1024_58 ws3[FFLEN_2048];
-    BIG_1024_58 gamma_mod[FFLEN_2048 + HFLEN_2048];
-    BIG_1024_58 mu_mod[2 * FFLEN_2048];
     BIG_1024_58 dws2[2 * FFLEN_2048];
     BIG_1024_58 t[2 * FFLEN_2048];
 
+    PiEnc_commit_A_ctx ctx;
+
     char oct[2 * FS_2048];
     octet OCT = {0, sizeof(oct), oct};
 
-
     // Curve order
     CG21_GET_CURVE_ORDER(q);
 
@@ -79,7 +111,6 @@ int PiEnc_Sample_randoms_and_commit(csprng *RNG, PAILLIER_private_key *priv_key,
     FF_2048_norm(n2, 2 * FFLEN_2048);
     FF_2048_invmodp(invp2q2, priv_key->p2, priv_key->q2, FFLEN_2048);
 
-
     FF_2048_sqr(q2, q, HFLEN_2048);
     FF_2048_mul(q3, q, q2, HFLEN_2048);
 
@@ -92,6 +123,63 @@ int PiEnc_Sample_randoms_and_commit(csprng *RNG, PAILLIER_private_key *priv_key,
     // Generate r in [0, .., N]
     FF_2048_randomnum(secrets->r, n, RNG, FFLEN_2048);   // r: 1024-bit random number
 
+    // ------------ COMMITMENT ----------
+    // Compute A using CRT and Paillier PK trick
+    // Compute 1 + n * alpha
+    // Defer the increment after the modular reduction so it can
+    // be performed without conversion to FF_4096
+    FF_2048_zero(dws2, 2 * FFLEN_2048);
+    CG21_FF_2048_amul(dws2, secrets->alpha, HFLEN_2048, n, FFLEN_2048);
+
+    // Compute pub_com P^2 and Q^2
+    ctx.priv_key = priv_key;
+    ctx.r = secrets->r;
+    ctx.n = n;
+    ctx.dws2 = dws2;
+    ctx.out[0] = q2;
+    ctx.out[1] = q3;
+
+    PARALLEL_crt(PiEnc_commit_A_half, &ctx);
+
+    // Combine results
+    FF_2048_crt(t, q2, q3, priv_key->p2, invp2q2, n2, FFLEN_2048);
+
+    // Convert A to FF_4096 since it is only used as such
+    FF_2048_toOctet(&OCT, t, 2 * FFLEN_2048);
+    FF_4096_fromOctet(A, &OCT, FFLEN_4096);
+
+    // ------------ CLEAN MEMORY ----------
+    OCT_clear(&OCT);
+    FF_2048_zero(dws2, 2 * FFLEN_2048);
+    FF_2048_zero(q2, FFLEN_2048);
+    FF_2048_zero(q3, FFLEN_2048);
+    FF_2048_zero(t, 2 * FFLEN_2048);
+    FF_2048_zero(invp2q2, FFLEN_2048);
+}
+
+/* Sample gamma, mu and compute the Pedersen commitments S and C
+ * for the verifier owning pub_com. Expects secrets->alpha to be set */
+static void PiEnc_sample_pedersen(csprng *RNG, PEDERSEN_PUB *pub_com, octet *k,
+                                  PiEnc_SECRETS *secrets, PiEnc_COMMITS *commits)
+{
+    // ------------ VARIABLE DEFINITION ----------
+    BIG_1024_58 q[HFLEN_2048];
+    BIG_1024_58 q2[FFLEN_2048];
+    BIG_1024_58 q3[FFLEN_2048];
+    BIG_1024_58 gamma_mod[FFLEN_2048 + HFLEN_2048];
+    BIG_1024_58 mu_mod[2 * FFLEN_2048];
+    BIG_1024_58 t[2 * FFLEN_2048];
+
+    char oct[2 * FS_2048];
+    octet OCT = {0, sizeof(oct), oct};
+
+    // Curve order
+    CG21_GET_CURVE_ORDER(q);
+
+    FF_2048_sqr(q2, q, HFLEN_2048);
+    FF_2048_mul(q3, q, q2, HFLEN_2048);
+
+    // ------------ RANDOM GENERATION ----------
     // Generate gamma in [0, .., Nt * q^3]
     CG21_FF_2048_amul(gamma_mod, q3, HFLEN_2048, pub_com->N, FFLEN_2048);   //Nt*q^3
     FF_2048_norm(gamma_mod, FFLEN_2048 + HFLEN_2048);
@@ -118,55 +206,97 @@ int PiEnc_Sample_randoms_and_commit(csprng *RNG, PAILLIER_private_key *priv_key,
     FF_2048_copy(t, secrets->alpha, HFLEN_2048);
     FF_2048_ct_pow_2(commits->C, pub_com->b0, t, pub_com->b1, secrets->gamma, pub_com->N, FFLEN_2048, FFLEN_2048 + HFLEN_2048);
 
-    // Compute A using CRT and Paillier PK trick
-    // Compute 1 + n * alpha
-    // Defer the increment after the modular reduction so it can
-    // be performed without conversion to FF_4096
-    FF_2048_zero(dws2, 2 * FFLEN_2048);
-    CG21_FF_2048_amul(dws2, secrets->alpha, HFLEN_2048, n, FFLEN_2048);
-
-    // Compute pub_com P^2
-    FF_2048_dmod(ws3, dws2, priv_key->p2, FFLEN_2048);
-    FF_2048_inc(ws3, 1, FFLEN_2048);
-    FF_2048_norm(ws3, FFLEN_2048);
-
-    FF_2048_ct_pow(q2, secrets->r, n, priv_key->p2, FFLEN_2048, FFLEN_2048);
+    // ------------ CLEAN MEMORY ----------
+    OCT_clear(&OCT);
+    FF_2048_zero(t, 2 * FFLEN_2048);
+}
 
-    FF_2048_mul(t, q2, ws3, FFLEN_2048);
-    FF_2048_dmod(q2, t, priv_key->p2, FFLEN_2048);
+int PiEnc_Sample_randoms_and_commit(csprng *RNG, PAILLIER_private_key *priv_key, PEDERSEN_PUB *pub_com,
+                                    octet *k, PiEnc_SECRETS *secrets, PiEnc_COMMITS *commits, PiEnc_COMMITS_OCT *commitsOct)
+{
 
-    // Compute pub_com Q^2
-    FF_2048_dmod(ws3, dws2, priv_key->q2, FFLEN_2048);
-    FF_2048_inc(ws3, 1, FFLEN_2048);
-    FF_2048_norm(ws3, FFLEN_2048);
+    /*
+     * ---------STEP 1: choosing randoms -----------
+     * alpha:       random from [0, q^3]
+     * mu_mod:      q + \hat{N} bits
+     * r:           Z_{N_0}
+     * gamma_mod:   q^3 + \hat{N} bits
+     */
 
-    FF_2048_ct_pow(q3, secrets->r, n, priv_key->q2, FFLEN_2048, FFLEN_2048);
+     /* ---------STEP 2: commitment --------------
+     * S = s^k x t^mu_mod pub_com \hat{N}
+     * A = (1 + N0)^alpha x r^N0 pub_com N0^2
+     * C = s^alpha x t^gamma_mod pub_com \hat{N}
+     */
 
-    FF_2048_mul(t, q3, ws3, FFLEN_2048);
-    FF_2048_dmod(q3, t, priv_key->q2, FFLEN_2048);
 
-    // Combine results
-    FF_2048_crt(t, q2, q3, priv_key->p2, invp2q2, n2, FFLEN_2048);
+    // ------------ CHECKING INPUTS -------------
+    if (RNG == NULL){
+        return PiEnc_RNG_IS_NULL;
+    }
+    if (priv_key == NULL){
+        return PiEnc_PAILLIER_SK_IS_NULL;
+    }
+    if (pub_com == NULL){
+        return PiEnc_COM_PUB_IS_NULL;
+    }
+    if (k == NULL){
+        return PiEnc_INPUT_IS_NULL;
+    }
 
-    // Convert A to FF_4096 since it is only used as such
-    FF_2048_toOctet(&OCT, t, 2 * FFLEN_2048);
-    FF_4096_fromOctet(commits->A, &OCT, FFLEN_4096);
+    PiEnc_sample_paillier(RNG, priv_key, secrets, commits->A);
+    PiEnc_sample_pedersen(RNG, pub_com, k, secrets, commits);
 
     // the commitment to octets for transmission
     PiEnc_Commitment_toOctets_enc(commitsOct, commits);
 
-    // ------------ CLEAN MEMORY ----------
-    OCT_clear(&OCT);
-    FF_2048_zero(dws2, 2 * FFLEN_2048);
-    FF_2048_zero(ws3, FFLEN_2048);
-    FF_2048_zero(q2, FFLEN_2048);
-    FF_2048_zero(q3, FFLEN_2048);
-    FF_2048_zero(t, 2 * FFLEN_2048);
-    FF_2048_zero(invp2q2, FFLEN_2048);
-    FF_2048_zero(ws3, HFLEN_2048);
+    return PiEnc_OK;
+}
+
+int PiEnc_Sample_randoms_and_commit_multi(csprng *RNG, PAILLIER_private_key *priv_key, PEDERSEN_PUB *pub_com[], int n,
+                                          octet *k, PiEnc_SECRETS *secrets, PiEnc_COMMITS *commits, PiEnc_COMMITS_OCT *commitsOct)
+{
+    // ------------ CHECKING INPUTS -------------
+    if (RNG == NULL){
+        return PiEnc_RNG_IS_NULL;
+    }
+    if (priv_key == NULL){
+        return PiEnc_PAILLIER_SK_IS_NULL;
+    }
+    if (pub_com == NULL){
+        return PiEnc_COM_PUB_IS_NULL;
+    }
+    for (int j = 0; j < n; j++){
+        if (pub_com[j] == NULL){
+            return PiEnc_COM_PUB_IS_NULL;
+        }
+    }
+    if (k == NULL || n < 1){
+        return PiEnc_INPUT_IS_NULL;
+    }
+
+    // alpha, r and A are computed once and shared by all the verifiers
+    PiEnc_sample_paillier(RNG, priv_key, &secrets[0], commits[0].A);
+
+    for (int j = 1; j < n; j++)
+    {
+        FF_2048_copy(secrets[j].alpha, secrets[0].alpha, FFLEN_2048);
+        FF_2048_copy(secrets[j].r, secrets[0].r, FFLEN_2048);
+        FF_4096_copy(commits[j].A, commits[0].A, FFLEN_4096);
+    }
+
+    // S and C are bound to the Pedersen parameters of each verifier
+    for (int j = 0; j < n; j++)
+    {
+        PiEnc_sample_pedersen(RNG, pub_com[j], k, &secrets[j], &commits[j]);
+
+        // the commitment to octets for transmission
+        PiEnc_Commitment_toOctets_enc(&commitsOct[j], &commits[j]);
+    }
 
     return PiEnc_OK;
 }
+
 void PiEnc_hash_commits(hash256 *sha, PiEnc_COMMITS *com)
 {
     char oct[2 * FS_2048];
@@ -221,6 +351,69 @@ void PiEnc_Challenge_gen(PAILLIER_public_key *pub_key, PEDERSEN_PUB *pub_com,
     E->len = EGS_SECP256K1;
 }
 
+void PiEnc_Challenge_gen_multi(PAILLIER_public_key *pub_key, PEDERSEN_PUB *pub_com[], int n,
+                               const octet *K, PiEnc_COMMITS *commits, CG21_SSID *ssid, octet *E)
+{
+    // ------------ VARIABLE DEFINITION ----------
+    hash256 sha;
+    BIG_256_56 q;
+    BIG_256_56 t;
+
+    char oct[FS_4096];
+    octet OCT = {0, sizeof(oct), oct};
+
+    HASH256_init(&sha);
+
+    // ------------ CHALLENGE GENERATION ----------
+    /* Bind to the public key of the prover and proof input */
+    FF_4096_toOctet(&OCT, pub_key->n, HFLEN_4096);
+    HASH_UTILS_hash_oct(&sha, &OCT);
+
+    HASH_UTILS_hash_oct(&sha, K);
+
+    /* Bind each verifier, in order, to its (Nt,s,t) and (S,A,C). A is the same
+     * for all the verifiers, but each of them checks the copy it received */
+    HASH_UTILS_hash_i2osp4(&sha, n);
+
+    for (int j = 0; j < n; j++)
+    {
+        HASH_UTILS_hash_i2osp4(&sha, j);
+
+        FF_2048_toOctet(&OCT, pub_com[j]->N, FFLEN_2048);
+        HASH_UTILS_hash_oct(&sha, &OCT);
+
+        FF_2048_toOctet(&OCT, pub_com[j]->b0, FFLEN_2048);
+        HASH_UTILS_hash_oct(&sha, &OCT);
+
+        FF_2048_toOctet(&OCT, pub_com[j]->b1, FFLEN_2048);
+        HASH_UTILS_hash_oct(&sha, &OCT);
+
+        FF_2048_toOctet(&OCT, commits[j].S, FFLEN_2048);
+        HASH_UTILS_hash_oct(&sha, &OCT);
+
+        FF_4096_toOctet(&OCT, commits[j].A, FFLEN_4096);
+        HASH_UTILS_hash_oct(&sha, &OCT);
+
+        FF_2048_toOctet(&OCT, commits[j].C, FFLEN_2048);
+        HASH_UTILS_hash_oct(&sha, &OCT);
+    }
+
+    /* Bind to SSID */
+    int rc = CG21_hash_SSID(ssid, &sha);
+    if (rc != CG21_OK){
+        exit(rc);
+    }
+
+    // ------------ OUTPUT ----------
+    BIG_256_56_rcopy(q, CURVE_Order_SECP256K1);
+    HASH_UTILS_rejection_sample_mod_BIG(&sha, q, t);
+
+    BIG_256_56_toBytes(E->val, t);
+    E->len = EGS_SECP256K1;
+
+    OCT_clear(&OCT);
+}
+
 void PiEnc_proof_toOctets(PiEnc_PROOFS_OCT *proofsOct, PiEnc_PROOFS *proofs)
 {
     FF_2048_toOctet(proofsOct->z1, proofs->z1, HFLEN_2048);
@@ -269,13 +462,14 @@ void PiEnc_Prove(PAILLIER_private_key *priv_key, octet *k_oct, octet *rho_oct,
     // ------------ VARIABLE DEFINITION ----------
     BIG_1024_58 ws1[FFLEN_2048];
     BIG_1024_58 ws2[FFLEN_2048];
-    BIG_1024_58 hws[HFLEN_2048];
     BIG_1024_58 rho[2 * FFLEN_2048];
     BIG_1024_58 e[HFLEN_2048];
     BIG_1024_58 k[HFLEN_2048];
     BIG_1024_58 sp[HFLEN_2048];
     BIG_1024_58 sq[HFLEN_2048];
 
+    PiEnc_prove_z2_ctx ctx;
+
     char oct[2*FS_2048];
     octet OCT = {0, sizeof(oct), oct};
 
@@ -296,17 +490,14 @@ void PiEnc_Prove(PAILLIER_private_key *priv_key, octet *k_oct, octet *rho_oct,
 
     // ------------ GENERATE PiEnc_PROOFS ----------
     // Compute z2 = r * mu^e mod N using CRT
-    CG21_FF_2048_amod(hws, rho, 2 * FFLEN_2048, priv_key->p, HFLEN_2048);
-    FF_2048_dmod(sp, secrets->r, priv_key->p, HFLEN_2048);
-    FF_2048_nt_pow(hws, hws, e, priv_key->p, HFLEN_2048, HFLEN_2048);
-    FF_2048_mul(ws1, sp, hws,  HFLEN_2048);
-    FF_2048_dmod(sp, ws1, priv_key->p, HFLEN_2048);
-
-    CG21_FF_2048_amod(hws, rho, 2 * FFLEN_2048, priv_key->q, HFLEN_2048);
-    FF_2048_dmod(sq, secrets->r, priv_key->q, HFLEN_2048);
-    FF_2048_nt_pow(hws, hws, e, priv_key->q, HFLEN_2048, HFLEN_2048);
-    FF_2048_mul(ws1, sq, hws,  HFLEN_2048);
-    FF_2048_dmod(sq, ws1, priv_key->q, HFLEN_2048);
+    ctx.priv_key = priv_key;
+    ctx.rho = rho;
+    ctx.r = secrets->r;
+    ctx.e = e;
+    ctx.out[0] = sp;
+    ctx.out[1] = sq;
+
+    PARALLEL_crt(PiEnc_prove_z2_half, &ctx);
 
     FF_2048_mul(ws2, priv_key->p, priv_key->q, HFLEN_2048);
     FF_2048_crt(ws1, sp, sq, priv_key->p, priv_key->invpq, ws2, HFLEN_2048);
@@ -336,7 +527,6 @@ void PiEnc_Prove(PAILLIER_private_key *priv_key, octet *k_oct, octet *rho_oct,
     FF_2048_zero(rho, 2 * FFLEN_2048);
     FF_2048_zero(ws1, FFLEN_2048);
     FF_2048_zero(ws2, FFLEN_2048);
-    FF_2048_zero(hws, HFLEN_2048);
     FF_2048_zero(sp, HFLEN_2048);
     FF_2048_zero(sq, HFLEN_2048);
     FF_2048_zero(k, HFLEN_2048);
@@ -383,8 +573,7 @@ int PiEnc_Verify(PAILLIER_public_key *pub_key, PEDERSEN_PRIV *priv_com, octet *K
 
     // ------------ VALIDATES THE PROOF - PART1 ----------
     // Split computation of proofs for C using CRT.
-    CG21_Pedersen_verify(wp_proof, priv_com, proofs->z1, proofs->z3, commits->S, e, priv_com->mod.p,false);
-    CG21_Pedersen_verify(wq_proof, priv_com, proofs->z1, proofs->z3, commits->S, e, priv_com->mod.q, false);
+    CG21_Pedersen_verify_crt(wp_proof, wq_proof, priv_com, proofs->z1, proofs->z3, commits->S, e, false);
 
     // Reduce C mod P and Q for comparison
     FF_2048_dmod(hws1, commits->C, priv_com->mod.p, HFLEN_2048);
@@ -21,45 +21,12 @@ under the License.
 #include "amcl/hash_utils.h"
 
 
-int PiLogstar_Sample_and_commit(csprng *RNG, PAILLIER_private_key *priv_key, PEDERSEN_PUB *pub_com,
-                                octet *x, octet *g, PiLogstar_SECRETS *secrets, PiLogstar_COMMITS *commits,
-                                PiLogstar_COMMITS_OCT *commitsOct)
+/* Sample alpha, r and compute the Paillier commitment A.
+ * None of these depend on the verifier */
+static void PiLogstar_sample_paillier(csprng *RNG, PAILLIER_private_key *priv_key,
+                                      PiLogstar_SECRETS *secrets, BIG_512_60 *A)
 {
-    /*
-     * ---------STEP 1: choosing randoms -----------
-     * alpha:       random from [0, q^3]
-     * mu_mod:      |q| + |\hat{N}| bits
-     * r:           random from Z_{N_0}
-     * gamma_mod:   |q^3| + |\hat{N}| bits
-     *
-     * ---------STEP 2: commitment --------------
-     * S = s^x * t^mu mod \hat{N}
-     * A = (1 + N0)^alpha * r^N0 mod N0^2
-     * D = s^alpha * t^gamma mod \hat{N}
-     * Y = alpha*G
-     */
-
-
-    // ------------ CHECKING INPUTS -------------
-    if (RNG == NULL){
-        return PiLogstar_RNG_IS_NULL;
-    }
-    if (priv_key == NULL){
-        return PiLogstar_PAILLIER_SK_IS_NULL;
-    }
-    if (pub_com == NULL){
-        return PiLogstar_COM_PUB_IS_NULL;
-    }
-    if (x == NULL){
-        return PiLogstar_INPUT_IS_NULL;
-    }
-    if (g == NULL){
-        return PiLogstar_INPUT_IS_NULL;
-    }
-
     // ------------ VARIABLE DEFINITION ----------
-    ECP_SECP256K1 G;
-
     BIG_1024_58 q[HFLEN_2048];          // q
     BIG_1024_58 q2[FFLEN_2048];         // q^2
     BIG_1024_58 q3[FFLEN_2048];         // q^3
@@ -68,15 +35,12 @@ int PiLogstar_Sample_and_commit(csprng *RNG, PAILLIER_private_key *priv_key, PED
     BIG_1024_58 invp2q2[FFLEN_2048];
     BIG_1024_58 n2[2 * FFLEN_2048];     // n^2
     BIG_1024_58 ws3[FFLEN_2048];
-    BIG_1024_58 gamma_mod[FFLEN_2048 + HFLEN_2048];
-    BIG_1024_58 mu_mod[2 * FFLEN_2048];
     BIG_1024_58 dws2[2 * FFLEN_2048];
     BIG_1024_58 t[2 * FFLEN_2048];
 
     char oct[2 * FS_2048];
     octet OCT = {0, sizeof(oct), oct};
 
-
     // Curve order
     CG21_GET_CURVE_ORDER(q);
 
@@ -97,34 +61,7 @@ int PiLogstar_Sample_and_commit(csprng *RNG, PAILLIER_private_key *priv_key, PED
     // Generate r in [0, .., N]
     FF_2048_randomnum(secrets->r, n, RNG, FFLEN_2048);   // |N| bit sized r needs to be reduced mod N
 
-    // Generate mu_mod in [0, .., Nt * q^3]
-    CG21_FF_2048_amul(gamma_mod, q3, HFLEN_2048, pub_com->N, FFLEN_2048);   //Nt*q^3
-    FF_2048_norm(gamma_mod,FFLEN_2048 + HFLEN_2048);
-    FF_2048_random(secrets->gamma, RNG, FFLEN_2048 + HFLEN_2048);           //gamma_mod: a (1024+2048)-bit number
-    FF_2048_mod(secrets->gamma, gamma_mod, FFLEN_2048 + HFLEN_2048);            //gamma_mod: in [0, .., 3*256+2048]
-
-    // Generate mu_mod in [0, .., Nt * q]
-    CG21_FF_2048_amul(mu_mod, q, HFLEN_2048, pub_com->N, FFLEN_2048);
-    FF_2048_norm(mu_mod,FFLEN_2048 + HFLEN_2048);
-    FF_2048_random(secrets->mu, RNG, FFLEN_2048 + HFLEN_2048);         //mu_mod: a (1024+2048)-bit number
-    FF_2048_mod(secrets->mu, mu_mod, FFLEN_2048 + HFLEN_2048);             //mu_mod: in [0, .., 256+2048]
-
-    // ------------ READING INPUTS ----------
-    OCT_copy(&OCT, x);                      // x is 32 bytes long
-    OCT_pad(&OCT, HFS_2048);                // pad to ensure that all 1024 bits are initialized
-    FF_2048_zero(t, 2 * FFLEN_2048);        // Set t to zero
-    FF_2048_fromOctet(t, &OCT, HFLEN_2048);
-
     // ------------ COMMITMENT ----------
-    // Compute S and C
-    FF_2048_ct_pow_2(commits->S, pub_com->b0, t, pub_com->b1, secrets->mu, pub_com->N, FFLEN_2048, FFLEN_2048 + HFLEN_2048);
-
-    FF_2048_copy(t, secrets->alpha, HFLEN_2048);
-
-    // recall: b0 is s and b1 is t from the eprint fig.25
-    FF_2048_ct_pow_2(commits->D, pub_com->b0, t, pub_com->b1, secrets->gamma, pub_com->N,
-                     FFLEN_2048, FFLEN_2048 + HFLEN_2048);
-
     // Compute A using CRT and Paillier PK trick
     // Compute 1 + n * alpha
     // Defer the increment after the modular reduction so it can
@@ -159,28 +96,191 @@ int PiLogstar_Sample_and_commit(csprng *RNG, PAILLIER_private_key *priv_key, PED
 
     // Convert A to FF_4096 since it is only used as such
     FF_2048_toOctet(&OCT, t, 2 * FFLEN_2048);
-    FF_4096_fromOctet(commits->A, &OCT, FFLEN_4096);
+    FF_4096_fromOctet(A, &OCT, FFLEN_4096);
+
+    // ------------ CLEAN MEMORY ----------
+    OCT_clear(&OCT);
+    FF_2048_zero(dws2, 2 * FFLEN_2048);
+    FF_2048_zero(ws3, FFLEN_2048);
+    FF_2048_zero(q2, FFLEN_2048);
+    FF_2048_zero(q3, FFLEN_2048);
+    FF_2048_zero(t, 2 * FFLEN_2048);
+    FF_2048_zero(invp2q2, FFLEN_2048);
+}
+
+/* Sample gamma, mu and compute the Pedersen commitments S and D
+ * for the verifier owning pub_com. Expects secrets->alpha to be set */
+static void PiLogstar_sample_pedersen(csprng *RNG, PEDERSEN_PUB *pub_com, octet *x,
+                                      PiLogstar_SECRETS *secrets, PiLogstar_COMMITS *commits)
+{
+    // ------------ VARIABLE DEFINITION ----------
+    BIG_1024_58 q[HFLEN_2048];          // q
+    BIG_1024_58 q2[FFLEN_2048];         // q^2
+    BIG_1024_58 q3[FFLEN_2048];         // q^3
+    BIG_1024_58 gamma_mod[FFLEN_2048 + HFLEN_2048];
+    BIG_1024_58 mu_mod[2 * FFLEN_2048];
+    BIG_1024_58 t[2 * FFLEN_2048];
+
+    char oct[2 * FS_2048];
+    octet OCT = {0, sizeof(oct), oct};
+
+    // Curve order
+    CG21_GET_CURVE_ORDER(q);
+
+    FF_2048_sqr(q2, q, HFLEN_2048);
+    FF_2048_mul(q3, q, q2, HFLEN_2048);
+
+    // ------------ RANDOM GENERATION ----------
+    // Generate mu_mod in [0, .., Nt * q^3]
+    CG21_FF_2048_amul(gamma_mod, q3, HFLEN_2048, pub_com->N, FFLEN_2048);   //Nt*q^3
+    FF_2048_norm(gamma_mod,FFLEN_2048 + HFLEN_2048);
+    FF_2048_random(secrets->gamma, RNG, FFLEN_2048 + HFLEN_2048);           //gamma_mod: a (1024+2048)-bit number
+    FF_2048_mod(secrets->gamma, gamma_mod, FFLEN_2048 + HFLEN_2048);            //gamma_mod: in [0, .., 3*256+2048]
+
+    // Generate mu_mod in [0, .., Nt * q]
+    CG21_FF_2048_amul(mu_mod, q, HFLEN_2048, pub_com->N, FFLEN_2048);
+    FF_2048_norm(mu_mod,FFLEN_2048 + HFLEN_2048);
+    FF_2048_random(secrets->mu, RNG, FFLEN_2048 + HFLEN_2048);         //mu_mod: a (1024+2048)-bit number
+    FF_2048_mod(secrets->mu, mu_mod, FFLEN_2048 + HFLEN_2048);             //mu_mod: in [0, .., 256+2048]
+
+    // ------------ READING INPUTS ----------
+    OCT_copy(&OCT, x);                      // x is 32 bytes long
+    OCT_pad(&OCT, HFS_2048);                // pad to ensure that all 1024 bits are initialized
+    FF_2048_zero(t, 2 * FFLEN_2048);        // Set t to zero
+    FF_2048_fromOctet(t, &OCT, HFLEN_2048);
+
+    // ------------ COMMITMENT ----------
+    // Compute S and C
+    FF_2048_ct_pow_2(commits->S, pub_com->b0, t, pub_com->b1, secrets->mu, pub_com->N, FFLEN_2048, FFLEN_2048 + HFLEN_2048);
+
+    FF_2048_copy(t, secrets->alpha, HFLEN_2048);
+
+    // recall: b0 is s and b1 is t from the eprint fig.25
+    FF_2048_ct_pow_2(commits->D, pub_com->b0, t, pub_com->b1, secrets->gamma, pub_com->N,
+                     FFLEN_2048, FFLEN_2048 + HFLEN_2048);
+
+    // ------------ CLEAN MEMORY ----------
+    OCT_clear(&OCT);
+    FF_2048_zero(t, 2 * FFLEN_2048);
+}
+
+/* Compute the group commitment Y = alpha*g */
+static int PiLogstar_commit_Y(octet *g, PiLogstar_SECRETS *secrets, ECP_SECP256K1 *Y)
+{
+    ECP_SECP256K1 G;
 
-    // Compute Y
     int rc = ECP_SECP256K1_fromOctet(&G, g);
     if (rc != 1)
     {
         return Pilogstar_Y_FAIL;
     }
     ECP_mul_1024(&G, secrets->alpha);
-    ECP_SECP256K1_copy(&commits->Y,&G);
+    ECP_SECP256K1_copy(Y, &G);
+
+    return PiLogstar_OK;
+}
+
+int PiLogstar_Sample_and_commit(csprng *RNG, PAILLIER_private_key *priv_key, PEDERSEN_PUB *pub_com,
+                                octet *x, octet *g, PiLogstar_SECRETS *secrets, PiLogstar_COMMITS *commits,
+                                PiLogstar_COMMITS_OCT *commitsOct)
+{
+    /*
+     * ---------STEP 1: choosing randoms -----------
+     * alpha:       random from [0, q^3]
+     * mu_mod:      |q| + |\hat{N}| bits
+     * r:           random from Z_{N_0}
+     * gamma_mod:   |q^3| + |\hat{N}| bits
+     *
+     * ---------STEP 2: commitment --------------
+     * S = s^x * t^mu mod \hat{N}
+     * A = (1 + N0)^alpha * r^N0 mod N0^2
+     * D = s^alpha * t^gamma mod \hat{N}
+     * Y = alpha*G
+     */
+
+
+    // ------------ CHECKING INPUTS -------------
+    if (RNG == NULL){
+        return PiLogstar_RNG_IS_NULL;
+    }
+    if (priv_key == NULL){
+        return PiLogstar_PAILLIER_SK_IS_NULL;
+    }
+    if (pub_com == NULL){
+        return PiLogstar_COM_PUB_IS_NULL;
+    }
+    if (x == NULL){
+        return PiLogstar_INPUT_IS_NULL;
+    }
+    if (g == NULL){
+        return PiLogstar_INPUT_IS_NULL;
+    }
+
+    PiLogstar_sample_paillier(RNG, priv_key, secrets, commits->A);
+    PiLogstar_sample_pedersen(RNG, pub_com, x, secrets, commits);
+
+    // Compute Y
+    int rc = PiLogstar_commit_Y(g, secrets, &commits->Y);
+    if (rc != PiLogstar_OK)
+    {
+        return rc;
+    }
 
     // the commitment to octets for transmission
     PiLogstar_Commitment_toOctets_logstar(commitsOct, commits);
 
-    // ------------ CLEAN MEMORY ----------
-    OCT_clear(&OCT);
-    FF_2048_zero(dws2, 2 * FFLEN_2048);
-    FF_2048_zero(ws3, FFLEN_2048);
-    FF_2048_zero(q2, FFLEN_2048);
-    FF_2048_zero(q3, FFLEN_2048);
-    FF_2048_zero(t, 2 * FFLEN_2048);
-    FF_2048_zero(invp2q2, FFLEN_2048);
+    return PiLogstar_OK;
+}
+
+int PiLogstar_Sample_and_commit_multi(csprng *RNG, PAILLIER_private_key *priv_key, PEDERSEN_PUB *pub_com[], int n,
+                                      octet *x, octet *g, PiLogstar_SECRETS *secrets, PiLogstar_COMMITS *commits,
+                                      PiLogstar_COMMITS_OCT *commitsOct)
+{
+    // ------------ CHECKING INPUTS -------------
+    if (RNG == NULL){
+        return PiLogstar_RNG_IS_NULL;
+    }
+    if (priv_key == NULL){
+        return PiLogstar_PAILLIER_SK_IS_NULL;
+    }
+    if (pub_com == NULL){
+        return PiLogstar_COM_PUB_IS_NULL;
+    }
+    for (int j = 0; j < n; j++){
+        if (pub_com[j] == NULL){
+            return PiLogstar_COM_PUB_IS_NULL;
+        }
+    }
+    if (x == NULL || g == NULL || n < 1){
+        return PiLogstar_INPUT_IS_NULL;
+    }
+
+    // alpha, r, A and Y are computed once and shared by all the verifiers
+    PiLogstar_sample_paillier(RNG, priv_key, &secrets[0], commits[0].A);
+
+    int rc = PiLogstar_commit_Y(g, &secrets[0], &commits[0].Y);
+    if (rc != PiLogstar_OK)
+    {
+        PiLogstar_clean_secrets(&secrets[0]);
+        return rc;
+    }
+
+    for (int j = 1; j < n; j++)
+    {
+        FF_2048_copy(secrets[j].alpha, secrets[0].alpha, HFLEN_2048);
+        FF_2048_copy(secrets[j].r, secrets[0].r, FFLEN_2048);
+        FF_4096_copy(commits[j].A, commits[0].A, FFLEN_4096);
+        ECP_SECP256K1_copy(&commits[j].Y, &commits[0].Y);
+    }
+
+    // S and D are bound to the Pedersen parameters of each verifier
+    for (int j = 0; j < n; j++)
+    {
+        PiLogstar_sample_pedersen(RNG, pub_com[j], x, &secrets[j], &commits[j]);
+
+        // the commitment to octets for transmission
+        PiLogstar_Commitment_toOctets_logstar(&commitsOct[j], &commits[j]);
+    }
 
     return PiLogstar_OK;
 }
@@ -243,6 +343,74 @@ void PiLogstar_Challenge_gen(PAILLIER_public_key *pub_key, PEDERSEN_PUB *pub_com
     E->len = EGS_SECP256K1;
 }
 
+void PiLogstar_Challenge_gen_multi(PAILLIER_public_key *pub_key, PEDERSEN_PUB *pub_com[], int n,
+                                   const octet *C, PiLogstar_COMMITS *commits, CG21_SSID *ssid,
+                                   const octet *X, octet *E)
+{
+    // ------------ VARIABLE DEFINITION ----------
+    hash256 sha;
+    BIG_256_56 q;
+    BIG_256_56 t;
+
+    char oct[FS_4096];
+    octet OCT = {0, sizeof(oct), oct};
+
+    HASH256_init(&sha);
+
+    // ------------ CHALLENGE GENERATION ----------
+    /* Bind to the public key of the prover and proof input */
+    FF_4096_toOctet(&OCT, pub_key->n, HFLEN_4096);
+    HASH_UTILS_hash_oct(&sha, &OCT);
+
+    HASH_UTILS_hash_oct(&sha, C);
+    HASH_UTILS_hash_oct(&sha, X);
+
+    /* Bind each verifier, in order, to its (Nt,s,t) and (S,A,Y,D). A and Y are
+     * the same for all the verifiers, but each of them checks the copy it received */
+    HASH_UTILS_hash_i2osp4(&sha, n);
+
+    for (int j = 0; j < n; j++)
+    {
+        HASH_UTILS_hash_i2osp4(&sha, j);
+
+        FF_2048_toOctet(&OCT, pub_com[j]->N, FFLEN_2048);
+        HASH_UTILS_hash_oct(&sha, &OCT);
+
+        FF_2048_toOctet(&OCT, pub_com[j]->b0, FFLEN_2048);
+        HASH_UTILS_hash_oct(&sha, &OCT);
+
+        FF_2048_toOctet(&OCT, pub_com[j]->b1, FFLEN_2048);
+        HASH_UTILS_hash_oct(&sha, &OCT);
+
+        FF_2048_toOctet(&OCT, commits[j].S, FFLEN_2048);
+        HASH_UTILS_hash_oct(&sha, &OCT);
+
+        FF_4096_toOctet(&OCT, commits[j].A, FFLEN_4096);
+        HASH_UTILS_hash_oct(&sha, &OCT);
+
+        ECP_SECP256K1_toOctet(&OCT, &commits[j].Y, true);
+        HASH_UTILS_hash_oct(&sha, &OCT);
+
+        FF_2048_toOctet(&OCT, commits[j].D, FFLEN_2048);
+        HASH_UTILS_hash_oct(&sha, &OCT);
+    }
+
+    /* Bind to SSID */
+    int rc = CG21_hash_SSID(ssid, &sha);
+    if (rc != CG21_OK){
+        exit(rc);
+    }
+
+    // ------------ OUTPUT ----------
+    BIG_256_56_rcopy(q, CURVE_Order_SECP256K1);
+    HASH_UTILS_rejection_sample_mod_BIG(&sha, q, t); // interpret sha output as an int mod q
+
+    BIG_256_56_toBytes(E->val, t);
+    E->len = EGS_SECP256K1;
+
+    OCT_clear(&OCT);
+}
+
 void PiLogstar_proof_toOctets(PiLogstar_PROOFS_OCT *proofsOct, PiLogstar_PROOFS *proofs)
 {
     FF_2048_toOctet(proofsOct->z1, proofs->z1, HFLEN_2048);
@@ -422,8 +590,7 @@ int PiLogstar_Verify(PAILLIER_public_key *pub_key, PEDERSEN_PRIV *priv_com, octe
     // ------------ VALIDATES THE PROOF - PART1 ----------
     // s^z1 * t^z3 =? D * S^e
     // Split computation of proofs for C using CRT.
-    CG21_Pedersen_verify(wp_proof, priv_com, proofs->z1, proofs->z3, commits->S, e, priv_com->mod.p,false);
-    CG21_Pedersen_verify(wq_proof, priv_com, proofs->z1, proofs->z3, commits->S, e, priv_com->mod.q, false);
+    CG21_Pedersen_verify_crt(wp_proof, wq_proof, priv_com, proofs->z1, proofs->z3, commits->S, e, false);
 
     // Reduce C mod P and Q for comparison
     FF_2048_dmod(hws1, commits->D, priv_com->mod.p, HFLEN_2048);
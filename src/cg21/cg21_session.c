@@ -0,0 +1,887 @@
+/*
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"); you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+*/
+
+/* Round-driven session of one player in a phase of CG21 */
+
+#include "amcl/cg21/cg21_session.h"
+#include "amcl/cg21/cg21_wire.h"
+
+int CG21_SESSION_STATUS(int processed, int n)
+{
+    if (n == 1)
+    {
+        return 3;
+    }
+
+    if (processed == 0)
+    {
+        return 0;
+    }
+
+    if (processed == n - 1)
+    {
+        return 2;
+    }
+
+    return 1;
+}
+
+void CG21_SESSION_INIT(CG21_SESSION *s, const CG21_SESSION_PHASE *phase, void *state,
+                       const int *peers, int *seen, int n,
+                       CG21_SESSION_MSG *queue, int queue_max, octet **outbox)
+{
+    s->phase = phase;
+    s->state = state;
+    s->peers = peers;
+    s->seen = seen;
+    s->n = n;
+    s->round = 0;
+    s->processed = 0;
+    s->aborted = 0;
+    s->queue = queue;
+    s->queue_max = queue_max;
+    s->outbox = outbox;
+
+    for (int j = 0; j < n; j++)
+    {
+        seen[j] = 0;
+    }
+
+    for (int j = 0; j < queue_max; j++)
+    {
+        queue[j].round = 0;
+    }
+}
+
+/* Position of a peer, -1 if it is not a peer of the session */
+static int CG21_SESSION_index(const CG21_SESSION *s, int from)
+{
+    for (int j = 0; j < s->n; j++)
+    {
+        if (s->peers[j] == from)
+        {
+            return j;
+        }
+    }
+
+    return -1;
+}
+
+/* Process a message of the current round, and mark it as seen once it is processed */
+static int CG21_SESSION_process(CG21_SESSION *s, int j, octet *body)
+{
+    int status = CG21_SESSION_STATUS(s->processed, s->n);
+    int rc = s->phase->process(s->state, s->round, s->peers[j], body, status);
+    if (rc != CG21_OK)
+    {
+        return rc;
+    }
+
+    s->seen[j] |= 1 << (s->round - 1);
+    s->processed++;
+
+    return CG21_SESSION_OK;
+}
+
+/* Move on while the current round is complete: start the next round and process its queued messages */
+static int CG21_SESSION_advance(CG21_SESSION *s, int *sent)
+{
+    int rc;
+
+    while (s->processed == s->n)
+    {
+        if (s->round == s->phase->rounds)
+        {
+            rc = s->phase->finish(s->state);
+            if (rc != CG21_OK)
+            {
+                return rc;
+            }
+
+            s->round++;
+            return CG21_SESSION_OK;
+        }
+
+        s->round++;
+        s->processed = 0;
+
+        rc = s->phase->start(s->state, s->round, s->outbox[s->round - 1]);
+        if (rc != CG21_OK)
+        {
+            return rc;
+        }
+
+        *sent |= 1 << (s->round - 1);
+
+        for (int k = 0; k < s->queue_max; k++)
+        {
+            if (s->queue[k].round == s->round)
+            {
+                // free the slot first, the session is aborted if the message is invalid
+                s->queue[k].round = 0;
+
+                rc = CG21_SESSION_process(s, CG21_SESSION_index(s, s->queue[k].from), s->queue[k].body);
+                if (rc != CG21_OK)
+                {
+                    return rc;
+                }
+            }
+        }
+    }
+
+    return CG21_SESSION_OK;
+}
+
+int CG21_SESSION_START(CG21_SESSION *s, int *sent)
+{
+    int rc;
+
+    *sent = 0;
+
+    if (s->aborted)
+    {
+        return CG21_SESSION_ABORTED;
+    }
+
+    if (s->round != 0)
+    {
+        return CG21_SESSION_ALREADY_STARTED;
+    }
+
+    // round 0 has no messages, so it is complete
+    s->processed = s->n;
+
+    rc = CG21_SESSION_advance(s, sent);
+    if (rc != CG21_SESSION_OK)
+    {
+        s->aborted = 1;
+    }
+
+    return rc;
+}
+
+int CG21_SESSION_PUSH(CG21_SESSION *s, const CG21_SESSION_MSG *msg, int *sent)
+{
+    int j;
+    int rc;
+
+    *sent = 0;
+
+    if (s->aborted)
+    {
+        return CG21_SESSION_ABORTED;
+    }
+
+    if (s->round > s->phase->rounds)
+    {
+        return CG21_SESSION_FINISHED;
+    }
+
+    if (msg->round < 1 || msg->round > s->phase->rounds)
+    {
+        return CG21_SESSION_INVALID_ROUND;
+    }
+
+    j = CG21_SESSION_index(s, msg->from);
+    if (j < 0)
+    {
+        return CG21_SESSION_UNKNOWN_PEER;
+    }
+
+    // the message of this round was already processed, or it is queued
+    if (s->seen[j] & (1 << (msg->round - 1)))
+    {
+        return CG21_SESSION_DUPLICATE_MESSAGE;
+    }
+
+    for (int k = 0; k < s->queue_max; k++)
+    {
+        if (s->queue[k].round == msg->round && s->queue[k].from == msg->from)
+        {
+            return CG21_SESSION_DUPLICATE_MESSAGE;
+        }
+    }
+
+    if (msg->round > s->round)
+    {
+        for (int k = 0; k < s->queue_max; k++)
+        {
+            if (s->queue[k].round == 0)
+            {
+                s->queue[k].round = msg->round;
+                s->queue[k].from = msg->from;
+                OCT_copy(s->queue[k].body, msg->body);
+
+                return CG21_SESSION_OK;
+            }
+        }
+
+        return CG21_SESSION_QUEUE_FULL;
+    }
+
+    rc = CG21_SESSION_process(s, j, msg->body);
+    if (rc == CG21_SESSION_OK)
+    {
+        rc = CG21_SESSION_advance(s, sent);
+    }
+
+    if (rc != CG21_SESSION_OK)
+    {
+        s->aborted = 1;
+    }
+
+    return rc;
+}
+
+int CG21_SESSION_DONE(const CG21_SESSION *s)
+{
+    return s->round > s->phase->rounds;
+}
+
+/* Position of a peer in a presign state, -1 if it is not a peer */
+static int CG21_PRESIGN_PHASE_index(const CG21_PRESIGN_SESSION_STATE *st, int from)
+{
+    for (int k = 0; k < st->n; k++)
+    {
+        if (st->peers[k] == from)
+        {
+            return k;
+        }
+    }
+
+    return -1;
+}
+
+/* Length of the fields of the proofs, as written by the provers */
+static const int CG21_PRESIGN_PHASE_enc_sizes[CG21_WIRE_PIENC_PROOF_FIELDS] =
+{
+    FS_2048, FS_4096, FS_2048, HFS_2048, HFS_4096, FS_2048 + HFS_2048
+};
+
+static const int CG21_PRESIGN_PHASE_logstar_sizes[CG21_WIRE_PILOGSTAR_PROOF_FIELDS] =
+{
+    FS_2048, FS_4096, FS_2048, CG21_WIRE_POINT_SIZE, HFS_2048, HFS_4096, FS_2048 + HFS_2048
+};
+
+static const int CG21_PRESIGN_PHASE_affg_sizes[CG21_WIRE_PIAFFG_PROOF_FIELDS] =
+{
+    FS_4096, CG21_WIRE_POINT_SIZE, FS_4096, FS_2048, FS_2048, FS_2048, FS_2048,
+    FS_2048, FS_2048, FS_2048 + HFS_2048, FS_2048 + HFS_2048, FS_2048, FS_2048
+};
+
+/* Length of the encoded psi, psi_hat and psi_prime of round 2 */
+static const int CG21_PRESIGN_PHASE_psi_sizes[3] =
+{
+    CG21_WIRE_PIAFFG_PROOF_SIZE, CG21_WIRE_PIAFFG_PROOF_SIZE, CG21_WIRE_PILOGSTAR_PROOF_SIZE
+};
+
+/* Proofs of round 2 for one peer */
+typedef struct
+{
+    Piaffg_COMMITS affgCommit;
+    Piaffg_PROOFS affgProof;
+    Piaffg_COMMITS_OCT affgCommitOct;
+    Piaffg_PROOFS_OCT affgProofOct;
+    Piaffg_COMMITS affgHatCommit;
+    Piaffg_PROOFS affgHatProof;
+    Piaffg_COMMITS_OCT affgHatCommitOct;
+    Piaffg_PROOFS_OCT affgHatProofOct;
+    PiLogstar_COMMITS logCommit;
+    PiLogstar_PROOFS logProof;
+    PiLogstar_COMMITS_OCT logCommitOct;
+    PiLogstar_PROOFS_OCT logProofOct;
+
+} CG21_PRESIGN_PHASE_ROUND2_PROOFS;
+
+/* Point n octets at consecutive slices of mem, with the given lengths */
+static void CG21_PRESIGN_PHASE_carve(char *mem, octet *o, const int *sizes, int n)
+{
+    for (int j = 0; j < n; j++)
+    {
+        o[j].len = 0;
+        o[j].max = sizes[j];
+        o[j].val = mem;
+        mem += sizes[j];
+    }
+}
+
+/* Fields of a PiEnc proof, in the order of the wire encoding */
+static void CG21_PRESIGN_PHASE_enc_oct(PiEnc_COMMITS_OCT *c, PiEnc_PROOFS_OCT *p, octet *o)
+{
+    c->S = o;
+    c->A = o + 1;
+    c->C = o + 2;
+    p->z1 = o + 3;
+    p->z2 = o + 4;
+    p->z3 = o + 5;
+}
+
+/* Fields of a PiLogstar proof, in the order of the wire encoding */
+static void CG21_PRESIGN_PHASE_logstar_oct(PiLogstar_COMMITS_OCT *c, PiLogstar_PROOFS_OCT *p, octet *o)
+{
+    c->S = o;
+    c->A = o + 1;
+    c->D = o + 2;
+    c->Y = o + 3;
+    p->z1 = o + 4;
+    p->z2 = o + 5;
+    p->z3 = o + 6;
+}
+
+/* Fields of a PiAffg proof, in the order of the wire encoding */
+static void CG21_PRESIGN_PHASE_affg_oct(Piaffg_COMMITS_OCT *c, Piaffg_PROOFS_OCT *p, octet *o)
+{
+    c->A = o;
+    c->Bx = o + 1;
+    c->By = o + 2;
+    c->E = o + 3;
+    c->S = o + 4;
+    c->F = o + 5;
+    c->T = o + 6;
+    p->z1 = o + 7;
+    p->z2 = o + 8;
+    p->z3 = o + 9;
+    p->z4 = o + 10;
+    p->w = o + 11;
+    p->wy = o + 12;
+}
+
+/* PiEnc proof for K addressed to peer k, encoded in psi */
+static int CG21_PRESIGN_PHASE_prove_enc(CG21_PRESIGN_SESSION_STATE *st, int k, octet *psi)
+{
+    PiEnc_SECRETS secrets;
+    PiEnc_COMMITS commits;
+    PiEnc_PROOFS proofs;
+    PiEnc_COMMITS_OCT commitsOct;
+    PiEnc_PROOFS_OCT proofsOct;
+
+    char mem[CG21_WIRE_PIENC_PROOF_SIZE];
+    octet o[CG21_WIRE_PIENC_PROOF_FIELDS];
+
+    char e_[MODBYTES_256_56];
+    octet e = {0, sizeof(e_), e_};
+
+    CG21_PRESIGN_PHASE_carve(mem, o, CG21_PRESIGN_PHASE_enc_sizes, CG21_WIRE_PIENC_PROOF_FIELDS);
+    CG21_PRESIGN_PHASE_enc_oct(&commitsOct, &proofsOct, o);
+
+    int rc = PiEnc_Sample_randoms_and_commit(st->RNG, &st->myKeys->paillier_sk, st->hisPedersen + k,
+                                             st->r1store->k, &secrets, &commits, &commitsOct);
+    if (rc != PiEnc_OK)
+    {
+        return CG21_PRESIGN_FAILED;
+    }
+
+    PiEnc_Challenge_gen(&st->myKeys->paillier_pk, st->hisPedersen + k, st->r1out->K, &commits, st->ssid, &e);
+
+    PiEnc_Prove(&st->myKeys->paillier_sk, st->r1store->k, st->r1store->rho, &secrets, &e, &proofs, &proofsOct);
+
+    PiEnc_Kill_secrets(&secrets);
+
+    return CG21_WIRE_PIENC_PROOF_toOctet(psi, &commitsOct, &proofsOct);
+}
+
+/* Verify the PiEnc proof of peer k for his K */
+static int CG21_PRESIGN_PHASE_verify_enc(CG21_PRESIGN_SESSION_STATE *st, int k, const CG21_PRESIGN_ROUND1_OUTPUT *his)
+{
+    PiEnc_COMMITS commits;
+    PiEnc_PROOFS proofs;
+    PiEnc_COMMITS_OCT commitsOct;
+    PiEnc_PROOFS_OCT proofsOct;
+    octet views[CG21_WIRE_PIENC_PROOF_FIELDS];
+
+    char e_[MODBYTES_256_56];
+    octet e = {0, sizeof(e_), e_};
+
+    int rc = CG21_WIRE_PIENC_PROOF_fromOctet(his->psi, &commitsOct, &proofsOct, views);
+    if (rc != CG21_WIRE_OK)
+    {
+        return rc;
+    }
+
+    PiEnc_commits_fromOctets(&commits, &commitsOct);
+    PiEnc_proofs_fromOctets(&proofs, &proofsOct);
+
+    PiEnc_Challenge_gen(st->hisPK + k, &st->myPedersen->pedersenPub, his->K, &commits, st->ssid, &e);
+
+    rc = PiEnc_Verify(st->hisPK + k, &st->myPedersen->pedersenPriv, his->K, &commits, &e, &proofs);
+    if (rc != PiEnc_OK)
+    {
+        return CG21_PRESIGN_ENC_NOT_VALID;
+    }
+
+    return CG21_OK;
+}
+
+/* Run the MtA and the proofs of round 2 for all the peers, and encode them in out */
+static int CG21_PRESIGN_PHASE_round2(CG21_PRESIGN_SESSION_STATE *st, octet *out)
+{
+    int n = st->n;
+    int rc;
+
+    CG21_PRESIGN_ROUND2_PEER peers[n];
+    CG21_PRESIGN_PHASE_ROUND2_PROOFS proofs[n];
+    CG21_PRESIGN_ROUND2_OUTPUT r2[n];
+
+    // proofs as written by the provers, then encoded
+    char mem[n][2 * CG21_WIRE_PIAFFG_PROOF_SIZE + CG21_WIRE_PILOGSTAR_PROOF_SIZE];
+    octet o[n][2 * CG21_WIRE_PIAFFG_PROOF_FIELDS + CG21_WIRE_PILOGSTAR_PROOF_FIELDS];
+    char psimem[n][2 * CG21_WIRE_PIAFFG_PROOF_SIZE + CG21_WIRE_PILOGSTAR_PROOF_SIZE];
+    octet psi[n][3];
+
+    for (int k = 0; k < n; k++)
+    {
+        CG21_PRESIGN_ROUND2_PEER *p = peers + k;
+        CG21_PRESIGN_PHASE_ROUND2_PROOFS *pr = proofs + k;
+        octet *f = o[k];
+        char *m = mem[k];
+
+        CG21_PRESIGN_PHASE_carve(m, f, CG21_PRESIGN_PHASE_affg_sizes, CG21_WIRE_PIAFFG_PROOF_FIELDS);
+        m += CG21_WIRE_PIAFFG_PROOF_SIZE;
+        f += CG21_WIRE_PIAFFG_PROOF_FIELDS;
+        CG21_PRESIGN_PHASE_carve(m, f, CG21_PRESIGN_PHASE_affg_sizes, CG21_WIRE_PIAFFG_PROOF_FIELDS);
+        m += CG21_WIRE_PIAFFG_PROOF_SIZE;
+        f += CG21_WIRE_PIAFFG_PROOF_FIELDS;
+        CG21_PRESIGN_PHASE_carve(m, f, CG21_PRESIGN_PHASE_logstar_sizes, CG21_WIRE_PILOGSTAR_PROOF_FIELDS);
+
+        CG21_PRESIGN_PHASE_affg_oct(&pr->affgCommitOct, &pr->affgProofOct, o[k]);
+        CG21_PRESIGN_PHASE_affg_oct(&pr->affgHatCommitOct, &pr->affgHatProofOct, o[k] + CG21_WIRE_PIAFFG_PROOF_FIELDS);
+        CG21_PRESIGN_PHASE_logstar_oct(&pr->logCommitOct, &pr->logProofOct, f);
+
+        p->r1output = st->hisR1out + k;
+        p->hisPK = st->hisPK + k;
+        p->hisPedersen = st->hisPedersen + k;
+        p->r2output = st->r2out + k;
+        p->r2store = st->r2store + k;
+        p->affgPre = NULL;
+        p->affgCommit = &pr->affgCommit;
+        p->affgCommitOct = &pr->affgCommitOct;
+        p->affgProof = &pr->affgProof;
+        p->affgProofOct = &pr->affgProofOct;
+        p->affgHatPre = NULL;
+        p->affgHatCommit = &pr->affgHatCommit;
+        p->affgHatCommitOct = &pr->affgHatCommitOct;
+        p->affgHatProof = &pr->affgHatProof;
+        p->affgHatProofOct = &pr->affgHatProofOct;
+        p->logCommit = &pr->logCommit;
+        p->logCommitOct = &pr->logCommitOct;
+        p->logProof = &pr->logProof;
+        p->logProofOct = &pr->logProofOct;
+    }
+
+    rc = CG21_PRESIGN_ROUND2_ALL(st->RNG, st->r1store, st->r1out, st->myKeys, st->ssid, peers, n);
+    if (rc != CG21_OK)
+    {
+        return rc;
+    }
+
+    for (int k = 0; k < n; k++)
+    {
+        CG21_PRESIGN_PHASE_ROUND2_PROOFS *pr = proofs + k;
+
+        CG21_PRESIGN_PHASE_carve(psimem[k], psi[k], CG21_PRESIGN_PHASE_psi_sizes, 3);
+        r2[k] = st->r2out[k];
+        r2[k].psi = psi[k];
+        r2[k].psi_hat = psi[k] + 1;
+        r2[k].psi_prime = psi[k] + 2;
+
+        rc = CG21_WIRE_PIAFFG_PROOF_toOctet(r2[k].psi, &pr->affgCommitOct, &pr->affgProofOct);
+        if (rc != CG21_WIRE_OK)
+        {
+            return rc;
+        }
+
+        rc = CG21_WIRE_PIAFFG_PROOF_toOctet(r2[k].psi_hat, &pr->affgHatCommitOct, &pr->affgHatProofOct);
+        if (rc != CG21_WIRE_OK)
+        {
+            return rc;
+        }
+
+        rc = CG21_WIRE_PILOGSTAR_PROOF_toOctet(r2[k].psi_prime, &pr->logCommitOct, &pr->logProofOct);
+        if (rc != CG21_WIRE_OK)
+        {
+            return rc;
+        }
+    }
+
+    return CG21_WIRE_PRESIGN_ROUND2_ALL_toOctet(out, r2, n);
+}
+/* Verify the proofs of round 2 of peer k, for the output he sent to me */
+static int CG21_PRESIGN_PHASE_verify_round2(CG21_PRESIGN_SESSION_STATE *st, int k, const CG21_PRESIGN_ROUND2_OUTPUT *his)
+{
+    CG21_PRESIGN_PHASE_ROUND2_PROOFS pr;
+    CG21_PRESIGN_ROUND3_PEER peer;
+    octet views[2 * CG21_WIRE_PIAFFG_PROOF_FIELDS + CG21_WIRE_PILOGSTAR_PROOF_FIELDS];
+    int verdict;
+    int failed;
+
+    int rc = CG21_WIRE_PIAFFG_PROOF_fromOctet(his->psi, &pr.affgCommitOct, &pr.affgProofOct, views);
+    if (rc != CG21_WIRE_OK)
+    {
+        return rc;
+    }
+
+    rc = CG21_WIRE_PIAFFG_PROOF_fromOctet(his->psi_hat, &pr.affgHatCommitOct, &pr.affgHatProofOct,
+                                          views + CG21_WIRE_PIAFFG_PROOF_FIELDS);
+    if (rc != CG21_WIRE_OK)
+    {
+        return rc;
+    }
+
+    rc = CG21_WIRE_PILOGSTAR_PROOF_fromOctet(his->psi_prime, &pr.logCommitOct, &pr.logProofOct,
+                                             views + 2 * CG21_WIRE_PIAFFG_PROOF_FIELDS);
+    if (rc != CG21_WIRE_OK)
+    {
+        return rc;
+    }
+
+    if (Piaffg_commits_fromOctets(&pr.affgCommit, &pr.affgCommitOct) != Piaffg_BX_OK)
+    {
+        return CG21_PRESIGN_AFFG_NOT_VALID;
+    }
+
+    if (Piaffg_commits_fromOctets(&pr.affgHatCommit, &pr.affgHatCommitOct) != Piaffg_BX_OK)
+    {
+        return CG21_PRESIGN_AFFG_HAT_NOT_VALID;
+    }
+
+    if (PiLogstar_commits_fromOctets(&pr.logCommit, &pr.logCommitOct) != Pilogstar_Y_OK)
+    {
+        return CG21_PRESIGN_LOGSTAR_NOT_VALID;
+    }
+
+    Piaffg_proofs_fromOctets(&pr.affgProof, &pr.affgProofOct);
+    Piaffg_proofs_fromOctets(&pr.affgHatProof, &pr.affgHatProofOct);
+    PiLogstar_proofs_fromOctets(&pr.logProof, &pr.logProofOct);
+
+    peer.hisPK = st->hisPK + k;
+    peer.r1output = st->hisR1out + k;
+    peer.r2output = his;
+    peer.X = st->hisX + k;
+    peer.affgCommit = &pr.affgCommit;
+    peer.affgProof = &pr.affgProof;
+    peer.affgHatCommit = &pr.affgHatCommit;
+    peer.affgHatProof = &pr.affgHatProof;
+    peer.logCommit = &pr.logCommit;
+    peer.logProof = &pr.logProof;
+
+    return CG21_PRESIGN_ROUND3_VERIFY_ALL(st->r1out, st->myKeys, st->myPedersen, st->ssid, &peer, 1,
+                                          &verdict, &failed);
+}
+
+/* PiLogstar proof that Delta = Gamma^k for the k encrypted in K, addressed to peer k, encoded in psi */
+static int CG21_PRESIGN_PHASE_prove_delta(CG21_PRESIGN_SESSION_STATE *st, int k, octet *psi)
+{
+    PiLogstar_SECRETS secrets;
+    PiLogstar_COMMITS commits;
+    PiLogstar_PROOFS proofs;
+    PiLogstar_COMMITS_OCT commitsOct;
+    PiLogstar_PROOFS_OCT proofsOct;
+
+    char mem[CG21_WIRE_PILOGSTAR_PROOF_SIZE];
+    octet o[CG21_WIRE_PILOGSTAR_PROOF_FIELDS];
+
+    char e_[MODBYTES_256_56];
+    octet e = {0, sizeof(e_), e_};
+
+    CG21_PRESIGN_PHASE_carve(mem, o, CG21_PRESIGN_PHASE_logstar_sizes, CG21_WIRE_PILOGSTAR_PROOF_FIELDS);
+    CG21_PRESIGN_PHASE_logstar_oct(&commitsOct, &proofsOct, o);
+
+    int rc = PiLogstar_Sample_and_commit(st->RNG, &st->myKeys->paillier_sk, st->hisPedersen + k, st->r1store->k,
+                                         st->r3store1->Gamma, &secrets, &commits, &commitsOct);
+    if (rc != PiLogstar_OK)
+    {
+        return CG21_PRESIGN_FAILED;
+    }
+
+    PiLogstar_Challenge_gen(&st->myKeys->paillier_pk, st->hisPedersen + k, st->r1out->K, &commits, st->ssid,
+                            st->r3out->Delta, &e);
+
+    PiLogstar_Prove(&st->myKeys->paillier_sk, st->r1store->k, st->r1store->rho, &secrets, &e, &proofs, &proofsOct);
+
+    PiLogstar_clean_secrets(&secrets);
+
+    return CG21_WIRE_PILOGSTAR_PROOF_toOctet(psi, &commitsOct, &proofsOct);
+}
+
+/* Verify the PiLogstar proof of peer k for his Delta */
+static int CG21_PRESIGN_PHASE_verify_delta(CG21_PRESIGN_SESSION_STATE *st, int k, const CG21_PRESIGN_ROUND3_OUTPUT *his)
+{
+    PiLogstar_COMMITS commits;
+    PiLogstar_PROOFS proofs;
+    PiLogstar_COMMITS_OCT commitsOct;
+    PiLogstar_PROOFS_OCT proofsOct;
+    octet views[CG21_WIRE_PILOGSTAR_PROOF_FIELDS];
+
+    char e_[MODBYTES_256_56];
+    octet e = {0, sizeof(e_), e_};
+
+    int rc = CG21_WIRE_PILOGSTAR_PROOF_fromOctet(his->psi_douplePrime, &commitsOct, &proofsOct, views);
+    if (rc != CG21_WIRE_OK)
+    {
+        return rc;
+    }
+
+    if (PiLogstar_commits_fromOctets(&commits, &commitsOct) != Pilogstar_Y_OK)
+    {
+        return CG21_PRESIGN_LOGSTAR_DELTA_NOT_VALID;
+    }
+
+    PiLogstar_proofs_fromOctets(&proofs, &proofsOct);
+
+    PiLogstar_Challenge_gen(st->hisPK + k, &st->myPedersen->pedersenPub, st->hisR1out[k].K, &commits, st->ssid,
+                            his->Delta, &e);
+
+    rc = PiLogstar_Verify(st->hisPK + k, &st->myPedersen->pedersenPriv, st->hisR1out[k].K, st->r3store1->Gamma,
+                          &commits, his->Delta, &e, &proofs);
+    if (rc != PiLogstar_OK)
+    {
+        return CG21_PRESIGN_LOGSTAR_DELTA_NOT_VALID;
+    }
+
+    return CG21_OK;
+}
+
+/* Round 1 of presign: (G, K) and PiEnc. Round 2: the MtA outputs and their proofs for all the peers.
+ * Round 3: (delta, Delta) and PiLogstar for Delta */
+static int CG21_PRESIGN_PHASE_start(void *state, int round, octet *out)
+{
+    CG21_PRESIGN_SESSION_STATE *st = (CG21_PRESIGN_SESSION_STATE *)state;
+    int rc;
+
+    if (st->n <= 0)
+    {
+        return CG21_SESSION_UNKNOWN_PEER;
+    }
+
+    if (round == 2)
+    {
+        return CG21_PRESIGN_PHASE_round2(st, out);
+    }
+
+    int size = (round == 1) ? CG21_WIRE_PIENC_PROOF_SIZE : CG21_WIRE_PILOGSTAR_PROOF_SIZE;
+    char mem[st->n][size];
+    octet psi[st->n];
+    octet *to[st->n];
+
+    if (round == 1)
+    {
+        rc = CG21_PRESIGN_ROUND1(st->RNG, st->reshareOutput, st->setting, st->r1out, st->r1store,
+                                 &st->myKeys->paillier_pk);
+        if (rc != CG21_OK)
+        {
+            return rc;
+        }
+    }
+
+    for (int k = 0; k < st->n; k++)
+    {
+        psi[k].len = 0;
+        psi[k].max = size;
+        psi[k].val = mem[k];
+        to[k] = psi + k;
+
+        if (round == 1)
+        {
+            rc = CG21_PRESIGN_PHASE_prove_enc(st, k, psi + k);
+        }
+        else
+        {
+            rc = CG21_PRESIGN_PHASE_prove_delta(st, k, psi + k);
+        }
+
+        if (rc != CG21_OK)
+        {
+            return rc;
+        }
+    }
+
+    if (round == 1)
+    {
+        return CG21_WIRE_PRESIGN_ROUND1_ALL_toOctet(out, st->r1out, to, st->peers, st->n);
+    }
+
+    return CG21_WIRE_PRESIGN_ROUND3_ALL_toOctet(out, st->r3out, to, st->peers, st->n);
+}
+
+/* Verify PiEnc of a peer and keep his (G, K) in round 1, verify his proofs and accumulate Gamma, delta and
+ * chi in round 2, and verify his proof of Delta and check delta in round 3 */
+static int CG21_PRESIGN_PHASE_process(void *state, int round, int from, octet *in, int status)
+{
+    CG21_PRESIGN_SESSION_STATE *st = (CG21_PRESIGN_SESSION_STATE *)state;
+    int rc;
+
+    int k = CG21_PRESIGN_PHASE_index(st, from);
+    if (k < 0)
+    {
+        return CG21_SESSION_UNKNOWN_PEER;
+    }
+
+    if (round == 1)
+    {
+        CG21_PRESIGN_ROUND1_OUTPUT his;
+        octet views[CG21_WIRE_PRESIGN_ALL_FIELDS + st->n * CG21_WIRE_PRESIGN_SECTION_FIELDS];
+
+        rc = CG21_WIRE_PRESIGN_ROUND1_ALL_fromOctet(in, st->r1store->i, st->n, &his, views);
+        if (rc != CG21_WIRE_OK)
+        {
+            return rc;
+        }
+
+        if (his.i != from)
+        {
+            return CG21_SESSION_UNKNOWN_PEER;
+        }
+
+        rc = CG21_PRESIGN_PHASE_verify_enc(st, k, &his);
+        if (rc != CG21_OK)
+        {
+            return rc;
+        }
+
+        // the MtA with this peer runs in round 2, with the outputs of all the peers
+        OCT_copy(st->hisR1out[k].G, his.G);
+        OCT_copy(st->hisR1out[k].K, his.K);
+        st->hisR1out[k].i = his.i;
+
+        return CG21_OK;
+    }
+
+    if (round == 2)
+    {
+        CG21_PRESIGN_ROUND2_OUTPUT his;
+        octet views[st->n * CG21_WIRE_PRESIGN_ROUND2_FIELDS];
+
+        rc = CG21_WIRE_PRESIGN_ROUND2_ALL_fromOctet(in, st->r1store->i, st->n, &his, views);
+        if (rc != CG21_WIRE_OK)
+        {
+            return rc;
+        }
+
+        if (his.i != from)
+        {
+            return CG21_SESSION_UNKNOWN_PEER;
+        }
+
+        rc = CG21_PRESIGN_PHASE_verify_round2(st, k, &his);
+        if (rc != CG21_OK)
+        {
+            return rc;
+        }
+
+        rc = CG21_PRESIGN_ROUND3_2_1(&his, st->r3store1, st->r2store + k, st->r1store, status);
+        if (rc != CG21_OK)
+        {
+            return rc;
+        }
+
+        return CG21_PRESIGN_ROUND3_2_2(&his, st->r3out, st->r3store1, st->r3store2, st->r1store,
+                                       &st->myKeys->paillier_sk, st->r2store + k, status);
+    }
+
+    CG21_PRESIGN_ROUND3_OUTPUT his;
+    octet views[CG21_WIRE_PRESIGN_ALL_FIELDS + st->n * CG21_WIRE_PRESIGN_SECTION_FIELDS];
+
+    rc = CG21_WIRE_PRESIGN_ROUND3_ALL_fromOctet(in, st->r1store->i, st->n, &his, views);
+    if (rc != CG21_WIRE_OK)
+    {
+        return rc;
+    }
+
+    if (his.i != from)
+    {
+        return CG21_SESSION_UNKNOWN_PEER;
+    }
+
+    rc = CG21_PRESIGN_PHASE_verify_delta(st, k, &his);
+    if (rc != CG21_OK)
+    {
+        return rc;
+    }
+
+    return CG21_PRESIGN_OUTPUT_2_1(&his, st->r3out, st->r4store1, status);
+}
+
+/* Compute R = Gamma^{delta^{-1}} */
+static int CG21_PRESIGN_PHASE_finish(void *state)
+{
+    CG21_PRESIGN_SESSION_STATE *st = (CG21_PRESIGN_SESSION_STATE *)state;
+
+    return CG21_PRESIGN_OUTPUT_2_2(st->r1store, st->r3store1, st->r3store2, st->r4store1, st->pre, st->r4out);
+}
+
+const CG21_SESSION_PHASE CG21_PRESIGN_PHASE =
+{
+    3,
+    CG21_PRESIGN_PHASE_start,
+    CG21_PRESIGN_PHASE_process,
+    CG21_PRESIGN_PHASE_finish
+};
+
+/* Round 1 of sign: sigma_i */
+static int CG21_SIGN_PHASE_start(void *state, int round, octet *out)
+{
+    CG21_SIGN_SESSION_STATE *st = (CG21_SIGN_SESSION_STATE *)state;
+
+    (void)round;
+
+    int rc = CG21_SIGN_ROUND1_TWEAKED(st->HM, st->T, st->pre, st->store, st->r1out);
+    if (rc != CG21_OK)
+    {
+        return rc;
+    }
+
+    OCT_copy(out, st->r1out->sigma);
+
+    return CG21_OK;
+}
+
+/* Add sigma_j of a peer */
+static int CG21_SIGN_PHASE_process(void *state, int round, int from, octet *in, int status)
+{
+    CG21_SIGN_SESSION_STATE *st = (CG21_SIGN_SESSION_STATE *)state;
+    CG21_SIGN_ROUND1_OUTPUT his;
+
+    (void)round;
+
+    his.sigma = in;
+    his.i = from;
+
+    return CG21_SIGN_ROUND2(st->store, &his, st->out, status);
+}
+
+/* Validate the signature, if a PK is given */
+static int CG21_SIGN_PHASE_finish(void *state)
+{
+    CG21_SIGN_SESSION_STATE *st = (CG21_SIGN_SESSION_STATE *)state;
+
+    if (st->PK == NULL)
+    {
+        return CG21_OK;
+    }
+
+    return CG21_SIGN_VALIDATE_PREHASHED(st->HM, st->out, st->PK);
+}
+
+const CG21_SESSION_PHASE CG21_SIGN_PHASE =
+{
+    1,
+    CG21_SIGN_PHASE_start,
+    CG21_SIGN_PHASE_process,
+    CG21_SIGN_PHASE_finish
+};
@@ -18,12 +18,74 @@ under the License.
 */
 
 #include "amcl/cg21/cg21.h"
+#include "amcl/hash_utils.h"
+
+/* chi = chi + t.k mod q, the share of k(x + t) for the child key X + t.G */
+static void CG21_SIGN_tweak_chi(BIG_256_56 chi, const octet *T, BIG_256_56 k, BIG_256_56 q){
+    BIG_256_56 tk;
+
+    BIG_256_56_fromBytesLen(tk, T->val, T->len);
+    BIG_256_56_mod(tk, q);
+    BIG_256_56_modmul(tk, tk, k, q);
+    BIG_256_56_add(chi, chi, tk);
+    BIG_256_56_mod(chi, q);
+
+    BIG_256_56_zero(tk);
+}
+
+void CG21_SIGN_HASH_INIT(CG21_SIGN_HASH *ctx){
+    HASH256_init(&ctx->sha);
+}
+
+void CG21_SIGN_HASH_UPDATE(CG21_SIGN_HASH *ctx, const octet *M){
+    HASH_UTILS_hash_oct(&ctx->sha, M);
+}
+
+int CG21_SIGN_HASH_FINAL(CG21_SIGN_HASH *ctx, octet *HM){
+
+    if (HM->max < SHA256_HASH_SIZE){
+        return CG21_SIGN_DIGEST_IS_INVALID;
+    }
+
+    HASH256_hash(&ctx->sha, HM->val);
+    HM->len = SHA256_HASH_SIZE;
+
+    return CG21_OK;
+}
 
 int CG21_SIGN_ROUND1(octet *msg,
                      const CG21_PRESIGN_ROUND4_STORE_2 *pre,
                      CG21_SIGN_ROUND1_STORE *store,
                      CG21_SIGN_ROUND1_OUTPUT *out){
 
+    char hm[SHA256_HASH_SIZE];
+    octet HM = {0,sizeof(hm),hm};
+
+    // hash message and store it in HM
+    ehashit(HASH_TYPE_SECP256K1, msg, -1, NULL, &HM, MODBYTES_256_56);
+
+    return CG21_SIGN_ROUND1_PREHASHED(&HM, pre, store, out);
+}
+
+int CG21_SIGN_ROUND1_PREHASHED(const octet *HM,
+                               const CG21_PRESIGN_ROUND4_STORE_2 *pre,
+                               CG21_SIGN_ROUND1_STORE *store,
+                               CG21_SIGN_ROUND1_OUTPUT *out){
+
+    return CG21_SIGN_ROUND1_TWEAKED(HM, NULL, pre, store, out);
+}
+
+int CG21_SIGN_ROUND1_TWEAKED(const octet *HM,
+                             const octet *T,
+                             const CG21_PRESIGN_ROUND4_STORE_2 *pre,
+                             CG21_SIGN_ROUND1_STORE *store,
+                             CG21_SIGN_ROUND1_OUTPUT *out){
+
+    if (HM->len != SHA256_HASH_SIZE)
+    {
+        return CG21_SIGN_DIGEST_IS_INVALID;
+    }
+
     /* ---------STEP 1: obtain R_x ----------
     * r:          get x component of R
     */
@@ -63,12 +125,6 @@ int CG21_SIGN_ROUND1(octet *msg,
     * sigma:            km + r\chi mod q
     */
 
-    char hm[SHA256_HASH_SIZE];
-    octet HM = {0,sizeof(hm),hm};
-
-    // hash message and store it in HM
-    ehashit(HASH_TYPE_SECP256K1, msg, -1, NULL, &HM, MODBYTES_256_56);
-
     BIG_256_56 m;
     BIG_256_56 r;
     BIG_256_56 k;
@@ -78,11 +134,15 @@ int CG21_SIGN_ROUND1(octet *msg,
     BIG_256_56 sigma;
 
     // Load values
-    BIG_256_56_fromBytes(m, HM.val);
+    BIG_256_56_fromBytes(m, HM->val);
     BIG_256_56_fromBytes(r, store->r->val);
     BIG_256_56_fromBytes(k, pre->k->val);
     BIG_256_56_fromBytes(chi, pre->chi->val);
 
+    if (T != NULL)
+    {
+        CG21_SIGN_tweak_chi(chi, T, k, q);
+    }
 
     // km = k.m mod q
     BIG_256_56_modmul(km, k, m, q);
@@ -172,10 +232,260 @@ int CG21_SIGN_ROUND2(const CG21_SIGN_ROUND1_STORE *mystore,
     return CG21_OK;
 }
 
+/* Shared state for the presignatures of CG21_PRESIGN_POOL_LOAD */
+typedef struct
+{
+    CG21_PRESIGN_POOL *pool;
+    const CG21_PRESIGN_ROUND4_STORE_2 *pre;
+} CG21_PRESIGN_POOL_ctx;
+
+/* Load the i-th presignature, r = R_x mod q */
+static int CG21_PRESIGN_POOL_load_iter(void *arg, int i){
+    CG21_PRESIGN_POOL_ctx *c = (CG21_PRESIGN_POOL_ctx *)arg;
+    const CG21_PRESIGN_ROUND4_STORE_2 *pre = c->pre + i;
+
+    ECP_SECP256K1 R;
+    BIG_256_56 q;
+    BIG_256_56 y;
+
+    BIG_256_56_rcopy(q, CURVE_Order_SECP256K1);
+
+    if (!ECP_SECP256K1_fromOctet(&R, pre->R))
+    {
+        return CG21_INVALID_ECP;
+    }
+
+    ECP_SECP256K1_get(c->pool->r[i], y, &R);
+    BIG_256_56_mod(c->pool->r[i], q);
+    if (BIG_256_56_iszilch(c->pool->r[i]))
+    {
+        return CG21_SIGN_r_IS_ZERO;
+    }
+
+    BIG_256_56_fromBytes(c->pool->k[i], pre->k->val);
+    BIG_256_56_fromBytes(c->pool->chi[i], pre->chi->val);
+
+    return CG21_OK;
+}
+
+int CG21_PRESIGN_POOL_LOAD(CG21_PRESIGN_POOL *pool, BIG_256_56 *r, BIG_256_56 *k, BIG_256_56 *chi,
+                           const CG21_PRESIGN_ROUND4_STORE_2 *pre, int n){
+
+    CG21_PRESIGN_POOL_ctx ctx;
+    int failed;
+
+    pool->r = r;
+    pool->k = k;
+    pool->chi = chi;
+    pool->n = 0;
+    pool->next = 0;
+
+    if (n <= 0){
+        return CG21_OK;
+    }
+
+    // a pool holds the presignatures of a single player
+    for (int j = 1; j < n; j++){
+        if (pre[j].i != pre->i){
+            return CG21_PRESIGN_POOL_MIXED_IDS;
+        }
+    }
+
+    int verdicts[n];
+
+    pool->i = pre->i;
+
+    ctx.pool = pool;
+    ctx.pre = pre;
+
+    failed = PARALLEL_verify(CG21_PRESIGN_POOL_load_iter, &ctx, n, verdicts);
+
+    pool->n = n;
+
+    if (failed >= 0){
+        CG21_PRESIGN_POOL_KILL(pool);
+        return verdicts[failed];
+    }
+
+    return CG21_OK;
+}
+
+void CG21_PRESIGN_POOL_KILL(CG21_PRESIGN_POOL *pool){
+
+    for (int i = pool->next; i < pool->n; i++){
+        BIG_256_56_zero(pool->k[i]);
+        BIG_256_56_zero(pool->chi[i]);
+    }
+
+    pool->next = pool->n;
+}
+
+/* Shared state for the signatures of CG21_SIGN_ROUND1_BATCH */
+typedef struct
+{
+    CG21_PRESIGN_POOL *pool;
+    octet **HM;
+    octet **T;
+    CG21_SIGN_BATCH *out;
+    int *zero;
+} CG21_SIGN_ROUND1_BATCH_ctx;
+
+/* sigma = k.m + r.chi mod q for the j-th message, chi tweaked if T is given */
+static void CG21_SIGN_ROUND1_batch_iter(void *arg, int j){
+    CG21_SIGN_ROUND1_BATCH_ctx *c = (CG21_SIGN_ROUND1_BATCH_ctx *)arg;
+    int i = c->pool->next + j;
+
+    BIG_256_56 q;
+    BIG_256_56 m;
+    BIG_256_56 chi;
+    BIG_256_56 km;
+    BIG_256_56 rchi;
+
+    BIG_256_56_rcopy(q, CURVE_Order_SECP256K1);
+    BIG_256_56_fromBytes(m, c->HM[j]->val);
+
+    BIG_256_56_copy(chi, c->pool->chi[i]);
+
+    if (c->T != NULL)
+    {
+        CG21_SIGN_tweak_chi(chi, c->T[j], c->pool->k[i], q);
+    }
+
+    BIG_256_56_modmul(km, c->pool->k[i], m, q);
+    BIG_256_56_modmul(rchi, c->pool->r[i], chi, q);
+
+    BIG_256_56_add(c->out->sigma[j], km, rchi);
+    BIG_256_56_mod(c->out->sigma[j], q);
+    BIG_256_56_copy(c->out->r[j], c->pool->r[i]);
+
+    c->zero[j] = BIG_256_56_iszilch(c->out->sigma[j]);
+
+    // never use a presignature twice
+    BIG_256_56_zero(c->pool->k[i]);
+    BIG_256_56_zero(c->pool->chi[i]);
+
+    BIG_256_56_zero(chi);
+    BIG_256_56_zero(km);
+    BIG_256_56_zero(rchi);
+}
+
+int CG21_SIGN_ROUND1_BATCH(CG21_PRESIGN_POOL *pool, octet *HM[], CG21_SIGN_BATCH *out){
+
+    return CG21_SIGN_ROUND1_BATCH_TWEAKED(pool, HM, NULL, out);
+}
+
+int CG21_SIGN_ROUND1_BATCH_TWEAKED(CG21_PRESIGN_POOL *pool, octet *HM[], octet *T[], CG21_SIGN_BATCH *out){
+
+    CG21_SIGN_ROUND1_BATCH_ctx ctx;
+    int n = out->n;
+    int rc = CG21_OK;
+
+    if (n <= 0){
+        return CG21_OK;
+    }
+
+    if (pool->n - pool->next < n){
+        return CG21_PRESIGN_POOL_EMPTY;
+    }
+
+    // check all the digests before any presignature is consumed
+    for (int j = 0; j < n; j++){
+        if (HM[j]->len != SHA256_HASH_SIZE){
+            return CG21_SIGN_DIGEST_IS_INVALID;
+        }
+    }
+
+    int zero[n];
+
+    ctx.pool = pool;
+    ctx.HM = HM;
+    ctx.T = T;
+    ctx.out = out;
+    ctx.zero = zero;
+
+    PARALLEL_for(CG21_SIGN_ROUND1_batch_iter, &ctx, n);
+
+    pool->next += n;
+
+    for (int j = 0; j < n; j++){
+        if (zero[j]){
+            rc = CG21_SIGN_SIGMA_IS_ZERO;
+        }
+    }
+
+    return rc;
+}
+
+int CG21_SIGN_BATCH_toOctet(octet *O, const CG21_SIGN_BATCH *batch){
+
+    if (O->max < batch->n * EGS_SECP256K1){
+        return CG21_UTILITIES_WRONG_PACKED_SIZE;
+    }
+
+    for (int j = 0; j < batch->n; j++){
+        BIG_256_56_toBytes(O->val + j * EGS_SECP256K1, batch->sigma[j]);
+    }
+
+    O->len = batch->n * EGS_SECP256K1;
+
+    return CG21_OK;
+}
+
+int CG21_SIGN_ROUND2_BATCH(const CG21_SIGN_BATCH *mine, octet *his[], int t, CG21_SIGN_BATCH *out){
+
+    BIG_256_56 q;
+    BIG_256_56 s;
+    BIG_256_56 accum;
+
+    for (int p = 0; p < t; p++){
+        if (his[p]->len != mine->n * EGS_SECP256K1){
+            return CG21_UTILITIES_WRONG_PACKED_SIZE;
+        }
+    }
+
+    // Curve order
+    BIG_256_56_rcopy(q, CURVE_Order_SECP256K1);
+
+    // sigma_j = \sum sigma_j of all the players, one signature at a time
+    for (int j = 0; j < mine->n; j++){
+        BIG_256_56_copy(accum, mine->sigma[j]);
+
+        for (int p = 0; p < t; p++){
+            BIG_256_56_fromBytesLen(s, his[p]->val + j * EGS_SECP256K1, EGS_SECP256K1);
+            BIG_256_56_add(accum, accum, s);
+            BIG_256_56_mod(accum, q);
+        }
+
+        BIG_256_56_copy(out->sigma[j], accum);
+        BIG_256_56_copy(out->r[j], mine->r[j]);
+    }
+
+    out->n = mine->n;
+
+    // clean memory
+    BIG_256_56_zero(accum);
+    BIG_256_56_zero(s);
+
+    return CG21_OK;
+}
+
 int CG21_SIGN_VALIDATE(const octet *msg,
                        CG21_SIGN_ROUND2_OUTPUT *out,
                        octet *PK){
 
+    char hm[SHA256_HASH_SIZE];
+    octet HM = {0,sizeof(hm),hm};
+
+    // hash message and store it in HM
+    ehashit(HASH_TYPE_SECP256K1, msg, -1, NULL, &HM, MODBYTES_256_56);
+
+    return CG21_SIGN_VALIDATE_PREHASHED(&HM, out, PK);
+}
+
+int CG21_SIGN_VALIDATE_PREHASHED(const octet *HM,
+                                 CG21_SIGN_ROUND2_OUTPUT *out,
+                                 octet *PK){
+
     BIG_256_56 q;
     BIG_256_56 a;
     BIG_256_56 r;
@@ -188,11 +498,10 @@ int CG21_SIGN_VALIDATE(const octet *msg,
     ECP_SECP256K1 c;
     int valid;
 
-    char hm[SHA256_HASH_SIZE];
-    octet HM = {0,sizeof(hm),hm};
-
-    // hash message and store it in HM
-    ehashit(HASH_TYPE_SECP256K1, msg, -1, NULL, &HM, MODBYTES_256_56);
+    if (HM->len != SHA256_HASH_SIZE)
+    {
+        return CG21_SIGN_DIGEST_IS_INVALID;
+    }
 
     // Curve order
     BIG_256_56_rcopy(q,CURVE_Order_SECP256K1);
@@ -203,7 +512,7 @@ int CG21_SIGN_VALIDATE(const octet *msg,
     OCT_shl(out->sigma,out->sigma->len-MODBYTES_256_56);
     BIG_256_56_fromBytes(r,out->r->val);
     BIG_256_56_fromBytes(s,out->sigma->val);
-    BIG_256_56_fromBytes(a,HM.val);
+    BIG_256_56_fromBytes(a,HM->val);
 
     if (BIG_256_56_iszilch(r) || BIG_256_56_comp(r,q)>=0 || BIG_256_56_iszilch(s) || BIG_256_56_comp(s,q)>=0)
     {
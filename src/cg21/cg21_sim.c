@@ -0,0 +1,280 @@
+/*
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"); you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+*/
+
+/* In-process simulation of the n players of a CG21 phase */
+
+#define _POSIX_C_SOURCE 200809L
+#include <time.h>
+#include "amcl/parallel.h"
+#include "amcl/cg21/cg21_sim.h"
+
+/* CPU time of the calling thread, microseconds */
+static long long CG21_SIM_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+
+    return (long long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/* Latency of one message, microseconds */
+static long long CG21_SIM_latency(CG21_SIM *sim)
+{
+    long long r = 0;
+
+    if (sim->RNG == NULL || sim->jitter <= 0)
+    {
+        return sim->latency;
+    }
+
+    for (int j = 0; j < 4; j++)
+    {
+        r = (r << 8) | (RAND_byte(sim->RNG) & 0xFF);
+    }
+
+    return sim->latency + r % sim->jitter;
+}
+
+/* Broadcast the outbox messages of player p, sent at time t */
+static int CG21_SIM_send(CG21_SIM *sim, int p, int sent, long long t)
+{
+    CG21_SESSION *s = sim->party + p;
+    int k = 0;
+
+    for (int r = 1; r <= CG21_SESSION_MAX_ROUNDS; r++)
+    {
+        if (!(sent & (1 << (r - 1))))
+        {
+            continue;
+        }
+
+        for (int q = 0; q < sim->n; q++)
+        {
+            if (q == p)
+            {
+                continue;
+            }
+
+            while (k < sim->max_events && sim->events[k].msg.round != 0)
+            {
+                k++;
+            }
+
+            if (k == sim->max_events)
+            {
+                return CG21_SIM_TOO_MANY_EVENTS;
+            }
+
+            sim->events[k].at = t + CG21_SIM_latency(sim);
+            sim->events[k].to = q;
+            sim->events[k].msg.round = r;
+            sim->events[k].msg.from = sim->ids[p];
+            OCT_copy(sim->events[k].msg.body, s->outbox[r - 1]);
+        }
+    }
+
+    return CG21_SIM_OK;
+}
+
+int CG21_SIM_RUN(CG21_SIM *sim)
+{
+    sim->elapsed = 0;
+    sim->rc = CG21_SIM_OK;
+
+    if (sim->n <= 0)
+    {
+        return CG21_SIM_OK;
+    }
+
+    long long busy[sim->n];
+    long long t;
+    int sent;
+    int rc;
+
+    for (int k = 0; k < sim->max_events; k++)
+    {
+        sim->events[k].msg.round = 0;
+    }
+
+    // all the players start at time 0
+    for (int p = 0; p < sim->n; p++)
+    {
+        t = CG21_SIM_now();
+        rc = CG21_SESSION_START(sim->party + p, &sent);
+        busy[p] = CG21_SIM_now() - t;
+        if (rc != CG21_OK)
+        {
+            sim->rc = rc;
+            return rc;
+        }
+
+        rc = CG21_SIM_send(sim, p, sent, busy[p]);
+        if (rc != CG21_SIM_OK)
+        {
+            sim->rc = rc;
+            return rc;
+        }
+    }
+
+    // deliver the earliest message until none is in flight
+    for (;;)
+    {
+        int next = -1;
+
+        for (int k = 0; k < sim->max_events; k++)
+        {
+            if (sim->events[k].msg.round != 0 && (next < 0 || sim->events[k].at < sim->events[next].at))
+            {
+                next = k;
+            }
+        }
+
+        if (next < 0)
+        {
+            break;
+        }
+
+        CG21_SIM_EVENT *e = sim->events + next;
+        int q = e->to;
+
+        // the receiver handles the message once it is idle
+        if (busy[q] < e->at)
+        {
+            busy[q] = e->at;
+        }
+
+        t = CG21_SIM_now();
+        rc = CG21_SESSION_PUSH(sim->party + q, &e->msg, &sent);
+        busy[q] += CG21_SIM_now() - t;
+        e->msg.round = 0;
+        if (rc != CG21_OK)
+        {
+            sim->rc = rc;
+            return rc;
+        }
+
+        rc = CG21_SIM_send(sim, q, sent, busy[q]);
+        if (rc != CG21_SIM_OK)
+        {
+            sim->rc = rc;
+            return rc;
+        }
+    }
+
+    for (int p = 0; p < sim->n; p++)
+    {
+        if (!CG21_SESSION_DONE(sim->party + p))
+        {
+            sim->rc = CG21_SIM_STALLED;
+            return CG21_SIM_STALLED;
+        }
+
+        if (busy[p] > sim->elapsed)
+        {
+            sim->elapsed = busy[p];
+        }
+    }
+
+    sim->rc = CG21_SIM_OK;
+    return CG21_SIM_OK;
+}
+
+/* Run the i-th simulation */
+static void CG21_SIM_run_iter(void *arg, int i)
+{
+    CG21_SIM *sims = (CG21_SIM *)arg;
+
+    CG21_SIM_RUN(sims + i);
+}
+
+int CG21_SIM_RUN_ALL(CG21_SIM *sims, int count, CG21_SIM_HIST *hist)
+{
+    int rc = CG21_SIM_OK;
+
+    PARALLEL_for(CG21_SIM_run_iter, sims, count);
+
+    for (int i = 0; i < count; i++)
+    {
+        if (sims[i].rc != CG21_SIM_OK)
+        {
+            if (rc == CG21_SIM_OK)
+            {
+                rc = sims[i].rc;
+            }
+
+            continue;
+        }
+
+        if (hist != NULL)
+        {
+            CG21_SIM_HIST_ADD(hist, sims[i].elapsed);
+        }
+    }
+
+    return rc;
+}
+
+void CG21_SIM_HIST_INIT(CG21_SIM_HIST *hist)
+{
+    for (int b = 0; b < CG21_SIM_HIST_BUCKETS; b++)
+    {
+        hist->count[b] = 0;
+    }
+
+    hist->total = 0;
+    hist->max = 0;
+    hist->n = 0;
+}
+
+void CG21_SIM_HIST_ADD(CG21_SIM_HIST *hist, long long us)
+{
+    int b = 0;
+
+    while (b < CG21_SIM_HIST_BUCKETS - 1 && (us >> (b + 1)) > 0)
+    {
+        b++;
+    }
+
+    hist->count[b]++;
+    hist->total += us;
+    hist->n++;
+
+    if (us > hist->max)
+    {
+        hist->max = us;
+    }
+}
+
+long long CG21_SIM_HIST_PERCENTILE(const CG21_SIM_HIST *hist, int p)
+{
+    long long seen = 0;
+    long long target = (hist->n * p + 99) / 100;
+
+    for (int b = 0; b < CG21_SIM_HIST_BUCKETS; b++)
+    {
+        seen += hist->count[b];
+        if (seen >= target && seen > 0)
+        {
+            return (long long)1 << (b + 1);
+        }
+    }
+
+    return hist->max;
+}
@@ -17,6 +17,18 @@ specific language governing permissions and limitations
 under the License.
 */
 #include "amcl/cg21/cg21_utilities.h"
+#include "amcl/parallel.h"
+
+/* Number of bits held by the top word of each BIG in an FF array */
+#define CG21_TBITS_4096 ((MODBYTES_512_60*8)%BASEBITS_512_60)
+#define CG21_TBITS_2048 ((MODBYTES_1024_58*8)%BASEBITS_1024_58)
+
+// Small primes used to sieve the safe prime candidates
+#define CG21_SIEVE_BOUND 16384
+#define CG21_SIEVE_PRIMES 1900
+
+// Seed length of the workers of safe_prime_gen_parallel
+#define CG21_SAFE_PRIME_SEED 32
 
 int teq_(sign32 b,sign32 c)
 {
@@ -200,6 +212,8 @@ void CG21_FF_2048_amul(BIG_1024_58 *r, BIG_1024_58 *x, int xlen, BIG_1024_58 *y,
 
 /*
  * Check if a number is a safe prime
+ *
+ * Small factors of p and P are already excluded by the sieve in safe_prime_gen
  */
 static bool safe_prime_check(BIG_1024_58 *p, BIG_1024_58 *P, csprng *RNG, int n)
 {
@@ -211,14 +225,6 @@ static bool safe_prime_check(BIG_1024_58 *p, BIG_1024_58 *P, csprng *RNG, int n)
     BIG_1024_58 f[n];
 #endif
 
-    // Sieve small primes from P, p is already checked in Miller-Rabin
-    sign32 sf=4849845;/* 3*5*.. *19 */
-
-    if(FF_2048_cfactor(P, sf, n))
-    {
-        return false;
-    }
-
     // Check primality of p
     if (FF_2048_prime(p, RNG, n) == 0)
     {
@@ -243,7 +249,62 @@ static bool safe_prime_check(BIG_1024_58 *p, BIG_1024_58 *P, csprng *RNG, int n)
     return false;
 }
 
-void safe_prime_gen(csprng *RNG, BIG_1024_58 *p, BIG_1024_58 *P, int n)
+/*
+ * Fill s with the odd primes 5 <= s < CG21_SIEVE_BOUND, return their number
+ *
+ * 2 and 3 are excluded since p = 11 mod 12 already takes care of them
+ */
+static int safe_prime_small_primes(sign32 *s)
+{
+    char composite[CG21_SIEVE_BOUND] = {0};
+    int k = 0;
+
+    for (sign32 i = 2; i < CG21_SIEVE_BOUND; i++)
+    {
+        if (composite[i])
+        {
+            continue;
+        }
+
+        for (sign32 j = i * i; j < CG21_SIEVE_BOUND; j += i)
+        {
+            composite[j] = 1;
+        }
+
+        if (i > 3 && k < CG21_SIEVE_PRIMES)
+        {
+            s[k++] = i;
+        }
+    }
+
+    return k;
+}
+
+sign32 CG21_FF_2048_residue(BIG_1024_58 *x, sign32 s, int n)
+{
+    chunk r = 0;
+    chunk wb = ((chunk)1 << BASEBITS_1024_58) % s;
+    chunk tb = ((chunk)1 << CG21_TBITS_2048) % s;
+
+    // Horner over the limbs, the top limb of each BIG only holds CG21_TBITS_2048 bits
+    for (int i = n - 1; i >= 0; i--)
+    {
+        for (int j = NLEN_1024_58 - 1; j >= 0; j--)
+        {
+            r = (r * (j == NLEN_1024_58 - 1 ? tb : wb) + x[i][j] % s) % s;
+        }
+    }
+
+    return (sign32)r;
+}
+
+/*
+ * Search a safe prime P = 2p + 1 starting from a random p
+ *
+ * If stop is not NULL it is polled before each primality test and the search
+ * is abandoned as soon as it returns non zero. Return true if a safe prime is found
+ */
+static bool safe_prime_search(csprng *RNG, BIG_1024_58 *p, BIG_1024_58 *P, int n, PARALLEL_stop stop, void *token)
 {
 #ifndef C99
     BIG_1024_58 r[HFLEN_2048];
@@ -252,6 +313,14 @@ void safe_prime_gen(csprng *RNG, BIG_1024_58 *p, BIG_1024_58 *P, int n)
     BIG_1024_58 r[n];
     BIG_1024_58 twelve[n];
 #endif
+    sign32 s[CG21_SIEVE_PRIMES];
+    sign32 rp[CG21_SIEVE_PRIMES];
+    sign32 rP[CG21_SIEVE_PRIMES];
+    int ns;
+    int step;
+    bool sieved;
+    bool found = true;
+
     FF_2048_init(twelve, 12, n);
 
     FF_2048_random(p, RNG, n);
@@ -270,17 +339,158 @@ void safe_prime_gen(csprng *RNG, BIG_1024_58 *p, BIG_1024_58 *P, int n)
     FF_2048_mod(r, twelve, n);
     FF_2048_inc(p, 11, n);
     FF_2048_sub(p, p, r, n);
+    FF_2048_norm(p, n);
 
     // P = 2p + 1
     FF_2048_copy(P, p, n);
     FF_2048_shl(P, n);
     FF_2048_inc(P, 1, n);
+    FF_2048_norm(P, n);
+
+    // Residues of p and P modulo the small primes. They are updated
+    // incrementally as p grows, so most candidates are discarded
+    // without touching the full size numbers
+    ns = safe_prime_small_primes(s);
+    for (int k = 0; k < ns; k++)
+    {
+        rp[k] = CG21_FF_2048_residue(p, s[k], n);
+        rP[k] = (2 * rp[k] + 1) % s[k];
+    }
 
-    while (!safe_prime_check(p, P, RNG, n))
+    step = 0;
+
+    for (;;)
     {
+        sieved = true;
+        for (int k = 0; k < ns; k++)
+        {
+            if (rp[k] == 0 || rP[k] == 0)
+            {
+                sieved = false;
+                break;
+            }
+        }
+
+        if (sieved)
+        {
+            // Another worker already found a safe prime
+            if (stop != NULL && stop(token))
+            {
+                found = false;
+                break;
+            }
+
+            // Catch up with the candidate found by the sieve
+            if (step != 0)
+            {
+                FF_2048_inc(p, 12 * step, n);
+                FF_2048_norm(p, n);
+                FF_2048_inc(P, 24 * step, n);
+                FF_2048_norm(P, n);
+                step = 0;
+            }
+
+            if (safe_prime_check(p, P, RNG, n))
+            {
+                break;
+            }
+        }
+
         // Increase p by 12 to keep it = 11 mod 12, P grows as 2*p
-        FF_2048_inc(p, 12, n);
-        FF_2048_inc(P, 24, n);
+        step++;
+        for (int k = 0; k < ns; k++)
+        {
+            rp[k] += 12;
+            while (rp[k] >= s[k]) rp[k] -= s[k];
+
+            rP[k] += 24;
+            while (rP[k] >= s[k]) rP[k] -= s[k];
+        }
+    }
+
+    // clean up
+    FF_2048_zero(r, n);
+    for (int k = 0; k < ns; k++)
+    {
+        rp[k] = 0;
+        rP[k] = 0;
+    }
+
+    return found;
+}
+
+void safe_prime_gen(csprng *RNG, BIG_1024_58 *p, BIG_1024_58 *P, int n)
+{
+    safe_prime_search(RNG, p, P, n, NULL, NULL);
+}
+
+/* State of a worker of safe_prime_gen_parallel */
+typedef struct
+{
+    csprng RNG;
+    BIG_1024_58 p[HFLEN_2048];
+    BIG_1024_58 P[HFLEN_2048];
+} safe_prime_worker;
+
+/* Shared state for the workers of safe_prime_gen_parallel */
+typedef struct
+{
+    safe_prime_worker *w;
+    int n;
+} safe_prime_race_ctx;
+
+static int safe_prime_race_task(void *arg, int i, PARALLEL_stop stop, void *token)
+{
+    safe_prime_race_ctx *c = (safe_prime_race_ctx *)arg;
+
+    return safe_prime_search(&c->w[i].RNG, c->w[i].p, c->w[i].P, c->n, stop, token);
+}
+
+void safe_prime_gen_parallel(csprng *RNG, BIG_1024_58 *p, BIG_1024_58 *P, int n)
+{
+    int winner;
+    int threads = PARALLEL_get_threads();
+    char seed[CG21_SAFE_PRIME_SEED];
+
+    safe_prime_worker w[PARALLEL_MAX_THREADS];
+    safe_prime_race_ctx ctx;
+
+    if (threads <= 1)
+    {
+        safe_prime_gen(RNG, p, P, n);
+        return;
+    }
+
+    // Independent candidate stream for each worker, seeded from the caller's RNG
+    for (int i = 0; i < threads; i++)
+    {
+        for (int j = 0; j < CG21_SAFE_PRIME_SEED; j++)
+        {
+            seed[j] = (char)RAND_byte(RNG);
+        }
+
+        RAND_seed(&w[i].RNG, CG21_SAFE_PRIME_SEED, seed);
+    }
+
+    ctx.w = w;
+    ctx.n = n;
+
+    winner = PARALLEL_race(safe_prime_race_task, &ctx, threads);
+
+    FF_2048_copy(p, w[winner].p, n);
+    FF_2048_copy(P, w[winner].P, n);
+
+    // clean up
+    for (int i = 0; i < threads; i++)
+    {
+        FF_2048_zero(w[i].p, n);
+        FF_2048_zero(w[i].P, n);
+        RAND_clean(&w[i].RNG);
+    }
+
+    for (int j = 0; j < CG21_SAFE_PRIME_SEED; j++)
+    {
+        seed[j] = 0;
     }
 }
 
@@ -302,7 +512,7 @@ void BC_find_generator(csprng *RNG, BIG_1024_58* x, BIG_1024_58 *P, int n)
     while (FF_2048_isunity(x, n));
 }
 
-void ring_Pedersen_setup(csprng *RNG, PEDERSEN_PRIV *m, octet *P, octet *Q)
+static void ring_Pedersen_setup_common(csprng *RNG, PEDERSEN_PRIV *m, octet *P, octet *Q, bool parallel)
 {
     BIG_1024_58 p[HFLEN_2048];
     BIG_1024_58 q[HFLEN_2048];
@@ -314,7 +524,14 @@ void ring_Pedersen_setup(csprng *RNG, PEDERSEN_PRIV *m, octet *P, octet *Q)
     /* Load or generate safe primes P, Q */
     if (P == NULL)
     {
-        safe_prime_gen(RNG, p, m->mod.p, HFLEN_2048);
+        if (parallel)
+        {
+            safe_prime_gen_parallel(RNG, p, m->mod.p, HFLEN_2048);
+        }
+        else
+        {
+            safe_prime_gen(RNG, p, m->mod.p, HFLEN_2048);
+        }
     }
     else
     {
@@ -328,7 +545,14 @@ void ring_Pedersen_setup(csprng *RNG, PEDERSEN_PRIV *m, octet *P, octet *Q)
 
     if (Q == NULL)
     {
-        safe_prime_gen(RNG, q, m->mod.q, HFLEN_2048);
+        if (parallel)
+        {
+            safe_prime_gen_parallel(RNG, q, m->mod.q, HFLEN_2048);
+        }
+        else
+        {
+            safe_prime_gen(RNG, q, m->mod.q, HFLEN_2048);
+        }
     }
     else
     {
@@ -378,6 +602,16 @@ void ring_Pedersen_setup(csprng *RNG, PEDERSEN_PRIV *m, octet *P, octet *Q)
     FF_2048_zero(aq, HFLEN_2048);
 }
 
+void ring_Pedersen_setup(csprng *RNG, PEDERSEN_PRIV *m, octet *P, octet *Q)
+{
+    ring_Pedersen_setup_common(RNG, m, P, Q, false);
+}
+
+void ring_Pedersen_setup_parallel(csprng *RNG, PEDERSEN_PRIV *m, octet *P, octet *Q)
+{
+    ring_Pedersen_setup_common(RNG, m, P, Q, true);
+}
+
 void Pedersen_get_public_param(PEDERSEN_PUB *pub, PEDERSEN_PRIV *priv)
 {
     FF_2048_copy(pub->b0, priv->b0, FFLEN_2048);
@@ -457,6 +691,45 @@ void CG21_Pedersen_verify(BIG_1024_58 *proof, PEDERSEN_PRIV *st, BIG_1024_58 *z1
     FF_2048_zero(hws4, HFLEN_2048);
 }
 
+/* Shared state for the two halves of CG21_Pedersen_verify_crt */
+typedef struct
+{
+    BIG_1024_58 *proof[2];
+    BIG_1024_58 *mod[2];
+    PEDERSEN_PRIV *st;
+    BIG_1024_58 *z1;
+    BIG_1024_58 *z3;
+    BIG_1024_58 *S;
+    BIG_1024_58 *e;
+    bool reduce_s1;
+} CG21_Pedersen_verify_ctx;
+
+static void CG21_Pedersen_verify_half(void *arg, int i)
+{
+    CG21_Pedersen_verify_ctx *c = (CG21_Pedersen_verify_ctx *)arg;
+
+    CG21_Pedersen_verify(c->proof[i], c->st, c->z1, c->z3, c->S, c->e, c->mod[i], c->reduce_s1);
+}
+
+void CG21_Pedersen_verify_crt(BIG_1024_58 *p_proof, BIG_1024_58 *q_proof, PEDERSEN_PRIV *st, BIG_1024_58 *z1,
+                              BIG_1024_58 *z3, BIG_1024_58 *S, BIG_1024_58 *e, bool reduce_s1)
+{
+    CG21_Pedersen_verify_ctx ctx;
+
+    ctx.proof[0] = p_proof;
+    ctx.proof[1] = q_proof;
+    ctx.mod[0] = st->mod.p;
+    ctx.mod[1] = st->mod.q;
+    ctx.st = st;
+    ctx.z1 = z1;
+    ctx.z3 = z3;
+    ctx.S = S;
+    ctx.e = e;
+    ctx.reduce_s1 = reduce_s1;
+
+    PARALLEL_crt(CG21_Pedersen_verify_half, &ctx);
+}
+
 void CG21_GET_CURVE_ORDER(BIG_1024_58 *q){
     BIG_256_56 q_;
     BIG_256_56_rcopy(q_, CURVE_Order_SECP256K1);
@@ -646,6 +919,132 @@ void CG21_get_q(octet *q_oct){
     BIG_256_56_toBytes(q_oct->val,q);
 }
 
+/* Shared state for the iterations of CG21_PAILLIER_DECRYPT_REDUCE_Q */
+typedef struct
+{
+    PAILLIER_private_key *sk;
+    octet **CT;
+    octet **OUT;
+    BIG_1024_58 *q;
+} CG21_decrypt_reduce_q_ctx;
+
+/* Decrypt the i-th ciphertext and reduce the plaintext mod q */
+static void CG21_decrypt_reduce_q_iter(void *arg, int i){
+    CG21_decrypt_reduce_q_ctx *c = (CG21_decrypt_reduce_q_ctx *)arg;
+
+    BIG_1024_58 m[FFLEN_2048];
+
+    char pt[FS_2048];
+    octet PT = {0, sizeof(pt), pt};
+
+    PAILLIER_DECRYPT(c->sk, c->CT[i], &PT);
+
+    FF_2048_fromOctet(m, &PT, FFLEN_2048);
+    FF_2048_mod(m, c->q, FFLEN_2048);
+
+    FF_2048_toOctet(&PT, m, FFLEN_2048);
+    OCT_chop(&PT, c->OUT[i], FS_2048 - EGS_SECP256K1);
+
+    // clean up
+    FF_2048_zero(m, FFLEN_2048);
+    OCT_clear(&PT);
+}
+
+void CG21_PAILLIER_DECRYPT_REDUCE_Q(PAILLIER_private_key *sk, octet *CT[], octet *OUT[], int n){
+
+    CG21_decrypt_reduce_q_ctx ctx;
+    BIG_1024_58 q[FFLEN_2048];
+
+    char t[FS_2048];
+    octet Q = {0, sizeof(t), t};
+
+    // curve order, shared by all the reductions
+    CG21_get_q(&Q);
+    OCT_pad(&Q, FS_2048);
+    FF_2048_fromOctet(q, &Q, FFLEN_2048);
+
+    ctx.sk = sk;
+    ctx.CT = CT;
+    ctx.OUT = OUT;
+    ctx.q = q;
+
+    PARALLEL_for(CG21_decrypt_reduce_q_iter, &ctx, n);
+}
+
+/* Compute r^N mod N^2 in place for the i-th nonce of a pool */
+static void CG21_nonce_pool_iter(void *arg, int i){
+    CG21_PAILLIER_NONCE_POOL *pool = (CG21_PAILLIER_NONCE_POOL *)arg;
+    BIG_512_60 *rN = pool->rN + i * FFLEN_4096;
+
+    FF_4096_ct_pow(rN, rN, pool->pk->n, pool->pk->n2, FFLEN_4096, HFLEN_4096);
+}
+
+void CG21_PAILLIER_NONCE_POOL_FILL(csprng *RNG, CG21_PAILLIER_NONCE_POOL *pool, PAILLIER_public_key *pk,
+                                   BIG_512_60 *mem, int n){
+
+    pool->pk = pk;
+    pool->rN = mem;
+    pool->n = n;
+    pool->next = 0;
+
+    // sample r in Z_N, in order so the pool only depends on RNG
+    for (int i = 0; i < n; i++){
+        FF_4096_zero(mem + i * FFLEN_4096, FFLEN_4096);
+        FF_4096_randomnum(mem + i * FFLEN_4096, pk->n, RNG, HFLEN_4096);
+    }
+
+    PARALLEL_for(CG21_nonce_pool_iter, pool, n);
+}
+
+int CG21_PAILLIER_ENCRYPT_POOL(CG21_PAILLIER_NONCE_POOL *pool, octet *PT, octet *CT){
+
+    BIG_512_60 pt[HFLEN_4096];
+    BIG_512_60 ct[FFLEN_4096];
+    BIG_512_60 dws[2 * FFLEN_4096];
+    BIG_512_60 *rN;
+
+    char t[HFS_4096];
+    octet T = {0, sizeof(t), t};
+
+    if (pool->next >= pool->n){
+        return CG21_NONCE_POOL_EMPTY;
+    }
+
+    rN = pool->rN + pool->next * FFLEN_4096;
+    pool->next++;
+
+    OCT_copy(&T, PT);
+    OCT_pad(&T, HFS_4096);
+    FF_4096_fromOctet(pt, &T, HFLEN_4096);
+
+    // (1+N)^PT = 1 + PT*N mod N^2
+    FF_4096_mul(ct, pool->pk->n, pt, HFLEN_4096);
+    FF_4096_inc(ct, 1, FFLEN_4096);
+    FF_4096_norm(ct, FFLEN_4096);
+
+    FF_4096_mul(dws, ct, rN, FFLEN_4096);
+    FF_4096_dmod(ct, dws, pool->pk->n2, FFLEN_4096);
+
+    FF_4096_toOctet(CT, ct, FFLEN_4096);
+
+    // clean up, including the used nonce
+    FF_4096_zero(rN, FFLEN_4096);
+    FF_4096_zero(pt, HFLEN_4096);
+    FF_4096_zero(dws, 2 * FFLEN_4096);
+    OCT_clear(&T);
+
+    return CG21_OK;
+}
+
+void CG21_PAILLIER_NONCE_POOL_KILL(CG21_PAILLIER_NONCE_POOL *pool){
+
+    for (int i = pool->next; i < pool->n; i++){
+        FF_4096_zero(pool->rN + i * FFLEN_4096, FFLEN_4096);
+    }
+
+    pool->next = pool->n;
+}
+
 int CG21_ADD_TWO_PK(octet *O, const octet *P){
 
     ECP_SECP256K1 tt;
@@ -1040,47 +1439,145 @@ int CG21_CALC_XI(int t, const octet *i, const octet *checks, ECP_SECP256K1 *V)
     return VSS_OK;
 }
 
-int FF_4096_jacobi(BIG_512_60 a[HFLEN_4096], BIG_512_60 p[HFLEN_4096])
+/* Number of trailing zero bits of w, capped at max */
+static int CG21_ctz(chunk w, int max)
+{
+    int k=0;
+    while (k<max && ((w>>k)&1)==0) k++;
+    return k;
+}
+
+/* Set a=a>>k, 0 < k <= CG21_TBITS_4096, one fshr per BIG instead of k full shifts */
+static void CG21_FF_4096_shrk(BIG_512_60 a[], int k, int n)
+{
+    for (int i=0; i<n-1; i++)
+    {
+        BIG_512_60_fshr(a[i],k);
+        a[i][NLEN_512_60-1]+=(a[i+1][0]&(((chunk)1<<k)-1))<<(CG21_TBITS_4096-k);
+    }
+    BIG_512_60_fshr(a[n-1],k);
+}
+
+/* Set a=a>>k, 0 < k <= CG21_TBITS_2048, one fshr per BIG instead of k full shifts */
+static void CG21_FF_2048_shrk(BIG_1024_58 a[], int k, int n)
+{
+    for (int i=0; i<n-1; i++)
+    {
+        BIG_1024_58_fshr(a[i],k);
+        a[i][NLEN_1024_58-1]+=(a[i+1][0]&(((chunk)1<<k)-1))<<(CG21_TBITS_2048-k);
+    }
+    BIG_1024_58_fshr(a[n-1],k);
+}
+
+int CG21_FF_4096_jacobi(BIG_512_60 a[HFLEN_4096], BIG_512_60 p[HFLEN_4096])
 {
-    int size = HFLEN_4096;
-    int n8;
     int k;
-    int m=0;
-    BIG_512_60 t[size];
-    BIG_512_60 x[size];
-    BIG_512_60 n[size];
-    BIG_512_60 zilch[size];
-    BIG_512_60 one[size];
-    FF_4096_init(one,1,size);
-    FF_4096_zero(zilch,size);
-    if (FF_4096_parity(p)==0 || FF_4096_comp(a,zilch,size)==0 || FF_4096_comp(p,one,size)<=0) return 0;
-    FF_4096_norm(a,size);
-    FF_4096_copy(x,a,size);
-    FF_4096_copy(n,p,size);
-    FF_4096_mod(x, p,size);
-
-    while (FF_4096_comp(n,one,size)>0)
+    int n8;
+    int rc;
+    int m=1;
+    BIG_512_60 xa[HFLEN_4096];
+    BIG_512_60 na[HFLEN_4096];
+    BIG_512_60 *x=xa;
+    BIG_512_60 *n=na;
+    BIG_512_60 *t;
+
+    if (FF_4096_parity(p)==0) return 0;
+
+    FF_4096_copy(x,a,HFLEN_4096);
+    FF_4096_norm(x,HFLEN_4096);
+    FF_4096_copy(n,p,HFLEN_4096);
+    FF_4096_norm(n,HFLEN_4096);
+
+    while (!FF_4096_iszilch(x,HFLEN_4096))
     {
-        if (FF_4096_comp(x,zilch,size)==0) return 0;
+        // strip the factors of two from x, a word at a time
         n8=FF_4096_lastbits(n,3);
-        k=0;
         while (FF_4096_parity(x)==0)
         {
-            k++;
-            FF_4096_shr(x,size);
+            k=CG21_ctz(x[0][0],CG21_TBITS_4096);
+            CG21_FF_4096_shrk(x,k,HFLEN_4096);
+            if ((k&1) && (n8==3 || n8==5)) m=-m;
         }
-        if (k%2==1) m+=(n8*n8-1)/8;
-        m+=(n8-1)*(FF_4096_lastbits(x,2)-1)/4;
-        FF_4096_copy(t,n,size);
 
-        FF_4096_mod(t,x,size);
-        FF_4096_copy(n,x, size);
-        FF_4096_copy(x,t,size);
-        m%=2;
+        // both odd, apply reciprocity if we need to swap to keep x >= n
+        if (FF_4096_comp(x,n,HFLEN_4096)<0)
+        {
+            t=x;
+            x=n;
+            n=t;
+            if (FF_4096_lastbits(x,2)==3 && FF_4096_lastbits(n,2)==3) m=-m;
+        }
 
+        // (x/n) = ((x-n)/n), and x-n is even
+        FF_4096_sub(x,x,n,HFLEN_4096);
+        FF_4096_norm(x,HFLEN_4096);
     }
-    if (m==0) return 1;
-    else return -1;
+
+    rc = FF_4096_isunity(n,HFLEN_4096) ? m : 0;
+
+    // clean up
+    FF_4096_zero(xa,HFLEN_4096);
+    FF_4096_zero(na,HFLEN_4096);
+
+    return rc;
+}
+
+int CG21_FF_2048_jacobi(BIG_1024_58 a[HFLEN_2048], BIG_1024_58 p[HFLEN_2048])
+{
+    int k;
+    int n8;
+    int rc;
+    int m=1;
+    BIG_1024_58 xa[HFLEN_2048];
+    BIG_1024_58 na[HFLEN_2048];
+    BIG_1024_58 *x=xa;
+    BIG_1024_58 *n=na;
+    BIG_1024_58 *t;
+
+    if (FF_2048_parity(p)==0) return 0;
+
+    FF_2048_copy(x,a,HFLEN_2048);
+    FF_2048_norm(x,HFLEN_2048);
+    FF_2048_copy(n,p,HFLEN_2048);
+    FF_2048_norm(n,HFLEN_2048);
+
+    while (!FF_2048_iszilch(x,HFLEN_2048))
+    {
+        // strip the factors of two from x, a word at a time
+        n8=FF_2048_lastbits(n,3);
+        while (FF_2048_parity(x)==0)
+        {
+            k=CG21_ctz(x[0][0],CG21_TBITS_2048);
+            CG21_FF_2048_shrk(x,k,HFLEN_2048);
+            if ((k&1) && (n8==3 || n8==5)) m=-m;
+        }
+
+        // both odd, apply reciprocity if we need to swap to keep x >= n
+        if (FF_2048_comp(x,n,HFLEN_2048)<0)
+        {
+            t=x;
+            x=n;
+            n=t;
+            if (FF_2048_lastbits(x,2)==3 && FF_2048_lastbits(n,2)==3) m=-m;
+        }
+
+        // (x/n) = ((x-n)/n), and x-n is even
+        FF_2048_sub(x,x,n,HFLEN_2048);
+        FF_2048_norm(x,HFLEN_2048);
+    }
+
+    rc = FF_2048_isunity(n,HFLEN_2048) ? m : 0;
+
+    // clean up
+    FF_2048_zero(xa,HFLEN_2048);
+    FF_2048_zero(na,HFLEN_2048);
+
+    return rc;
+}
+
+int FF_4096_jacobi(BIG_512_60 a[HFLEN_4096], BIG_512_60 p[HFLEN_4096])
+{
+    return CG21_FF_4096_jacobi(a,p);
 }
 
 bool CG21_check_sqrt_exist(BIG_1024_58 a[FFLEN_2048], BIG_1024_58 p[HFLEN_2048]){
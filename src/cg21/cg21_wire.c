@@ -0,0 +1,795 @@
+/*
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"); you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+*/
+
+/* Versioned, length-prefixed binary encoding of the CG21 round messages */
+
+#include <string.h>
+#include "amcl/cg21/cg21_wire.h"
+
+/* Length of the fields of each message type */
+static const int CG21_WIRE_presign_round1_sizes[CG21_WIRE_PRESIGN_ROUND1_FIELDS] =
+{
+    CG21_WIRE_PIENC_PROOF_SIZE, FS_4096, FS_4096, 4
+};
+
+static const int CG21_WIRE_presign_round2_sizes[CG21_WIRE_PRESIGN_ROUND2_FIELDS] =
+{
+    CG21_WIRE_POINT_SIZE, FS_4096, FS_4096, FS_4096, FS_4096,
+    CG21_WIRE_PIAFFG_PROOF_SIZE, CG21_WIRE_PIAFFG_PROOF_SIZE, CG21_WIRE_PILOGSTAR_PROOF_SIZE, 4, 4
+};
+
+static const int CG21_WIRE_presign_round3_sizes[CG21_WIRE_PRESIGN_ROUND3_FIELDS] =
+{
+    EGS_SECP256K1, CG21_WIRE_POINT_SIZE, CG21_WIRE_PILOGSTAR_PROOF_SIZE, 4
+};
+
+/* Common fields of the _ALL messages of round 1 and 3 */
+static const int CG21_WIRE_presign_round1_all_sizes[CG21_WIRE_PRESIGN_ALL_FIELDS] =
+{
+    FS_4096, FS_4096, 4
+};
+
+static const int CG21_WIRE_presign_round3_all_sizes[CG21_WIRE_PRESIGN_ALL_FIELDS] =
+{
+    EGS_SECP256K1, CG21_WIRE_POINT_SIZE, 4
+};
+
+static const int CG21_WIRE_piaffg_commits_sizes[CG21_WIRE_PIAFFG_COMMITS_FIELDS] =
+{
+    FS_4096, CG21_WIRE_POINT_SIZE, FS_4096, FS_2048, FS_2048, FS_2048, FS_2048
+};
+
+static const int CG21_WIRE_piaffg_proofs_sizes[CG21_WIRE_PIAFFG_PROOFS_FIELDS] =
+{
+    FS_2048, FS_2048, FS_2048 + HFS_2048, FS_2048 + HFS_2048, FS_2048, FS_2048
+};
+
+static const int CG21_WIRE_pienc_proof_sizes[CG21_WIRE_PIENC_PROOF_FIELDS] =
+{
+    FS_2048, FS_4096, FS_2048, HFS_2048, HFS_4096, FS_2048 + HFS_2048
+};
+
+static const int CG21_WIRE_pilogstar_proof_sizes[CG21_WIRE_PILOGSTAR_PROOF_FIELDS] =
+{
+    FS_2048, FS_4096, FS_2048, CG21_WIRE_POINT_SIZE, HFS_2048, HFS_4096, FS_2048 + HFS_2048
+};
+
+static const int CG21_WIRE_pimod_proof_sizes[CG21_WIRE_PIMOD_PROOF_FIELDS] =
+{
+    HFS_4096, CG21_PAILLIER_PROOF_SIZE, CG21_PAILLIER_PROOF_SIZE, CG21_PAILLIER_PROOF_AB_SIZE
+};
+
+static const int CG21_WIRE_aux_round3_sizes[CG21_WIRE_AUX_ROUND3_FIELDS] =
+{
+    EGS_SECP256K1, 4, 4,
+    HFS_4096, CG21_PAILLIER_PROOF_SIZE, CG21_PAILLIER_PROOF_SIZE, CG21_PAILLIER_PROOF_AB_SIZE,
+    FS_2048 + HFS_2048, FS_2048 + HFS_2048, FS_2048 + HFS_2048, FS_2048 + HFS_2048, 2 * FS_2048 + HFS_2048,
+    FS_2048, FS_2048, FS_2048, FS_2048, FS_2048, 2 * FS_2048 + HFS_2048
+};
+
+/* Write a 4 bytes big endian integer */
+static void CG21_WIRE_put32(char *p, unsigned int v)
+{
+    p[0] = (char)((v >> 24) & 0xFF);
+    p[1] = (char)((v >> 16) & 0xFF);
+    p[2] = (char)((v >> 8) & 0xFF);
+    p[3] = (char)(v & 0xFF);
+}
+
+/* Read a 4 bytes big endian integer */
+static unsigned int CG21_WIRE_get32(const char *p)
+{
+    const unsigned char *u = (const unsigned char *)p;
+
+    return ((unsigned int)u[0] << 24) | ((unsigned int)u[1] << 16) | ((unsigned int)u[2] << 8) | u[3];
+}
+
+/* Integer field from its view */
+static int CG21_WIRE_get_int(const octet *V, int *i)
+{
+    if (V->len != 4)
+    {
+        return CG21_WIRE_INVALID_FIELD;
+    }
+
+    *i = (int)CG21_WIRE_get32(V->val);
+
+    return CG21_WIRE_OK;
+}
+
+int CG21_WIRE_ENCODE(octet *O, int type, octet *const *fields, int n)
+{
+    int len = CG21_WIRE_HEADER_SIZE;
+    char *p;
+
+    for (int j = 0; j < n; j++)
+    {
+        len += CG21_WIRE_LENGTH_SIZE + fields[j]->len;
+    }
+
+    if (len > O->max)
+    {
+        return CG21_WIRE_BUFFER_TOO_SMALL;
+    }
+
+    p = O->val;
+    p[0] = (char)CG21_WIRE_VERSION;
+    p[1] = (char)type;
+    p[2] = (char)n;
+    p += CG21_WIRE_HEADER_SIZE;
+
+    for (int j = 0; j < n; j++)
+    {
+        CG21_WIRE_put32(p, (unsigned int)fields[j]->len);
+        p += CG21_WIRE_LENGTH_SIZE;
+
+        // an empty field may have no storage
+        if (fields[j]->len > 0)
+        {
+            memcpy(p, fields[j]->val, (size_t)fields[j]->len);
+        }
+        p += fields[j]->len;
+    }
+
+    O->len = len;
+
+    return CG21_WIRE_OK;
+}
+
+int CG21_WIRE_TYPE(const octet *I, int *type)
+{
+    if (I->len < CG21_WIRE_HEADER_SIZE)
+    {
+        return CG21_WIRE_TRUNCATED;
+    }
+
+    if ((unsigned char)I->val[0] != CG21_WIRE_VERSION)
+    {
+        return CG21_WIRE_INVALID_VERSION;
+    }
+
+    *type = (unsigned char)I->val[1];
+
+    return CG21_WIRE_OK;
+}
+
+int CG21_WIRE_DECODE(const octet *I, int type, octet *views, const int *sizes, int n)
+{
+    int t;
+    int off = CG21_WIRE_HEADER_SIZE;
+
+    int rc = CG21_WIRE_TYPE(I, &t);
+    if (rc != CG21_WIRE_OK)
+    {
+        return rc;
+    }
+
+    if (t != type)
+    {
+        return CG21_WIRE_INVALID_TYPE;
+    }
+
+    if ((unsigned char)I->val[2] != n)
+    {
+        return CG21_WIRE_INVALID_COUNT;
+    }
+
+    for (int j = 0; j < n; j++)
+    {
+        if (I->len - off < CG21_WIRE_LENGTH_SIZE)
+        {
+            return CG21_WIRE_TRUNCATED;
+        }
+
+        unsigned int len = CG21_WIRE_get32(I->val + off);
+        off += CG21_WIRE_LENGTH_SIZE;
+
+        if (len > (unsigned int)(I->len - off))
+        {
+            return CG21_WIRE_TRUNCATED;
+        }
+
+        if (sizes != NULL && len != (unsigned int)sizes[j])
+        {
+            return CG21_WIRE_INVALID_FIELD;
+        }
+
+        views[j].len = (int)len;
+        views[j].max = (int)len;
+        views[j].val = I->val + off;
+        off += (int)len;
+    }
+
+    if (off != I->len)
+    {
+        return CG21_WIRE_TRAILING_DATA;
+    }
+
+    return CG21_WIRE_OK;
+}
+
+int CG21_WIRE_PRESIGN_ROUND1_toOctet(octet *O, const CG21_PRESIGN_ROUND1_OUTPUT *out)
+{
+    char i[4];
+    octet I = {4, sizeof(i), i};
+
+    CG21_WIRE_put32(i, (unsigned int)out->i);
+
+    octet *f[CG21_WIRE_PRESIGN_ROUND1_FIELDS] = {out->psi, out->G, out->K, &I};
+
+    return CG21_WIRE_ENCODE(O, CG21_WIRE_PRESIGN_ROUND1, f, CG21_WIRE_PRESIGN_ROUND1_FIELDS);
+}
+
+int CG21_WIRE_PRESIGN_ROUND1_fromOctet(const octet *I, CG21_PRESIGN_ROUND1_OUTPUT *out, octet *views)
+{
+    int rc = CG21_WIRE_DECODE(I, CG21_WIRE_PRESIGN_ROUND1, views, CG21_WIRE_presign_round1_sizes, CG21_WIRE_PRESIGN_ROUND1_FIELDS);
+    if (rc != CG21_WIRE_OK)
+    {
+        return rc;
+    }
+
+    out->psi = views;
+    out->G = views + 1;
+    out->K = views + 2;
+
+    return CG21_WIRE_get_int(views + 3, &out->i);
+}
+
+/* Fields of an output of round 2 of presign, with the ids encoded into I and J */
+static void CG21_WIRE_presign_round2_fields(const CG21_PRESIGN_ROUND2_OUTPUT *out, octet **f, octet *I, octet *J)
+{
+    CG21_WIRE_put32(I->val, (unsigned int)out->i);
+    CG21_WIRE_put32(J->val, (unsigned int)out->j);
+    I->len = 4;
+    J->len = 4;
+
+    f[0] = out->Gamma;
+    f[1] = out->D;
+    f[2] = out->D_hat;
+    f[3] = out->F;
+    f[4] = out->F_hat;
+    f[5] = out->psi;
+    f[6] = out->psi_hat;
+    f[7] = out->psi_prime;
+    f[8] = I;
+    f[9] = J;
+}
+
+/* Output of round 2 of presign from its views */
+static int CG21_WIRE_presign_round2_views(CG21_PRESIGN_ROUND2_OUTPUT *out, octet *views)
+{
+    int rc;
+
+    out->Gamma = views;
+    out->D = views + 1;
+    out->D_hat = views + 2;
+    out->F = views + 3;
+    out->F_hat = views + 4;
+    out->psi = views + 5;
+    out->psi_hat = views + 6;
+    out->psi_prime = views + 7;
+
+    rc = CG21_WIRE_get_int(views + 8, &out->i);
+    if (rc != CG21_WIRE_OK)
+    {
+        return rc;
+    }
+
+    return CG21_WIRE_get_int(views + 9, &out->j);
+}
+
+int CG21_WIRE_PRESIGN_ROUND2_toOctet(octet *O, const CG21_PRESIGN_ROUND2_OUTPUT *out)
+{
+    char i[4];
+    char j[4];
+    octet I = {4, sizeof(i), i};
+    octet J = {4, sizeof(j), j};
+
+    octet *f[CG21_WIRE_PRESIGN_ROUND2_FIELDS];
+
+    CG21_WIRE_presign_round2_fields(out, f, &I, &J);
+
+    return CG21_WIRE_ENCODE(O, CG21_WIRE_PRESIGN_ROUND2, f, CG21_WIRE_PRESIGN_ROUND2_FIELDS);
+}
+
+int CG21_WIRE_PRESIGN_ROUND2_fromOctet(const octet *I, CG21_PRESIGN_ROUND2_OUTPUT *out, octet *views)
+{
+    int rc = CG21_WIRE_DECODE(I, CG21_WIRE_PRESIGN_ROUND2, views, CG21_WIRE_presign_round2_sizes, CG21_WIRE_PRESIGN_ROUND2_FIELDS);
+    if (rc != CG21_WIRE_OK)
+    {
+        return rc;
+    }
+
+    return CG21_WIRE_presign_round2_views(out, views);
+}
+
+int CG21_WIRE_PRESIGN_ROUND2_ALL_toOctet(octet *O, const CG21_PRESIGN_ROUND2_OUTPUT *out, int n)
+{
+    if (n <= 0 || n * CG21_WIRE_PRESIGN_ROUND2_FIELDS > 255)
+    {
+        return CG21_WIRE_INVALID_COUNT;
+    }
+
+    char ij[n][8];
+    octet I[n];
+    octet J[n];
+
+    octet *f[n * CG21_WIRE_PRESIGN_ROUND2_FIELDS];
+
+    for (int k = 0; k < n; k++)
+    {
+        I[k].max = 4;
+        I[k].val = ij[k];
+        J[k].max = 4;
+        J[k].val = ij[k] + 4;
+
+        CG21_WIRE_presign_round2_fields(out + k, f + k * CG21_WIRE_PRESIGN_ROUND2_FIELDS, I + k, J + k);
+    }
+
+    return CG21_WIRE_ENCODE(O, CG21_WIRE_PRESIGN_ROUND2_ALL, f, n * CG21_WIRE_PRESIGN_ROUND2_FIELDS);
+}
+
+int CG21_WIRE_PRESIGN_ROUND2_ALL_fromOctet(const octet *I, int j, int n, CG21_PRESIGN_ROUND2_OUTPUT *out,
+                                           octet *views)
+{
+    int rc;
+
+    if (n <= 0 || n * CG21_WIRE_PRESIGN_ROUND2_FIELDS > 255)
+    {
+        return CG21_WIRE_INVALID_COUNT;
+    }
+
+    int sizes[n * CG21_WIRE_PRESIGN_ROUND2_FIELDS];
+
+    for (int k = 0; k < n; k++)
+    {
+        memcpy(sizes + k * CG21_WIRE_PRESIGN_ROUND2_FIELDS, CG21_WIRE_presign_round2_sizes,
+               sizeof(CG21_WIRE_presign_round2_sizes));
+    }
+
+    rc = CG21_WIRE_DECODE(I, CG21_WIRE_PRESIGN_ROUND2_ALL, views, sizes, n * CG21_WIRE_PRESIGN_ROUND2_FIELDS);
+    if (rc != CG21_WIRE_OK)
+    {
+        return rc;
+    }
+
+    for (int k = 0; k < n; k++)
+    {
+        rc = CG21_WIRE_presign_round2_views(out, views + k * CG21_WIRE_PRESIGN_ROUND2_FIELDS);
+        if (rc != CG21_WIRE_OK)
+        {
+            return rc;
+        }
+
+        if (out->j == j)
+        {
+            return CG21_WIRE_OK;
+        }
+    }
+
+    return CG21_WIRE_NO_SECTION;
+}
+
+int CG21_WIRE_PRESIGN_ROUND3_toOctet(octet *O, const CG21_PRESIGN_ROUND3_OUTPUT *out)
+{
+    char i[4];
+    octet I = {4, sizeof(i), i};
+
+    CG21_WIRE_put32(i, (unsigned int)out->i);
+
+    octet *f[CG21_WIRE_PRESIGN_ROUND3_FIELDS] = {out->delta, out->Delta, out->psi_douplePrime, &I};
+
+    return CG21_WIRE_ENCODE(O, CG21_WIRE_PRESIGN_ROUND3, f, CG21_WIRE_PRESIGN_ROUND3_FIELDS);
+}
+
+int CG21_WIRE_PRESIGN_ROUND3_fromOctet(const octet *I, CG21_PRESIGN_ROUND3_OUTPUT *out, octet *views)
+{
+    int rc = CG21_WIRE_DECODE(I, CG21_WIRE_PRESIGN_ROUND3, views, CG21_WIRE_presign_round3_sizes, CG21_WIRE_PRESIGN_ROUND3_FIELDS);
+    if (rc != CG21_WIRE_OK)
+    {
+        return rc;
+    }
+
+    out->delta = views;
+    out->Delta = views + 1;
+    out->psi_douplePrime = views + 2;
+
+    return CG21_WIRE_get_int(views + 3, &out->i);
+}
+
+/* Number of sections of an _ALL message of round 1 or 3 is valid */
+static int CG21_WIRE_presign_all_count(int n)
+{
+    return n > 0 && CG21_WIRE_PRESIGN_ALL_FIELDS + n * CG21_WIRE_PRESIGN_SECTION_FIELDS <= 255;
+}
+
+/* Encode the common fields f of a round, then (j, psi) for each peer */
+static int CG21_WIRE_presign_all_toOctet(octet *O, int type, octet **f, octet *const *psi, const int *to, int n)
+{
+    char j[n][4];
+    octet J[n];
+
+    for (int k = 0; k < n; k++)
+    {
+        CG21_WIRE_put32(j[k], (unsigned int)to[k]);
+        J[k].len = 4;
+        J[k].max = 4;
+        J[k].val = j[k];
+
+        f[CG21_WIRE_PRESIGN_ALL_FIELDS + k * CG21_WIRE_PRESIGN_SECTION_FIELDS] = J + k;
+        f[CG21_WIRE_PRESIGN_ALL_FIELDS + k * CG21_WIRE_PRESIGN_SECTION_FIELDS + 1] = psi[k];
+    }
+
+    return CG21_WIRE_ENCODE(O, type, f, CG21_WIRE_PRESIGN_ALL_FIELDS + n * CG21_WIRE_PRESIGN_SECTION_FIELDS);
+}
+
+/* Decode the common fields of a round and return in psi the view addressed to j */
+static int CG21_WIRE_presign_all_fromOctet(const octet *I, int type, const int *sizes, int psi_size, int j, int n,
+                                           octet **psi, octet *views)
+{
+    int rc;
+    int to;
+
+    if (!CG21_WIRE_presign_all_count(n))
+    {
+        return CG21_WIRE_INVALID_COUNT;
+    }
+
+    int all[CG21_WIRE_PRESIGN_ALL_FIELDS + n * CG21_WIRE_PRESIGN_SECTION_FIELDS];
+
+    memcpy(all, sizes, CG21_WIRE_PRESIGN_ALL_FIELDS * sizeof(int));
+
+    for (int k = 0; k < n; k++)
+    {
+        all[CG21_WIRE_PRESIGN_ALL_FIELDS + k * CG21_WIRE_PRESIGN_SECTION_FIELDS] = 4;
+        all[CG21_WIRE_PRESIGN_ALL_FIELDS + k * CG21_WIRE_PRESIGN_SECTION_FIELDS + 1] = psi_size;
+    }
+
+    rc = CG21_WIRE_DECODE(I, type, views, all, CG21_WIRE_PRESIGN_ALL_FIELDS + n * CG21_WIRE_PRESIGN_SECTION_FIELDS);
+    if (rc != CG21_WIRE_OK)
+    {
+        return rc;
+    }
+
+    for (int k = 0; k < n; k++)
+    {
+        octet *section = views + CG21_WIRE_PRESIGN_ALL_FIELDS + k * CG21_WIRE_PRESIGN_SECTION_FIELDS;
+
+        rc = CG21_WIRE_get_int(section, &to);
+        if (rc != CG21_WIRE_OK)
+        {
+            return rc;
+        }
+
+        if (to == j)
+        {
+            *psi = section + 1;
+            return CG21_WIRE_OK;
+        }
+    }
+
+    return CG21_WIRE_NO_SECTION;
+}
+
+int CG21_WIRE_PRESIGN_ROUND1_ALL_toOctet(octet *O, const CG21_PRESIGN_ROUND1_OUTPUT *out, octet *const *psi,
+                                         const int *to, int n)
+{
+    char i[4];
+    octet I = {4, sizeof(i), i};
+
+    if (!CG21_WIRE_presign_all_count(n))
+    {
+        return CG21_WIRE_INVALID_COUNT;
+    }
+
+    CG21_WIRE_put32(i, (unsigned int)out->i);
+
+    octet *f[CG21_WIRE_PRESIGN_ALL_FIELDS + n * CG21_WIRE_PRESIGN_SECTION_FIELDS];
+
+    f[0] = out->G;
+    f[1] = out->K;
+    f[2] = &I;
+
+    return CG21_WIRE_presign_all_toOctet(O, CG21_WIRE_PRESIGN_ROUND1_ALL, f, psi, to, n);
+}
+
+int CG21_WIRE_PRESIGN_ROUND1_ALL_fromOctet(const octet *I, int j, int n, CG21_PRESIGN_ROUND1_OUTPUT *out,
+                                           octet *views)
+{
+    int rc = CG21_WIRE_presign_all_fromOctet(I, CG21_WIRE_PRESIGN_ROUND1_ALL, CG21_WIRE_presign_round1_all_sizes,
+                                             CG21_WIRE_PIENC_PROOF_SIZE, j, n, &out->psi, views);
+    if (rc != CG21_WIRE_OK)
+    {
+        return rc;
+    }
+
+    out->G = views;
+    out->K = views + 1;
+
+    return CG21_WIRE_get_int(views + 2, &out->i);
+}
+
+int CG21_WIRE_PRESIGN_ROUND3_ALL_toOctet(octet *O, const CG21_PRESIGN_ROUND3_OUTPUT *out, octet *const *psi,
+                                         const int *to, int n)
+{
+    char i[4];
+    octet I = {4, sizeof(i), i};
+
+    if (!CG21_WIRE_presign_all_count(n))
+    {
+        return CG21_WIRE_INVALID_COUNT;
+    }
+
+    CG21_WIRE_put32(i, (unsigned int)out->i);
+
+    octet *f[CG21_WIRE_PRESIGN_ALL_FIELDS + n * CG21_WIRE_PRESIGN_SECTION_FIELDS];
+
+    f[0] = out->delta;
+    f[1] = out->Delta;
+    f[2] = &I;
+
+    return CG21_WIRE_presign_all_toOctet(O, CG21_WIRE_PRESIGN_ROUND3_ALL, f, psi, to, n);
+}
+
+int CG21_WIRE_PRESIGN_ROUND3_ALL_fromOctet(const octet *I, int j, int n, CG21_PRESIGN_ROUND3_OUTPUT *out,
+                                           octet *views)
+{
+    int rc = CG21_WIRE_presign_all_fromOctet(I, CG21_WIRE_PRESIGN_ROUND3_ALL, CG21_WIRE_presign_round3_all_sizes,
+                                             CG21_WIRE_PILOGSTAR_PROOF_SIZE, j, n, &out->psi_douplePrime, views);
+    if (rc != CG21_WIRE_OK)
+    {
+        return rc;
+    }
+
+    out->delta = views;
+    out->Delta = views + 1;
+
+    return CG21_WIRE_get_int(views + 2, &out->i);
+}
+
+int CG21_WIRE_PIENC_PROOF_toOctet(octet *O, const PiEnc_COMMITS_OCT *c, const PiEnc_PROOFS_OCT *p)
+{
+    octet *f[CG21_WIRE_PIENC_PROOF_FIELDS] = {c->S, c->A, c->C, p->z1, p->z2, p->z3};
+
+    return CG21_WIRE_ENCODE(O, CG21_WIRE_PIENC_PROOF, f, CG21_WIRE_PIENC_PROOF_FIELDS);
+}
+
+int CG21_WIRE_PIENC_PROOF_fromOctet(const octet *I, PiEnc_COMMITS_OCT *c, PiEnc_PROOFS_OCT *p, octet *views)
+{
+    int rc = CG21_WIRE_DECODE(I, CG21_WIRE_PIENC_PROOF, views, CG21_WIRE_pienc_proof_sizes, CG21_WIRE_PIENC_PROOF_FIELDS);
+    if (rc != CG21_WIRE_OK)
+    {
+        return rc;
+    }
+
+    c->S = views;
+    c->A = views + 1;
+    c->C = views + 2;
+    p->z1 = views + 3;
+    p->z2 = views + 4;
+    p->z3 = views + 5;
+
+    return CG21_WIRE_OK;
+}
+
+int CG21_WIRE_PILOGSTAR_PROOF_toOctet(octet *O, const PiLogstar_COMMITS_OCT *c, const PiLogstar_PROOFS_OCT *p)
+{
+    octet *f[CG21_WIRE_PILOGSTAR_PROOF_FIELDS] = {c->S, c->A, c->D, c->Y, p->z1, p->z2, p->z3};
+
+    return CG21_WIRE_ENCODE(O, CG21_WIRE_PILOGSTAR_PROOF, f, CG21_WIRE_PILOGSTAR_PROOF_FIELDS);
+}
+
+int CG21_WIRE_PILOGSTAR_PROOF_fromOctet(const octet *I, PiLogstar_COMMITS_OCT *c, PiLogstar_PROOFS_OCT *p,
+                                        octet *views)
+{
+    int rc = CG21_WIRE_DECODE(I, CG21_WIRE_PILOGSTAR_PROOF, views, CG21_WIRE_pilogstar_proof_sizes,
+                              CG21_WIRE_PILOGSTAR_PROOF_FIELDS);
+    if (rc != CG21_WIRE_OK)
+    {
+        return rc;
+    }
+
+    c->S = views;
+    c->A = views + 1;
+    c->D = views + 2;
+    c->Y = views + 3;
+    p->z1 = views + 4;
+    p->z2 = views + 5;
+    p->z3 = views + 6;
+
+    return CG21_WIRE_OK;
+}
+
+int CG21_WIRE_PIAFFG_PROOF_toOctet(octet *O, const Piaffg_COMMITS_OCT *c, const Piaffg_PROOFS_OCT *p)
+{
+    octet *f[CG21_WIRE_PIAFFG_PROOF_FIELDS] = {c->A, c->Bx, c->By, c->E, c->S, c->F, c->T,
+                                               p->z1, p->z2, p->z3, p->z4, p->w, p->wy};
+
+    return CG21_WIRE_ENCODE(O, CG21_WIRE_PIAFFG_PROOF, f, CG21_WIRE_PIAFFG_PROOF_FIELDS);
+}
+
+int CG21_WIRE_PIAFFG_PROOF_fromOctet(const octet *I, Piaffg_COMMITS_OCT *c, Piaffg_PROOFS_OCT *p, octet *views)
+{
+    int sizes[CG21_WIRE_PIAFFG_PROOF_FIELDS];
+
+    memcpy(sizes, CG21_WIRE_piaffg_commits_sizes, sizeof(CG21_WIRE_piaffg_commits_sizes));
+    memcpy(sizes + CG21_WIRE_PIAFFG_COMMITS_FIELDS, CG21_WIRE_piaffg_proofs_sizes, sizeof(CG21_WIRE_piaffg_proofs_sizes));
+
+    int rc = CG21_WIRE_DECODE(I, CG21_WIRE_PIAFFG_PROOF, views, sizes, CG21_WIRE_PIAFFG_PROOF_FIELDS);
+    if (rc != CG21_WIRE_OK)
+    {
+        return rc;
+    }
+
+    c->A = views;
+    c->Bx = views + 1;
+    c->By = views + 2;
+    c->E = views + 3;
+    c->S = views + 4;
+    c->F = views + 5;
+    c->T = views + 6;
+
+    p->z1 = views + 7;
+    p->z2 = views + 8;
+    p->z3 = views + 9;
+    p->z4 = views + 10;
+    p->w = views + 11;
+    p->wy = views + 12;
+
+    return CG21_WIRE_OK;
+}
+
+int CG21_WIRE_PIAFFG_COMMITS_toOctet(octet *O, const Piaffg_COMMITS_OCT *c)
+{
+    octet *f[CG21_WIRE_PIAFFG_COMMITS_FIELDS] = {c->A, c->Bx, c->By, c->E, c->S, c->F, c->T};
+
+    return CG21_WIRE_ENCODE(O, CG21_WIRE_PIAFFG_COMMITS, f, CG21_WIRE_PIAFFG_COMMITS_FIELDS);
+}
+
+int CG21_WIRE_PIAFFG_COMMITS_fromOctet(const octet *I, Piaffg_COMMITS_OCT *c, octet *views)
+{
+    int rc = CG21_WIRE_DECODE(I, CG21_WIRE_PIAFFG_COMMITS, views, CG21_WIRE_piaffg_commits_sizes, CG21_WIRE_PIAFFG_COMMITS_FIELDS);
+    if (rc != CG21_WIRE_OK)
+    {
+        return rc;
+    }
+
+    c->A = views;
+    c->Bx = views + 1;
+    c->By = views + 2;
+    c->E = views + 3;
+    c->S = views + 4;
+    c->F = views + 5;
+    c->T = views + 6;
+
+    return CG21_WIRE_OK;
+}
+
+int CG21_WIRE_PIAFFG_PROOFS_toOctet(octet *O, const Piaffg_PROOFS_OCT *p)
+{
+    octet *f[CG21_WIRE_PIAFFG_PROOFS_FIELDS] = {p->z1, p->z2, p->z3, p->z4, p->w, p->wy};
+
+    return CG21_WIRE_ENCODE(O, CG21_WIRE_PIAFFG_PROOFS, f, CG21_WIRE_PIAFFG_PROOFS_FIELDS);
+}
+
+int CG21_WIRE_PIAFFG_PROOFS_fromOctet(const octet *I, Piaffg_PROOFS_OCT *p, octet *views)
+{
+    int rc = CG21_WIRE_DECODE(I, CG21_WIRE_PIAFFG_PROOFS, views, CG21_WIRE_piaffg_proofs_sizes, CG21_WIRE_PIAFFG_PROOFS_FIELDS);
+    if (rc != CG21_WIRE_OK)
+    {
+        return rc;
+    }
+
+    p->z1 = views;
+    p->z2 = views + 1;
+    p->z3 = views + 2;
+    p->z4 = views + 3;
+    p->w = views + 4;
+    p->wy = views + 5;
+
+    return CG21_WIRE_OK;
+}
+
+int CG21_WIRE_PIMOD_PROOF_toOctet(octet *O, const CG21_PIMOD_PROOF_OCT *p)
+{
+    octet *f[CG21_WIRE_PIMOD_PROOF_FIELDS] = {p->w, p->x, p->z, p->ab};
+
+    return CG21_WIRE_ENCODE(O, CG21_WIRE_PIMOD_PROOF, f, CG21_WIRE_PIMOD_PROOF_FIELDS);
+}
+
+int CG21_WIRE_PIMOD_PROOF_fromOctet(const octet *I, CG21_PIMOD_PROOF_OCT *p, octet *views)
+{
+    int rc = CG21_WIRE_DECODE(I, CG21_WIRE_PIMOD_PROOF, views, CG21_WIRE_pimod_proof_sizes, CG21_WIRE_PIMOD_PROOF_FIELDS);
+    if (rc != CG21_WIRE_OK)
+    {
+        return rc;
+    }
+
+    p->w = views;
+    p->x = views + 1;
+    p->z = views + 2;
+    p->ab = views + 3;
+
+    return CG21_WIRE_OK;
+}
+
+int CG21_WIRE_AUX_ROUND3_toOctet(octet *O, const CG21_AUX_ROUND3 *r3)
+{
+    char i[4];
+    char t[4];
+    octet I = {4, sizeof(i), i};
+    octet T = {4, sizeof(t), t};
+
+    CG21_WIRE_put32(i, (unsigned int)r3->i);
+    CG21_WIRE_put32(t, (unsigned int)r3->t);
+
+    const CG21_PIMOD_PROOF_OCT *mod = &r3->paillierProof;
+    const CG21_PiFACTOR_PROOF *fp = &r3->factorProof;
+    const CG21_PiFACTOR_COMMIT *fc = &r3->factorCommits;
+
+    octet *f[CG21_WIRE_AUX_ROUND3_FIELDS] = {r3->rho, &I, &T,
+                                             mod->w, mod->x, mod->z, mod->ab,
+                                             fp->z1, fp->z2, fp->w1, fp->w2, fp->v,
+                                             fc->P, fc->Q, fc->A, fc->B, fc->T, fc->sigma};
+
+    return CG21_WIRE_ENCODE(O, CG21_WIRE_AUX_ROUND3, f, CG21_WIRE_AUX_ROUND3_FIELDS);
+}
+
+int CG21_WIRE_AUX_ROUND3_fromOctet(const octet *I, CG21_AUX_ROUND3 *r3, octet *views)
+{
+    int rc = CG21_WIRE_DECODE(I, CG21_WIRE_AUX_ROUND3, views, CG21_WIRE_aux_round3_sizes, CG21_WIRE_AUX_ROUND3_FIELDS);
+    if (rc != CG21_WIRE_OK)
+    {
+        return rc;
+    }
+
+    r3->rho = views;
+
+    rc = CG21_WIRE_get_int(views + 1, &r3->i);
+    if (rc != CG21_WIRE_OK)
+    {
+        return rc;
+    }
+
+    rc = CG21_WIRE_get_int(views + 2, &r3->t);
+    if (rc != CG21_WIRE_OK)
+    {
+        return rc;
+    }
+
+    r3->paillierProof.w = views + 3;
+    r3->paillierProof.x = views + 4;
+    r3->paillierProof.z = views + 5;
+    r3->paillierProof.ab = views + 6;
+
+    r3->factorProof.z1 = views + 7;
+    r3->factorProof.z2 = views + 8;
+    r3->factorProof.w1 = views + 9;
+    r3->factorProof.w2 = views + 10;
+    r3->factorProof.v = views + 11;
+
+    r3->factorCommits.P = views + 12;
+    r3->factorCommits.Q = views + 13;
+    r3->factorCommits.A = views + 14;
+    r3->factorCommits.B = views + 15;
+    r3->factorCommits.T = views + 16;
+    r3->factorCommits.sigma = views + 17;
+
+    return CG21_WIRE_OK;
+}
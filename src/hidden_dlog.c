@@ -18,6 +18,7 @@ under the License.
 */
 
 #include "amcl/hidden_dlog.h"
+#include "amcl/parallel.h"
 
 /* Definitions for ZKPoK of a DLOG in a hidden order group */
 
@@ -27,27 +28,69 @@ under the License.
 #define C_SIZE 1 << C_WINDOW
 
 // Window and table size for non CT precomputation
-// using basic interleaving
+// using basic interleaving, N_SIZE = 1 << (N_WINDOW - 1)
 #define N_WINDOW 5
-#define N_SIZE 1 << (N_WINDOW - 1)
+#define N_SIZE HDLOG_VERIFY_TABLE_SIZE
+
+/* Shared state for the iterations of HDLOG_commit */
+typedef struct
+{
+    MODULUS_priv *m;
+    BIG_1024_58 *fm1p;
+    BIG_1024_58 *fm1q;
+    BIG_1024_58 *NDp;
+    BIG_1024_58 *NDq;
+    BIG_1024_58 **Tp;
+    BIG_1024_58 **Tq;
+    BIG_1024_58 (*R)[FFLEN_2048];
+    BIG_1024_58 (*RHO)[FFLEN_2048];
+} HDLOG_commit_ctx;
+
+/* Compute RHO[i] = B0^R[i] mod P and mod Q, recombined using CRT */
+static void HDLOG_commit_iter(void *arg, int i)
+{
+    HDLOG_commit_ctx *c = (HDLOG_commit_ctx *)arg;
+
+    BIG_1024_58 rhoq[HFLEN_2048];
+    BIG_1024_58 ws[HFLEN_2048];
+    BIG_1024_58 *WS[] = {ws};
+
+    FF_2048_dmod(ws, c->R[i], c->fm1p, HFLEN_2048);
+    FF_2048_ct_2w_pow(c->RHO[i], c->Tp, WS, 1, C_WINDOW, c->m->p, c->NDp, HFLEN_2048, HFLEN_2048);
+
+    FF_2048_dmod(ws, c->R[i], c->fm1q, HFLEN_2048);
+    FF_2048_ct_2w_pow(rhoq, c->Tq, WS, 1, C_WINDOW, c->m->q, c->NDq, HFLEN_2048, HFLEN_2048);
+
+    FF_2048_crt(c->RHO[i], c->RHO[i], rhoq, c->m->p, c->m->invpq, c->m->n, HFLEN_2048);
+
+    // Clean memory
+    FF_2048_zero(ws,   HFLEN_2048);
+    FF_2048_zero(rhoq, HFLEN_2048);
+}
 
 void HDLOG_commit(csprng *RNG, MODULUS_priv *m, BIG_1024_58 *ord, BIG_1024_58 *B0, HDLOG_iter_values R, HDLOG_iter_values RHO)
 {
     int i;
 
-    BIG_1024_58 fm1[HFLEN_2048];
-    BIG_1024_58 rhoq[HFLEN_2048];
-    BIG_1024_58 ND[HFLEN_2048];
+    HDLOG_commit_ctx ctx;
+
+    BIG_1024_58 fm1p[HFLEN_2048];
+    BIG_1024_58 fm1q[HFLEN_2048];
+    BIG_1024_58 NDp[HFLEN_2048];
+    BIG_1024_58 NDq[HFLEN_2048];
 
     BIG_1024_58 ws[HFLEN_2048];
     BIG_1024_58 *WS[] = {ws};
 
-    BIG_1024_58 T_mem[C_SIZE][HFLEN_2048];
-    BIG_1024_58 *T[C_SIZE] = {0};
+    BIG_1024_58 Tp_mem[C_SIZE][HFLEN_2048];
+    BIG_1024_58 Tq_mem[C_SIZE][HFLEN_2048];
+    BIG_1024_58 *Tp[C_SIZE] = {0};
+    BIG_1024_58 *Tq[C_SIZE] = {0};
 
     for (i = 0; i < C_SIZE; i++)
     {
-        T[i] = T_mem[i];
+        Tp[i] = Tp_mem[i];
+        Tq[i] = Tq_mem[i];
     }
 
     // Generate random values for commitments
@@ -59,42 +102,46 @@ void HDLOG_commit(csprng *RNG, MODULUS_priv *m, BIG_1024_58 *ord, BIG_1024_58 *B
         }
     }
 
-    // Compute exponents B0^R mod P for later use in CRT
-    FF_2048_copy(fm1, m->p, HFLEN_2048);
-    FF_2048_dec(fm1, 1, HFLEN_2048);
+    // Precompute tables for B0 mod P and mod Q
+    FF_2048_copy(fm1p, m->p, HFLEN_2048);
+    FF_2048_dec(fm1p, 1, HFLEN_2048);
 
     FF_2048_dmod(ws, B0, m->p, HFLEN_2048);
+    FF_2048_invmod2m(NDp, m->p, HFLEN_2048);
+    FF_2048_2w_precompute(WS, Tp, 1, C_WINDOW, m->p, NDp, HFLEN_2048);
 
-    FF_2048_invmod2m(ND, m->p, HFLEN_2048);
-    FF_2048_2w_precompute(WS, T, 1, C_WINDOW, m->p, ND, HFLEN_2048);
-
-    for (i = 0; i < HDLOG_PROOF_ITERS; i++)
-    {
-        FF_2048_dmod(ws, R[i], fm1, HFLEN_2048);
-        FF_2048_ct_2w_pow(RHO[i], T, WS, 1, C_WINDOW, m->p, ND, HFLEN_2048, HFLEN_2048);
-    }
+    FF_2048_copy(fm1q, m->q, HFLEN_2048);
+    FF_2048_dec(fm1q, 1, HFLEN_2048);
 
-    // Compute exponents B0^R mod Q and recombine using CRT
     FF_2048_dmod(ws, B0, m->q, HFLEN_2048);
-    FF_2048_invmod2m(ND, m->q, HFLEN_2048);
-    FF_2048_2w_precompute(WS, T, 1, C_WINDOW, m->q, ND, HFLEN_2048);
+    FF_2048_invmod2m(NDq, m->q, HFLEN_2048);
+    FF_2048_2w_precompute(WS, Tq, 1, C_WINDOW, m->q, NDq, HFLEN_2048);
+
+    // Compute exponents B0^R mod P and Q and recombine using CRT
+    ctx.m = m;
+    ctx.fm1p = fm1p;
+    ctx.fm1q = fm1q;
+    ctx.NDp = NDp;
+    ctx.NDq = NDq;
+    ctx.Tp = Tp;
+    ctx.Tq = Tq;
+    ctx.R = R;
+    ctx.RHO = RHO;
+
+    PARALLEL_for(HDLOG_commit_iter, &ctx, HDLOG_PROOF_ITERS);
 
-    FF_2048_copy(fm1, m->q, HFLEN_2048);
-    FF_2048_dec(fm1, 1, HFLEN_2048);
+    // Clean memory
+    FF_2048_zero(fm1p, HFLEN_2048);
+    FF_2048_zero(fm1q, HFLEN_2048);
+    FF_2048_zero(ws,   HFLEN_2048);
+    FF_2048_zero(NDp,  HFLEN_2048);
+    FF_2048_zero(NDq,  HFLEN_2048);
 
-    for (i = 0; i < HDLOG_PROOF_ITERS; i++)
+    for (i = 0; i < C_SIZE; i++)
     {
-        FF_2048_dmod(ws, R[i], fm1, HFLEN_2048);
-        FF_2048_ct_2w_pow(rhoq, T, WS, 1, C_WINDOW, m->q, ND, HFLEN_2048, HFLEN_2048);
-
-        FF_2048_crt(RHO[i], RHO[i], rhoq, m->p, m->invpq, m->n, HFLEN_2048);
+        FF_2048_zero(Tp_mem[i], HFLEN_2048);
+        FF_2048_zero(Tq_mem[i], HFLEN_2048);
     }
-
-    // Clean memory
-    FF_2048_zero(fm1,  HFLEN_2048);
-    FF_2048_zero(ws,   HFLEN_2048);
-    FF_2048_zero(rhoq, HFLEN_2048);
-    FF_2048_zero(ND,   HFLEN_2048);
 }
 
 
@@ -140,10 +187,8 @@ void HDLOG_challenge(BIG_1024_58 *N, BIG_1024_58 *B0, BIG_1024_58 *B1, HDLOG_ite
     OCT_jbytes(E, w, HDLOG_CHALLENGE_SIZE);
 }
 
-int HDLOG_challenge_CG21(BIG_1024_58 *N, BIG_1024_58 *B0, BIG_1024_58 *B1, HDLOG_iter_values RHO, const HDLOG_SSID *ssid,
-                         octet *E, int n)
+int HDLOG_challenge_CG21_init(hash256 *sha, BIG_1024_58 *N, BIG_1024_58 *B0, BIG_1024_58 *B1, const HDLOG_SSID *ssid, int n)
 {
-    hash256 sha;
     char o[SFS_SECP256K1 + 1];
     octet G_oct = {0, sizeof(o), o};
 
@@ -154,134 +199,280 @@ int HDLOG_challenge_CG21(BIG_1024_58 *N, BIG_1024_58 *B0, BIG_1024_58 *B1, HDLOG
     char w[FS_2048];
     octet W = {0, sizeof(w), w};
 
-    HASH256_init(&sha);
+    HASH256_init(sha);
 
     // Bind the public parameters
     FF_2048_toOctet(&W, N, FFLEN_2048);
-    HASH_UTILS_hash_oct(&sha, &W);
+    HASH_UTILS_hash_oct(sha, &W);
 
     FF_2048_toOctet(&W, B0, FFLEN_2048);
-    HASH_UTILS_hash_oct(&sha, &W);
+    HASH_UTILS_hash_oct(sha, &W);
 
     FF_2048_toOctet(&W, B1, FFLEN_2048);
-    HASH_UTILS_hash_oct(&sha, &W);
+    HASH_UTILS_hash_oct(sha, &W);
 
-    HASH_UTILS_hash_oct(&sha, ssid->rid);
-    HASH_UTILS_hash_oct(&sha, ssid->rho);
+    HASH_UTILS_hash_oct(sha, ssid->rid);
+    HASH_UTILS_hash_oct(sha, ssid->rho);
 
     CG21_get_G(&G_oct);
     CG21_get_q(&q_oct);
 
-    HASH_UTILS_hash_oct(&sha, &G_oct);
-    HASH_UTILS_hash_oct(&sha, &q_oct);
+    HASH_UTILS_hash_oct(sha, &G_oct);
+    HASH_UTILS_hash_oct(sha, &q_oct);
 
     // sort partial X[i] based on j_packed and process them into sha
-    int rc = CG21_hash_set_X(&sha, ssid->X_set_packed, ssid->j_set_packed, n, EFS_SECP256K1 + 1);
+    int rc = CG21_hash_set_X(sha, ssid->X_set_packed, ssid->j_set_packed, n, EFS_SECP256K1 + 1);
     if (rc!=CG21_OK){
         return rc;
     }
 
+    return HDLOG_OK;
+}
+
+void HDLOG_challenge_CG21_update(hash256 *sha, const octet *RHO)
+{
+    // The encoding of the values is the concatenation of their FS_2048 bytes
+    HASH_UTILS_hash_oct(sha, RHO);
+}
+
+void HDLOG_challenge_CG21_final(hash256 *sha, octet *E)
+{
+    char w[SHA256];
+
+    HASH256_hash(sha, w);
+
+    OCT_clear(E);
+    OCT_jbytes(E, w, HDLOG_CHALLENGE_SIZE);
+}
+
+int HDLOG_challenge_CG21(BIG_1024_58 *N, BIG_1024_58 *B0, BIG_1024_58 *B1, HDLOG_iter_values RHO, const HDLOG_SSID *ssid,
+                         octet *E, int n)
+{
+    hash256 sha;
+
+    char w[FS_2048];
+    octet W = {0, sizeof(w), w};
+
+    int rc = HDLOG_challenge_CG21_init(&sha, N, B0, B1, ssid, n);
+    if (rc != HDLOG_OK)
+    {
+        return rc;
+    }
+
     // Bind to commitment
     for (int i = 0; i < HDLOG_PROOF_ITERS; i++)
     {
         FF_2048_toOctet(&W, RHO[i], FFLEN_2048);
-        HASH_UTILS_hash_oct(&sha, &W);
+        HDLOG_challenge_CG21_update(&sha, &W);
     }
 
-    HASH256_hash(&sha, w);
-
-    OCT_clear(E);
-    OCT_jbytes(E, w, HDLOG_CHALLENGE_SIZE);
+    HDLOG_challenge_CG21_final(&sha, E);
 
     return HDLOG_OK;
 }
 
 
+/* Shared state for the iterations of HDLOG_prove */
+typedef struct
+{
+    BIG_1024_58 *ord;
+    BIG_1024_58 *alphaneg;
+    BIG_1024_58 (*R)[FFLEN_2048];
+    const octet *E;
+    BIG_1024_58 (*T)[FFLEN_2048];
+} HDLOG_prove_ctx;
+
+/* Compute T[i] = R[i] - e_i * alpha mod ord */
+static void HDLOG_prove_iter(void *arg, int i)
+{
+    HDLOG_prove_ctx *c = (HDLOG_prove_ctx *)arg;
+
+    FF_2048_copy(c->T[i], c->R[i], FFLEN_2048);
+
+    // No need to be constant time over the value of E
+    // since it is public
+    if (c->E->val[i / 8] & (0x80 >> (i % 8)))
+    {
+        FF_2048_add(c->T[i], c->T[i], c->alphaneg, FFLEN_2048);
+        FF_2048_mod(c->T[i], c->ord, FFLEN_2048);
+    }
+}
+
 void HDLOG_prove(BIG_1024_58 *ord, BIG_1024_58 *alpha, HDLOG_iter_values R, octet *E, HDLOG_iter_values T)
 {
-    int i;
-    int mask;
+    HDLOG_prove_ctx ctx;
 
     BIG_1024_58 alphaneg[FFLEN_2048];
 
     FF_2048_sub(alphaneg, ord, alpha, FFLEN_2048);
 
-    for (i = 0; i < HDLOG_CHALLENGE_SIZE; i++)
-    {
-        mask = 0x80;
-        while (mask)
-        {
-            FF_2048_copy(*T, *R, FFLEN_2048);
-
-            // No need to be constant time over the value of E
-            // since it is public
-            if (E->val[i] & mask)
-            {
-                FF_2048_add(*T, *T, alphaneg, FFLEN_2048);
-                FF_2048_mod(*T, ord, FFLEN_2048);
-            }
-
-            // Advance mask and iter values
-            mask>>=1;
-            R++;
-            T++;
-        }
-    }
+    ctx.ord = ord;
+    ctx.alphaneg = alphaneg;
+    ctx.R = R;
+    ctx.E = E;
+    ctx.T = T;
+
+    PARALLEL_for(HDLOG_prove_iter, &ctx, HDLOG_PROOF_ITERS);
 
     FF_2048_zero(alphaneg, FFLEN_2048);
 }
 
-
-int HDLOG_verify(BIG_1024_58 *N, BIG_1024_58 *B0, BIG_1024_58 *B1, HDLOG_iter_values RHO, const octet *E, HDLOG_iter_values T)
+/* Shared state for the iterations of HDLOG_verify */
+typedef struct
 {
-    int i;
-    int mask;
+    HDLOG_verify_state *S;
+    BIG_1024_58 **PT;
+    BIG_1024_58 (*RHO)[FFLEN_2048];
+    BIG_1024_58 (*T)[FFLEN_2048];
+    int *rc;
+} HDLOG_verify_ctx;
+
+/* Check B0^T[i] * B1^e_i = RHO[i] mod N, for the iteration S->next + i */
+static void HDLOG_verify_iter(void *arg, int i)
+{
+    HDLOG_verify_ctx *c = (HDLOG_verify_ctx *)arg;
+    HDLOG_verify_state *S = c->S;
+
+    int j = S->next + i;
 
     BIG_1024_58 ws[FFLEN_2048];
     BIG_1024_58 dws[2 * FFLEN_2048];
-    BIG_1024_58 ND[FFLEN_2048];
+    BIG_1024_58 *E[] = {c->T[i]};
+
+    FF_2048_bi_pow(ws, c->PT, E, 1, N_WINDOW, S->N, S->ND, FFLEN_2048, FFLEN_2048);
+
+    // No need to be constant time over the value of E
+    // since it is public
+    if (S->e[j / 8] & (0x80 >> (j % 8)))
+    {
+        FF_2048_mul(dws, ws, S->B1, FFLEN_2048);
+        FF_2048_dmod(ws, dws, S->N, FFLEN_2048);
+    }
+
+    c->rc[i] = FF_2048_comp(ws, c->RHO[i], FFLEN_2048);
+}
+
+/* Verify k consecutive iterations from S->next */
+static int HDLOG_verify_values(HDLOG_verify_state *S, BIG_1024_58 (*RHO)[FFLEN_2048], BIG_1024_58 (*T)[FFLEN_2048], int k)
+{
+    int i;
+    int rc[k];
+
+    HDLOG_verify_ctx ctx;
 
-    BIG_1024_58 PT_mem[N_SIZE][FFLEN_2048];
     BIG_1024_58 *PT[N_SIZE];
 
     for (i = 0; i < N_SIZE; i++)
     {
-        PT[i] = PT_mem[i];
+        PT[i] = S->PT[i];
     }
 
-    FF_2048_invmod2m(ND, N, FFLEN_2048);
-    FF_2048_bi_precompute(&B0, PT, 1, N_WINDOW, N, ND, FFLEN_2048);
+    ctx.S = S;
+    ctx.PT = PT;
+    ctx.RHO = RHO;
+    ctx.T = T;
+    ctx.rc = rc;
 
-    for (i = 0; i < HDLOG_CHALLENGE_SIZE; i++)
+    PARALLEL_for(HDLOG_verify_iter, &ctx, k);
+
+    for (i = 0; i < k; i++)
     {
-        mask = 0x80;
-        while (mask)
+        if (rc[i])
         {
-            FF_2048_bi_pow(ws, PT, (BIG_1024_58 **)(&T), 1, N_WINDOW, N, ND, FFLEN_2048, FFLEN_2048);
-
-            // No need to be constant time over the value of E
-            // since it is public
-            if (E->val[i] & mask)
-            {
-                FF_2048_mul(dws, ws, B1, FFLEN_2048);
-                FF_2048_dmod(ws, dws, N, FFLEN_2048);
-            }
-
-            if (FF_2048_comp(ws, *RHO, FFLEN_2048))
-            {
-                return HDLOG_FAIL;
-            }
-
-            // Advance mask and iter values
-            mask>>=1;
-            RHO++;
-            T++;
+            return HDLOG_FAIL;
         }
     }
 
+    S->next += k;
+
     return HDLOG_OK;
 }
 
+int HDLOG_verify_init(HDLOG_verify_state *S, BIG_1024_58 *N, BIG_1024_58 *B0, BIG_1024_58 *B1, const octet *E)
+{
+    int i;
+
+    BIG_1024_58 *PT[N_SIZE];
+
+    if (E->len != HDLOG_CHALLENGE_SIZE)
+    {
+        return HDLOG_INVALID_VALUES;
+    }
+
+    for (i = 0; i < N_SIZE; i++)
+    {
+        PT[i] = S->PT[i];
+    }
+
+    FF_2048_copy(S->N, N, FFLEN_2048);
+    FF_2048_copy(S->B1, B1, FFLEN_2048);
+
+    FF_2048_invmod2m(S->ND, N, FFLEN_2048);
+    FF_2048_bi_precompute(&B0, PT, 1, N_WINDOW, N, S->ND, FFLEN_2048);
+
+    for (i = 0; i < HDLOG_CHALLENGE_SIZE; i++)
+    {
+        S->e[i] = E->val[i];
+    }
+
+    S->next = 0;
+
+    return HDLOG_OK;
+}
+
+int HDLOG_verify_chunk(HDLOG_verify_state *S, const octet *RHO, const octet *T)
+{
+    int i;
+
+    if (RHO->len != T->len || RHO->len <= 0 || RHO->len % FS_2048 != 0)
+    {
+        return HDLOG_INVALID_VALUES;
+    }
+
+    int k = RHO->len / FS_2048;
+    if (k > HDLOG_PROOF_ITERS - S->next)
+    {
+        return HDLOG_INVALID_VALUES;
+    }
+
+    BIG_1024_58 rho[k][FFLEN_2048];
+    BIG_1024_58 t[k][FFLEN_2048];
+
+    for (i = 0; i < k; i++)
+    {
+        octet W = {FS_2048, FS_2048, RHO->val + i * FS_2048};
+        FF_2048_fromOctet(rho[i], &W, FFLEN_2048);
+
+        W.val = T->val + i * FS_2048;
+        FF_2048_fromOctet(t[i], &W, FFLEN_2048);
+    }
+
+    return HDLOG_verify_values(S, rho, t, k);
+}
+
+int HDLOG_verify_final(const HDLOG_verify_state *S)
+{
+    if (S->next != HDLOG_PROOF_ITERS)
+    {
+        return HDLOG_INVALID_VALUES;
+    }
+
+    return HDLOG_OK;
+}
+
+int HDLOG_verify(BIG_1024_58 *N, BIG_1024_58 *B0, BIG_1024_58 *B1, HDLOG_iter_values RHO, const octet *E, HDLOG_iter_values T)
+{
+    HDLOG_verify_state S;
+
+    int rc = HDLOG_verify_init(&S, N, B0, B1, E);
+    if (rc != HDLOG_OK)
+    {
+        return rc;
+    }
+
+    return HDLOG_verify_values(&S, RHO, T, HDLOG_PROOF_ITERS);
+}
+
 void HDLOG_iter_values_toOctet(octet *O, HDLOG_iter_values v)
 {
     int i;
@@ -0,0 +1,419 @@
+/*
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"); you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+*/
+
+/* Execution of independent loop iterations across threads */
+
+#define _POSIX_C_SOURCE 200809L
+#include <pthread.h>
+
+#ifdef MPC_THREADS
+#include <unistd.h>
+#endif
+
+#include <stddef.h>
+#include "amcl/parallel.h"
+
+static PARALLEL_executor parallel_executor = NULL;
+static void *parallel_pool = NULL;
+static int parallel_threads = 0;
+static int parallel_crt = 0;
+
+/* Nesting depth of the parallel loops on the current thread. Only the
+ * outermost loop is spread across threads, the nested ones run in order.
+ * C99 has no thread local storage, use the GNU C extension */
+static __thread int parallel_depth = 0;
+
+/* Iteration of a loop handed to the caller supplied executor */
+typedef struct
+{
+    PARALLEL_task task;
+    void *ctx;
+} PARALLEL_nested;
+
+static void PARALLEL_run_nested(void *arg, int i)
+{
+    PARALLEL_nested *w = (PARALLEL_nested *)arg;
+
+    parallel_depth++;
+    w->task(w->ctx, i);
+    parallel_depth--;
+}
+
+void PARALLEL_set_executor(PARALLEL_executor executor, void *pool)
+{
+    parallel_executor = executor;
+    parallel_pool = pool;
+}
+
+void PARALLEL_set_threads(int threads)
+{
+    parallel_threads = threads;
+}
+
+void PARALLEL_set_crt(int enable)
+{
+    parallel_crt = enable;
+}
+
+#ifdef MPC_THREADS
+
+typedef struct
+{
+    PARALLEL_task task;
+    void *ctx;
+    int start;
+    int end;
+} PARALLEL_block;
+
+static void *PARALLEL_run_block(void *arg)
+{
+    PARALLEL_block *b = (PARALLEL_block *)arg;
+
+    parallel_depth++;
+
+    for (int i = b->start; i < b->end; i++)
+    {
+        b->task(b->ctx, i);
+    }
+
+    parallel_depth--;
+
+    return NULL;
+}
+
+int PARALLEL_get_threads(void)
+{
+    long threads = parallel_threads;
+
+    if (threads < 1)
+    {
+        threads = sysconf(_SC_NPROCESSORS_ONLN);
+    }
+
+    if (threads < 1)
+    {
+        threads = 1;
+    }
+
+    if (threads > PARALLEL_MAX_THREADS)
+    {
+        threads = PARALLEL_MAX_THREADS;
+    }
+
+    return (int)threads;
+}
+
+#endif
+
+void PARALLEL_for(PARALLEL_task task, void *ctx, int n)
+{
+    if (parallel_depth == 0 && parallel_executor != NULL)
+    {
+        PARALLEL_nested w;
+
+        w.task = task;
+        w.ctx = ctx;
+
+        parallel_executor(parallel_pool, PARALLEL_run_nested, &w, n);
+        return;
+    }
+
+#ifdef MPC_THREADS
+    int threads = (parallel_depth == 0) ? PARALLEL_get_threads() : 1;
+
+    if (threads > n)
+    {
+        threads = n;
+    }
+
+    if (threads > 1)
+    {
+        pthread_t tid[PARALLEL_MAX_THREADS];
+        PARALLEL_block blocks[PARALLEL_MAX_THREADS];
+        int started[PARALLEL_MAX_THREADS];
+
+        // Split the iterations in contiguous blocks, the first block
+        // runs on the calling thread
+        for (int t = 0; t < threads; t++)
+        {
+            blocks[t].task = task;
+            blocks[t].ctx = ctx;
+            blocks[t].start = (n * t) / threads;
+            blocks[t].end = (n * (t + 1)) / threads;
+        }
+
+        for (int t = 1; t < threads; t++)
+        {
+            started[t] = (pthread_create(&tid[t], NULL, PARALLEL_run_block, &blocks[t]) == 0);
+
+            // Run the block on the calling thread if it can not be spawned
+            if (!started[t])
+            {
+                PARALLEL_run_block(&blocks[t]);
+            }
+        }
+
+        PARALLEL_run_block(&blocks[0]);
+
+        for (int t = 1; t < threads; t++)
+        {
+            if (started[t])
+            {
+                pthread_join(tid[t], NULL);
+            }
+        }
+
+        return;
+    }
+#endif
+
+    for (int i = 0; i < n; i++)
+    {
+        task(ctx, i);
+    }
+}
+
+void PARALLEL_crt(PARALLEL_task task, void *ctx)
+{
+    if (parallel_depth == 0 && parallel_crt && parallel_executor != NULL)
+    {
+        PARALLEL_nested w;
+
+        w.task = task;
+        w.ctx = ctx;
+
+        parallel_executor(parallel_pool, PARALLEL_run_nested, &w, 2);
+        return;
+    }
+
+#ifdef MPC_THREADS
+    if (parallel_depth == 0 && parallel_crt)
+    {
+        pthread_t tid;
+        PARALLEL_block block0;
+        PARALLEL_block block;
+
+        block0.task = task;
+        block0.ctx = ctx;
+        block0.start = 0;
+        block0.end = 1;
+
+        block.task = task;
+        block.ctx = ctx;
+        block.start = 1;
+        block.end = 2;
+
+        // The first half runs on the calling thread
+        if (pthread_create(&tid, NULL, PARALLEL_run_block, &block) == 0)
+        {
+            PARALLEL_run_block(&block0);
+            pthread_join(tid, NULL);
+            return;
+        }
+    }
+#endif
+
+    task(ctx, 0);
+    task(ctx, 1);
+}
+
+#ifndef MPC_THREADS
+
+int PARALLEL_get_threads(void)
+{
+    return 1;
+}
+
+#endif
+
+#ifdef MPC_THREADS
+
+/* Shared state of the workers of PARALLEL_race */
+typedef struct
+{
+    pthread_mutex_t lock;
+    int winner;
+} PARALLEL_race_state;
+
+typedef struct
+{
+    PARALLEL_race_task task;
+    void *ctx;
+    int i;
+    PARALLEL_race_state *state;
+} PARALLEL_racer;
+
+static int PARALLEL_race_stop(void *token)
+{
+    PARALLEL_race_state *state = (PARALLEL_race_state *)token;
+    int winner;
+
+    pthread_mutex_lock(&state->lock);
+    winner = state->winner;
+    pthread_mutex_unlock(&state->lock);
+
+    return winner >= 0;
+}
+
+static void *PARALLEL_run_racer(void *arg)
+{
+    PARALLEL_racer *r = (PARALLEL_racer *)arg;
+
+    parallel_depth++;
+
+    if (r->task(r->ctx, r->i, PARALLEL_race_stop, r->state))
+    {
+        pthread_mutex_lock(&r->state->lock);
+        if (r->state->winner < 0)
+        {
+            r->state->winner = r->i;
+        }
+        pthread_mutex_unlock(&r->state->lock);
+    }
+
+    parallel_depth--;
+
+    return NULL;
+}
+
+#endif
+
+static int PARALLEL_never_stop(void *token)
+{
+    (void)token;
+    return 0;
+}
+
+int PARALLEL_race(PARALLEL_race_task task, void *ctx, int n)
+{
+#ifdef MPC_THREADS
+    if (n > 1 && parallel_depth == 0)
+    {
+        pthread_t tid[PARALLEL_MAX_THREADS];
+        PARALLEL_racer racers[PARALLEL_MAX_THREADS];
+        int started[PARALLEL_MAX_THREADS];
+        PARALLEL_race_state state;
+
+        if (n > PARALLEL_MAX_THREADS)
+        {
+            n = PARALLEL_MAX_THREADS;
+        }
+
+        pthread_mutex_init(&state.lock, NULL);
+        state.winner = -1;
+
+        for (int i = 0; i < n; i++)
+        {
+            racers[i].task = task;
+            racers[i].ctx = ctx;
+            racers[i].i = i;
+            racers[i].state = &state;
+        }
+
+        // The first worker runs on the calling thread
+        for (int i = 1; i < n; i++)
+        {
+            started[i] = (pthread_create(&tid[i], NULL, PARALLEL_run_racer, &racers[i]) == 0);
+        }
+
+        PARALLEL_run_racer(&racers[0]);
+
+        for (int i = 1; i < n; i++)
+        {
+            if (started[i])
+            {
+                pthread_join(tid[i], NULL);
+            }
+        }
+
+        pthread_mutex_destroy(&state.lock);
+
+        return state.winner;
+    }
+#endif
+
+    for (int i = 0; i < n; i++)
+    {
+        if (task(ctx, i, PARALLEL_never_stop, NULL))
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+/* Shared state of the checks of PARALLEL_verify. The checks can run
+ * concurrently on a caller supplied executor even without MPC_THREADS,
+ * so the index of the first failure is always behind a lock */
+typedef struct
+{
+    PARALLEL_check task;
+    void *ctx;
+    int *verdicts;
+    pthread_mutex_t lock;
+    int failed;
+} PARALLEL_verify_state;
+
+static void PARALLEL_run_check(void *arg, int i)
+{
+    PARALLEL_verify_state *state = (PARALLEL_verify_state *)arg;
+    int failed;
+
+    pthread_mutex_lock(&state->lock);
+    failed = state->failed;
+    pthread_mutex_unlock(&state->lock);
+
+    // Cancel the remaining checks after the first failure
+    if (failed >= 0)
+    {
+        state->verdicts[i] = PARALLEL_SKIPPED;
+        return;
+    }
+
+    state->verdicts[i] = state->task(state->ctx, i);
+
+    if (state->verdicts[i] != 0)
+    {
+        pthread_mutex_lock(&state->lock);
+        if (state->failed < 0)
+        {
+            state->failed = i;
+        }
+        pthread_mutex_unlock(&state->lock);
+    }
+}
+
+int PARALLEL_verify(PARALLEL_check task, void *ctx, int n, int *verdicts)
+{
+    PARALLEL_verify_state state;
+
+    state.task = task;
+    state.ctx = ctx;
+    state.verdicts = verdicts;
+    state.failed = -1;
+
+    pthread_mutex_init(&state.lock, NULL);
+
+    PARALLEL_for(PARALLEL_run_check, &state, n);
+
+    pthread_mutex_destroy(&state.lock);
+
+    return state.failed;
+}
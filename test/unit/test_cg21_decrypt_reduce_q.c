@@ -0,0 +1,152 @@
+/*
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"); you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+*/
+
+#include <string.h>
+#include "test.h"
+#include "amcl/cg21/cg21_utilities.h"
+
+/* CG21 batch Paillier decryption mod q unit test */
+
+#define LINE_LEN      8192
+#define OCT_ARRAY_LEN 8
+
+int main(int argc, char **argv)
+{
+    if (argc != 2)
+    {
+        printf("usage: ./test_cg21_decrypt_reduce_q [path to test vector file]\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int i;
+    int test_run = 0;
+
+    FILE *fp;
+    char line[LINE_LEN] = {0};
+
+    const char *TESTline = "TEST = ";
+    int testNo = 0;
+
+    char p[HFS_2048];
+    octet P = {0, sizeof(p), p};
+    const char *Pline = "P = ";
+
+    char q[HFS_2048];
+    octet Q = {0, sizeof(q), q};
+    const char *Qline = "Q = ";
+
+    const char *Nline = "N = ";
+    int n = 0;
+
+    const char *CTline = "CT = ";
+    char ct[OCT_ARRAY_LEN][FS_4096];
+    octet CT[OCT_ARRAY_LEN];
+    octet *CT_ptr[OCT_ARRAY_LEN];
+
+    const char *OUTline = "OUT = ";
+    char out_golden[OCT_ARRAY_LEN][EGS_SECP256K1];
+    octet OUT_GOLDEN[OCT_ARRAY_LEN];
+
+    char out[OCT_ARRAY_LEN][EGS_SECP256K1];
+    octet OUT[OCT_ARRAY_LEN];
+    octet *OUT_ptr[OCT_ARRAY_LEN];
+
+    PAILLIER_private_key priv;
+    PAILLIER_public_key pub;
+
+    for (i = 0; i < OCT_ARRAY_LEN; i++)
+    {
+        CT[i].val = ct[i];
+        CT[i].len = 0;
+        CT[i].max = sizeof(ct[i]);
+        CT_ptr[i] = CT + i;
+
+        OUT_GOLDEN[i].val = out_golden[i];
+        OUT_GOLDEN[i].len = 0;
+        OUT_GOLDEN[i].max = sizeof(out_golden[i]);
+
+        OUT[i].val = out[i];
+        OUT[i].len = 0;
+        OUT[i].max = sizeof(out[i]);
+        OUT_ptr[i] = OUT + i;
+    }
+
+    // Line terminating a test vector
+    const char *last_line = OUTline;
+
+    /* Test happy path using test vectors */
+    fp = fopen(argv[1], "r");
+    if (fp == NULL)
+    {
+        printf("ERROR opening test vector file\n");
+        exit(EXIT_FAILURE);
+    }
+
+    while (fgets(line, LINE_LEN, fp) != NULL)
+    {
+        scan_int(&testNo, line, TESTline);
+
+        // Read inputs
+        scan_OCTET(fp, &P, line, Pline);
+        scan_OCTET(fp, &Q, line, Qline);
+        scan_int(&n, line, Nline);
+        scan_OCTET_ARRAY(fp, CT, line, CTline, n);
+
+        // Read ground truth
+        scan_OCTET_ARRAY(fp, OUT_GOLDEN, line, OUTline, n);
+
+        if (!strncmp(line, last_line, strlen(last_line)))
+        {
+            PAILLIER_KEY_PAIR(NULL, &P, &Q, &pub, &priv);
+
+            CG21_PAILLIER_DECRYPT_REDUCE_Q(&priv, CT_ptr, OUT_ptr, n);
+
+            for (i = 0; i < n; i++)
+            {
+                assert_tv(fp, testNo, "CG21_PAILLIER_DECRYPT_REDUCE_Q", OCT_comp(OUT + i, OUT_GOLDEN + i));
+            }
+
+            // The batch is the same as decrypting each ciphertext on its own
+            for (i = 0; i < n; i++)
+            {
+                OCT_clear(OUT + i);
+
+                CG21_PAILLIER_DECRYPT_REDUCE_Q(&priv, CT_ptr + i, OUT_ptr + i, 1);
+                assert_tv(fp, testNo, "CG21_PAILLIER_DECRYPT_REDUCE_Q single ciphertext",
+                          OCT_comp(OUT + i, OUT_GOLDEN + i));
+            }
+
+            PAILLIER_PRIVATE_KEY_KILL(&priv);
+
+            // Mark that at least one test vector was executed
+            test_run = 1;
+        }
+    }
+
+    fclose(fp);
+
+    if (test_run == 0)
+    {
+        printf("ERROR no test vector was executed\n");
+        exit(EXIT_FAILURE);
+    }
+
+    printf("SUCCESS\n");
+    exit(EXIT_SUCCESS);
+}
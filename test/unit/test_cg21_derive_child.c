@@ -0,0 +1,145 @@
+/*
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"); you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+*/
+
+#include <string.h>
+#include "test.h"
+#include "amcl/cg21/cg21_derive.h"
+
+/* CG21 child key derivation unit test, BIP32 CKDpub vectors */
+
+#define LINE_LEN 256
+
+int main(int argc, char **argv)
+{
+    if (argc != 2)
+    {
+        printf("usage: ./test_cg21_derive_child [path to test vector file]\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int rc;
+    int test_run = 0;
+
+    FILE *fp;
+    char line[LINE_LEN] = {0};
+
+    const char *TESTline = "TEST = ";
+    int testNo = 0;
+
+    char x[EFS_SECP256K1 + 1];
+    octet X = {0, sizeof(x), x};
+    const char *Xline = "X = ";
+
+    char c[CG21_DERIVE_CHAIN_SIZE];
+    octet C = {0, sizeof(c), c};
+    const char *Cline = "C = ";
+
+    int index = 0;
+    const char *INDEXline = "INDEX = ";
+
+    char childx_golden[EFS_SECP256K1 + 1];
+    octet CHILDX_GOLDEN = {0, sizeof(childx_golden), childx_golden};
+    const char *CHILDXline = "CHILDX = ";
+
+    char childc_golden[CG21_DERIVE_CHAIN_SIZE];
+    octet CHILDC_GOLDEN = {0, sizeof(childc_golden), childc_golden};
+    const char *CHILDCline = "CHILDC = ";
+
+    char t_golden[EGS_SECP256K1];
+    octet T_GOLDEN = {0, sizeof(t_golden), t_golden};
+    const char *Tline = "T = ";
+
+    char childx[EFS_SECP256K1 + 1];
+    octet CHILDX = {0, sizeof(childx), childx};
+
+    char childc[CG21_DERIVE_CHAIN_SIZE];
+    octet CHILDC = {0, sizeof(childc), childc};
+
+    char t[EGS_SECP256K1];
+    octet T = {0, sizeof(t), t};
+
+    // Line terminating a test vector
+    const char *last_line = Tline;
+
+    /* Test happy path using test vectors */
+    fp = fopen(argv[1], "r");
+    if (fp == NULL)
+    {
+        printf("ERROR opening test vector file\n");
+        exit(EXIT_FAILURE);
+    }
+
+    while (fgets(line, LINE_LEN, fp) != NULL)
+    {
+        scan_int(&testNo, line, TESTline);
+
+        // Read inputs
+        scan_OCTET(fp, &X, line, Xline);
+        scan_OCTET(fp, &C, line, Cline);
+        scan_int(&index, line, INDEXline);
+
+        // Read ground truth
+        scan_OCTET(fp, &CHILDX_GOLDEN, line, CHILDXline);
+        scan_OCTET(fp, &CHILDC_GOLDEN, line, CHILDCline);
+        scan_OCTET(fp, &T_GOLDEN, line, Tline);
+
+        if (!strncmp(line, last_line, strlen(last_line)))
+        {
+            rc = CG21_DERIVE_CHILD(&X, &C, (unsigned int)index, &CHILDX, &CHILDC, &T);
+            assert_tv(fp, testNo, "CG21_DERIVE_CHILD", rc == CG21_DERIVE_OK);
+
+            compare_OCT(fp, testNo, "CG21_DERIVE_CHILD childX", &CHILDX, &CHILDX_GOLDEN);
+            compare_OCT(fp, testNo, "CG21_DERIVE_CHILD childC", &CHILDC, &CHILDC_GOLDEN);
+            compare_OCT(fp, testNo, "CG21_DERIVE_CHILD T", &T, &T_GOLDEN);
+
+            // Mark that at least one test vector was executed
+            test_run = 1;
+        }
+    }
+
+    fclose(fp);
+
+    if (test_run == 0)
+    {
+        printf("ERROR no test vector was executed\n");
+        exit(EXIT_FAILURE);
+    }
+
+    /* Test unhappy path */
+
+    rc = CG21_DERIVE_CHILD(&X, &C, CG21_DERIVE_HARDENED, &CHILDX, &CHILDC, &T);
+    assert(NULL, "CG21_DERIVE_CHILD accepted a hardened index", rc == CG21_DERIVE_INVALID_INDEX);
+
+    C.len--;
+    rc = CG21_DERIVE_CHILD(&X, &C, (unsigned int)index, &CHILDX, &CHILDC, &T);
+    assert(NULL, "CG21_DERIVE_CHILD accepted a short chain code", rc == CG21_DERIVE_INVALID_CHAIN);
+    C.len++;
+
+    X.len--;
+    rc = CG21_DERIVE_CHILD(&X, &C, (unsigned int)index, &CHILDX, &CHILDC, &T);
+    assert(NULL, "CG21_DERIVE_CHILD accepted a short public key", rc == CG21_DERIVE_INVALID_PK);
+    X.len++;
+
+    X.val[0] = 0x04;
+    rc = CG21_DERIVE_CHILD(&X, &C, (unsigned int)index, &CHILDX, &CHILDC, &T);
+    assert(NULL, "CG21_DERIVE_CHILD accepted an invalid public key", rc == CG21_DERIVE_INVALID_PK);
+
+    printf("SUCCESS\n");
+    exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,201 @@
+/*
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"); you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+*/
+
+#include <string.h>
+#include "test.h"
+#include "amcl/randapi.h"
+#include "amcl/cg21/cg21_utilities.h"
+
+/* CG21 Paillier encryption with a nonce pool unit test */
+
+#define LINE_LEN      4096
+#define OCT_ARRAY_LEN 8
+
+int main(int argc, char **argv)
+{
+    if (argc != 2)
+    {
+        printf("usage: ./test_cg21_encrypt_pool [path to test vector file]\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int i;
+    int rc;
+    int test_run = 0;
+
+    FILE *fp;
+    char line[LINE_LEN] = {0};
+
+    const char *TESTline = "TEST = ";
+    int testNo = 0;
+
+    char seed[32];
+    octet SEED = {0, sizeof(seed), seed};
+    const char *SEEDline = "SEED = ";
+
+    char p[HFS_2048];
+    octet P = {0, sizeof(p), p};
+    const char *Pline = "P = ";
+
+    char q[HFS_2048];
+    octet Q = {0, sizeof(q), q};
+    const char *Qline = "Q = ";
+
+    const char *Nline = "N = ";
+    int n = 0;
+
+    const char *PTline = "PT = ";
+    char pt[OCT_ARRAY_LEN][HFS_4096];
+    octet PT[OCT_ARRAY_LEN];
+
+    char ct[OCT_ARRAY_LEN][FS_4096];
+    octet CT[OCT_ARRAY_LEN];
+
+    char ct_golden[FS_4096];
+    octet CT_GOLDEN = {0, sizeof(ct_golden), ct_golden};
+
+    char m[HFS_4096];
+    octet M = {0, sizeof(m), m};
+
+    char r[FS_4096];
+    octet R = {0, sizeof(r), r};
+
+    BIG_512_60 mem[OCT_ARRAY_LEN * FFLEN_4096];
+    BIG_512_60 rr[FFLEN_4096];
+
+    csprng RNG;
+    PAILLIER_private_key priv;
+    PAILLIER_public_key pub;
+    CG21_PAILLIER_NONCE_POOL pool;
+
+    for (i = 0; i < OCT_ARRAY_LEN; i++)
+    {
+        PT[i].val = pt[i];
+        PT[i].len = 0;
+        PT[i].max = sizeof(pt[i]);
+
+        CT[i].val = ct[i];
+        CT[i].len = 0;
+        CT[i].max = sizeof(ct[i]);
+    }
+
+    // Line terminating a test vector
+    const char *last_line = PTline;
+
+    /* Test happy path using test vectors */
+    fp = fopen(argv[1], "r");
+    if (fp == NULL)
+    {
+        printf("ERROR opening test vector file\n");
+        exit(EXIT_FAILURE);
+    }
+
+    while (fgets(line, LINE_LEN, fp) != NULL)
+    {
+        scan_int(&testNo, line, TESTline);
+
+        // Read inputs
+        scan_OCTET(fp, &SEED, line, SEEDline);
+        scan_OCTET(fp, &P, line, Pline);
+        scan_OCTET(fp, &Q, line, Qline);
+        scan_int(&n, line, Nline);
+        scan_OCTET_ARRAY(fp, PT, line, PTline, n);
+
+        if (!strncmp(line, last_line, strlen(last_line)))
+        {
+            PAILLIER_KEY_PAIR(NULL, &P, &Q, &pub, &priv);
+
+            CREATE_CSPRNG(&RNG, &SEED);
+            CG21_PAILLIER_NONCE_POOL_FILL(&RNG, &pool, &pub, mem, n);
+            KILL_CSPRNG(&RNG);
+
+            for (i = 0; i < n; i++)
+            {
+                rc = CG21_PAILLIER_ENCRYPT_POOL(&pool, PT + i, CT + i);
+                assert_tv(fp, testNo, "CG21_PAILLIER_ENCRYPT_POOL", rc == CG21_OK);
+
+                PAILLIER_DECRYPT(&priv, CT + i, &M);
+                assert_tv(fp, testNo, "CG21_PAILLIER_ENCRYPT_POOL decryption", OCT_comp(&M, PT + i));
+
+                // A nonce is wiped once used
+                assert_tv(fp, testNo, "CG21_PAILLIER_ENCRYPT_POOL used nonce",
+                          FF_4096_iszilch(mem + i * FFLEN_4096, FFLEN_4096));
+            }
+
+            rc = CG21_PAILLIER_ENCRYPT_POOL(&pool, PT, &CT_GOLDEN);
+            assert_tv(fp, testNo, "CG21_PAILLIER_ENCRYPT_POOL empty pool", rc == CG21_NONCE_POOL_EMPTY);
+
+            // The nonces are the r sampled in order from the same seed
+            CREATE_CSPRNG(&RNG, &SEED);
+            for (i = 0; i < n; i++)
+            {
+                FF_4096_zero(rr, FFLEN_4096);
+                FF_4096_randomnum(rr, pub.n, &RNG, HFLEN_4096);
+                FF_4096_toOctet(&R, rr, FFLEN_4096);
+
+                PAILLIER_ENCRYPT(NULL, &pub, PT + i, &CT_GOLDEN, &R);
+                assert_tv(fp, testNo, "CG21_PAILLIER_ENCRYPT_POOL against PAILLIER_ENCRYPT",
+                          OCT_comp(CT + i, &CT_GOLDEN));
+            }
+            KILL_CSPRNG(&RNG);
+
+            // Fresh nonces give different ciphertexts for the same plaintext
+            for (i = 1; i < n; i++)
+            {
+                assert_tv(fp, testNo, "CG21_PAILLIER_ENCRYPT_POOL reused nonce", !OCT_comp(CT, CT + i));
+            }
+
+            // Killing a pool wipes the nonces left
+            CREATE_CSPRNG(&RNG, &SEED);
+            CG21_PAILLIER_NONCE_POOL_FILL(&RNG, &pool, &pub, mem, n);
+            KILL_CSPRNG(&RNG);
+
+            rc = CG21_PAILLIER_ENCRYPT_POOL(&pool, PT, &CT_GOLDEN);
+            assert_tv(fp, testNo, "CG21_PAILLIER_ENCRYPT_POOL refilled pool",
+                      rc == CG21_OK && OCT_comp(CT, &CT_GOLDEN));
+
+            CG21_PAILLIER_NONCE_POOL_KILL(&pool);
+
+            for (i = 0; i < n; i++)
+            {
+                assert_tv(fp, testNo, "CG21_PAILLIER_NONCE_POOL_KILL",
+                          FF_4096_iszilch(mem + i * FFLEN_4096, FFLEN_4096));
+            }
+
+            rc = CG21_PAILLIER_ENCRYPT_POOL(&pool, PT, &CT_GOLDEN);
+            assert_tv(fp, testNo, "CG21_PAILLIER_ENCRYPT_POOL killed pool", rc == CG21_NONCE_POOL_EMPTY);
+
+            PAILLIER_PRIVATE_KEY_KILL(&priv);
+
+            // Mark that at least one test vector was executed
+            test_run = 1;
+        }
+    }
+
+    fclose(fp);
+
+    if (test_run == 0)
+    {
+        printf("ERROR no test vector was executed\n");
+        exit(EXIT_FAILURE);
+    }
+
+    printf("SUCCESS\n");
+    exit(EXIT_SUCCESS);
+}
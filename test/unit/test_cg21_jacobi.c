@@ -0,0 +1,158 @@
+/*
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"); you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+*/
+
+#include <string.h>
+#include "test.h"
+#include "amcl/cg21/cg21_utilities.h"
+
+/* CG21 binary Jacobi symbol unit test */
+
+#define LINE_LEN 2048
+
+/* Number of consecutive values checked against the Euler criterion */
+#define EULER_VALUES 16
+
+int main(int argc, char **argv)
+{
+    if (argc != 2)
+    {
+        printf("usage: ./test_cg21_jacobi [path to test vector file]\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int rc;
+    int test_run = 0;
+    int euler_run = 0;
+
+    FILE *fp;
+    char line[LINE_LEN] = {0};
+
+    const char *TESTline = "TEST = ";
+    int testNo = 0;
+
+    BIG_512_60 A[HFLEN_4096];
+    const char *Aline = "A = ";
+
+    BIG_512_60 P[HFLEN_4096];
+    const char *Pline = "P = ";
+
+    int j_golden = 0;
+    const char *Jline = "J = ";
+
+    BIG_1024_58 A2[HFLEN_2048];
+    const char *A2line = "A2 = ";
+
+    BIG_1024_58 P2[HFLEN_2048];
+    const char *P2line = "P2 = ";
+
+    int prime = 0;
+    const char *PRIMEline = "PRIME = ";
+
+    int j2_golden = 0;
+    const char *J2line = "J2 = ";
+
+    BIG_1024_58 a[FFLEN_2048];
+
+    // Line terminating a test vector
+    const char *last_line = J2line;
+
+    /* Test happy path using test vectors */
+    fp = fopen(argv[1], "r");
+    if (fp == NULL)
+    {
+        printf("ERROR opening test vector file\n");
+        exit(EXIT_FAILURE);
+    }
+
+    while (fgets(line, LINE_LEN, fp) != NULL)
+    {
+        scan_int(&testNo, line, TESTline);
+
+        // Read inputs
+        scan_FF_4096(fp, A, line, Aline, HFLEN_4096);
+        scan_FF_4096(fp, P, line, Pline, HFLEN_4096);
+        scan_FF_2048(fp, A2, line, A2line, HFLEN_2048);
+        scan_FF_2048(fp, P2, line, P2line, HFLEN_2048);
+        scan_int(&prime, line, PRIMEline);
+
+        // Read ground truth
+        scan_int(&j_golden, line, Jline);
+        scan_int(&j2_golden, line, J2line);
+
+        if (!strncmp(line, last_line, strlen(last_line)))
+        {
+            rc = CG21_FF_4096_jacobi(A, P);
+            assert_tv(fp, testNo, "CG21_FF_4096_jacobi", rc == j_golden);
+
+            rc = FF_4096_jacobi(A, P);
+            assert_tv(fp, testNo, "FF_4096_jacobi", rc == j_golden);
+
+            rc = CG21_FF_2048_jacobi(A2, P2);
+            assert_tv(fp, testNo, "CG21_FF_2048_jacobi", rc == j2_golden);
+
+            // Mod a prime = 3 mod 4 the symbol is 1 iff the Euler criterion finds a square root
+            for (int k = 0; prime && k < EULER_VALUES; k++)
+            {
+                rc = CG21_FF_2048_jacobi(A2, P2);
+                if (rc != 0)
+                {
+                    FF_2048_zero(a, FFLEN_2048);
+                    FF_2048_copy(a, A2, HFLEN_2048);
+
+                    assert_tv(fp, testNo, "CG21_FF_2048_jacobi against CG21_check_sqrt_exist",
+                              (rc == 1) == CG21_check_sqrt_exist(a, P2));
+
+                    euler_run = 1;
+                }
+
+                FF_2048_inc(A2, 1, HFLEN_2048);
+                FF_2048_norm(A2, HFLEN_2048);
+            }
+
+            // Mark that at least one test vector was executed
+            test_run = 1;
+        }
+    }
+
+    fclose(fp);
+
+    if (test_run == 0 || euler_run == 0)
+    {
+        printf("ERROR no test vector was executed\n");
+        exit(EXIT_FAILURE);
+    }
+
+    /* Test unhappy path */
+
+    // The symbol is not defined for an even modulus
+    FF_2048_init(A2, 3, HFLEN_2048);
+    FF_2048_init(P2, 8, HFLEN_2048);
+
+    rc = CG21_FF_2048_jacobi(A2, P2);
+    assert(NULL, "CG21_FF_2048_jacobi accepted an even modulus", rc == 0);
+
+    FF_4096_init(A, 3, HFLEN_4096);
+    FF_4096_init(P, 8, HFLEN_4096);
+
+    rc = CG21_FF_4096_jacobi(A, P);
+    assert(NULL, "CG21_FF_4096_jacobi accepted an even modulus", rc == 0);
+
+    printf("SUCCESS\n");
+    exit(EXIT_SUCCESS);
+}
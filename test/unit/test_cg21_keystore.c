@@ -0,0 +1,240 @@
+/*
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"); you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include "test.h"
+#include "amcl/randapi.h"
+#include "amcl/cg21/cg21_keystore.h"
+
+/* CG21 encrypted keystore unit test */
+
+#define PEERS 2
+
+/* Offset of record i in the keystore file */
+#define OFFSET(i) (CG21_KEYSTORE_HEADER_SIZE + (long)(i) * (CG21_KEYSTORE_IV_SIZE + (long)sizeof(CG21_KEYSTORE_KEY) \
+                   + PEERS * (long)sizeof(CG21_KEYSTORE_PEER) + CG21_KEYSTORE_TAG_SIZE))
+
+/* Flip one bit of byte j of record i of the keystore file */
+static void tamper_record(const char *path, int i, int j)
+{
+    char c;
+    FILE *fp = fopen(path, "r+b");
+
+    assert(NULL, "ERROR opening the keystore", fp != NULL);
+    assert(NULL, "ERROR seeking in the keystore", fseek(fp, OFFSET(i) + j, SEEK_SET) == 0);
+    assert(NULL, "ERROR reading the keystore", fread(&c, 1, 1, fp) == 1);
+
+    c ^= 0x01;
+
+    assert(NULL, "ERROR seeking in the keystore", fseek(fp, OFFSET(i) + j, SEEK_SET) == 0);
+    assert(NULL, "ERROR writing the keystore", fwrite(&c, 1, 1, fp) == 1);
+
+    fclose(fp);
+}
+
+/* Check a key share is wiped */
+static void check_wiped(const CG21_KEYSTORE_KEY *key, char *msg)
+{
+    const char *b = (const char *)key;
+
+    for (size_t i = 0; i < sizeof(CG21_KEYSTORE_KEY); i++)
+    {
+        assert(NULL, msg, b[i] == 0);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 2)
+    {
+        printf("usage: ./test_cg21_keystore [path to a scratch keystore file]\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int rc;
+    int index;
+    const char *path = argv[1];
+
+    char seed[16] = {0};
+    octet SEED = {sizeof(seed), sizeof(seed), seed};
+
+    char p[HFS_2048];
+    octet P = {0, sizeof(p), p};
+
+    char q[HFS_2048];
+    octet Q = {0, sizeof(q), q};
+
+    char k[CG21_KEYSTORE_KEY_SIZE];
+    octet K = {0, sizeof(k), k};
+
+    char wk[CG21_KEYSTORE_KEY_SIZE];
+    octet WK = {0, sizeof(wk), wk};
+
+    char pt[HFS_4096];
+    octet PT = {0, sizeof(pt), pt};
+
+    char ct[FS_4096];
+    octet CT = {0, sizeof(ct), ct};
+
+    char m[HFS_4096];
+    octet M = {0, sizeof(m), m};
+
+    csprng RNG;
+    CG21_KEYSTORE ks;
+    CG21_KEYSTORE_KEY key;
+    CG21_KEYSTORE_KEY loaded;
+    CG21_KEYSTORE_PEER peers[PEERS];
+    CG21_KEYSTORE_PEER lpeers[PEERS];
+
+    OCT_fromHex(&SEED, "78d0fb6705ce77dee47d03eb5b9c5d30");
+    CREATE_CSPRNG(&RNG, &SEED);
+
+    OCT_fromHex(&P, "ffa0ec8cec4d2ffbef2a251111a361ad0199133f0aaa715df5ef052ad1efee2efda77a9349a74743e394ecef4da268c63171b8a896df79ec940f0c11d5de4a90d66628646f21f1ac0ac5f13adf45d2fd1d795c766dff1f656c91c3650ac2b59734efd3431332d691815da465b0d6f65b1620f4b1c7b9c18b38f63f478c06ca67");
+    OCT_fromHex(&Q, "e4d2fcd44d6bda22588e7f64e47fb32b1783cdc6ea43df8618cd27ae50e38a7d2ff1a252aec54625ab497f3cfe5860547ee0c66cb4ca0e29ccb1098fa3c04cee2565a20510596f5e0c8e4e2adde5aedcbb1803250f3465941880055798f1e36f5ba60e8878328132c070c6fad3c8ad2c155fd4cc88927f4410d498a5a5e40d8b");
+
+    OCT_fromHex(&K, "8f1e3c5a7b9d0e2f4a6c8e0b1d3f5a7c9e0b2d4f6a8c0e1f3b5d7a9c0e2f4b6d");
+    OCT_fromHex(&WK, "0f1e3c5a7b9d0e2f4a6c8e0b1d3f5a7c9e0b2d4f6a8c0e1f3b5d7a9c0e2f4b6d");
+
+    // Key share with parsed keys, every peer holds the public keys of the party
+    memset(&key, 0, sizeof(key));
+
+    key.j = 1;
+    key.t = 2;
+    OCT_rand(&M, &RNG, CG21_KEYSTORE_ID_SIZE);
+    memcpy(key.id, M.val, CG21_KEYSTORE_ID_SIZE);
+    OCT_rand(&M, &RNG, EGS_SECP256K1);
+    memcpy(key.share, M.val, EGS_SECP256K1);
+
+    PAILLIER_KEY_PAIR(NULL, &P, &Q, &key.paillier.paillier_pk, &key.paillier.paillier_sk);
+
+    ring_Pedersen_setup(&RNG, &key.pedersen.pedersenPriv, &P, &Q);
+    Pedersen_get_public_param(&key.pedersen.pedersenPub, &key.pedersen.pedersenPriv);
+
+    for (int i = 0; i < PEERS; i++)
+    {
+        memset(peers + i, 0, sizeof(CG21_KEYSTORE_PEER));
+
+        peers[i].j = i + 2;
+        peers[i].paillier = key.paillier.paillier_pk;
+        peers[i].pedersen = key.pedersen.pedersenPub;
+    }
+
+    remove(path);
+
+    /* Test append and load */
+    rc = CG21_KEYSTORE_OPEN(&ks, path, PEERS);
+    assert(NULL, "CG21_KEYSTORE_OPEN new file", rc == CG21_KEYSTORE_OK && ks.count == 0);
+
+    rc = CG21_KEYSTORE_APPEND(&RNG, &ks, &K, &key, peers, &index);
+    assert(NULL, "CG21_KEYSTORE_APPEND first record", rc == CG21_KEYSTORE_OK && index == 0);
+
+    // The second record holds another key
+    key.id[0] ^= 0x01;
+
+    rc = CG21_KEYSTORE_APPEND(&RNG, &ks, &K, &key, peers, &index);
+    assert(NULL, "CG21_KEYSTORE_APPEND second record", rc == CG21_KEYSTORE_OK && index == 1);
+
+    rc = CG21_KEYSTORE_CLOSE(&ks);
+    assert(NULL, "CG21_KEYSTORE_CLOSE", rc == CG21_KEYSTORE_OK);
+
+    // The records are found again once the keystore is reopened
+    rc = CG21_KEYSTORE_OPEN(&ks, path, PEERS);
+    assert(NULL, "CG21_KEYSTORE_OPEN existing file", rc == CG21_KEYSTORE_OK && ks.count == 2);
+
+    rc = CG21_KEYSTORE_LOAD(&ks, &K, 1, &loaded, lpeers);
+    assert(NULL, "CG21_KEYSTORE_LOAD", rc == CG21_KEYSTORE_OK);
+    assert(NULL, "CG21_KEYSTORE_LOAD key share", !memcmp(&loaded, &key, sizeof(key)));
+    assert(NULL, "CG21_KEYSTORE_LOAD peers", !memcmp(lpeers, peers, sizeof(peers)));
+
+    // The loaded Paillier keys are usable as they are
+    OCT_rand(&PT, &RNG, HFS_4096 - 1);
+
+    PAILLIER_ENCRYPT(&RNG, &lpeers[0].paillier, &PT, &CT, NULL);
+    PAILLIER_DECRYPT(&loaded.paillier.paillier_sk, &CT, &M);
+    OCT_shl(&M, M.len - PT.len);
+    assert(NULL, "CG21_KEYSTORE_LOAD Paillier keys", OCT_comp(&M, &PT));
+
+    rc = CG21_KEYSTORE_LOAD(&ks, &K, 0, &loaded, lpeers);
+    assert(NULL, "CG21_KEYSTORE_LOAD first record", rc == CG21_KEYSTORE_OK && loaded.id[0] == (key.id[0] ^ 0x01));
+
+    rc = CG21_KEYSTORE_CLOSE(&ks);
+    assert(NULL, "CG21_KEYSTORE_CLOSE", rc == CG21_KEYSTORE_OK);
+
+    /* Test unhappy path */
+
+    // A tampered ciphertext fails authentication and the key share is wiped
+    tamper_record(path, 0, CG21_KEYSTORE_IV_SIZE + 1);
+
+    rc = CG21_KEYSTORE_OPEN(&ks, path, PEERS);
+    assert(NULL, "CG21_KEYSTORE_OPEN tampered file", rc == CG21_KEYSTORE_OK && ks.count == 2);
+
+    rc = CG21_KEYSTORE_LOAD(&ks, &K, 0, &loaded, lpeers);
+    assert(NULL, "CG21_KEYSTORE_LOAD tampered record", rc == CG21_KEYSTORE_INVALID_RECORD);
+    check_wiped(&loaded, "CG21_KEYSTORE_LOAD tampered record not wiped");
+
+    // The other records are still valid
+    rc = CG21_KEYSTORE_LOAD(&ks, &K, 1, &loaded, lpeers);
+    assert(NULL, "CG21_KEYSTORE_LOAD record after a tampered one",
+           rc == CG21_KEYSTORE_OK && !memcmp(&loaded, &key, sizeof(key)));
+
+    // A different key fails authentication
+    rc = CG21_KEYSTORE_LOAD(&ks, &WK, 1, &loaded, lpeers);
+    assert(NULL, "CG21_KEYSTORE_LOAD wrong key", rc == CG21_KEYSTORE_INVALID_RECORD);
+    check_wiped(&loaded, "CG21_KEYSTORE_LOAD wrong key not wiped");
+
+    // Invalid key length and index
+    K.len--;
+    rc = CG21_KEYSTORE_APPEND(&RNG, &ks, &K, &key, peers, NULL);
+    assert(NULL, "CG21_KEYSTORE_APPEND invalid key", rc == CG21_KEYSTORE_INVALID_KEY && ks.count == 2);
+
+    rc = CG21_KEYSTORE_LOAD(&ks, &K, 1, &loaded, lpeers);
+    assert(NULL, "CG21_KEYSTORE_LOAD invalid key", rc == CG21_KEYSTORE_INVALID_KEY);
+    K.len++;
+
+    rc = CG21_KEYSTORE_LOAD(&ks, &K, 2, &loaded, lpeers);
+    assert(NULL, "CG21_KEYSTORE_LOAD index past the end", rc == CG21_KEYSTORE_INVALID_INDEX);
+
+    rc = CG21_KEYSTORE_LOAD(&ks, &K, -1, &loaded, lpeers);
+    assert(NULL, "CG21_KEYSTORE_LOAD negative index", rc == CG21_KEYSTORE_INVALID_INDEX);
+
+    CG21_KEYSTORE_CLOSE(&ks);
+
+    // The number of peers must match the file
+    rc = CG21_KEYSTORE_OPEN(&ks, path, PEERS + 1);
+    assert(NULL, "CG21_KEYSTORE_OPEN other number of peers", rc == CG21_KEYSTORE_INVALID_FILE);
+
+    // A truncated record makes the file invalid
+    FILE *fp = fopen(path, "ab");
+    assert(NULL, "ERROR opening the keystore", fp != NULL);
+    fputc(0, fp);
+    fclose(fp);
+
+    rc = CG21_KEYSTORE_OPEN(&ks, path, PEERS);
+    assert(NULL, "CG21_KEYSTORE_OPEN truncated file", rc == CG21_KEYSTORE_INVALID_FILE);
+
+    remove(path);
+
+    CG21_KEYSTORE_KEY_KILL(&key);
+    CG21_KEYSTORE_KEY_KILL(&loaded);
+    KILL_CSPRNG(&RNG);
+
+    printf("SUCCESS\n");
+    exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,161 @@
+/*
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"); you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+*/
+
+#include <string.h>
+#include "test.h"
+#include "amcl/cg21/cg21.h"
+
+/* CG21 MtA homomorphic evaluation unit test */
+
+#define LINE_LEN 2048
+
+int main(int argc, char **argv)
+{
+    if (argc != 2)
+    {
+        printf("usage: ./test_cg21_mta_eval [path to test vector file]\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int test_run = 0;
+
+    FILE *fp;
+    char line[LINE_LEN] = {0};
+
+    const char *TESTline = "TEST = ";
+    int testNo = 0;
+
+    char p[HFS_2048];
+    octet P = {0, sizeof(p), p};
+    const char *Pline = "P = ";
+
+    char q[HFS_2048];
+    octet Q = {0, sizeof(q), q};
+    const char *Qline = "Q = ";
+
+    char k[FS_4096];
+    octet K = {0, sizeof(k), k};
+    const char *Kline = "K = ";
+
+    char x[HFS_4096];
+    octet X = {0, sizeof(x), x};
+    const char *Xline = "X = ";
+
+    char y[HFS_4096];
+    octet Y = {0, sizeof(y), y};
+    const char *Yline = "Y = ";
+
+    char s[FS_4096];
+    octet S = {0, sizeof(s), s};
+    const char *Sline = "S = ";
+
+    char d_golden[FS_4096];
+    octet D_GOLDEN = {0, sizeof(d_golden), d_golden};
+    const char *Dline = "D = ";
+
+    char d[FS_4096];
+    octet D = {0, sizeof(d), d};
+
+    char ct1[FS_4096];
+    octet CT1 = {0, sizeof(ct1), ct1};
+
+    char ct2[FS_4096];
+    octet CT2 = {0, sizeof(ct2), ct2};
+
+    BIG_512_60 kk[FFLEN_4096];
+    BIG_512_60 xx[HFLEN_4096];
+    BIG_512_60 yy[HFLEN_4096];
+    BIG_512_60 ss[FFLEN_4096];
+    BIG_512_60 dd[FFLEN_4096];
+
+    PAILLIER_private_key priv;
+    PAILLIER_public_key pub;
+
+    // Line terminating a test vector
+    const char *last_line = Dline;
+
+    /* Test happy path using test vectors */
+    fp = fopen(argv[1], "r");
+    if (fp == NULL)
+    {
+        printf("ERROR opening test vector file\n");
+        exit(EXIT_FAILURE);
+    }
+
+    while (fgets(line, LINE_LEN, fp) != NULL)
+    {
+        scan_int(&testNo, line, TESTline);
+
+        // Read inputs
+        scan_OCTET(fp, &P, line, Pline);
+        scan_OCTET(fp, &Q, line, Qline);
+        scan_OCTET(fp, &K, line, Kline);
+        scan_OCTET(fp, &X, line, Xline);
+        scan_OCTET(fp, &Y, line, Yline);
+        scan_OCTET(fp, &S, line, Sline);
+
+        // Read ground truth
+        scan_OCTET(fp, &D_GOLDEN, line, Dline);
+
+        if (!strncmp(line, last_line, strlen(last_line)))
+        {
+            PAILLIER_KEY_PAIR(NULL, &P, &Q, &pub, &priv);
+
+            // Operands as parsed by CG21_PRESIGN_ROUND2
+            OCT_pad(&K, FS_4096);
+            OCT_pad(&X, HFS_4096);
+            OCT_pad(&Y, HFS_4096);
+            OCT_pad(&S, FS_4096);
+
+            FF_4096_fromOctet(kk, &K, FFLEN_4096);
+            FF_4096_fromOctet(xx, &X, HFLEN_4096);
+            FF_4096_fromOctet(yy, &Y, HFLEN_4096);
+            FF_4096_fromOctet(ss, &S, FFLEN_4096);
+
+            CG21_MTA_EVAL(&pub, kk, xx, yy, ss, dd);
+            FF_4096_toOctet(&D, dd, FFLEN_4096);
+
+            assert_tv(fp, testNo, "CG21_MTA_EVAL", OCT_comp(&D, &D_GOLDEN));
+
+            // Same ciphertext with the generic Paillier operations
+            PAILLIER_MULT(&pub, &K, &X, &CT1);
+            PAILLIER_ENCRYPT(NULL, &pub, &Y, &CT2, &S);
+            PAILLIER_ADD(&pub, &CT1, &CT2, &D);
+
+            assert_tv(fp, testNo, "CG21_MTA_EVAL against PAILLIER_ENCRYPT, PAILLIER_MULT and PAILLIER_ADD",
+                      OCT_comp(&D, &D_GOLDEN));
+
+            PAILLIER_PRIVATE_KEY_KILL(&priv);
+
+            // Mark that at least one test vector was executed
+            test_run = 1;
+        }
+    }
+
+    fclose(fp);
+
+    if (test_run == 0)
+    {
+        printf("ERROR no test vector was executed\n");
+        exit(EXIT_FAILURE);
+    }
+
+    printf("SUCCESS\n");
+    exit(EXIT_SUCCESS);
+}
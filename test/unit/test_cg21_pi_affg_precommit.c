@@ -0,0 +1,309 @@
+/*
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"); you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+*/
+
+#include <string.h>
+#include "test.h"
+#include "amcl/randapi.h"
+#include "amcl/cg21/cg21_rp_pi_affg.h"
+
+/* CG21 PiAffg offline/online commitment unit test */
+
+#define LINE_LEN 2048
+
+/* Compare the octet form of two commitments */
+static int commits_equal(const Piaffg_COMMITS_OCT *a, const Piaffg_COMMITS_OCT *b)
+{
+    return OCT_comp(a->A, b->A) && OCT_comp(a->Bx, b->Bx) && OCT_comp(a->By, b->By) &&
+           OCT_comp(a->E, b->E) && OCT_comp(a->S, b->S) && OCT_comp(a->F, b->F) &&
+           OCT_comp(a->T, b->T);
+}
+
+/* Compute s^e1 t^e2 mod Nt, the exponents are up to FFLEN_2048 + HFLEN_2048 long */
+static void pedersen_commit(octet *W, PEDERSEN_PUB *pub, BIG_1024_58 *e1, int n1, BIG_1024_58 *e2)
+{
+    BIG_1024_58 e[FFLEN_2048 + HFLEN_2048];
+    BIG_1024_58 w[FFLEN_2048];
+
+    FF_2048_zero(e, FFLEN_2048 + HFLEN_2048);
+    FF_2048_copy(e, e1, n1);
+
+    FF_2048_ct_pow_2(w, pub->b0, e, pub->b1, e2, pub->N, FFLEN_2048, FFLEN_2048 + HFLEN_2048);
+    FF_2048_toOctet(W, w, FFLEN_2048);
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 2)
+    {
+        printf("usage: ./test_cg21_pi_affg_precommit [path to test vector file]\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int rc;
+    int test_run = 0;
+
+    FILE *fp;
+    char line[LINE_LEN] = {0};
+
+    const char *TESTline = "TEST = ";
+    int testNo = 0;
+
+    char seed[32];
+    octet SEED = {0, sizeof(seed), seed};
+    const char *SEEDline = "SEED = ";
+
+    char p0[HFS_2048];
+    octet P0 = {0, sizeof(p0), p0};
+    const char *P0line = "P0 = ";
+
+    char q0[HFS_2048];
+    octet Q0 = {0, sizeof(q0), q0};
+    const char *Q0line = "Q0 = ";
+
+    char p1[HFS_2048];
+    octet P1 = {0, sizeof(p1), p1};
+    const char *P1line = "P1 = ";
+
+    char q1[HFS_2048];
+    octet Q1 = {0, sizeof(q1), q1};
+    const char *Q1line = "Q1 = ";
+
+    char x[EGS_SECP256K1];
+    octet X = {0, sizeof(x), x};
+    const char *Xline = "X = ";
+
+    char y[HFS_4096];
+    octet Y = {0, sizeof(y), y};
+    const char *Yline = "Y = ";
+
+    char c[FS_4096];
+    octet C = {0, sizeof(c), c};
+    const char *Cline = "C = ";
+
+    // One-shot commitment
+    char a1[2 * FS_2048];
+    octet A1 = {0, sizeof(a1), a1};
+    char bx1[FS_2048];
+    octet BX1 = {0, sizeof(bx1), bx1};
+    char by1[2 * FS_2048];
+    octet BY1 = {0, sizeof(by1), by1};
+    char e1[FS_2048];
+    octet E1 = {0, sizeof(e1), e1};
+    char s1[FS_2048];
+    octet S1 = {0, sizeof(s1), s1};
+    char f1[FS_2048];
+    octet F1 = {0, sizeof(f1), f1};
+    char t1[FS_2048];
+    octet T1 = {0, sizeof(t1), t1};
+
+    // Offline/online commitment
+    char a2[2 * FS_2048];
+    octet A2 = {0, sizeof(a2), a2};
+    char bx2[FS_2048];
+    octet BX2 = {0, sizeof(bx2), bx2};
+    char by2[2 * FS_2048];
+    octet BY2 = {0, sizeof(by2), by2};
+    char e2[FS_2048];
+    octet E2 = {0, sizeof(e2), e2};
+    char s2[FS_2048];
+    octet S2 = {0, sizeof(s2), s2};
+    char f2[FS_2048];
+    octet F2 = {0, sizeof(f2), f2};
+    char t2[FS_2048];
+    octet T2 = {0, sizeof(t2), t2};
+
+    // Commitment recomputed from the secrets
+    char a3[2 * FS_2048];
+    octet A3 = {0, sizeof(a3), a3};
+    char bx3[FS_2048];
+    octet BX3 = {0, sizeof(bx3), bx3};
+    char by3[2 * FS_2048];
+    octet BY3 = {0, sizeof(by3), by3};
+    char e3[FS_2048];
+    octet E3 = {0, sizeof(e3), e3};
+    char s3[FS_2048];
+    octet S3 = {0, sizeof(s3), s3};
+    char f3[FS_2048];
+    octet F3 = {0, sizeof(f3), f3};
+    char t3[FS_2048];
+    octet T3 = {0, sizeof(t3), t3};
+
+    char pt[HFS_4096];
+    octet PT = {0, sizeof(pt), pt};
+
+    char r[FS_4096];
+    octet R = {0, sizeof(r), r};
+
+    char ct[FS_4096];
+    octet CT = {0, sizeof(ct), ct};
+
+    char ca[FS_4096];
+    octet CA = {0, sizeof(ca), ca};
+
+    Piaffg_COMMITS_OCT oneshot = {&A1, &BX1, &BY1, &E1, &S1, &F1, &T1};
+    Piaffg_COMMITS_OCT online = {&A2, &BX2, &BY2, &E2, &S2, &F2, &T2};
+    Piaffg_COMMITS_OCT expected = {&A3, &BX3, &BY3, &E3, &S3, &F3, &T3};
+
+    BIG_1024_58 xx[HFLEN_2048];
+    BIG_1024_58 yy[FFLEN_2048];
+
+    ECP_SECP256K1 G;
+
+    csprng RNG;
+    PAILLIER_private_key verifier_priv;
+    PAILLIER_public_key verifier_pub;
+    PAILLIER_private_key prover_priv;
+    PAILLIER_public_key prover_pub;
+    PEDERSEN_PRIV pedersen_priv;
+    PEDERSEN_PUB pedersen_pub;
+    Piaffg_PRECOMMITS pre;
+    Piaffg_SECRETS secrets1;
+    Piaffg_SECRETS secrets2;
+    Piaffg_COMMITS commits1;
+    Piaffg_COMMITS commits2;
+
+    // Line terminating a test vector
+    const char *last_line = Cline;
+
+    /* Test happy path using test vectors */
+    fp = fopen(argv[1], "r");
+    if (fp == NULL)
+    {
+        printf("ERROR opening test vector file\n");
+        exit(EXIT_FAILURE);
+    }
+
+    while (fgets(line, LINE_LEN, fp) != NULL)
+    {
+        scan_int(&testNo, line, TESTline);
+
+        // Read inputs
+        scan_OCTET(fp, &SEED, line, SEEDline);
+        scan_OCTET(fp, &P0, line, P0line);
+        scan_OCTET(fp, &Q0, line, Q0line);
+        scan_OCTET(fp, &P1, line, P1line);
+        scan_OCTET(fp, &Q1, line, Q1line);
+        scan_OCTET(fp, &X, line, Xline);
+        scan_OCTET(fp, &Y, line, Yline);
+        scan_OCTET(fp, &C, line, Cline);
+
+        if (!strncmp(line, last_line, strlen(last_line)))
+        {
+            PAILLIER_KEY_PAIR(NULL, &P0, &Q0, &verifier_pub, &verifier_priv);
+            PAILLIER_KEY_PAIR(NULL, &P1, &Q1, &prover_pub, &prover_priv);
+
+            // The verifier's ring Pedersen parameters, as in the example
+            CREATE_CSPRNG(&RNG, &SEED);
+            ring_Pedersen_setup(&RNG, &pedersen_priv, &P0, &Q0);
+            Pedersen_get_public_param(&pedersen_pub, &pedersen_priv);
+            KILL_CSPRNG(&RNG);
+
+            // Same seed for both runs, so the secrets are the same
+            CREATE_CSPRNG(&RNG, &SEED);
+            rc = Piaffg_Sample_and_Commit(&RNG, &prover_priv, &verifier_pub, &pedersen_pub,
+                                          &X, &Y, &secrets1, &commits1, &oneshot, &C);
+            assert_tv(fp, testNo, "Piaffg_Sample_and_Commit", rc == Piaffg_OK);
+            KILL_CSPRNG(&RNG);
+
+            CREATE_CSPRNG(&RNG, &SEED);
+            rc = Piaffg_Precommit(&RNG, &prover_priv, &verifier_pub, &pedersen_pub, &pre);
+            assert_tv(fp, testNo, "Piaffg_Precommit", rc == Piaffg_OK);
+            KILL_CSPRNG(&RNG);
+
+            rc = Piaffg_Commit_online(&verifier_pub, &pedersen_pub, &X, &Y, &C, &pre,
+                                      &secrets2, &commits2, &online);
+            assert_tv(fp, testNo, "Piaffg_Commit_online", rc == Piaffg_OK);
+
+            assert_tv(fp, testNo, "Piaffg_Commit_online against Piaffg_Sample_and_Commit",
+                      commits_equal(&oneshot, &online));
+
+            // A = C^alpha (1+N0)^beta r^N0 mod N0^2
+            FF_2048_toOctet(&PT, secrets1.alpha, HFLEN_2048);
+            OCT_pad(&PT, HFS_4096);
+            PAILLIER_MULT(&verifier_pub, &C, &PT, &CA);
+
+            FF_2048_toOctet(&PT, secrets1.beta, FFLEN_2048);
+            OCT_pad(&PT, HFS_4096);
+            FF_2048_toOctet(&R, secrets1.r, FFLEN_2048);
+            OCT_pad(&R, FS_4096);
+            PAILLIER_ENCRYPT(NULL, &verifier_pub, &PT, &CT, &R);
+            PAILLIER_ADD(&verifier_pub, &CA, &CT, &A3);
+
+            // By = (1+N1)^beta ry^N1 mod N1^2
+            FF_2048_toOctet(&R, secrets1.ry, FFLEN_2048);
+            OCT_pad(&R, FS_4096);
+            PAILLIER_ENCRYPT(NULL, &prover_pub, &PT, &BY3, &R);
+
+            // Bx = alpha G
+            ECP_SECP256K1_generator(&G);
+            ECP_mul_1024(&G, secrets1.alpha);
+            ECP_SECP256K1_toOctet(&BX3, &G, true);
+
+            // Ring Pedersen commitments
+            OCT_copy(&PT, &X);
+            OCT_pad(&PT, HFS_2048);
+            FF_2048_fromOctet(xx, &PT, HFLEN_2048);
+
+            OCT_copy(&PT, &Y);
+            OCT_pad(&PT, HFS_4096);
+            FF_2048_fromOctet(yy, &PT, FFLEN_2048);
+
+            pedersen_commit(&E3, &pedersen_pub, secrets1.alpha, HFLEN_2048, secrets1.gamma);
+            pedersen_commit(&F3, &pedersen_pub, secrets1.beta, FFLEN_2048, secrets1.delta);
+            pedersen_commit(&S3, &pedersen_pub, xx, HFLEN_2048, secrets1.m);
+            pedersen_commit(&T3, &pedersen_pub, yy, FFLEN_2048, secrets1.mu);
+
+            assert_tv(fp, testNo, "Piaffg_Sample_and_Commit against the commitment formulas",
+                      commits_equal(&oneshot, &expected));
+
+            // The precommitments are consumed by the online step
+            rc = Piaffg_Commit_online(&verifier_pub, &pedersen_pub, &X, &Y, &C, &pre,
+                                      &secrets2, &commits2, &online);
+            assert_tv(fp, testNo, "Piaffg_Commit_online reused precommitments", rc == Piaffg_INVALID_PRECOMMIT);
+
+            // Precommitments for one verifier can not be used for another
+            CREATE_CSPRNG(&RNG, &SEED);
+            rc = Piaffg_Precommit(&RNG, &prover_priv, &verifier_pub, &pedersen_pub, &pre);
+            assert_tv(fp, testNo, "Piaffg_Precommit", rc == Piaffg_OK);
+            KILL_CSPRNG(&RNG);
+
+            rc = Piaffg_Commit_online(&prover_pub, &pedersen_pub, &X, &Y, &C, &pre,
+                                      &secrets2, &commits2, &online);
+            assert_tv(fp, testNo, "Piaffg_Commit_online other keys", rc == Piaffg_INVALID_PRECOMMIT);
+
+            Piaffg_Kill_precommits(&pre);
+            Piaffg_Kill_secrets(&secrets1);
+            Piaffg_Kill_secrets(&secrets2);
+
+            // Mark that at least one test vector was executed
+            test_run = 1;
+        }
+    }
+
+    fclose(fp);
+
+    if (test_run == 0)
+    {
+        printf("ERROR no test vector was executed\n");
+        exit(EXIT_FAILURE);
+    }
+
+    printf("SUCCESS\n");
+    exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,194 @@
+/*
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"); you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+*/
+
+#include <string.h>
+#include "test.h"
+#include "amcl/randapi.h"
+#include "amcl/cg21/cg21_pi_mod.h"
+
+/* CG21 PiMod batch verification unit test */
+
+#define LINE_LEN 2048
+
+/* Iteration of the proof whose zi is tampered with */
+#define TAMPERED 77
+
+int main(int argc, char **argv)
+{
+    if (argc != 2)
+    {
+        printf("usage: ./test_cg21_pi_mod_batch [path to test vector file]\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int rc;
+    int test_run = 0;
+
+    FILE *fp;
+    char line[LINE_LEN] = {0};
+
+    const char *TESTline = "TEST = ";
+    int testNo = 0;
+
+    char seed[16];
+    octet SEED = {0, sizeof(seed), seed};
+    const char *SEEDline = "SEED = ";
+
+    char p[HFS_2048];
+    octet P = {0, sizeof(p), p};
+    const char *Pline = "P = ";
+
+    char q[HFS_2048];
+    octet Q = {0, sizeof(q), q};
+    const char *Qline = "Q = ";
+
+    char rid[EGS_SECP256K1];
+    octet RID = {0, sizeof(rid), rid};
+    const char *RIDline = "RID = ";
+
+    char rho[EGS_SECP256K1];
+    octet RHO = {0, sizeof(rho), rho};
+    const char *RHOline = "RHO = ";
+
+    char x_packed[8 * (EFS_SECP256K1 + 1)];
+    octet X_PACKED = {0, sizeof(x_packed), x_packed};
+    const char *XPACKEDline = "XPACKED = ";
+
+    char j_packed[8 * 4];
+    octet J_PACKED = {0, sizeof(j_packed), j_packed};
+    const char *JPACKEDline = "JPACKED = ";
+
+    int n = 0;
+    const char *Nline = "N = ";
+
+    char w[HFS_4096];
+    octet W = {0, sizeof(w), w};
+
+    char x[CG21_PAILLIER_PROOF_SIZE];
+    octet X = {0, sizeof(x), x};
+
+    char z[CG21_PAILLIER_PROOF_SIZE];
+    octet Z = {0, sizeof(z), z};
+
+    char ab[CG21_PAILLIER_PROOF_AB_SIZE];
+    octet AB = {0, sizeof(ab), ab};
+
+    csprng RNG;
+    CG21_PAILLIER_KEYS keys;
+    CG21_SSID ssid;
+    CG21_PIMOD_PROOF_OCT proof;
+
+    ssid.rid = &RID;
+    ssid.rho = &RHO;
+    ssid.X_set_packed = &X_PACKED;
+    ssid.j_set_packed = &J_PACKED;
+
+    proof.w = &W;
+    proof.x = &X;
+    proof.z = &Z;
+    proof.ab = &AB;
+
+    // Line terminating a test vector
+    const char *last_line = Nline;
+
+    /* Test happy path using test vectors */
+    fp = fopen(argv[1], "r");
+    if (fp == NULL)
+    {
+        printf("ERROR opening test vector file\n");
+        exit(EXIT_FAILURE);
+    }
+
+    while (fgets(line, LINE_LEN, fp) != NULL)
+    {
+        scan_int(&testNo, line, TESTline);
+
+        // Read inputs
+        scan_OCTET(fp, &SEED, line, SEEDline);
+        scan_OCTET(fp, &P, line, Pline);
+        scan_OCTET(fp, &Q, line, Qline);
+        scan_OCTET(fp, &RID, line, RIDline);
+        scan_OCTET(fp, &RHO, line, RHOline);
+        scan_OCTET(fp, &X_PACKED, line, XPACKEDline);
+        scan_OCTET(fp, &J_PACKED, line, JPACKEDline);
+        scan_int(&n, line, Nline);
+
+        if (!strncmp(line, last_line, strlen(last_line)))
+        {
+            CREATE_CSPRNG(&RNG, &SEED);
+
+            PAILLIER_KEY_PAIR(NULL, &P, &Q, &keys.paillier_pk, &keys.paillier_sk);
+
+            rc = CG21_PI_MOD_PROVE(&RNG, keys, &ssid, &proof, n);
+            assert_tv(fp, testNo, "CG21_PI_MOD_PROVE", rc == CG21_OK);
+
+            rc = CG21_PI_MOD_VERIFY(&proof, &ssid, keys.paillier_pk, n);
+            assert_tv(fp, testNo, "CG21_PI_MOD_VERIFY", rc == CG21_OK);
+
+            rc = CG21_PI_MOD_VERIFY_BATCH(&RNG, &proof, &ssid, keys.paillier_pk, n);
+            assert_tv(fp, testNo, "CG21_PI_MOD_VERIFY_BATCH", rc == CG21_OK);
+
+            // A tampered zi must fail the batch check and the fallback
+            Z.val[TAMPERED * FS_2048 + FS_2048 - 1] ^= 0x01;
+
+            rc = CG21_PI_MOD_VERIFY_BATCH(&RNG, &proof, &ssid, keys.paillier_pk, n);
+            assert_tv(fp, testNo, "CG21_PI_MOD_VERIFY_BATCH tampered zi", rc != CG21_OK);
+
+            rc = CG21_PI_MOD_VERIFY(&proof, &ssid, keys.paillier_pk, n);
+            assert_tv(fp, testNo, "CG21_PI_MOD_VERIFY tampered zi", rc != CG21_OK);
+
+            Z.val[TAMPERED * FS_2048 + FS_2048 - 1] ^= 0x01;
+
+            // The yi are derived from the SSID, so a different rid changes all of them
+            RID.val[0] ^= 0x01;
+
+            rc = CG21_PI_MOD_VERIFY_BATCH(&RNG, &proof, &ssid, keys.paillier_pk, n);
+            assert_tv(fp, testNo, "CG21_PI_MOD_VERIFY_BATCH tampered yi", rc != CG21_OK);
+
+            RID.val[0] ^= 0x01;
+
+            rc = CG21_PI_MOD_VERIFY_BATCH(&RNG, &proof, &ssid, keys.paillier_pk, n);
+            assert_tv(fp, testNo, "CG21_PI_MOD_VERIFY_BATCH restored proof", rc == CG21_OK);
+
+            // The (ai,bi) bitmap must fit in the output
+            AB.max = CG21_PAILLIER_PROOF_AB_SIZE - 1;
+
+            rc = CG21_PI_MOD_PROVE(&RNG, keys, &ssid, &proof, n);
+            assert_tv(fp, testNo, "CG21_PI_MOD_PROVE short ab", rc == CG21_UTILITIES_WRONG_PACKED_SIZE);
+
+            AB.max = sizeof(ab);
+
+            KILL_CSPRNG(&RNG);
+
+            // Mark that at least one test vector was executed
+            test_run = 1;
+        }
+    }
+
+    fclose(fp);
+
+    if (test_run == 0)
+    {
+        printf("ERROR no test vector was executed\n");
+        exit(EXIT_FAILURE);
+    }
+
+    printf("SUCCESS\n");
+    exit(EXIT_SUCCESS);
+}
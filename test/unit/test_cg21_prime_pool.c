@@ -0,0 +1,214 @@
+/*
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"); you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include "test.h"
+#include "amcl/randapi.h"
+#include "amcl/cg21/cg21_prime_pool.h"
+
+/* CG21 safe prime pool unit test */
+
+#define UNUSED 0
+#define USED 1
+
+/* Offset of record i in the pool file */
+#define OFFSET(i) (CG21_PRIME_POOL_HEADER_SIZE + (long)(i) * CG21_PRIME_POOL_RECORD_SIZE)
+
+/* Read record i of the pool file */
+static void read_record(const char *path, int i, char *record)
+{
+    FILE *fp = fopen(path, "rb");
+
+    assert(NULL, "ERROR opening the pool", fp != NULL);
+    assert(NULL, "ERROR seeking in the pool", fseek(fp, OFFSET(i), SEEK_SET) == 0);
+    assert(NULL, "ERROR reading the pool", fread(record, 1, CG21_PRIME_POOL_RECORD_SIZE, fp) == CG21_PRIME_POOL_RECORD_SIZE);
+
+    fclose(fp);
+}
+
+/* Flip one bit of byte j of record i of the pool file */
+static void tamper_record(const char *path, int i, int j)
+{
+    char c;
+    FILE *fp = fopen(path, "r+b");
+
+    assert(NULL, "ERROR opening the pool", fp != NULL);
+    assert(NULL, "ERROR seeking in the pool", fseek(fp, OFFSET(i) + j, SEEK_SET) == 0);
+    assert(NULL, "ERROR reading the pool", fread(&c, 1, 1, fp) == 1);
+
+    c ^= 0x01;
+
+    assert(NULL, "ERROR seeking in the pool", fseek(fp, OFFSET(i) + j, SEEK_SET) == 0);
+    assert(NULL, "ERROR writing the pool", fwrite(&c, 1, 1, fp) == 1);
+
+    fclose(fp);
+}
+
+/* Check the number of unused primes */
+static void check_available(const char *path, int expected, char *msg)
+{
+    int available;
+
+    int rc = CG21_PRIME_POOL_AVAILABLE(path, &available);
+    assert(NULL, msg, rc == CG21_PRIME_POOL_OK && available == expected);
+}
+
+/* Check P = 2p + 1 is a safe prime */
+static void check_safe_prime(csprng *RNG, octet *P, char *msg)
+{
+    BIG_1024_58 x[HFLEN_2048];
+
+    assert(NULL, msg, P->len == HFS_2048);
+
+    FF_2048_fromOctet(x, P, HFLEN_2048);
+    assert(NULL, msg, FF_2048_prime(x, RNG, HFLEN_2048));
+
+    FF_2048_shr(x, HFLEN_2048);
+    assert(NULL, msg, FF_2048_prime(x, RNG, HFLEN_2048));
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 2)
+    {
+        printf("usage: ./test_cg21_prime_pool [path to a scratch pool file]\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int rc;
+    const char *path = argv[1];
+
+    char seed[16] = {0};
+    octet SEED = {sizeof(seed), sizeof(seed), seed};
+
+    char k[CG21_PRIME_POOL_KEY_SIZE];
+    octet K = {0, sizeof(k), k};
+
+    char wk[CG21_PRIME_POOL_KEY_SIZE];
+    octet WK = {0, sizeof(wk), wk};
+
+    char p1[HFS_2048];
+    octet P1 = {0, sizeof(p1), p1};
+
+    char p2[HFS_2048];
+    octet P2 = {0, sizeof(p2), p2};
+
+    char small[HFS_2048 - 1];
+    octet SMALL = {0, sizeof(small), small};
+
+    char record[CG21_PRIME_POOL_RECORD_SIZE];
+
+    csprng RNG;
+
+    OCT_fromHex(&SEED, "2d5f0ab3c1e48976f00c3b5a9e12d847");
+    CREATE_CSPRNG(&RNG, &SEED);
+
+    OCT_fromHex(&K, "8f1e3c5a7b9d0e2f4a6c8e0b1d3f5a7c9e0b2d4f6a8c0e1f3b5d7a9c0e2f4b6d");
+    OCT_fromHex(&WK, "0f1e3c5a7b9d0e2f4a6c8e0b1d3f5a7c9e0b2d4f6a8c0e1f3b5d7a9c0e2f4b6d");
+
+    remove(path);
+
+    /* Test fill, take and burn */
+    rc = CG21_PRIME_POOL_FILL(&RNG, path, &K, 2);
+    assert(NULL, "CG21_PRIME_POOL_FILL", rc == CG21_PRIME_POOL_OK);
+
+    check_available(path, 2, "CG21_PRIME_POOL_AVAILABLE after fill");
+
+    rc = CG21_PRIME_POOL_TAKE(path, &K, &P1);
+    assert(NULL, "CG21_PRIME_POOL_TAKE first prime", rc == CG21_PRIME_POOL_OK);
+    check_safe_prime(&RNG, &P1, "CG21_PRIME_POOL_TAKE first prime is not a safe prime");
+
+    // The record of the first prime is burned
+    read_record(path, 0, record);
+    assert(NULL, "CG21_PRIME_POOL_TAKE record not marked as used", record[0] == USED);
+    for (int j = 1; j < CG21_PRIME_POOL_RECORD_SIZE; j++)
+    {
+        assert(NULL, "CG21_PRIME_POOL_TAKE record not wiped", record[j] == 0);
+    }
+
+    check_available(path, 1, "CG21_PRIME_POOL_AVAILABLE after take");
+
+    rc = CG21_PRIME_POOL_TAKE(path, &K, &P2);
+    assert(NULL, "CG21_PRIME_POOL_TAKE second prime", rc == CG21_PRIME_POOL_OK);
+    check_safe_prime(&RNG, &P2, "CG21_PRIME_POOL_TAKE second prime is not a safe prime");
+    assert(NULL, "CG21_PRIME_POOL_TAKE returned the same prime twice", !OCT_comp(&P1, &P2));
+
+    check_available(path, 0, "CG21_PRIME_POOL_AVAILABLE after emptying the pool");
+
+    rc = CG21_PRIME_POOL_TAKE(path, &K, &P1);
+    assert(NULL, "CG21_PRIME_POOL_TAKE from an empty pool", rc == CG21_PRIME_POOL_EMPTY);
+
+    // The records are appended after the burned ones
+    rc = CG21_PRIME_POOL_FILL(&RNG, path, &K, 2);
+    assert(NULL, "CG21_PRIME_POOL_FILL after take", rc == CG21_PRIME_POOL_OK);
+
+    check_available(path, 2, "CG21_PRIME_POOL_AVAILABLE after refill");
+
+    read_record(path, 2, record);
+    assert(NULL, "CG21_PRIME_POOL_FILL record not appended", record[0] == UNUSED);
+
+    /* Test unhappy path */
+
+    // A tampered ciphertext fails authentication, the record is still burned
+    tamper_record(path, 2, 1 + CG21_PRIME_POOL_IV_SIZE);
+
+    rc = CG21_PRIME_POOL_TAKE(path, &K, &P1);
+    assert(NULL, "CG21_PRIME_POOL_TAKE tampered record", rc == CG21_PRIME_POOL_INVALID_RECORD);
+    assert(NULL, "CG21_PRIME_POOL_TAKE tampered record output not cleared", P1.len == 0);
+
+    check_available(path, 1, "CG21_PRIME_POOL_AVAILABLE after tampered record");
+
+    // A different key fails authentication
+    rc = CG21_PRIME_POOL_TAKE(path, &WK, &P1);
+    assert(NULL, "CG21_PRIME_POOL_TAKE wrong key", rc == CG21_PRIME_POOL_INVALID_RECORD);
+
+    check_available(path, 0, "CG21_PRIME_POOL_AVAILABLE after wrong key");
+
+    // Invalid key length and output
+    K.len--;
+    rc = CG21_PRIME_POOL_FILL(&RNG, path, &K, 1);
+    assert(NULL, "CG21_PRIME_POOL_FILL invalid key", rc == CG21_PRIME_POOL_INVALID_KEY);
+
+    rc = CG21_PRIME_POOL_TAKE(path, &K, &P1);
+    assert(NULL, "CG21_PRIME_POOL_TAKE invalid key", rc == CG21_PRIME_POOL_INVALID_KEY);
+    K.len++;
+
+    rc = CG21_PRIME_POOL_TAKE(path, &K, &SMALL);
+    assert(NULL, "CG21_PRIME_POOL_TAKE invalid output", rc == CG21_PRIME_POOL_INVALID_OUTPUT);
+
+    // A truncated record makes the file invalid
+    FILE *fp = fopen(path, "ab");
+    assert(NULL, "ERROR opening the pool", fp != NULL);
+    fputc(0, fp);
+    fclose(fp);
+
+    rc = CG21_PRIME_POOL_TAKE(path, &K, &P1);
+    assert(NULL, "CG21_PRIME_POOL_TAKE truncated file", rc == CG21_PRIME_POOL_INVALID_FILE);
+
+    remove(path);
+
+    rc = CG21_PRIME_POOL_TAKE(path, &K, &P1);
+    assert(NULL, "CG21_PRIME_POOL_TAKE missing file", rc == CG21_PRIME_POOL_IO_ERROR);
+
+    KILL_CSPRNG(&RNG);
+
+    printf("SUCCESS\n");
+    exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,149 @@
+/*
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"); you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+*/
+
+#include <string.h>
+#include "test.h"
+#include "amcl/randapi.h"
+#include "amcl/parallel.h"
+#include "amcl/cg21/cg21_utilities.h"
+
+/* CG21 safe prime search unit test */
+
+#define LINE_LEN 256
+
+/* Bound of the small factors checked, the same as the sieve */
+#define SMALL_BOUND 16384
+
+/* Check P = 2p + 1 is a safe prime as generated by safe_prime_gen */
+static void check_safe_prime(FILE *fp, int testNo, char *name, csprng *RNG, BIG_1024_58 *p, BIG_1024_58 *P)
+{
+    BIG_1024_58 t[HFLEN_2048];
+
+    FF_2048_copy(t, p, HFLEN_2048);
+    FF_2048_shl(t, HFLEN_2048);
+    FF_2048_inc(t, 1, HFLEN_2048);
+    FF_2048_norm(t, HFLEN_2048);
+    assert_tv(fp, testNo, name, FF_2048_comp(t, P, HFLEN_2048) == 0);
+
+    assert_tv(fp, testNo, name, CG21_FF_2048_residue(p, 12, HFLEN_2048) == 11);
+
+    for (sign32 s = 3; s < SMALL_BOUND; s += 2)
+    {
+        assert_tv(fp, testNo, name, CG21_FF_2048_residue(p, s, HFLEN_2048) != 0);
+        assert_tv(fp, testNo, name, CG21_FF_2048_residue(P, s, HFLEN_2048) != 0);
+    }
+
+    assert_tv(fp, testNo, name, FF_2048_prime(p, RNG, HFLEN_2048));
+    assert_tv(fp, testNo, name, FF_2048_prime(P, RNG, HFLEN_2048));
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 2)
+    {
+        printf("usage: ./test_cg21_safe_prime [path to test vector file]\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int test_run = 0;
+
+    FILE *fp;
+    char line[LINE_LEN] = {0};
+
+    const char *TESTline = "TEST = ";
+    int testNo = 0;
+
+    char seed[16];
+    octet SEED = {0, sizeof(seed), seed};
+    const char *SEEDline = "SEED = ";
+
+    csprng RNG;
+    csprng CHECK_RNG;
+
+    BIG_1024_58 p[HFLEN_2048];
+    BIG_1024_58 P[HFLEN_2048];
+    BIG_1024_58 p_golden[HFLEN_2048];
+    BIG_1024_58 P_golden[HFLEN_2048];
+
+    // Line terminating a test vector
+    const char *last_line = SEEDline;
+
+    /* Test happy path using test vectors */
+    fp = fopen(argv[1], "r");
+    if (fp == NULL)
+    {
+        printf("ERROR opening test vector file\n");
+        exit(EXIT_FAILURE);
+    }
+
+    while (fgets(line, LINE_LEN, fp) != NULL)
+    {
+        scan_int(&testNo, line, TESTline);
+
+        // Read inputs
+        scan_OCTET(fp, &SEED, line, SEEDline);
+
+        if (!strncmp(line, last_line, strlen(last_line)))
+        {
+            CREATE_CSPRNG(&CHECK_RNG, &SEED);
+
+            // Sequential search
+            CREATE_CSPRNG(&RNG, &SEED);
+            safe_prime_gen(&RNG, p_golden, P_golden, HFLEN_2048);
+            KILL_CSPRNG(&RNG);
+
+            check_safe_prime(fp, testNo, "safe_prime_gen", &CHECK_RNG, p_golden, P_golden);
+
+            // A single thread falls back to the sequential search
+            PARALLEL_set_threads(1);
+
+            CREATE_CSPRNG(&RNG, &SEED);
+            safe_prime_gen_parallel(&RNG, p, P, HFLEN_2048);
+            KILL_CSPRNG(&RNG);
+
+            assert_tv(fp, testNo, "safe_prime_gen_parallel single thread p", FF_2048_comp(p, p_golden, HFLEN_2048) == 0);
+            assert_tv(fp, testNo, "safe_prime_gen_parallel single thread P", FF_2048_comp(P, P_golden, HFLEN_2048) == 0);
+
+            // The winner of the race depends on the scheduling, only check the result
+            PARALLEL_set_threads(4);
+
+            CREATE_CSPRNG(&RNG, &SEED);
+            safe_prime_gen_parallel(&RNG, p, P, HFLEN_2048);
+            KILL_CSPRNG(&RNG);
+
+            check_safe_prime(fp, testNo, "safe_prime_gen_parallel", &CHECK_RNG, p, P);
+
+            KILL_CSPRNG(&CHECK_RNG);
+
+            // Mark that at least one test vector was executed
+            test_run = 1;
+        }
+    }
+
+    fclose(fp);
+
+    if (test_run == 0)
+    {
+        printf("ERROR no test vector was executed\n");
+        exit(EXIT_FAILURE);
+    }
+
+    printf("SUCCESS\n");
+    exit(EXIT_SUCCESS);
+}
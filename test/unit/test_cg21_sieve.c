@@ -0,0 +1,104 @@
+/*
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"); you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+*/
+
+#include <string.h>
+#include "test.h"
+#include "amcl/cg21/cg21_utilities.h"
+
+/* CG21 safe prime sieve residues unit test */
+
+#define LINE_LEN 2048
+
+int main(int argc, char **argv)
+{
+    if (argc != 2)
+    {
+        printf("usage: ./test_cg21_sieve [path to test vector file]\n");
+        exit(EXIT_FAILURE);
+    }
+
+    sign32 r;
+    int test_run = 0;
+
+    FILE *fp;
+    char line[LINE_LEN] = {0};
+
+    const char *TESTline = "TEST = ";
+    int testNo = 0;
+
+    BIG_1024_58 X[FFLEN_2048];
+    const char *Xline = "X = ";
+
+    int s = 0;
+    const char *Sline = "S = ";
+
+    int r_golden = 0;
+    const char *Rline = "R = ";
+
+    int rh_golden = 0;
+    const char *RHline = "RH = ";
+
+    // Line terminating a test vector
+    const char *last_line = RHline;
+
+    /* Test happy path using test vectors */
+    fp = fopen(argv[1], "r");
+    if (fp == NULL)
+    {
+        printf("ERROR opening test vector file\n");
+        exit(EXIT_FAILURE);
+    }
+
+    while (fgets(line, LINE_LEN, fp) != NULL)
+    {
+        scan_int(&testNo, line, TESTline);
+
+        // Read inputs
+        scan_FF_2048(fp, X, line, Xline, FFLEN_2048);
+        scan_int(&s, line, Sline);
+
+        // Read ground truth
+        scan_int(&r_golden, line, Rline);
+        scan_int(&rh_golden, line, RHline);
+
+        if (!strncmp(line, last_line, strlen(last_line)))
+        {
+            r = CG21_FF_2048_residue(X, s, FFLEN_2048);
+            assert_tv(fp, testNo, "CG21_FF_2048_residue", r == r_golden);
+
+            // Only the low half of X
+            r = CG21_FF_2048_residue(X, s, HFLEN_2048);
+            assert_tv(fp, testNo, "CG21_FF_2048_residue half length", r == rh_golden);
+
+            // Mark that at least one test vector was executed
+            test_run = 1;
+        }
+    }
+
+    fclose(fp);
+
+    if (test_run == 0)
+    {
+        printf("ERROR no test vector was executed\n");
+        exit(EXIT_FAILURE);
+    }
+
+    printf("SUCCESS\n");
+    exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,278 @@
+/*
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"); you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+*/
+
+#include <string.h>
+#include "test.h"
+#include "amcl/cg21/cg21.h"
+
+/* CG21 batch signing with a presignature pool unit test */
+
+#define LINE_LEN      1024
+#define OCT_ARRAY_LEN 8
+
+/* Check a batch against the r and sigma of the test vector */
+static int batch_equal(const CG21_SIGN_BATCH *batch, const octet *RX, const octet *SIGMA)
+{
+    char b[EGS_SECP256K1];
+    octet B = {0, sizeof(b), b};
+
+    for (int j = 0; j < batch->n; j++)
+    {
+        B.len = EGS_SECP256K1;
+
+        BIG_256_56_toBytes(B.val, batch->r[j]);
+        if (!OCT_comp(&B, RX + j))
+        {
+            return 0;
+        }
+
+        BIG_256_56_toBytes(B.val, batch->sigma[j]);
+        if (!OCT_comp(&B, SIGMA + j))
+        {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 2)
+    {
+        printf("usage: ./test_cg21_sign_batch [path to test vector file]\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int i;
+    int rc;
+    int test_run = 0;
+
+    FILE *fp;
+    char line[LINE_LEN] = {0};
+
+    const char *TESTline = "TEST = ";
+    int testNo = 0;
+
+    const char *Nline = "N = ";
+    int n = 0;
+
+    const char *Rline = "R = ";
+    char r[OCT_ARRAY_LEN][EFS_SECP256K1 + 1];
+    octet R[OCT_ARRAY_LEN];
+
+    const char *Kline = "K = ";
+    char k[OCT_ARRAY_LEN][EGS_SECP256K1];
+    octet K[OCT_ARRAY_LEN];
+
+    const char *CHIline = "CHI = ";
+    char chi[OCT_ARRAY_LEN][EGS_SECP256K1];
+    octet CHI[OCT_ARRAY_LEN];
+
+    const char *HMline = "HM = ";
+    char hm[OCT_ARRAY_LEN][SHA256_HASH_SIZE];
+    octet HM[OCT_ARRAY_LEN];
+    octet *HM_ptr[OCT_ARRAY_LEN];
+
+    const char *Tline = "T = ";
+    char t[OCT_ARRAY_LEN][EGS_SECP256K1];
+    octet T[OCT_ARRAY_LEN];
+    octet *T_ptr[OCT_ARRAY_LEN];
+
+    const char *RXline = "RX = ";
+    char rx[OCT_ARRAY_LEN][EGS_SECP256K1];
+    octet RX[OCT_ARRAY_LEN];
+
+    const char *SIGMAline = "SIGMA = ";
+    char sigma[OCT_ARRAY_LEN][EGS_SECP256K1];
+    octet SIGMA[OCT_ARRAY_LEN];
+
+    const char *SIGMATline = "SIGMAT = ";
+    char sigmat[OCT_ARRAY_LEN][EGS_SECP256K1];
+    octet SIGMAT[OCT_ARRAY_LEN];
+
+    char store_r[EGS_SECP256K1];
+    octet STORE_R = {0, sizeof(store_r), store_r};
+
+    char store_sigma[EGS_SECP256K1];
+    octet STORE_SIGMA = {0, sizeof(store_sigma), store_sigma};
+
+    char out_sigma[EGS_SECP256K1];
+    octet OUT_SIGMA = {0, sizeof(out_sigma), out_sigma};
+
+    char packed[OCT_ARRAY_LEN * EGS_SECP256K1];
+    octet PACKED = {0, sizeof(packed), packed};
+
+    CG21_PRESIGN_ROUND4_STORE_2 pre[OCT_ARRAY_LEN];
+    CG21_SIGN_ROUND1_STORE store = {&STORE_R, &STORE_SIGMA, 0};
+    CG21_SIGN_ROUND1_OUTPUT out = {&OUT_SIGMA, 0};
+
+    BIG_256_56 pool_r[OCT_ARRAY_LEN];
+    BIG_256_56 pool_k[OCT_ARRAY_LEN];
+    BIG_256_56 pool_chi[OCT_ARRAY_LEN];
+    CG21_PRESIGN_POOL pool;
+
+    BIG_256_56 batch_r[OCT_ARRAY_LEN];
+    BIG_256_56 batch_sigma[OCT_ARRAY_LEN];
+    CG21_SIGN_BATCH batch = {batch_r, batch_sigma, 0};
+
+    for (i = 0; i < OCT_ARRAY_LEN; i++)
+    {
+        R[i].val = r[i];
+        R[i].len = 0;
+        R[i].max = sizeof(r[i]);
+
+        K[i].val = k[i];
+        K[i].len = 0;
+        K[i].max = sizeof(k[i]);
+
+        CHI[i].val = chi[i];
+        CHI[i].len = 0;
+        CHI[i].max = sizeof(chi[i]);
+
+        HM[i].val = hm[i];
+        HM[i].len = 0;
+        HM[i].max = sizeof(hm[i]);
+        HM_ptr[i] = HM + i;
+
+        T[i].val = t[i];
+        T[i].len = 0;
+        T[i].max = sizeof(t[i]);
+        T_ptr[i] = T + i;
+
+        RX[i].val = rx[i];
+        RX[i].len = 0;
+        RX[i].max = sizeof(rx[i]);
+
+        SIGMA[i].val = sigma[i];
+        SIGMA[i].len = 0;
+        SIGMA[i].max = sizeof(sigma[i]);
+
+        SIGMAT[i].val = sigmat[i];
+        SIGMAT[i].len = 0;
+        SIGMAT[i].max = sizeof(sigmat[i]);
+
+        pre[i].R = R + i;
+        pre[i].k = K + i;
+        pre[i].chi = CHI + i;
+    }
+
+    // Line terminating a test vector
+    const char *last_line = SIGMATline;
+
+    /* Test happy path using test vectors */
+    fp = fopen(argv[1], "r");
+    if (fp == NULL)
+    {
+        printf("ERROR opening test vector file\n");
+        exit(EXIT_FAILURE);
+    }
+
+    while (fgets(line, LINE_LEN, fp) != NULL)
+    {
+        scan_int(&testNo, line, TESTline);
+
+        // Read inputs
+        scan_int(&n, line, Nline);
+        scan_OCTET_ARRAY(fp, R, line, Rline, n);
+        scan_OCTET_ARRAY(fp, K, line, Kline, n);
+        scan_OCTET_ARRAY(fp, CHI, line, CHIline, n);
+        scan_OCTET_ARRAY(fp, HM, line, HMline, n);
+        scan_OCTET_ARRAY(fp, T, line, Tline, n);
+
+        // Read ground truth
+        scan_OCTET_ARRAY(fp, RX, line, RXline, n);
+        scan_OCTET_ARRAY(fp, SIGMA, line, SIGMAline, n);
+        scan_OCTET_ARRAY(fp, SIGMAT, line, SIGMATline, n);
+
+        if (!strncmp(line, last_line, strlen(last_line)))
+        {
+            for (i = 0; i < n; i++)
+            {
+                pre[i].i = testNo + 1;
+            }
+
+            // One signature at a time
+            for (i = 0; i < n; i++)
+            {
+                rc = CG21_SIGN_ROUND1_PREHASHED(HM + i, pre + i, &store, &out);
+                assert_tv(fp, testNo, "CG21_SIGN_ROUND1_PREHASHED",
+                          rc == CG21_OK && OCT_comp(&STORE_R, RX + i) && OCT_comp(&OUT_SIGMA, SIGMA + i));
+
+                rc = CG21_SIGN_ROUND1_TWEAKED(HM + i, T + i, pre + i, &store, &out);
+                assert_tv(fp, testNo, "CG21_SIGN_ROUND1_TWEAKED",
+                          rc == CG21_OK && OCT_comp(&STORE_R, RX + i) && OCT_comp(&OUT_SIGMA, SIGMAT + i));
+            }
+
+            // The same signatures from a pool
+            rc = CG21_PRESIGN_POOL_LOAD(&pool, pool_r, pool_k, pool_chi, pre, n);
+            assert_tv(fp, testNo, "CG21_PRESIGN_POOL_LOAD", rc == CG21_OK && pool.i == testNo + 1);
+
+            batch.n = n;
+            rc = CG21_SIGN_ROUND1_BATCH(&pool, HM_ptr, &batch);
+            assert_tv(fp, testNo, "CG21_SIGN_ROUND1_BATCH", rc == CG21_OK && batch_equal(&batch, RX, SIGMA));
+
+            rc = CG21_SIGN_ROUND1_BATCH(&pool, HM_ptr, &batch);
+            assert_tv(fp, testNo, "CG21_SIGN_ROUND1_BATCH empty pool", rc == CG21_PRESIGN_POOL_EMPTY);
+
+            rc = CG21_PRESIGN_POOL_LOAD(&pool, pool_r, pool_k, pool_chi, pre, n);
+            assert_tv(fp, testNo, "CG21_PRESIGN_POOL_LOAD", rc == CG21_OK);
+
+            rc = CG21_SIGN_ROUND1_BATCH_TWEAKED(&pool, HM_ptr, T_ptr, &batch);
+            assert_tv(fp, testNo, "CG21_SIGN_ROUND1_BATCH_TWEAKED",
+                      rc == CG21_OK && batch_equal(&batch, RX, SIGMAT));
+
+            // Packed sigmas
+            PACKED.max = n * EGS_SECP256K1 - 1;
+            rc = CG21_SIGN_BATCH_toOctet(&PACKED, &batch);
+            assert_tv(fp, testNo, "CG21_SIGN_BATCH_toOctet short output", rc == CG21_UTILITIES_WRONG_PACKED_SIZE);
+
+            PACKED.max = sizeof(packed);
+            rc = CG21_SIGN_BATCH_toOctet(&PACKED, &batch);
+            assert_tv(fp, testNo, "CG21_SIGN_BATCH_toOctet", rc == CG21_OK && PACKED.len == n * EGS_SECP256K1);
+
+            for (i = 0; i < n; i++)
+            {
+                assert_tv(fp, testNo, "CG21_SIGN_BATCH_toOctet packed sigma",
+                          !memcmp(PACKED.val + i * EGS_SECP256K1, SIGMAT[i].val, EGS_SECP256K1));
+            }
+
+            // A pool holds the presignatures of a single player
+            pre[n - 1].i++;
+
+            rc = CG21_PRESIGN_POOL_LOAD(&pool, pool_r, pool_k, pool_chi, pre, n);
+            assert_tv(fp, testNo, "CG21_PRESIGN_POOL_LOAD mixed ids",
+                      rc == CG21_PRESIGN_POOL_MIXED_IDS && pool.n == 0);
+
+            // Mark that at least one test vector was executed
+            test_run = 1;
+        }
+    }
+
+    fclose(fp);
+
+    if (test_run == 0)
+    {
+        printf("ERROR no test vector was executed\n");
+        exit(EXIT_FAILURE);
+    }
+
+    printf("SUCCESS\n");
+    exit(EXIT_SUCCESS);
+}
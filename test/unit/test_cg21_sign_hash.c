@@ -0,0 +1,142 @@
+/*
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"); you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+*/
+
+#include <string.h>
+#include "test.h"
+#include "amcl/cg21/cg21.h"
+
+/* CG21 streaming message digest unit test */
+
+#define LINE_LEN 4096
+#define MSG_LEN  1024
+
+/* Chunk sizes the messages are hashed with, 0 for an empty update */
+static const int chunks[] = {1, 7, 64, 0, MSG_LEN};
+
+int main(int argc, char **argv)
+{
+    if (argc != 2)
+    {
+        printf("usage: ./test_cg21_sign_hash [path to test vector file]\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int rc;
+    int test_run = 0;
+
+    FILE *fp;
+    char line[LINE_LEN] = {0};
+
+    const char *TESTline = "TEST = ";
+    int testNo = 0;
+
+    char msg[MSG_LEN];
+    octet MSG = {0, sizeof(msg), msg};
+    const char *MSGline = "MSG = ";
+
+    char hm_golden[SHA256_HASH_SIZE];
+    octet HM_GOLDEN = {0, sizeof(hm_golden), hm_golden};
+    const char *HMline = "HM = ";
+
+    char hm[SHA256_HASH_SIZE];
+    octet HM = {0, sizeof(hm), hm};
+
+    octet CHUNK;
+    CG21_SIGN_HASH ctx;
+
+    // Line terminating a test vector
+    const char *last_line = HMline;
+
+    /* Test happy path using test vectors */
+    fp = fopen(argv[1], "r");
+    if (fp == NULL)
+    {
+        printf("ERROR opening test vector file\n");
+        exit(EXIT_FAILURE);
+    }
+
+    while (fgets(line, LINE_LEN, fp) != NULL)
+    {
+        scan_int(&testNo, line, TESTline);
+
+        // Read inputs
+        scan_OCTET(fp, &MSG, line, MSGline);
+
+        // Read ground truth
+        scan_OCTET(fp, &HM_GOLDEN, line, HMline);
+
+        if (!strncmp(line, last_line, strlen(last_line)))
+        {
+            // Digest of the whole message, as CG21_SIGN_ROUND1 computes it
+            ehashit(HASH_TYPE_SECP256K1, &MSG, -1, NULL, &HM, MODBYTES_256_56);
+            assert_tv(fp, testNo, "ehashit", OCT_comp(&HM, &HM_GOLDEN));
+
+            for (int c = 0; c < (int)(sizeof(chunks) / sizeof(chunks[0])); c++)
+            {
+                CG21_SIGN_HASH_INIT(&ctx);
+
+                // An empty update leaves the digest unchanged
+                CHUNK.val = MSG.val;
+                CHUNK.len = 0;
+                CHUNK.max = 0;
+                CG21_SIGN_HASH_UPDATE(&ctx, &CHUNK);
+
+                for (int done = 0; done < MSG.len; done += CHUNK.len)
+                {
+                    CHUNK.val = MSG.val + done;
+                    CHUNK.len = (chunks[c] == 0) ? MSG.len : chunks[c];
+                    if (CHUNK.len > MSG.len - done)
+                    {
+                        CHUNK.len = MSG.len - done;
+                    }
+                    CHUNK.max = CHUNK.len;
+
+                    CG21_SIGN_HASH_UPDATE(&ctx, &CHUNK);
+                }
+
+                // A short output is rejected and the context can still be used
+                HM.max = SHA256_HASH_SIZE - 1;
+                OCT_clear(&HM);
+
+                rc = CG21_SIGN_HASH_FINAL(&ctx, &HM);
+                assert_tv(fp, testNo, "CG21_SIGN_HASH_FINAL short output",
+                          rc == CG21_SIGN_DIGEST_IS_INVALID && HM.len == 0);
+
+                HM.max = SHA256_HASH_SIZE;
+
+                rc = CG21_SIGN_HASH_FINAL(&ctx, &HM);
+                assert_tv(fp, testNo, "CG21_SIGN_HASH_FINAL", rc == CG21_OK && OCT_comp(&HM, &HM_GOLDEN));
+            }
+
+            // Mark that at least one test vector was executed
+            test_run = 1;
+        }
+    }
+
+    fclose(fp);
+
+    if (test_run == 0)
+    {
+        printf("ERROR no test vector was executed\n");
+        exit(EXIT_FAILURE);
+    }
+
+    printf("SUCCESS\n");
+    exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,583 @@
+/*
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"); you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+*/
+
+#include <string.h>
+#include "test.h"
+#include "amcl/cg21/cg21_wire.h"
+
+/* CG21 wire encoding unit test */
+
+#define EGS EGS_SECP256K1
+#define EFS (EFS_SECP256K1 + 1)
+
+#define POOL_SIZE   (1 << 18)
+#define MAX_FIELDS  64
+#define MSG_SIZE    (1 << 18)
+
+static char pool[POOL_SIZE];
+static int pool_used = 0;
+
+static octet fields[MAX_FIELDS];
+static int fields_used = 0;
+
+static char msg[MSG_SIZE];
+
+static octet EMPTY = {0, 0, NULL};
+
+/* New field of len bytes with distinct content */
+static octet *field(int len)
+{
+    octet *F = fields + fields_used;
+
+    F->len = len;
+    F->max = len;
+    F->val = pool + pool_used;
+
+    for (int k = 0; k < len; k++)
+    {
+        F->val[k] = (char)(fields_used + 7 * k);
+    }
+
+    fields_used++;
+    pool_used += len;
+
+    return F;
+}
+
+/* Release all the fields */
+static void reset()
+{
+    fields_used = 0;
+    pool_used = 0;
+}
+
+static void presign_round1(CG21_PRESIGN_ROUND1_OUTPUT *out, int g, int k)
+{
+    out->psi = field(CG21_WIRE_PIENC_PROOF_SIZE);
+    out->G = field(g);
+    out->K = field(k);
+    out->i = 3;
+}
+
+static void presign_round2(CG21_PRESIGN_ROUND2_OUTPUT *out, int i, int j, int gamma)
+{
+    out->Gamma = field(gamma);
+    out->D = field(FS_4096);
+    out->D_hat = field(FS_4096);
+    out->F = field(FS_4096);
+    out->F_hat = field(FS_4096);
+    out->psi = field(CG21_WIRE_PIAFFG_PROOF_SIZE);
+    out->psi_hat = field(CG21_WIRE_PIAFFG_PROOF_SIZE);
+    out->psi_prime = field(CG21_WIRE_PILOGSTAR_PROOF_SIZE);
+    out->i = i;
+    out->j = j;
+}
+
+static void presign_round3(CG21_PRESIGN_ROUND3_OUTPUT *out, int delta)
+{
+    out->delta = field(delta);
+    out->Delta = field(EFS);
+    out->psi_douplePrime = field(CG21_WIRE_PILOGSTAR_PROOF_SIZE);
+    out->i = 5;
+}
+
+static int same_round2(const CG21_PRESIGN_ROUND2_OUTPUT *a, const CG21_PRESIGN_ROUND2_OUTPUT *b)
+{
+    return OCT_comp(a->Gamma, b->Gamma) && OCT_comp(a->D, b->D) && OCT_comp(a->D_hat, b->D_hat) &&
+           OCT_comp(a->F, b->F) && OCT_comp(a->F_hat, b->F_hat) && OCT_comp(a->psi, b->psi) &&
+           OCT_comp(a->psi_hat, b->psi_hat) && OCT_comp(a->psi_prime, b->psi_prime) && a->i == b->i && a->j == b->j;
+}
+
+static void pienc_proof(PiEnc_COMMITS_OCT *c, PiEnc_PROOFS_OCT *p, int z3)
+{
+    c->S = field(FS_2048);
+    c->A = field(FS_4096);
+    c->C = field(FS_2048);
+    p->z1 = field(HFS_2048);
+    p->z2 = field(HFS_4096);
+    p->z3 = field(z3);
+}
+
+static void pilogstar_proof(PiLogstar_COMMITS_OCT *c, PiLogstar_PROOFS_OCT *p, int y)
+{
+    c->S = field(FS_2048);
+    c->A = field(FS_4096);
+    c->D = field(FS_2048);
+    c->Y = field(y);
+    p->z1 = field(HFS_2048);
+    p->z2 = field(HFS_4096);
+    p->z3 = field(FS_2048 + HFS_2048);
+}
+
+int main()
+{
+    int rc;
+
+    octet M = {0, sizeof(msg), msg};
+    octet views[MAX_FIELDS];
+
+    /* Test round trips */
+
+    CG21_PRESIGN_ROUND1_OUTPUT r1;
+    CG21_PRESIGN_ROUND1_OUTPUT r1d;
+
+    presign_round1(&r1, FS_4096, FS_4096);
+
+    rc = CG21_WIRE_PRESIGN_ROUND1_toOctet(&M, &r1);
+    assert(NULL, "PRESIGN_ROUND1 encode", rc == CG21_WIRE_OK);
+
+    rc = CG21_WIRE_PRESIGN_ROUND1_fromOctet(&M, &r1d, views);
+    assert(NULL, "PRESIGN_ROUND1 decode", rc == CG21_WIRE_OK);
+    assert(NULL, "PRESIGN_ROUND1 fields", OCT_comp(r1d.psi, r1.psi) && OCT_comp(r1d.G, r1.G) &&
+           OCT_comp(r1d.K, r1.K) && r1d.i == r1.i);
+
+    // The type is read from the header
+    int type;
+    rc = CG21_WIRE_TYPE(&M, &type);
+    assert(NULL, "PRESIGN_ROUND1 type", rc == CG21_WIRE_OK && type == CG21_WIRE_PRESIGN_ROUND1);
+
+    reset();
+
+    CG21_PRESIGN_ROUND2_OUTPUT r2;
+    CG21_PRESIGN_ROUND2_OUTPUT r2d;
+
+    presign_round2(&r2, 1, 2, EFS);
+
+    rc = CG21_WIRE_PRESIGN_ROUND2_toOctet(&M, &r2);
+    assert(NULL, "PRESIGN_ROUND2 encode", rc == CG21_WIRE_OK);
+
+    rc = CG21_WIRE_PRESIGN_ROUND2_fromOctet(&M, &r2d, views);
+    assert(NULL, "PRESIGN_ROUND2 decode", rc == CG21_WIRE_OK);
+    assert(NULL, "PRESIGN_ROUND2 fields", same_round2(&r2d, &r2));
+
+    reset();
+
+    CG21_PRESIGN_ROUND2_OUTPUT r2all[3];
+
+    for (int k = 0; k < 3; k++)
+    {
+        presign_round2(r2all + k, 1, k + 2, EFS);
+    }
+
+    rc = CG21_WIRE_PRESIGN_ROUND2_ALL_toOctet(&M, r2all, 3);
+    assert(NULL, "PRESIGN_ROUND2_ALL encode", rc == CG21_WIRE_OK);
+
+    for (int k = 0; k < 3; k++)
+    {
+        rc = CG21_WIRE_PRESIGN_ROUND2_ALL_fromOctet(&M, k + 2, 3, &r2d, views);
+        assert(NULL, "PRESIGN_ROUND2_ALL decode", rc == CG21_WIRE_OK);
+        assert(NULL, "PRESIGN_ROUND2_ALL fields", same_round2(&r2d, r2all + k));
+    }
+
+    reset();
+
+    CG21_PRESIGN_ROUND3_OUTPUT r3;
+    CG21_PRESIGN_ROUND3_OUTPUT r3d;
+
+    presign_round3(&r3, EGS);
+
+    rc = CG21_WIRE_PRESIGN_ROUND3_toOctet(&M, &r3);
+    assert(NULL, "PRESIGN_ROUND3 encode", rc == CG21_WIRE_OK);
+
+    rc = CG21_WIRE_PRESIGN_ROUND3_fromOctet(&M, &r3d, views);
+    assert(NULL, "PRESIGN_ROUND3 decode", rc == CG21_WIRE_OK);
+    assert(NULL, "PRESIGN_ROUND3 fields", OCT_comp(r3d.delta, r3.delta) && OCT_comp(r3d.Delta, r3.Delta) &&
+           OCT_comp(r3d.psi_douplePrime, r3.psi_douplePrime) && r3d.i == r3.i);
+
+    reset();
+
+    // Round 1 and 3 with a proof for each peer
+    int to[3] = {2, 4, 6};
+    octet *psi[3];
+
+    presign_round1(&r1, FS_4096, FS_4096);
+
+    for (int k = 0; k < 3; k++)
+    {
+        psi[k] = field(CG21_WIRE_PIENC_PROOF_SIZE);
+    }
+
+    rc = CG21_WIRE_PRESIGN_ROUND1_ALL_toOctet(&M, &r1, psi, to, 3);
+    assert(NULL, "PRESIGN_ROUND1_ALL encode", rc == CG21_WIRE_OK);
+
+    for (int k = 0; k < 3; k++)
+    {
+        rc = CG21_WIRE_PRESIGN_ROUND1_ALL_fromOctet(&M, to[k], 3, &r1d, views);
+        assert(NULL, "PRESIGN_ROUND1_ALL decode", rc == CG21_WIRE_OK);
+        assert(NULL, "PRESIGN_ROUND1_ALL fields", OCT_comp(r1d.psi, psi[k]) && OCT_comp(r1d.G, r1.G) &&
+               OCT_comp(r1d.K, r1.K) && r1d.i == r1.i);
+    }
+
+    reset();
+
+    presign_round3(&r3, EGS);
+
+    for (int k = 0; k < 3; k++)
+    {
+        psi[k] = field(CG21_WIRE_PILOGSTAR_PROOF_SIZE);
+    }
+
+    rc = CG21_WIRE_PRESIGN_ROUND3_ALL_toOctet(&M, &r3, psi, to, 3);
+    assert(NULL, "PRESIGN_ROUND3_ALL encode", rc == CG21_WIRE_OK);
+
+    for (int k = 0; k < 3; k++)
+    {
+        rc = CG21_WIRE_PRESIGN_ROUND3_ALL_fromOctet(&M, to[k], 3, &r3d, views);
+        assert(NULL, "PRESIGN_ROUND3_ALL decode", rc == CG21_WIRE_OK);
+        assert(NULL, "PRESIGN_ROUND3_ALL fields", OCT_comp(r3d.psi_douplePrime, psi[k]) &&
+               OCT_comp(r3d.delta, r3.delta) && OCT_comp(r3d.Delta, r3.Delta) && r3d.i == r3.i);
+    }
+
+    reset();
+
+    PiEnc_COMMITS_OCT ec;
+    PiEnc_COMMITS_OCT ecd;
+    PiEnc_PROOFS_OCT ep;
+    PiEnc_PROOFS_OCT epd;
+
+    pienc_proof(&ec, &ep, FS_2048 + HFS_2048);
+
+    rc = CG21_WIRE_PIENC_PROOF_toOctet(&M, &ec, &ep);
+    assert(NULL, "PIENC_PROOF encode", rc == CG21_WIRE_OK && M.len == CG21_WIRE_PIENC_PROOF_SIZE);
+
+    rc = CG21_WIRE_PIENC_PROOF_fromOctet(&M, &ecd, &epd, views);
+    assert(NULL, "PIENC_PROOF decode", rc == CG21_WIRE_OK);
+    assert(NULL, "PIENC_PROOF fields", OCT_comp(ecd.S, ec.S) && OCT_comp(ecd.A, ec.A) && OCT_comp(ecd.C, ec.C) &&
+           OCT_comp(epd.z1, ep.z1) && OCT_comp(epd.z2, ep.z2) && OCT_comp(epd.z3, ep.z3));
+
+    reset();
+
+    PiLogstar_COMMITS_OCT lc;
+    PiLogstar_COMMITS_OCT lcd;
+    PiLogstar_PROOFS_OCT lp;
+    PiLogstar_PROOFS_OCT lpd;
+
+    pilogstar_proof(&lc, &lp, EFS);
+
+    rc = CG21_WIRE_PILOGSTAR_PROOF_toOctet(&M, &lc, &lp);
+    assert(NULL, "PILOGSTAR_PROOF encode", rc == CG21_WIRE_OK && M.len == CG21_WIRE_PILOGSTAR_PROOF_SIZE);
+
+    rc = CG21_WIRE_PILOGSTAR_PROOF_fromOctet(&M, &lcd, &lpd, views);
+    assert(NULL, "PILOGSTAR_PROOF decode", rc == CG21_WIRE_OK);
+    assert(NULL, "PILOGSTAR_PROOF fields", OCT_comp(lcd.S, lc.S) && OCT_comp(lcd.A, lc.A) &&
+           OCT_comp(lcd.D, lc.D) && OCT_comp(lcd.Y, lc.Y) && OCT_comp(lpd.z1, lp.z1) &&
+           OCT_comp(lpd.z2, lp.z2) && OCT_comp(lpd.z3, lp.z3));
+
+    reset();
+
+    Piaffg_COMMITS_OCT c;
+    Piaffg_COMMITS_OCT cd;
+
+    c.A = field(FS_4096);
+    c.Bx = field(EFS);
+    c.By = field(FS_4096);
+    c.E = field(FS_2048);
+    c.S = field(FS_2048);
+    c.F = field(FS_2048);
+    c.T = field(FS_2048);
+
+    rc = CG21_WIRE_PIAFFG_COMMITS_toOctet(&M, &c);
+    assert(NULL, "PIAFFG_COMMITS encode", rc == CG21_WIRE_OK);
+
+    rc = CG21_WIRE_PIAFFG_COMMITS_fromOctet(&M, &cd, views);
+    assert(NULL, "PIAFFG_COMMITS decode", rc == CG21_WIRE_OK);
+    assert(NULL, "PIAFFG_COMMITS fields", OCT_comp(cd.A, c.A) && OCT_comp(cd.Bx, c.Bx) &&
+           OCT_comp(cd.By, c.By) && OCT_comp(cd.E, c.E) && OCT_comp(cd.S, c.S) &&
+           OCT_comp(cd.F, c.F) && OCT_comp(cd.T, c.T));
+
+    reset();
+
+    Piaffg_PROOFS_OCT p;
+    Piaffg_PROOFS_OCT pd;
+
+    p.z1 = field(FS_2048);
+    p.z2 = field(FS_2048);
+    p.z3 = field(FS_2048 + HFS_2048);
+    p.z4 = field(FS_2048 + HFS_2048);
+    p.w = field(FS_2048);
+    p.wy = field(FS_2048);
+
+    rc = CG21_WIRE_PIAFFG_PROOFS_toOctet(&M, &p);
+    assert(NULL, "PIAFFG_PROOFS encode", rc == CG21_WIRE_OK);
+
+    rc = CG21_WIRE_PIAFFG_PROOFS_fromOctet(&M, &pd, views);
+    assert(NULL, "PIAFFG_PROOFS decode", rc == CG21_WIRE_OK);
+    assert(NULL, "PIAFFG_PROOFS fields", OCT_comp(pd.z1, p.z1) && OCT_comp(pd.z2, p.z2) &&
+           OCT_comp(pd.z3, p.z3) && OCT_comp(pd.z4, p.z4) && OCT_comp(pd.w, p.w) && OCT_comp(pd.wy, p.wy));
+
+    // Commitment and proof in one message, as carried by psi and psi_hat
+    c.A = field(FS_4096);
+    c.Bx = field(EFS);
+    c.By = field(FS_4096);
+    c.E = field(FS_2048);
+    c.S = field(FS_2048);
+    c.F = field(FS_2048);
+    c.T = field(FS_2048);
+
+    rc = CG21_WIRE_PIAFFG_PROOF_toOctet(&M, &c, &p);
+    assert(NULL, "PIAFFG_PROOF encode", rc == CG21_WIRE_OK && M.len == CG21_WIRE_PIAFFG_PROOF_SIZE);
+
+    rc = CG21_WIRE_PIAFFG_PROOF_fromOctet(&M, &cd, &pd, views);
+    assert(NULL, "PIAFFG_PROOF decode", rc == CG21_WIRE_OK);
+    assert(NULL, "PIAFFG_PROOF fields", OCT_comp(cd.A, c.A) && OCT_comp(cd.Bx, c.Bx) && OCT_comp(cd.T, c.T) &&
+           OCT_comp(pd.z1, p.z1) && OCT_comp(pd.z4, p.z4) && OCT_comp(pd.wy, p.wy));
+
+    reset();
+
+    CG21_PIMOD_PROOF_OCT mod;
+    CG21_PIMOD_PROOF_OCT modd;
+
+    mod.w = field(HFS_4096);
+    mod.x = field(CG21_PAILLIER_PROOF_SIZE);
+    mod.z = field(CG21_PAILLIER_PROOF_SIZE);
+    mod.ab = field(CG21_PAILLIER_PROOF_AB_SIZE);
+
+    rc = CG21_WIRE_PIMOD_PROOF_toOctet(&M, &mod);
+    assert(NULL, "PIMOD_PROOF encode", rc == CG21_WIRE_OK);
+
+    rc = CG21_WIRE_PIMOD_PROOF_fromOctet(&M, &modd, views);
+    assert(NULL, "PIMOD_PROOF decode", rc == CG21_WIRE_OK);
+    assert(NULL, "PIMOD_PROOF fields", OCT_comp(modd.w, mod.w) && OCT_comp(modd.x, mod.x) &&
+           OCT_comp(modd.z, mod.z) && OCT_comp(modd.ab, mod.ab));
+
+    reset();
+
+    CG21_AUX_ROUND3 aux;
+    CG21_AUX_ROUND3 auxd;
+
+    aux.rho = field(EGS);
+    aux.i = 2;
+    aux.t = 3;
+    aux.paillierProof.w = field(HFS_4096);
+    aux.paillierProof.x = field(CG21_PAILLIER_PROOF_SIZE);
+    aux.paillierProof.z = field(CG21_PAILLIER_PROOF_SIZE);
+    aux.paillierProof.ab = field(CG21_PAILLIER_PROOF_AB_SIZE);
+    aux.factorProof.z1 = field(FS_2048 + HFS_2048);
+    aux.factorProof.z2 = field(FS_2048 + HFS_2048);
+    aux.factorProof.w1 = field(FS_2048 + HFS_2048);
+    aux.factorProof.w2 = field(FS_2048 + HFS_2048);
+    aux.factorProof.v = field(2 * FS_2048 + HFS_2048);
+    aux.factorCommits.P = field(FS_2048);
+    aux.factorCommits.Q = field(FS_2048);
+    aux.factorCommits.A = field(FS_2048);
+    aux.factorCommits.B = field(FS_2048);
+    aux.factorCommits.T = field(FS_2048);
+    aux.factorCommits.sigma = field(2 * FS_2048 + HFS_2048);
+
+    rc = CG21_WIRE_AUX_ROUND3_toOctet(&M, &aux);
+    assert(NULL, "AUX_ROUND3 encode", rc == CG21_WIRE_OK);
+
+    rc = CG21_WIRE_AUX_ROUND3_fromOctet(&M, &auxd, views);
+    assert(NULL, "AUX_ROUND3 decode", rc == CG21_WIRE_OK);
+    assert(NULL, "AUX_ROUND3 fields", OCT_comp(auxd.rho, aux.rho) && auxd.i == aux.i && auxd.t == aux.t &&
+           OCT_comp(auxd.paillierProof.x, aux.paillierProof.x) &&
+           OCT_comp(auxd.paillierProof.ab, aux.paillierProof.ab) &&
+           OCT_comp(auxd.factorProof.v, aux.factorProof.v) &&
+           OCT_comp(auxd.factorCommits.sigma, aux.factorCommits.sigma));
+
+    reset();
+
+    /* Test unhappy path */
+
+    presign_round1(&r1, FS_4096, FS_4096);
+    CG21_WIRE_PRESIGN_ROUND1_toOctet(&M, &r1);
+
+    // Truncated in the last field, in a length and in the header
+    int len = M.len;
+
+    M.len = len - 1;
+    rc = CG21_WIRE_PRESIGN_ROUND1_fromOctet(&M, &r1d, views);
+    assert(NULL, "truncated field", rc == CG21_WIRE_TRUNCATED);
+
+    M.len = CG21_WIRE_HEADER_SIZE + 2;
+    rc = CG21_WIRE_PRESIGN_ROUND1_fromOctet(&M, &r1d, views);
+    assert(NULL, "truncated length", rc == CG21_WIRE_TRUNCATED);
+
+    M.len = CG21_WIRE_HEADER_SIZE - 1;
+    rc = CG21_WIRE_PRESIGN_ROUND1_fromOctet(&M, &r1d, views);
+    assert(NULL, "truncated header", rc == CG21_WIRE_TRUNCATED);
+
+    // Trailing data
+    M.len = len + 1;
+    M.val[len] = 0;
+    rc = CG21_WIRE_PRESIGN_ROUND1_fromOctet(&M, &r1d, views);
+    assert(NULL, "trailing data", rc == CG21_WIRE_TRAILING_DATA);
+
+    // Unknown version and unexpected type
+    M.len = len;
+    M.val[0] = CG21_WIRE_VERSION + 1;
+    rc = CG21_WIRE_PRESIGN_ROUND1_fromOctet(&M, &r1d, views);
+    assert(NULL, "invalid version", rc == CG21_WIRE_INVALID_VERSION);
+
+    M.val[0] = CG21_WIRE_VERSION;
+    rc = CG21_WIRE_PRESIGN_ROUND3_fromOctet(&M, &r3d, views);
+    assert(NULL, "invalid type", rc == CG21_WIRE_INVALID_TYPE);
+
+    reset();
+
+    // Oversized and short ciphertexts
+    presign_round1(&r1, FS_4096, FS_4096 + 1);
+    CG21_WIRE_PRESIGN_ROUND1_toOctet(&M, &r1);
+    rc = CG21_WIRE_PRESIGN_ROUND1_fromOctet(&M, &r1d, views);
+    assert(NULL, "oversized K", rc == CG21_WIRE_INVALID_FIELD);
+
+    reset();
+
+    presign_round1(&r1, FS_4096 - 1, FS_4096);
+    CG21_WIRE_PRESIGN_ROUND1_toOctet(&M, &r1);
+    rc = CG21_WIRE_PRESIGN_ROUND1_fromOctet(&M, &r1d, views);
+    assert(NULL, "short G", rc == CG21_WIRE_INVALID_FIELD);
+
+    reset();
+
+    // Missing proof
+    presign_round1(&r1, FS_4096, FS_4096);
+    r1.psi = &EMPTY;
+    CG21_WIRE_PRESIGN_ROUND1_toOctet(&M, &r1);
+    rc = CG21_WIRE_PRESIGN_ROUND1_fromOctet(&M, &r1d, views);
+    assert(NULL, "empty psi", rc == CG21_WIRE_INVALID_FIELD);
+
+    reset();
+
+    presign_round2(&r2, 1, 2, EFS);
+    r2.psi_prime = field(CG21_WIRE_PIAFFG_PROOF_SIZE);
+    CG21_WIRE_PRESIGN_ROUND2_toOctet(&M, &r2);
+    rc = CG21_WIRE_PRESIGN_ROUND2_fromOctet(&M, &r2d, views);
+    assert(NULL, "PiAffg proof as psi_prime", rc == CG21_WIRE_INVALID_FIELD);
+
+    reset();
+
+    // Integer field of 5 bytes
+    octet *f[CG21_WIRE_PRESIGN_ROUND1_FIELDS] = {field(CG21_WIRE_PIENC_PROOF_SIZE), field(FS_4096), field(FS_4096),
+                                                 field(5)};
+    CG21_WIRE_ENCODE(&M, CG21_WIRE_PRESIGN_ROUND1, f, CG21_WIRE_PRESIGN_ROUND1_FIELDS);
+    rc = CG21_WIRE_PRESIGN_ROUND1_fromOctet(&M, &r1d, views);
+    assert(NULL, "integer field", rc == CG21_WIRE_INVALID_FIELD);
+
+    reset();
+
+    // Oversized point in round 2, in one section of round 2 for all the peers
+    presign_round2(&r2, 1, 2, EFS + 1);
+    CG21_WIRE_PRESIGN_ROUND2_toOctet(&M, &r2);
+    rc = CG21_WIRE_PRESIGN_ROUND2_fromOctet(&M, &r2d, views);
+    assert(NULL, "oversized Gamma", rc == CG21_WIRE_INVALID_FIELD);
+
+    reset();
+
+    presign_round2(r2all, 1, 2, EFS);
+    presign_round2(r2all + 1, 1, 3, EFS - 1);
+    CG21_WIRE_PRESIGN_ROUND2_ALL_toOctet(&M, r2all, 2);
+    rc = CG21_WIRE_PRESIGN_ROUND2_ALL_fromOctet(&M, 2, 2, &r2d, views);
+    assert(NULL, "short Gamma in a section", rc == CG21_WIRE_INVALID_FIELD);
+
+    reset();
+
+    // No section for the player, or another number of sections
+    presign_round2(r2all, 1, 2, EFS);
+    presign_round2(r2all + 1, 1, 3, EFS);
+    CG21_WIRE_PRESIGN_ROUND2_ALL_toOctet(&M, r2all, 2);
+
+    rc = CG21_WIRE_PRESIGN_ROUND2_ALL_fromOctet(&M, 4, 2, &r2d, views);
+    assert(NULL, "no section", rc == CG21_WIRE_NO_SECTION);
+
+    rc = CG21_WIRE_PRESIGN_ROUND2_ALL_fromOctet(&M, 2, 3, &r2d, views);
+    assert(NULL, "section count", rc == CG21_WIRE_INVALID_COUNT);
+
+    rc = CG21_WIRE_PRESIGN_ROUND2_ALL_toOctet(&M, r2all, 0);
+    assert(NULL, "no sections", rc == CG21_WIRE_INVALID_COUNT);
+
+    reset();
+
+    // No proof for the player, short proof for a peer, no peers
+    presign_round1(&r1, FS_4096, FS_4096);
+    psi[0] = field(CG21_WIRE_PIENC_PROOF_SIZE);
+    psi[1] = field(CG21_WIRE_PIENC_PROOF_SIZE);
+    CG21_WIRE_PRESIGN_ROUND1_ALL_toOctet(&M, &r1, psi, to, 2);
+
+    rc = CG21_WIRE_PRESIGN_ROUND1_ALL_fromOctet(&M, 6, 2, &r1d, views);
+    assert(NULL, "no proof for the player", rc == CG21_WIRE_NO_SECTION);
+
+    rc = CG21_WIRE_PRESIGN_ROUND1_ALL_fromOctet(&M, 2, 3, &r1d, views);
+    assert(NULL, "proof count", rc == CG21_WIRE_INVALID_COUNT);
+
+    rc = CG21_WIRE_PRESIGN_ROUND1_ALL_toOctet(&M, &r1, psi, to, 0);
+    assert(NULL, "no proofs", rc == CG21_WIRE_INVALID_COUNT);
+
+    reset();
+
+    presign_round3(&r3, EGS);
+    psi[0] = field(CG21_WIRE_PILOGSTAR_PROOF_SIZE);
+    psi[1] = field(CG21_WIRE_PILOGSTAR_PROOF_SIZE - 1);
+    CG21_WIRE_PRESIGN_ROUND3_ALL_toOctet(&M, &r3, psi, to, 2);
+    rc = CG21_WIRE_PRESIGN_ROUND3_ALL_fromOctet(&M, 2, 2, &r3d, views);
+    assert(NULL, "short proof for a peer", rc == CG21_WIRE_INVALID_FIELD);
+
+    reset();
+
+    // Short z3 of a PiEnc proof, uncompressed Y of a PiLogstar proof
+    pienc_proof(&ec, &ep, FS_2048);
+    CG21_WIRE_PIENC_PROOF_toOctet(&M, &ec, &ep);
+    rc = CG21_WIRE_PIENC_PROOF_fromOctet(&M, &ecd, &epd, views);
+    assert(NULL, "short PiEnc z3", rc == CG21_WIRE_INVALID_FIELD);
+
+    reset();
+
+    pilogstar_proof(&lc, &lp, 2 * EFS_SECP256K1 + 1);
+    CG21_WIRE_PILOGSTAR_PROOF_toOctet(&M, &lc, &lp);
+    rc = CG21_WIRE_PILOGSTAR_PROOF_fromOctet(&M, &lcd, &lpd, views);
+    assert(NULL, "uncompressed PiLogstar Y", rc == CG21_WIRE_INVALID_FIELD);
+
+    // A PiLogstar proof is not a PiEnc proof
+    pilogstar_proof(&lc, &lp, EFS);
+    CG21_WIRE_PILOGSTAR_PROOF_toOctet(&M, &lc, &lp);
+    rc = CG21_WIRE_PIENC_PROOF_fromOctet(&M, &ecd, &epd, views);
+    assert(NULL, "PiLogstar proof as PiEnc", rc == CG21_WIRE_INVALID_TYPE);
+
+    reset();
+
+    // Oversized scalar in round 3
+    presign_round3(&r3, EGS + 1);
+    CG21_WIRE_PRESIGN_ROUND3_toOctet(&M, &r3);
+    rc = CG21_WIRE_PRESIGN_ROUND3_fromOctet(&M, &r3d, views);
+    assert(NULL, "oversized delta", rc == CG21_WIRE_INVALID_FIELD);
+
+    reset();
+
+    // Short z3 of a PiAffg proof
+    p.z1 = field(FS_2048);
+    p.z2 = field(FS_2048);
+    p.z3 = field(FS_2048);
+    p.z4 = field(FS_2048 + HFS_2048);
+    p.w = field(FS_2048);
+    p.wy = field(FS_2048);
+    CG21_WIRE_PIAFFG_PROOFS_toOctet(&M, &p);
+    rc = CG21_WIRE_PIAFFG_PROOFS_fromOctet(&M, &pd, views);
+    assert(NULL, "short z3", rc == CG21_WIRE_INVALID_FIELD);
+
+    reset();
+
+    // Message larger than the output buffer
+    octet SMALL = {0, CG21_WIRE_HEADER_SIZE, msg};
+    presign_round3(&r3, EGS);
+    rc = CG21_WIRE_PRESIGN_ROUND3_toOctet(&SMALL, &r3);
+    assert(NULL, "buffer too small", rc == CG21_WIRE_BUFFER_TOO_SMALL);
+
+    printf("SUCCESS\n");
+    exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,202 @@
+/*
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"); you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+*/
+
+/* Hidden DLOG chunked verification unit test */
+
+#include <string.h>
+#include "test.h"
+#include "amcl/hidden_dlog.h"
+
+#define LINE_LEN 65555
+
+/* Size of the chunks, not a divisor of HDLOG_PROOF_ITERS */
+#define CHUNK 5
+
+/* Verify the encoded RHO and T in chunks of CHUNK iterations */
+int verify_chunks(BIG_1024_58 *N, BIG_1024_58 *B0, BIG_1024_58 *B1, octet *RHO, octet *E, octet *T)
+{
+    int rc;
+
+    HDLOG_verify_state S;
+
+    rc = HDLOG_verify_init(&S, N, B0, B1, E);
+    if (rc != HDLOG_OK)
+    {
+        return rc;
+    }
+
+    for (int i = 0; i < HDLOG_PROOF_ITERS; i += CHUNK)
+    {
+        int k = HDLOG_PROOF_ITERS - i < CHUNK ? HDLOG_PROOF_ITERS - i : CHUNK;
+
+        octet R = {k * FS_2048, k * FS_2048, RHO->val + i * FS_2048};
+        octet U = {k * FS_2048, k * FS_2048, T->val + i * FS_2048};
+
+        rc = HDLOG_verify_chunk(&S, &R, &U);
+        if (rc != HDLOG_OK)
+        {
+            return rc;
+        }
+    }
+
+    return HDLOG_verify_final(&S);
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 2)
+    {
+        printf("usage: ./test_hidden_dlog_verify_chunk [path to test vector file]\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int rc;
+    int test_run = 0;
+
+    FILE *fp;
+    char line[LINE_LEN] = {0};
+
+    const char *TESTline = "TEST = ";
+    int testNo = 0;
+
+    BIG_1024_58 N[FFLEN_2048];
+    const char *Nline = "N = ";
+
+    BIG_1024_58 B0[FFLEN_2048];
+    const char *B0line = "B0 = ";
+
+    BIG_1024_58 B1[FFLEN_2048];
+    const char *B1line = "B1 = ";
+
+    HDLOG_iter_values RHO;
+    const char *RHOline = "RHO = ";
+
+    HDLOG_iter_values T;
+    const char *Tline = "T = ";
+
+    char e[HDLOG_CHALLENGE_SIZE];
+    octet E = {0, sizeof(e), e};
+    const char *Eline = "E = ";
+
+    char rho[HDLOG_VALUES_SIZE];
+    octet RHOoct = {0, sizeof(rho), rho};
+
+    char t[HDLOG_VALUES_SIZE];
+    octet Toct = {0, sizeof(t), t};
+
+    // Line terminating a test vector
+    const char *last_line = Tline;
+
+    fp = fopen(argv[1], "r");
+    if (fp == NULL)
+    {
+        printf("ERROR opening test vector file\n");
+        exit(EXIT_FAILURE);
+    }
+
+    /* Test happy path using test vectors */
+
+    while (fgets(line, LINE_LEN, fp) != NULL)
+    {
+        scan_int(&testNo, line, TESTline);
+
+        scan_FF_2048(fp, N,  line, Nline,  FFLEN_2048);
+        scan_FF_2048(fp, B0, line, B0line, FFLEN_2048);
+        scan_FF_2048(fp, B1, line, B1line, FFLEN_2048);
+
+        scan_HDLOG_iv(fp, RHO, line, RHOline);
+        scan_HDLOG_iv(fp, T,   line, Tline);
+
+        scan_OCTET(fp, &E, line, Eline);
+
+        if (!strncmp(line, last_line, strlen(last_line)))
+        {
+            HDLOG_iter_values_toOctet(&RHOoct, RHO);
+            HDLOG_iter_values_toOctet(&Toct, T);
+
+            rc = verify_chunks(N, B0, B1, &RHOoct, &E, &Toct);
+
+            assert_tv(fp, testNo, "HDLOG_verify_chunk", rc == HDLOG_OK);
+
+            // Mark that at least one test vector was executed
+            test_run = 1;
+        }
+    }
+
+    fclose(fp);
+
+    if (test_run == 0)
+    {
+        printf("ERROR no test vector was executed\n");
+        exit(EXIT_FAILURE);
+    }
+
+    /* Test unhappy path */
+    HDLOG_verify_state S;
+
+    // Short challenge
+    E.len = HDLOG_CHALLENGE_SIZE - 1;
+
+    rc = HDLOG_verify_init(&S, N, B0, B1, &E);
+
+    assert(NULL, "HDLOG_verify_init. Short challenge", rc == HDLOG_INVALID_VALUES);
+
+    E.len = HDLOG_CHALLENGE_SIZE;
+
+    rc = HDLOG_verify_init(&S, N, B0, B1, &E);
+
+    assert(NULL, "HDLOG_verify_init. Valid challenge", rc == HDLOG_OK);
+
+    // Chunks of different lengths
+    octet R = {2 * FS_2048, 2 * FS_2048, RHOoct.val};
+    octet U = {FS_2048, FS_2048, Toct.val};
+
+    rc = HDLOG_verify_chunk(&S, &R, &U);
+
+    assert(NULL, "HDLOG_verify_chunk. Invalid chunk length", rc == HDLOG_INVALID_VALUES);
+
+    // Missing iterations
+    R.len = FS_2048;
+
+    rc = HDLOG_verify_chunk(&S, &R, &U);
+
+    assert(NULL, "HDLOG_verify_chunk. Valid chunk", rc == HDLOG_OK);
+
+    rc = HDLOG_verify_final(&S);
+
+    assert(NULL, "HDLOG_verify_final. Missing iterations", rc == HDLOG_INVALID_VALUES);
+
+    // Chunk past the last iteration
+    RHOoct.len = HDLOG_VALUES_SIZE;
+    Toct.len = HDLOG_VALUES_SIZE;
+
+    rc = HDLOG_verify_chunk(&S, &RHOoct, &Toct);
+
+    assert(NULL, "HDLOG_verify_chunk. Too many iterations", rc == HDLOG_INVALID_VALUES);
+
+    // Invalid proof
+    Toct.val[FS_2048 + 1] ^= 1;
+
+    rc = verify_chunks(N, B0, B1, &RHOoct, &E, &Toct);
+
+    assert(NULL, "HDLOG_verify_chunk. Invalid proof", rc == HDLOG_FAIL);
+
+    printf("SUCCESS\n");
+    exit(EXIT_SUCCESS);
+}
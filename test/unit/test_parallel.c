@@ -0,0 +1,273 @@
+/*
+Licensed to the Apache Software Foundation (ASF) under one
+or more contributor license agreements.  See the NOTICE file
+distributed with this work for additional information
+regarding copyright ownership.  The ASF licenses this file
+to you under the Apache License, Version 2.0 (the
+"License"); you may not use this file except in compliance
+with the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the License is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied.  See the License for the
+specific language governing permissions and limitations
+under the License.
+*/
+
+/* Parallel loops unit test */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "amcl/parallel.h"
+
+#define ITERS 128
+
+typedef struct
+{
+    int out[ITERS];
+    int calls[ITERS];
+} test_ctx;
+
+static void square(void *arg, int i)
+{
+    test_ctx *c = (test_ctx *)arg;
+
+    c->out[i] = i * i;
+    c->calls[i]++;
+}
+
+static int executor_calls = 0;
+
+/* Executor running the iterations backwards */
+static void reverse_executor(void *pool, PARALLEL_task task, void *ctx, int n)
+{
+    int *calls = (int *)pool;
+
+    (*calls)++;
+
+    for (int i = n - 1; i >= 0; i--)
+    {
+        task(ctx, i);
+    }
+}
+
+static void check(test_ctx *c, const char *name)
+{
+    for (int i = 0; i < ITERS; i++)
+    {
+        if (c->out[i] != i * i || c->calls[i] != 1)
+        {
+            fprintf(stderr, "FAILURE %s iteration %d\n", name, i);
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+#define OUTER 4
+
+/* Each outer iteration runs its own loop */
+static void nested(void *arg, int i)
+{
+    test_ctx *c = (test_ctx *)arg;
+
+    PARALLEL_for(square, &c[i], ITERS);
+}
+
+/* Only worker 1 succeeds */
+static int race_one(void *arg, int i, PARALLEL_stop stop, void *token)
+{
+    (void)arg;
+    (void)stop;
+    (void)token;
+
+    return i == 1;
+}
+
+/* No worker succeeds */
+static int race_none(void *arg, int i, PARALLEL_stop stop, void *token)
+{
+    (void)arg;
+    (void)i;
+    (void)stop;
+    (void)token;
+
+    return 0;
+}
+
+/* Only check 37 fails */
+static int check_one(void *arg, int i)
+{
+    (void)arg;
+
+    return (i == 37) ? 5 : 0;
+}
+
+int main()
+{
+    int threads[] = {1, 3, 4, 0, ITERS + 1};
+
+    test_ctx c;
+
+    /* Test internal executor with different number of threads */
+    for (unsigned int t = 0; t < sizeof(threads) / sizeof(threads[0]); t++)
+    {
+        for (int i = 0; i < ITERS; i++)
+        {
+            c.out[i] = -1;
+            c.calls[i] = 0;
+        }
+
+        PARALLEL_set_threads(threads[t]);
+        PARALLEL_for(square, &c, ITERS);
+
+        check(&c, "internal executor");
+    }
+
+    /* Test caller supplied executor */
+    for (int i = 0; i < ITERS; i++)
+    {
+        c.out[i] = -1;
+        c.calls[i] = 0;
+    }
+
+    PARALLEL_set_executor(reverse_executor, &executor_calls);
+    PARALLEL_for(square, &c, ITERS);
+    PARALLEL_set_executor(NULL, NULL);
+
+    check(&c, "caller executor");
+
+    if (executor_calls != 1)
+    {
+        fprintf(stderr, "FAILURE caller executor not used\n");
+        exit(EXIT_FAILURE);
+    }
+
+    /* Test nested loops, only the outer one uses the executor */
+    test_ctx inner[OUTER];
+
+    for (int k = 0; k < OUTER; k++)
+    {
+        for (int i = 0; i < ITERS; i++)
+        {
+            inner[k].out[i] = -1;
+            inner[k].calls[i] = 0;
+        }
+    }
+
+    PARALLEL_set_executor(reverse_executor, &executor_calls);
+    PARALLEL_for(nested, inner, OUTER);
+    PARALLEL_set_executor(NULL, NULL);
+
+    for (int k = 0; k < OUTER; k++)
+    {
+        check(&inner[k], "nested caller executor");
+    }
+
+    if (executor_calls != 2)
+    {
+        fprintf(stderr, "FAILURE caller executor re-entered\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (unsigned int t = 0; t < sizeof(threads) / sizeof(threads[0]); t++)
+    {
+        for (int k = 0; k < OUTER; k++)
+        {
+            for (int i = 0; i < ITERS; i++)
+            {
+                inner[k].out[i] = -1;
+                inner[k].calls[i] = 0;
+            }
+        }
+
+        PARALLEL_set_threads(threads[t]);
+        PARALLEL_for(nested, inner, OUTER);
+
+        for (int k = 0; k < OUTER; k++)
+        {
+            check(&inner[k], "nested internal executor");
+        }
+    }
+
+    /* Test race between workers */
+    PARALLEL_set_threads(4);
+
+    if (PARALLEL_race(race_one, NULL, 4) != 1)
+    {
+        fprintf(stderr, "FAILURE race winner\n");
+        exit(EXIT_FAILURE);
+    }
+
+    if (PARALLEL_race(race_none, NULL, 4) != -1)
+    {
+        fprintf(stderr, "FAILURE race without winner\n");
+        exit(EXIT_FAILURE);
+    }
+
+    /* Test CRT halves, sequential and concurrent */
+    for (int enable = 0; enable < 2; enable++)
+    {
+        c.out[0] = c.out[1] = -1;
+        c.calls[0] = c.calls[1] = 0;
+
+        PARALLEL_set_crt(enable);
+        PARALLEL_crt(square, &c);
+
+        if (c.out[0] != 0 || c.out[1] != 1 || c.calls[0] != 1 || c.calls[1] != 1)
+        {
+            fprintf(stderr, "FAILURE crt halves\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    PARALLEL_set_crt(0);
+
+    /* Test verification with early abort */
+    int verdicts[ITERS];
+
+    for (unsigned int t = 0; t < sizeof(threads) / sizeof(threads[0]); t++)
+    {
+        PARALLEL_set_threads(threads[t]);
+
+        if (PARALLEL_verify(check_one, NULL, ITERS, verdicts) != 37)
+        {
+            fprintf(stderr, "FAILURE verify failed index\n");
+            exit(EXIT_FAILURE);
+        }
+
+        for (int i = 0; i < ITERS; i++)
+        {
+            int expected = (i == 37) ? 5 : 0;
+
+            // Run in order, the checks after the failure are all cancelled
+            if ((threads[t] == 1 && i > 37 && verdicts[i] != PARALLEL_SKIPPED) ||
+                    (verdicts[i] != expected && verdicts[i] != PARALLEL_SKIPPED) ||
+                    (i == 37 && verdicts[i] != 5))
+            {
+                fprintf(stderr, "FAILURE verify verdict %d\n", i);
+                exit(EXIT_FAILURE);
+            }
+        }
+
+        if (PARALLEL_verify(check_one, NULL, 37, verdicts) != -1)
+        {
+            fprintf(stderr, "FAILURE verify without failure\n");
+            exit(EXIT_FAILURE);
+        }
+
+        for (int i = 0; i < 37; i++)
+        {
+            if (verdicts[i] != 0)
+            {
+                fprintf(stderr, "FAILURE verify verdict %d\n", i);
+                exit(EXIT_FAILURE);
+            }
+        }
+    }
+
+    printf("SUCCESS\n");
+    exit(EXIT_SUCCESS);
+}